@@ -0,0 +1,81 @@
+/**
+ * PingPongDelayAudit.h:
+ *
+ * Declaration of PingPongDelayAuditScope class marking the code
+ * which must never allocate, free nor lock, such as processReplacing.
+ *
+ * Scopes only call the hooks of the audit shim (built from
+ * PingPongDelayAuditShim.cpp and loaded by LD_PRELOAD), which checks
+ * every allocation and lock of the marked thread. Without the shim
+ * loaded the hooks are not resolved and scopes do nothing.
+ *
+ * Whole audit is compiled only when PINGPONGDELAY_AUDIT is
+ * defined on Linux, otherwise this header declares nothing.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayAuditScope
+ */
+
+
+#if defined(PINGPONGDELAY_AUDIT) && defined(__linux__)
+
+#ifndef PINGPONGDELAYAUDIT_H
+#define PINGPONGDELAYAUDIT_H
+
+
+extern "C"
+{
+    /**
+     * Hook of the audit shim marking the beginning of the audited scope
+     * on the calling thread. Weak, so it resolves to NULL without the shim.
+     */
+    void pingpongdelay_audit_enter() __attribute__((weak));
+
+    /**
+     * Hook of the audit shim marking the end of the audited scope
+     * on the calling thread. Weak, so it resolves to NULL without the shim.
+     */
+    void pingpongdelay_audit_leave() __attribute__((weak));
+}
+
+
+namespace PingPongDelay
+{
+    /**
+     * Marks the lifetime of the object as audited scope of the current
+     * thread. Any allocation, freeing or locking within it is reported
+     * by the audit shim as a violation.
+     */
+    class PingPongDelayAuditScope
+    {
+    public:
+        /**
+         * A constructor. Enters the audited scope.
+         */
+        PingPongDelayAuditScope()
+        {
+            if(pingpongdelay_audit_enter)
+            {
+                pingpongdelay_audit_enter();
+            }
+        }
+
+        /**
+         * A destructor. Leaves the audited scope.
+         */
+        ~PingPongDelayAuditScope()
+        {
+            if(pingpongdelay_audit_leave)
+            {
+                pingpongdelay_audit_leave();
+            }
+        }
+    };
+}
+
+
+#endif
+#endif
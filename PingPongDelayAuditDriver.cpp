@@ -0,0 +1,292 @@
+/**
+ * PingPongDelayAuditDriver.cpp:
+ *
+ * Command line tool hosting PingPongDelayEffect without a real host,
+ * so that its audio thread is audited by the audit shim on every build.
+ *
+ * Usage: LD_PRELOAD=libPingPongDelayAudit.so PingPongDelayAuditDriver
+ *              [-b frames] [-n blocks] [-r rate] [-s speakers]
+ *      -b frames the largest number of frames processed at once,
+ *          512 by default.
+ *      -n blocks a number of processed blocks, 20000 by default.
+ *      -r rate a sample rate in Hz, 48000 by default.
+ *      -s speakers a number of speakers, 2 for stereo by default,
+ *          4 for quad, 6 for 5.1, 8 for 7.1 or 12 for 7.1.4.
+ *      with the effect built with PINGPONGDELAY_AUDIT and
+ *      PINGPONGDELAY_NO_EDITOR defined.
+ *
+ * Driver creates the effect against a stub audio master answering only
+ * the time info, resumes it and processes the blocks by processReplacing.
+ * Between the blocks it changes the parameters, switches the programs,
+ * freezes the delay line, drifts the tempo and varies the block size, as
+ * a host would from its other threads, so that every path of the audio
+ * thread is taken. The economy is changed by suspending and resuming
+ * the effect. The shim fails the driver on any allocation, freeing
+ * or locking within processReplacing. Surround speakers are arranged
+ * before the first resume, as by a host.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayEffect
+ * @see PingPongDelayAuditScope
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+#include "public.sdk/source/vst2.x/audioeffectx.h"
+#include "PingPongDelayEffect.h"
+
+
+using namespace PingPongDelay;
+
+
+extern AudioEffect* createEffectInstance(audioMasterCallback audioMaster);
+
+
+/**
+ * Time info reported by the stub audio master.
+ */
+VstTimeInfo driverTimeInfo;
+
+/**
+ * Maximal number of speakers of the driver.
+ */
+const int maxDriverSpeakers = 12;
+
+/**
+ * Speaker arrangement of the driver, with room for the speakers past
+ * the eight held by VstSpeakerArrangement itself.
+ */
+struct DriverArrangement
+{
+    /**
+     * The arrangement with its first speakers.
+     */
+    VstSpeakerArrangement arrangement;
+
+    /**
+     * The speakers following the first ones.
+     */
+    VstSpeakerProperties moreSpeakers[maxDriverSpeakers - 8];
+};
+
+/**
+ * Types of the speakers of the 7.1.4 arrangement in the channel order
+ * of the hosts, the quad, 5.1 and 7.1 ones take the ones they have.
+ */
+const VstInt32 driverSpeakers[maxDriverSpeakers] =
+{
+    kSpeakerL, kSpeakerR, kSpeakerC, kSpeakerLfe, kSpeakerLs, kSpeakerRs,
+    kSpeakerSl, kSpeakerSr, kSpeakerTfl, kSpeakerTfr, kSpeakerTrl, kSpeakerTrr
+};
+
+
+/**
+ * Stub audio master of the driver, it reports the time info and answers
+ * nothing else.
+ * @param effect the effect calling back.
+ * @param opcode an opcode of the request.
+ * @param index a request specific index.
+ * @param value a request specific value.
+ * @param ptr a request specific pointer.
+ * @param opt a request specific float value.
+ * @return pointer to the time info for audioMasterGetTime, 0 otherwise.
+ */
+VstIntPtr DriverAudioMaster(AEffect* effect, VstInt32 opcode, VstInt32 index, VstIntPtr value, void* ptr, float opt)
+{
+    (void)effect;
+    (void)index;
+    (void)value;
+    (void)ptr;
+    (void)opt;
+    if(opcode == audioMasterGetTime)
+    {
+        return (VstIntPtr)&driverTimeInfo;
+    }
+    return 0;
+}
+
+/**
+ * Changes the effect between the blocks the way a host does, so that
+ * the following blocks take another path of the audio thread.
+ * @param effect the effect to change.
+ * @param block an index of the next block.
+ */
+void ChangeEffect(AudioEffect* effect, int block)
+{
+    switch((block / 250) % 8)
+    {
+        case 0:
+            effect->setParameter(InterpolationParam, 0.0f);
+            effect->setParameter(TapCountParam, 0.0f);
+            break;
+
+        case 1:
+            // Tempo drifts, so the synchronized delay ramps.
+            effect->setParameter(SyncParam, 1.0f);
+            effect->setParameter(InterpolationParam, 0.4f);
+            break;
+
+        case 2:
+            effect->setParameter(InterpolationParam, 1.0f);
+            effect->setParameter(TapCountParam, 1.0f);
+            break;
+
+        case 3:
+            effect->setParameter(FreezeParam, 1.0f);
+            break;
+
+        case 4:
+            effect->setParameter(FreezeParam, 0.0f);
+            effect->setProgram(1);
+            break;
+
+        case 5:
+            effect->setParameter(SyncParam, 0.0f);
+            effect->setParameter(DelayParam, 0.1f);
+            effect->setParameter(FeedbackParam, 0.8f);
+            effect->setProgram(0);
+            break;
+
+        case 6:
+            // Economy takes effect once the host resumes the effect,
+            // the rounds alternate the half and the quarter rate.
+            effect->setParameter(EconomyParam, ((block / 2000) % 2 == 0) ? 0.5f : 1.0f);
+            effect->dispatcher(effMainsChanged, 0, 0, NULL, 0.0f);
+            effect->dispatcher(effMainsChanged, 0, 1, NULL, 0.0f);
+            break;
+
+        case 7:
+            effect->setParameter(EconomyParam, 0.0f);
+            effect->dispatcher(effMainsChanged, 0, 0, NULL, 0.0f);
+            effect->dispatcher(effMainsChanged, 0, 1, NULL, 0.0f);
+            break;
+    }
+}
+
+/**
+ * Arranges the speakers of the effect the way a host does.
+ * @param effect the effect to arrange.
+ * @param speakerCount a number of the speakers, 4, 6, 8 or 12.
+ * @return true if the effect accepted the arrangement, false otherwise.
+ */
+bool ArrangeSpeakers(AudioEffect* effect, int speakerCount)
+{
+    DriverArrangement arrangement;
+    memset(&arrangement, 0, sizeof(arrangement));
+    arrangement.arrangement.type = kSpeakerArrUserDefined;
+    arrangement.arrangement.numChannels = speakerCount;
+    for(int speaker = 0; speaker < speakerCount; ++speaker)
+    {
+        // Quad has no center nor LFE speaker.
+        int type = (speakerCount == 4) ? ((speaker < 2) ? speaker : speaker + 2) : speaker;
+        arrangement.arrangement.speakers[speaker].type = driverSpeakers[type];
+    }
+    return ((AudioEffectX*)effect)->setSpeakerArrangement(&arrangement.arrangement, &arrangement.arrangement);
+}
+
+/**
+ * Entry point of the audit driver.
+ * @param argc number of arguments.
+ * @param argv arguments.
+ * @return zero on success.
+ */
+int main(int argc, char* argv[])
+{
+    int blockFrames = 512;
+    int blockCount = 20000;
+    double sampleRate = 48000.0;
+    int speakerCount = 2;
+    int option;
+    while((option = getopt(argc, argv, "b:n:r:s:")) != -1)
+    {
+        switch(option)
+        {
+            case 'b':
+                blockFrames = atoi(optarg);
+                break;
+
+            case 'n':
+                blockCount = atoi(optarg);
+                break;
+
+            case 'r':
+                sampleRate = atof(optarg);
+                break;
+
+            case 's':
+                speakerCount = atoi(optarg);
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-b frames] [-n blocks] [-r rate] [-s speakers]\n", argv[0]);
+                return 1;
+        }
+    }
+    if(blockFrames < 1 || blockCount < 1 || sampleRate <= 0.0 || speakerCount < 2 || speakerCount > maxDriverSpeakers)
+    {
+        fprintf(stderr, "%s: invalid option value\n", argv[0]);
+        return 1;
+    }
+
+    memset(&driverTimeInfo, 0, sizeof(driverTimeInfo));
+    driverTimeInfo.sampleRate = sampleRate;
+    driverTimeInfo.tempo = 120.0;
+    driverTimeInfo.flags = kVstTempoValid | kVstPpqPosValid | kVstTransportPlaying;
+
+    AudioEffect* effect = createEffectInstance(DriverAudioMaster);
+    effect->dispatcher(effOpen, 0, 0, NULL, 0.0f);
+    effect->setSampleRate((float)sampleRate);
+    effect->setBlockSize(blockFrames);
+    if(speakerCount != 2 && !ArrangeSpeakers(effect, speakerCount))
+    {
+        fprintf(stderr, "%s: %d speakers not accepted\n", argv[0], speakerCount);
+        return 1;
+    }
+    effect->dispatcher(effMainsChanged, 0, 1, NULL, 0.0f);
+
+    std::vector<float> samples((size_t)speakerCount * blockFrames);
+    float* channels[maxDriverSpeakers];
+    for(int channel = 0; channel < speakerCount; ++channel)
+    {
+        channels[channel] = &samples[(size_t)channel * blockFrames];
+    }
+    double phase = 0.0;
+    for(int block = 0; block < blockCount; ++block)
+    {
+        if(block % 250 == 0)
+        {
+            ChangeEffect(effect, block);
+        }
+
+        // Block sizes vary as with hosts splitting blocks at automation.
+        int frames = 1 + (block * 97) % blockFrames;
+        for(int frame = 0; frame < frames; ++frame)
+        {
+            for(int channel = 0; channel < speakerCount; ++channel)
+            {
+                channels[channel][frame] = 0.5f * (float)sin((1.0 - 0.3 * channel / speakerCount) * phase);
+            }
+            phase += 0.05;
+        }
+        effect->processReplacing(channels, channels, frames);
+
+        driverTimeInfo.ppqPos += frames * driverTimeInfo.tempo / (60.0 * sampleRate);
+        driverTimeInfo.samplePos += frames;
+        driverTimeInfo.tempo = 120.0 + 10.0 * sin(block * 0.01);
+    }
+
+    effect->dispatcher(effMainsChanged, 0, 0, NULL, 0.0f);
+    effect->dispatcher(effClose, 0, 0, NULL, 0.0f);
+    delete effect;
+    printf("%d blocks processed\n", blockCount);
+    return 0;
+}
@@ -0,0 +1,216 @@
+/**
+ * PingPongDelayAuditShim.cpp:
+ *
+ * Audit shim for Linux, to be loaded into the host by LD_PRELOAD.
+ * It interposes malloc, calloc, realloc, memalign, free and
+ * pthread_mutex_lock and fails on any of them called by a thread within
+ * PingPongDelayAuditScope, printing the stack trace of the offender.
+ *
+ * Usage: LD_PRELOAD=libPingPongDelayAudit.so host ...
+ *      with the plugin built with PINGPONGDELAY_AUDIT defined.
+ *      By default the first violation aborts the host. With the environment
+ *      variable PINGPONGDELAY_AUDIT_CONTINUE set, all the violations are
+ *      reported and the host exits with status 1 at the end instead.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayAuditScope
+ */
+
+
+#include <errno.h>
+#include <execinfo.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+// Allocator entry points of glibc, used to avoid resolving them by dlsym,
+// which allocates itself.
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* pointer, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void* pointer);
+}
+
+
+/**
+ * Depth of the audited scopes of the thread.
+ */
+static __thread int auditDepth = 0;
+
+/**
+ * Set while the thread reports a violation, the reporting itself may
+ * allocate.
+ */
+static __thread int reporting = 0;
+
+/**
+ * Number of reported violations.
+ */
+static int violationCount = 0;
+
+/**
+ * Tells whether to continue after a violation.
+ */
+static int continueAfterViolation = 0;
+
+/**
+ * Maximal number of reported stack frames.
+ */
+static const int maxFrameCount = 64;
+
+
+/**
+ * Writes a string to the standard error without allocating.
+ * @param text a string to write.
+ */
+static void WriteError(const char* text)
+{
+    ssize_t written = write(STDERR_FILENO, text, strlen(text));
+    (void)written;
+}
+
+/**
+ * Reports a violation with the stack trace of the offender.
+ * @param function a name of the called function.
+ */
+static void Violation(const char* function)
+{
+    reporting = 1;
+    WriteError("PingPongDelay audit: ");
+    WriteError(function);
+    WriteError(" called from the audited audio thread scope\n");
+    void* frames[maxFrameCount];
+    int frameCount = backtrace(frames, maxFrameCount);
+    backtrace_symbols_fd(frames, frameCount, STDERR_FILENO);
+    __sync_fetch_and_add(&violationCount, 1);
+    if(!continueAfterViolation)
+    {
+        abort();
+    }
+    reporting = 0;
+}
+
+/**
+ * Checks whether the calling thread is within the audited scope.
+ * @param function a name of the called function.
+ */
+static inline void Check(const char* function)
+{
+    if(auditDepth > 0 && !reporting)
+    {
+        Violation(function);
+    }
+}
+
+/**
+ * Initializes the shim when loaded.
+ */
+__attribute__((constructor)) static void InitializeAudit()
+{
+    continueAfterViolation = (getenv("PINGPONGDELAY_AUDIT_CONTINUE") != NULL);
+    // The first backtrace loads the unwinder, which must not happen
+    // during the first violation.
+    void* frames[1];
+    backtrace(frames, 1);
+}
+
+/**
+ * Fails the process at its exit if any violation was reported.
+ */
+__attribute__((destructor)) static void FinishAudit()
+{
+    if(violationCount > 0)
+    {
+        WriteError("PingPongDelay audit: violations found\n");
+        _exit(1);
+    }
+}
+
+
+extern "C"
+{
+    /**
+     * Enters the audited scope on the calling thread.
+     */
+    void pingpongdelay_audit_enter()
+    {
+        ++auditDepth;
+    }
+
+    /**
+     * Leaves the audited scope on the calling thread.
+     */
+    void pingpongdelay_audit_leave()
+    {
+        --auditDepth;
+    }
+
+    void* malloc(size_t size)
+    {
+        Check("malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        Check("calloc");
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, size_t size)
+    {
+        Check("realloc");
+        return __libc_realloc(pointer, size);
+    }
+
+    void* memalign(size_t alignment, size_t size)
+    {
+        Check("memalign");
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** pointer, size_t alignment, size_t size)
+    {
+        Check("posix_memalign");
+        void* memory = __libc_memalign(alignment, size);
+        if(!memory)
+        {
+            return ENOMEM;
+        }
+        *pointer = memory;
+        return 0;
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        Check("aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    void free(void* pointer)
+    {
+        Check("free");
+        __libc_free(pointer);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex)
+    {
+        typedef int (*LockFunction)(pthread_mutex_t*);
+        static LockFunction originalLock = NULL;
+        Check("pthread_mutex_lock");
+        if(!originalLock)
+        {
+            originalLock = (LockFunction)dlsym(RTLD_NEXT, "pthread_mutex_lock");
+        }
+        return originalLock(mutex);
+    }
+}
@@ -0,0 +1,309 @@
+/**
+ * PingPongDelayBank.cpp:
+ *
+ * Implementation of PingPongDelayBank class processing many ping pong
+ * delay units at once in vector lanes.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayBank
+ */
+
+
+#include <string.h>
+#include "public.sdk/source/vst2.x/audioeffectx.h"
+
+#ifndef PINGPONGDELAYBANK_H
+#include "PingPongDelayBank.h"
+#endif
+
+
+namespace PingPongDelay
+{
+    /**
+     * Number of units processed at once, all their samples read
+     * before any is written, so that the loops vectorize.
+     */
+    const int PingPongDelayBank::bankLaneCount_;
+
+
+    /**
+     * A constructor.
+     * All the parameters are between [0, 1] and set to all the units.
+     * The buffers are not allocated until AllocateBuffers is called.
+     * @param unitCount a number of the units, must be greater than 0.
+     *      The buffers of all the units must not hold more than INT_MAX
+     *      samples, so that they are indexed by int lanes.
+     * @param bufferSize a size of the buffer of each unit, must not be
+     *      lower than RequiredBufferSize of the lowest tempo, so that
+     *      the delayed samples are never the written ones.
+     * @param timeInfo a timeInfo with valid tempo information.
+     * @param delayParam a default delay parameter between [0, 1].
+     * @param feedbackParam a default feedback parameter between [0, 1].
+     * @param panoramaParam a default panorama parameter between [0, 1].
+     * @param wetParam a default wet parameter between [0, 1].
+     * @param syncParam a default synchronization parameter between [0, 1].
+     *
+     * @see PingPongDelayUnit::RequiredBufferSize(float sampleRate, float tempo)
+     */
+    PingPongDelayBank::PingPongDelayBank(int unitCount, int bufferSize, VstTimeInfo* timeInfo, float delayParam,
+                                         float feedbackParam, float panoramaParam, float wetParam, float syncParam) :
+        unitCount_(unitCount),
+        bufferSize_(bufferSize),
+        feedbacks_(unitCount),
+        wets_(unitCount),
+        drys_(unitCount),
+        panoramas_(unitCount),
+        panoramaCs_(unitCount),
+        primaryQuotients_(unitCount),
+        secondaryQuotients_(unitCount),
+        semiDistances_(unitCount),
+        fullDistances_(unitCount),
+        bufferCursor_(0),
+        leftBuffers_(NULL),
+        rightBuffers_(NULL)
+    {
+        // Units only hold the settings, they never allocate their buffers.
+        for(int unit = 0; unit < unitCount_; ++unit)
+        {
+            units_.push_back(new PingPongDelayUnit(bufferSize, timeInfo, delayParam, feedbackParam,
+                                                   panoramaParam, wetParam, syncParam));
+        }
+    }
+
+    /**
+     * A destructor.
+     */
+    PingPongDelayBank::~PingPongDelayBank()
+    {
+        for(int unit = 0; unit < unitCount_; ++unit)
+        {
+            delete units_[unit];
+        }
+        if(leftBuffers_)
+        {
+            delete[] leftBuffers_;
+        }
+        if(rightBuffers_)
+        {
+            delete[] rightBuffers_;
+        }
+    }
+
+    /**
+     * Gets the number of the units.
+     * @return number of the units.
+     */
+    int PingPongDelayBank::GetUnitCount()
+    {
+        return unitCount_;
+    }
+
+    /**
+     * Gets a unit holding the settings of the bank unit. Its settings
+     * may be changed between the blocks, processing it on its own
+     * gives no sound, as it has no buffers.
+     * @param unit an index of the unit.
+     * @return unit holding the settings.
+     */
+    PingPongDelayUnit& PingPongDelayBank::GetUnit(int unit)
+    {
+        return *units_[unit];
+    }
+
+    /**
+     * PingPongDelayBank block processing method. Gives the same output
+     * as calling GetSample of each unit for each frame of the block.
+     * Output arrays may be the same as the input ones.
+     * @param leftInputs an array of left channel samples to be processed,
+     *      sampleFrames * unitCount samples interleaved by the units.
+     * @param rightInputs an array of right channel samples to be processed.
+     * @param leftOutputs where to store the effected left channel samples.
+     * @param rightOutputs where to store the effected right channel samples.
+     * @param sampleFrames number of frames of each unit.
+     */
+    void PingPongDelayBank::ProcessBlock(const float* leftInputs, const float* rightInputs, float* leftOutputs,
+                                         float* rightOutputs, int sampleFrames)
+    {
+        int sampleCount = sampleFrames * unitCount_;
+
+        // Without buffers the delay lines are silent.
+        if(!leftBuffers_)
+        {
+            for(int sample = 0; sample < sampleCount; ++sample)
+            {
+                int unit = sample % unitCount_;
+                leftOutputs[sample] = units_[unit]->wetParamC_ * leftInputs[sample];
+                rightOutputs[sample] = units_[unit]->wetParamC_ * rightInputs[sample];
+            }
+            return;
+        }
+
+        // The settings are constant within the block.
+        LoadLaneSettings();
+        const float* feedbacks = feedbacks_.data();
+        const float* wets = wets_.data();
+        const float* drys = drys_.data();
+        const float* panoramas = panoramas_.data();
+        const float* panoramaCs = panoramaCs_.data();
+        const float* primaries = primaryQuotients_.data();
+        const float* secondaries = secondaryQuotients_.data();
+        const int* semiDistances = semiDistances_.data();
+        const int* fullDistances = fullDistances_.data();
+        int groupedUnits = unitCount_ - (unitCount_ % bankLaneCount_);
+
+        // Units are processed in groups of lanes, each group through
+        // the whole block, so that only the pages of the buffers of a few
+        // units are touched at once. The delayed samples of each lane are
+        // gathered from the buffer of its unit and all of them are read
+        // before the written ones are stored, which is correct as long as
+        // the delays never reach the buffer size.
+        for(int unit = 0; unit < groupedUnits; unit += bankLaneCount_)
+        {
+            int cursor = bufferCursor_;
+            for(int frame = 0; frame < sampleFrames; ++frame)
+            {
+                int offset = frame * unitCount_ + unit;
+                float leftWrittenSamples[bankLaneCount_];
+                float rightWrittenSamples[bankLaneCount_];
+                float leftOutputSamples[bankLaneCount_];
+                float rightOutputSamples[bankLaneCount_];
+                for(int lane = 0; lane < bankLaneCount_; ++lane)
+                {
+                    int u = unit + lane;
+                    int semiDelayedCursor = cursor - semiDistances[u];
+                    int fullDelayedCursor = cursor - fullDistances[u];
+                    semiDelayedCursor += (semiDelayedCursor < 0) ? bufferSize_ : 0;
+                    fullDelayedCursor += (fullDelayedCursor < 0) ? bufferSize_ : 0;
+                    int semiDelayed = u * bufferSize_ + semiDelayedCursor;
+                    int fullDelayed = u * bufferSize_ + fullDelayedCursor;
+
+                    float leftInput = leftInputs[offset + lane];
+                    float rightInput = rightInputs[offset + lane];
+                    float leftFullDelayed = leftBuffers_[fullDelayed];
+                    float rightFullDelayed = rightBuffers_[fullDelayed];
+                    leftWrittenSamples[lane] = (leftInput + leftFullDelayed) * feedbacks[u];
+                    rightWrittenSamples[lane] = (rightInput + rightFullDelayed) * feedbacks[u];
+
+                    float semiMix = primaries[u] * leftBuffers_[semiDelayed] + secondaries[u] * rightBuffers_[semiDelayed];
+                    float fullMix = secondaries[u] * leftFullDelayed + primaries[u] * rightFullDelayed;
+                    leftOutputSamples[lane] = (drys[u] * leftInput) + (wets[u] * ((panoramaCs[u] * semiMix) + (panoramas[u] * fullMix)));
+                    rightOutputSamples[lane] = (drys[u] * rightInput) + (wets[u] * ((panoramas[u] * semiMix) + (panoramaCs[u] * fullMix)));
+                }
+                for(int lane = 0; lane < bankLaneCount_; ++lane)
+                {
+                    int written = (unit + lane) * bufferSize_ + cursor;
+                    leftBuffers_[written] = leftWrittenSamples[lane];
+                    rightBuffers_[written] = rightWrittenSamples[lane];
+                    leftOutputs[offset + lane] = leftOutputSamples[lane];
+                    rightOutputs[offset + lane] = rightOutputSamples[lane];
+                }
+                cursor = (cursor + 1 == bufferSize_) ? 0 : (cursor + 1);
+            }
+        }
+
+        // Remaining units are processed one by one.
+        for(int unit = groupedUnits; unit < unitCount_; ++unit)
+        {
+            float* leftBuffer = leftBuffers_ + (size_t)unit * bufferSize_;
+            float* rightBuffer = rightBuffers_ + (size_t)unit * bufferSize_;
+            int cursor = bufferCursor_;
+            for(int frame = 0; frame < sampleFrames; ++frame)
+            {
+                int semiDelayedCursor = cursor - semiDistances[unit];
+                int fullDelayedCursor = cursor - fullDistances[unit];
+                semiDelayedCursor += (semiDelayedCursor < 0) ? bufferSize_ : 0;
+                fullDelayedCursor += (fullDelayedCursor < 0) ? bufferSize_ : 0;
+
+                int offset = frame * unitCount_ + unit;
+                float leftInput = leftInputs[offset];
+                float rightInput = rightInputs[offset];
+                float leftFullDelayed = leftBuffer[fullDelayedCursor];
+                float rightFullDelayed = rightBuffer[fullDelayedCursor];
+                float semiMix = primaries[unit] * leftBuffer[semiDelayedCursor] + secondaries[unit] * rightBuffer[semiDelayedCursor];
+                float fullMix = secondaries[unit] * leftFullDelayed + primaries[unit] * rightFullDelayed;
+                leftBuffer[cursor] = (leftInput + leftFullDelayed) * feedbacks[unit];
+                rightBuffer[cursor] = (rightInput + rightFullDelayed) * feedbacks[unit];
+                leftOutputs[offset] = (drys[unit] * leftInput) + (wets[unit] * ((panoramaCs[unit] * semiMix) + (panoramas[unit] * fullMix)));
+                rightOutputs[offset] = (drys[unit] * rightInput) + (wets[unit] * ((panoramas[unit] * semiMix) + (panoramaCs[unit] * fullMix)));
+                cursor = (cursor + 1 == bufferSize_) ? 0 : (cursor + 1);
+            }
+        }
+
+        // Moving the buffer cursor shared by all the units.
+        bufferCursor_ = (bufferCursor_ + sampleFrames) % bufferSize_;
+    }
+
+    /**
+     * Allocates the buffers of all the units, if they are not
+     * allocated yet.
+     * @return true if the buffers were allocated, false if they
+     *      already had been.
+     */
+    bool PingPongDelayBank::AllocateBuffers()
+    {
+        if(leftBuffers_)
+        {
+            return false;
+        }
+
+        leftBuffers_ = new float[(size_t)bufferSize_ * unitCount_];
+        rightBuffers_ = new float[(size_t)bufferSize_ * unitCount_];
+        ResetBuffers();
+        return true;
+    }
+
+    /**
+     * Clears the buffers of all the units.
+     */
+    void PingPongDelayBank::ResetBuffers()
+    {
+        // Unlike the unit, the bank clears the whole buffers instead of
+        // keeping the watermark, which keeps the check out of the lanes.
+        memset(leftBuffers_, 0, (size_t)bufferSize_ * unitCount_ * sizeof(float));
+        memset(rightBuffers_, 0, (size_t)bufferSize_ * unitCount_ * sizeof(float));
+        bufferCursor_ = 0;
+    }
+
+    /**
+     * Tells whether the buffers are allocated.
+     * @return true if the buffers are allocated, false otherwise.
+     */
+    bool PingPongDelayBank::HasBuffers()
+    {
+        return leftBuffers_ != NULL;
+    }
+
+    /**
+     * Gets the memory of the buffers.
+     * @return memory of the buffers in bytes, zero if not allocated.
+     */
+    long long PingPongDelayBank::GetBufferMemory()
+    {
+        return leftBuffers_ ? (2LL * bufferSize_ * unitCount_ * sizeof(float)) : 0;
+    }
+
+    /**
+     * Copies the settings of the units into the lanes.
+     */
+    void PingPongDelayBank::LoadLaneSettings()
+    {
+        for(int unit = 0; unit < unitCount_; ++unit)
+        {
+            PingPongDelayUnit& settings = *units_[unit];
+            feedbacks_[unit] = settings.feedback_;
+            wets_[unit] = settings.wetParam_;
+            drys_[unit] = settings.wetParamC_;
+            panoramas_[unit] = settings.panoramaParam_;
+            panoramaCs_[unit] = settings.panoramaParamC_;
+            primaryQuotients_[unit] = settings.primaryPanningQuotient_;
+            secondaryQuotients_[unit] = settings.secondaryPanningQuotient_;
+
+            int delaySamples = settings.DelaySamples();
+            semiDistances_[unit] = settings.BufferModulo(delaySamples);
+            fullDistances_[unit] = settings.BufferModulo(delaySamples * 2);
+        }
+    }
+}
@@ -0,0 +1,232 @@
+/**
+ * PingPongDelayBank.h:
+ *
+ * Declaration of PingPongDelayBank class processing many ping pong
+ * delay units at once, with the samples and settings of the units laid
+ * out side by side, so that the units are processed in vector lanes.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayBank
+ * @see PingPongDelayUnit
+ */
+
+
+#include <vector>
+#include "public.sdk/source/vst2.x/audioeffectx.h"
+#include "PingPongDelayUnit.h"
+
+#ifndef PINGPONGDELAYBANK_H
+#define PINGPONGDELAYBANK_H
+
+
+namespace PingPongDelay
+{
+    /**
+     * Bank of ping pong delay units of the same buffer size and time info,
+     * processed at once. The blocks of the bank hold the samples of all
+     * the units interleaved, the sample of a unit at a frame lies at index
+     * frame * unitCount + unit. The buffers of the units lie one after
+     * another and all the units advance their buffer cursors together, only
+     * the delayed samples differ by the delays of the units and so they are
+     * gathered.
+     *
+     * Each unit of the bank keeps its settings in PingPongDelayUnit, which
+     * never allocates its buffers. The bank reads them at the start of each
+     * block, so that they may be changed through the whole unit interface.
+     * The bank gives the same output as GetSample of the units without taps
+     * and interpolation, it ignores the taps and the interpolation of
+     * the units, meters no levels and does not trim its buffers.
+     *
+     * ALERT: Whole class requires correct usage as written
+     * in documentation. It does not make any argument checks
+     * nor it throws any own error,
+     */
+    class PingPongDelayBank
+    {
+    public:
+        /**
+         * A constructor.
+         * All the parameters are between [0, 1] and set to all the units.
+         * The buffers are not allocated until AllocateBuffers is called.
+         * @param unitCount a number of the units, must be greater than 0.
+         *      The buffers of all the units must not hold more than INT_MAX
+         *      samples, so that they are indexed by int lanes.
+         * @param bufferSize a size of the buffer of each unit, must not be
+         *      lower than RequiredBufferSize of the lowest tempo, so that
+         *      the delayed samples are never the written ones.
+         * @param timeInfo a timeInfo with valid tempo information.
+         * @param delayParam a default delay parameter between [0, 1].
+         * @param feedbackParam a default feedback parameter between [0, 1].
+         * @param panoramaParam a default panorama parameter between [0, 1].
+         * @param wetParam a default wet parameter between [0, 1].
+         * @param syncParam a default synchronization parameter between [0, 1].
+         *
+         * @see PingPongDelayUnit::RequiredBufferSize(float sampleRate, float tempo)
+         */
+        PingPongDelayBank(int unitCount, int bufferSize, VstTimeInfo* timeInfo, float delayParam, float feedbackParam,
+                          float panoramaParam, float wetParam, float syncParam);
+
+        /**
+         * A destructor.
+         */
+        ~PingPongDelayBank();
+
+        /**
+         * Gets the number of the units.
+         * @return number of the units.
+         */
+        int GetUnitCount();
+
+        /**
+         * Gets a unit holding the settings of the bank unit. Its settings
+         * may be changed between the blocks, processing it on its own
+         * gives no sound, as it has no buffers.
+         * @param unit an index of the unit.
+         * @return unit holding the settings.
+         */
+        PingPongDelayUnit& GetUnit(int unit);
+
+        /**
+         * PingPongDelayBank block processing method. Gives the same output
+         * as calling GetSample of each unit for each frame of the block.
+         * Output arrays may be the same as the input ones.
+         * @param leftInputs an array of left channel samples to be processed,
+         *      sampleFrames * unitCount samples interleaved by the units.
+         * @param rightInputs an array of right channel samples to be processed.
+         * @param leftOutputs where to store the effected left channel samples.
+         * @param rightOutputs where to store the effected right channel samples.
+         * @param sampleFrames number of frames of each unit.
+         */
+        void ProcessBlock(const float* leftInputs, const float* rightInputs, float* leftOutputs,
+                          float* rightOutputs, int sampleFrames);
+
+        /**
+         * Allocates the buffers of all the units, if they are not
+         * allocated yet.
+         * @return true if the buffers were allocated, false if they
+         *      already had been.
+         */
+        bool AllocateBuffers();
+
+        /**
+         * Clears the buffers of all the units.
+         */
+        void ResetBuffers();
+
+        /**
+         * Tells whether the buffers are allocated.
+         * @return true if the buffers are allocated, false otherwise.
+         */
+        bool HasBuffers();
+
+        /**
+         * Gets the memory of the buffers.
+         * @return memory of the buffers in bytes, zero if not allocated.
+         */
+        long long GetBufferMemory();
+
+    private:
+        /**
+         * Copies the settings of the units into the lanes.
+         */
+        void LoadLaneSettings();
+
+
+        /**
+         * Number of the units.
+         */
+        int unitCount_;
+
+        /**
+         * Size of the buffer of each unit.
+         */
+        int bufferSize_;
+
+        /**
+         * Units holding the settings, without buffers.
+         */
+        std::vector<PingPongDelayUnit*> units_;
+
+
+        // Settings of the units in the lanes, loaded at the start
+        // of each block.
+        /**
+         * Feedback ratios of the units.
+         */
+        std::vector<float> feedbacks_;
+
+        /**
+         * Wet ratios of the units.
+         */
+        std::vector<float> wets_;
+
+        /**
+         * Dry ratios of the units, complementary to the wet ones.
+         */
+        std::vector<float> drys_;
+
+        /**
+         * Panorama ratios of the units.
+         */
+        std::vector<float> panoramas_;
+
+        /**
+         * Panorama ratios of the units complementary to panoramas_.
+         */
+        std::vector<float> panoramaCs_;
+
+        /**
+         * Primary panning quotients of the units.
+         */
+        std::vector<float> primaryQuotients_;
+
+        /**
+         * Secondary panning quotients of the units.
+         */
+        std::vector<float> secondaryQuotients_;
+
+        /**
+         * Distances of the semi delayed cursors of the units behind
+         * the buffer cursor.
+         */
+        std::vector<int> semiDistances_;
+
+        /**
+         * Distances of the fully delayed cursors of the units behind
+         * the buffer cursor.
+         */
+        std::vector<int> fullDistances_;
+
+
+        /**
+         * Cursor pointing to the frame of the buffers to be written next,
+         * shared by all the units.
+         */
+        int bufferCursor_;
+
+        /**
+         * Left channel buffers of the units, one after another.
+         */
+        float* leftBuffers_;
+
+        /**
+         * Right channel buffers of the units, one after another.
+         */
+        float* rightBuffers_;
+
+
+        /**
+         * Number of units processed at once, all their samples read
+         * before any is written, so that the loops vectorize. Each unit
+         * streams through six places of its buffers, more lanes outrun
+         * the hardware prefetchers, 8 lanes are some 1.4 times slower.
+         */
+        static const int bankLaneCount_ = 4;
+    };
+}
+
+
+#endif
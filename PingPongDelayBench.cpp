@@ -0,0 +1,393 @@
+/**
+ * PingPongDelayBench.cpp:
+ *
+ * Command line tool timing PingPongDelayUnit::ProcessBlock at the full rate
+ * and in the economy, or frozen against running, for each interpolation
+ * and with all the taps, or PingPongDelayBank::ProcessBlock against as many
+ * units on their own.
+ *
+ * Usage: PingPongDelayBench [-b frames] [-r rate] [-t tempo] [-n count]
+ *              [-z] [-B units]
+ *      -b frames a number of frames processed at once, 512 by default.
+ *      -r rate a sample rate in Hz, 48000 by default.
+ *      -t tempo the lowest tempo the buffers are sized for in BPM,
+ *          120 by default.
+ *      -n count a number of timed rounds, 30 by default.
+ *      -z times the frozen units against the running ones instead
+ *          of the economies.
+ *      -B units times a bank of the given number of units instead.
+ *
+ * Units of all the rates, or the running and the frozen ones, are timed
+ * in alternating rounds and the fastest round of each is reported, so that other processes slow down neither of them
+ * more than the others. Each round processes about five seconds of audio.
+ *
+ * The bank and its units on their own are timed the same way, each round
+ * processing about one second of audio of every unit. The units differ
+ * in the delay, feedback and panorama, the bank gets the blocks already
+ * interleaved and the units their own ones. The output of the bank
+ * is compared with the one of the units after the timing.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayUnit
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "PingPongDelayUnit.h"
+#include "PingPongDelayBank.h"
+
+
+using namespace PingPongDelay;
+
+
+/**
+ * Number of the timed economies, the full rate, the half and the quarter one.
+ */
+const int benchEconomyCount = 3;
+
+/**
+ * Economy parameters of the timed economies.
+ */
+const float benchEconomyParams[benchEconomyCount] = {0.0f, 0.5f, 1.0f};
+
+/**
+ * Number of the timed freeze states, the running and the frozen one.
+ */
+const int benchFreezeCount = 2;
+
+
+/**
+ * Times rounds of blocks processed by the units and keeps the fastest
+ * round of each.
+ * @param units units to be timed in alternating rounds.
+ * @param unitCount number of the units.
+ * @param input the stereo input block.
+ * @param output where to store the stereo output block.
+ * @param blockFrames number of frames of each block.
+ * @param roundBlocks number of blocks of each round.
+ * @param roundCount number of rounds of each unit.
+ * @param frameNs where to store the nanoseconds per frame of each unit.
+ */
+void TimeUnits(PingPongDelayUnit* units[], int unitCount, float* input[2], float* output[2], int blockFrames,
+               int roundBlocks, int roundCount, double frameNs[])
+{
+    for(int unit = 0; unit < unitCount; ++unit)
+    {
+        frameNs[unit] = -1.0;
+    }
+
+    for(int round = 0; round < roundCount * unitCount; ++round)
+    {
+        int unit = round % unitCount;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(int block = 0; block < roundBlocks; ++block)
+        {
+            units[unit]->ProcessBlock(input[0], input[1], output[0], output[1], blockFrames);
+        }
+        std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+        double ns = (double)elapsed.count() / ((double)roundBlocks * blockFrames);
+        if(frameNs[unit] < 0.0 || ns < frameNs[unit])
+        {
+            frameNs[unit] = ns;
+        }
+    }
+}
+
+/**
+ * Times rounds of blocks processed by a bank and by as many units on their
+ * own in alternating rounds, keeping the fastest round of each, and prints
+ * them together with the largest difference of their output.
+ * @param unitCount number of the units.
+ * @param bufferSize a size of the buffer of each unit.
+ * @param timeInfo a timeInfo with valid tempo information.
+ * @param blockFrames number of frames of each block.
+ * @param roundCount number of rounds of each.
+ */
+void TimeBank(int unitCount, int bufferSize, VstTimeInfo* timeInfo, int blockFrames, int roundCount)
+{
+    PingPongDelayBank bank(unitCount, bufferSize, timeInfo, 0.37f, 0.6f, 0.2f, 0.9f, 0.0f);
+    std::vector<PingPongDelayUnit*> units(unitCount);
+    for(int unit = 0; unit < unitCount; ++unit)
+    {
+        // Each unit of a group of lanes delays by another length.
+        float delayParam = 0.1f + 0.8f * (unit % 16) / 16.0f;
+        float feedbackParam = 0.4f + 0.4f * (unit % 5) / 5.0f;
+        float panoramaParam = (float)(unit % 3) / 2.0f;
+        units[unit] = new PingPongDelayUnit(bufferSize, timeInfo, delayParam, feedbackParam, panoramaParam, 0.9f,
+                                            0.0f);
+        units[unit]->AllocateBuffers();
+        PingPongDelayUnit& settings = bank.GetUnit(unit);
+        settings.SetDelayParam(delayParam);
+        settings.SetFeedbackParam(feedbackParam);
+        settings.SetPanoramaParam(panoramaParam);
+    }
+    bank.AllocateBuffers();
+
+    // Blocks of the bank are interleaved by the units, each unit
+    // gets a tone of its own phase.
+    int sampleCount = blockFrames * unitCount;
+    std::vector<float> leftInputs(sampleCount);
+    std::vector<float> rightInputs(sampleCount);
+    std::vector<float> leftOutputs(sampleCount);
+    std::vector<float> rightOutputs(sampleCount);
+    std::vector<std::vector<float> > leftInput(unitCount, std::vector<float>(blockFrames));
+    std::vector<std::vector<float> > rightInput(unitCount, std::vector<float>(blockFrames));
+    std::vector<std::vector<float> > leftOutput(unitCount, std::vector<float>(blockFrames));
+    std::vector<std::vector<float> > rightOutput(unitCount, std::vector<float>(blockFrames));
+    for(int unit = 0; unit < unitCount; ++unit)
+    {
+        for(int frame = 0; frame < blockFrames; ++frame)
+        {
+            leftInput[unit][frame] = 0.5f * sinf(0.1f * frame + unit);
+            rightInput[unit][frame] = 0.5f * cosf(0.07f * frame + unit);
+            leftInputs[frame * unitCount + unit] = leftInput[unit][frame];
+            rightInputs[frame * unitCount + unit] = rightInput[unit][frame];
+        }
+    }
+    int roundBlocks = std::max((int)timeInfo->sampleRate / blockFrames, 1);
+
+    double frameNs[2] = {-1.0, -1.0};
+    for(int round = 0; round < roundCount * 2; ++round)
+    {
+        bool isBank = round % 2 == 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(int block = 0; block < roundBlocks; ++block)
+        {
+            if(isBank)
+            {
+                bank.ProcessBlock(&leftInputs[0], &rightInputs[0], &leftOutputs[0], &rightOutputs[0], blockFrames);
+            }
+            else
+            {
+                for(int unit = 0; unit < unitCount; ++unit)
+                {
+                    units[unit]->ProcessBlock(&leftInput[unit][0], &rightInput[unit][0], &leftOutput[unit][0],
+                                              &rightOutput[unit][0], blockFrames);
+                }
+            }
+        }
+        std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+        double ns = (double)elapsed.count() / ((double)roundBlocks * sampleCount);
+        double& best = frameNs[isBank ? 0 : 1];
+        if(best < 0.0 || ns < best)
+        {
+            best = ns;
+        }
+    }
+
+    // Both processed the same blocks, so the last ones are compared.
+    float difference = 0.0f;
+    for(int unit = 0; unit < unitCount; ++unit)
+    {
+        for(int frame = 0; frame < blockFrames; ++frame)
+        {
+            difference = std::max(difference, fabsf(leftOutputs[frame * unitCount + unit] - leftOutput[unit][frame]));
+            difference = std::max(difference, fabsf(rightOutputs[frame * unitCount + unit] - rightOutput[unit][frame]));
+        }
+    }
+
+    printf("%-10s %12s %12s %8s\n", "", "units ns", "bank ns", "ratio");
+    printf("%-10d %12.2f %12.2f %8.2f\n", unitCount, frameNs[1], frameNs[0], frameNs[0] / frameNs[1]);
+    printf("difference %12g\n", difference);
+    for(int unit = 0; unit < unitCount; ++unit)
+    {
+        delete units[unit];
+    }
+}
+
+/**
+ * Times the running and the frozen units in alternating rounds for each
+ * interpolation and with all the taps, and prints the fastest round
+ * of each.
+ * @param bufferSize a size of the buffers of each unit.
+ * @param timeInfo a timeInfo with valid tempo information.
+ * @param input the stereo input block.
+ * @param output where to store the stereo output block.
+ * @param blockFrames number of frames of each block.
+ * @param roundBlocks number of blocks of each round.
+ * @param roundCount number of rounds of each unit.
+ */
+void TimeFreeze(int bufferSize, VstTimeInfo* timeInfo, float* input[2], float* output[2], int blockFrames,
+                int roundBlocks, int roundCount)
+{
+    printf("%-10s %12s %12s %8s\n", "", "running ns", "frozen ns", "ratio");
+    for(int config = 0; config <= InterpolationCount; ++config)
+    {
+        bool taps = config == InterpolationCount;
+        PingPongDelayUnit* units[benchFreezeCount];
+        const char* name = "Taps";
+        for(int frozen = 0; frozen < benchFreezeCount; ++frozen)
+        {
+            units[frozen] = new PingPongDelayUnit(bufferSize, timeInfo, 0.37f, 0.6f, 0.2f, 0.9f, 0.0f);
+            units[frozen]->SetInterpolationParam(taps ? 0.0f : (float)config / (InterpolationCount - 1));
+            units[frozen]->SetTapCountParam(taps ? 1.0f : 0.0f);
+            units[frozen]->AllocateBuffers();
+
+            // Filling the delay line before it is frozen.
+            for(int block = 0; block < roundBlocks; ++block)
+            {
+                units[frozen]->ProcessBlock(input[0], input[1], output[0], output[1], blockFrames);
+            }
+            units[frozen]->SetFreezeParam(frozen ? 1.0f : 0.0f);
+            if(!taps)
+            {
+                name = units[frozen]->GetInterpolationName();
+            }
+        }
+
+        double frameNs[benchFreezeCount];
+        TimeUnits(units, benchFreezeCount, input, output, blockFrames, roundBlocks, roundCount, frameNs);
+        printf("%-10s %12.2f %12.2f %8.2f\n", name, frameNs[0], frameNs[1], frameNs[1] / frameNs[0]);
+
+        for(int frozen = 0; frozen < benchFreezeCount; ++frozen)
+        {
+            delete units[frozen];
+        }
+    }
+}
+
+/**
+ * Entry point of the benchmark.
+ * @param argc number of arguments.
+ * @param argv arguments.
+ * @return zero on success.
+ */
+int main(int argc, char* argv[])
+{
+    int blockFrames = 512;
+    double sampleRate = 48000.0;
+    float tempo = 120.0f;
+    int roundCount = 30;
+    int bankUnits = 0;
+    bool freeze = false;
+    int option;
+    while((option = getopt(argc, argv, "b:r:t:n:zB:")) != -1)
+    {
+        switch(option)
+        {
+            case 'b':
+                blockFrames = atoi(optarg);
+                break;
+
+            case 'r':
+                sampleRate = atof(optarg);
+                break;
+
+            case 't':
+                tempo = (float)atof(optarg);
+                break;
+
+            case 'n':
+                roundCount = atoi(optarg);
+                break;
+
+            case 'z':
+                freeze = true;
+                break;
+
+            case 'B':
+                bankUnits = atoi(optarg);
+                if(bankUnits < 1)
+                {
+                    fprintf(stderr, "%s: invalid option value\n", argv[0]);
+                    return 1;
+                }
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-b frames] [-r rate] [-t tempo] [-n count] [-z] [-B units]\n", argv[0]);
+                return 1;
+        }
+    }
+    if(blockFrames < 1 || sampleRate <= 0.0 || tempo <= 0.0f || roundCount < 1)
+    {
+        fprintf(stderr, "%s: invalid option value\n", argv[0]);
+        return 1;
+    }
+
+    VstTimeInfo timeInfo;
+    memset(&timeInfo, 0, sizeof(timeInfo));
+    timeInfo.sampleRate = sampleRate;
+    timeInfo.tempo = tempo;
+    timeInfo.flags = kVstTempoValid;
+    int bufferSize = PingPongDelayUnit::RequiredBufferSize((float)sampleRate, tempo);
+    if(bankUnits > 0)
+    {
+        TimeBank(bankUnits, bufferSize, &timeInfo, blockFrames, roundCount);
+        return 0;
+    }
+
+    // Tones of different pitch in each channel keep the feedback loop
+    // away from the denormals.
+    std::vector<float> leftInput(blockFrames);
+    std::vector<float> rightInput(blockFrames);
+    std::vector<float> leftOutput(blockFrames);
+    std::vector<float> rightOutput(blockFrames);
+    for(int frame = 0; frame < blockFrames; ++frame)
+    {
+        leftInput[frame] = 0.5f * sinf(0.1f * frame);
+        rightInput[frame] = 0.5f * cosf(0.07f * frame);
+    }
+    float* input[2] = {&leftInput[0], &rightInput[0]};
+    float* output[2] = {&leftOutput[0], &rightOutput[0]};
+    int roundBlocks = std::max((int)(5.0 * sampleRate) / blockFrames, 1);
+    if(freeze)
+    {
+        TimeFreeze(bufferSize, &timeInfo, input, output, blockFrames, roundBlocks, roundCount);
+        return 0;
+    }
+
+    printf("%-10s %12s %12s %8s %12s %8s\n", "", "full ns", "1/2 ns", "ratio", "1/4 ns", "ratio");
+    long long bufferMemory[benchEconomyCount];
+    for(int config = 0; config <= InterpolationCount; ++config)
+    {
+        // Taps are timed with the interpolation off, after all
+        // the interpolations without them.
+        bool taps = config == InterpolationCount;
+        PingPongDelayUnit* units[benchEconomyCount];
+        const char* name = "Taps";
+        for(int economy = 0; economy < benchEconomyCount; ++economy)
+        {
+            units[economy] = new PingPongDelayUnit(bufferSize, &timeInfo, 0.37f, 0.6f, 0.2f, 0.9f, 0.0f);
+            units[economy]->SetInterpolationParam(taps ? 0.0f : (float)config / (InterpolationCount - 1));
+            units[economy]->SetTapCountParam(taps ? 1.0f : 0.0f);
+            units[economy]->SetEconomyParam(benchEconomyParams[economy]);
+            units[economy]->AllocateBuffers();
+            bufferMemory[economy] = units[economy]->GetBufferMemory();
+
+            // Warming up the caches and filling the delay line.
+            for(int block = 0; block < roundBlocks; ++block)
+            {
+                units[economy]->ProcessBlock(input[0], input[1], output[0], output[1], blockFrames);
+            }
+            if(!taps)
+            {
+                name = units[economy]->GetInterpolationName();
+            }
+        }
+
+        double frameNs[benchEconomyCount];
+        TimeUnits(units, benchEconomyCount, input, output, blockFrames, roundBlocks, roundCount, frameNs);
+        printf("%-10s %12.2f %12.2f %8.2f %12.2f %8.2f\n", name, frameNs[0], frameNs[1], frameNs[1] / frameNs[0],
+               frameNs[2], frameNs[2] / frameNs[0]);
+
+        for(int economy = 0; economy < benchEconomyCount; ++economy)
+        {
+            delete units[economy];
+        }
+    }
+    printf("buffers    %9.2f MB %9.2f MB %8s %9.2f MB\n", bufferMemory[0] / 1048576.0, bufferMemory[1] / 1048576.0, "",
+           bufferMemory[2] / 1048576.0);
+    return 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * PingPongDelayBitmapCache.cpp:
+ *
+ * Implementation of PingPongDelayBitmapCache class sharing the editor
+ * bitmaps among all PingPongDelayEditor instances of the process.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayBitmapCache
+ */
+
+
+#ifndef PINGPONGDELAYBITMAPCACHE_H
+#include "PingPongDelayBitmapCache.h"
+#endif
+
+
+namespace PingPongDelay
+{
+    /**
+     * Cached bitmaps by resource id.
+     */
+    std::map<short, PingPongDelayBitmapCache::Entry> PingPongDelayBitmapCache::entries_;
+
+    /**
+     * Guards the entries_.
+     */
+    std::mutex PingPongDelayBitmapCache::entriesMutex_;
+
+
+    /**
+     * Gets the shared bitmap of a resource, loading it if it has no
+     * other user. Each call must be paired with a Release call.
+     * @param resourceId an id of the bitmap resource.
+     * @return shared bitmap, valid until the paired Release call.
+     */
+    CBitmap* PingPongDelayBitmapCache::Acquire(short resourceId)
+    {
+        std::lock_guard<std::mutex> lock(entriesMutex_);
+        std::map<short, Entry>::iterator entry = entries_.find(resourceId);
+        if(entry == entries_.end())
+        {
+            // Freshly loaded bitmap has one reference, the one of the cache.
+            Entry loaded;
+            loaded.bitmap = new CBitmap(resourceId);
+            loaded.users = 0;
+            entry = entries_.insert(std::make_pair(resourceId, loaded)).first;
+        }
+        ++entry->second.users;
+        return entry->second.bitmap;
+    }
+
+    /**
+     * Releases the shared bitmap of a resource, forgetting it if this
+     * was its last user. Views which remember the bitmap keep it alive
+     * until they are deleted.
+     * @param resourceId an id of the bitmap resource.
+     */
+    void PingPongDelayBitmapCache::Release(short resourceId)
+    {
+        std::lock_guard<std::mutex> lock(entriesMutex_);
+        std::map<short, Entry>::iterator entry = entries_.find(resourceId);
+        if(entry == entries_.end())
+        {
+            return;
+        }
+        if(--entry->second.users == 0)
+        {
+            entry->second.bitmap->forget();
+            entries_.erase(entry);
+        }
+    }
+}
@@ -0,0 +1,88 @@
+/**
+ * PingPongDelayBitmapCache.h:
+ *
+ * Declaration of PingPongDelayBitmapCache class sharing the editor
+ * bitmaps among all PingPongDelayEditor instances of the process.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayBitmapCache
+ * @see PingPongDelayEditor
+ */
+
+
+#include <map>
+#include <mutex>
+#include "vstgui.sf/vstgui/vstgui.h"
+
+#ifndef PINGPONGDELAYBITMAPCACHE_H
+#define PINGPONGDELAYBITMAPCACHE_H
+
+
+namespace PingPongDelay
+{
+    /**
+     * Process wide cache of bitmaps loaded from resources, keyed by
+     * the resource id. Each bitmap is loaded by its first user and
+     * forgotten by its last one, all the users in between share it.
+     * The cache may be used from any thread except the audio one.
+     */
+    class PingPongDelayBitmapCache
+    {
+    public:
+        /**
+         * Gets the shared bitmap of a resource, loading it if it has no
+         * other user. Each call must be paired with a Release call.
+         * @param resourceId an id of the bitmap resource.
+         * @return shared bitmap, valid until the paired Release call.
+         */
+        static CBitmap* Acquire(short resourceId);
+
+        /**
+         * Releases the shared bitmap of a resource, forgetting it if this
+         * was its last user. Views which remember the bitmap keep it alive
+         * until they are deleted.
+         * @param resourceId an id of the bitmap resource.
+         */
+        static void Release(short resourceId);
+
+    private:
+        /**
+         * Cached bitmap together with the number of its users.
+         */
+        struct Entry
+        {
+            /**
+             * Shared bitmap, the cache holds one reference of it.
+             */
+            CBitmap* bitmap;
+
+            /**
+             * Number of Acquire calls not yet paired with Release.
+             */
+            int users;
+        };
+
+
+        /**
+         * A constructor. The cache has only static methods.
+         */
+        PingPongDelayBitmapCache();
+
+
+        /**
+         * Cached bitmaps by resource id.
+         */
+        static std::map<short, Entry> entries_;
+
+        /**
+         * Guards the entries_.
+         */
+        static std::mutex entriesMutex_;
+    };
+}
+
+
+#endif
@@ -0,0 +1,261 @@
+/**
+ * PingPongDelayBufferPool.cpp:
+ *
+ * Implementation of PingPongDelayBufferPool class trimming the delay buffers
+ * of idle PingPongDelayUnit instances and keeping prefaulted spare buffers,
+ * from which the units are provided again.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayBufferPool
+ */
+
+
+#ifdef PINGPONGDELAY_TRIMMING
+
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <algorithm>
+
+#ifndef PINGPONGDELAYBUFFERPOOL_H
+#include "PingPongDelayBufferPool.h"
+#endif
+
+
+namespace PingPongDelay
+{
+    /**
+     * Number of spare buffer pairs kept while any unit is trimmed.
+     */
+    const int PingPongDelayBufferPool::spareCount_;
+
+    /**
+     * Period of trimming in milliseconds.
+     */
+    const int PingPongDelayBufferPool::trimPeriodMs_ = 100;
+
+    /**
+     * Spare buffers.
+     */
+    PingPongDelayBufferPool::Spare PingPongDelayBufferPool::spares_[spareCount_];
+
+    /**
+     * Registered units.
+     */
+    std::vector<PingPongDelayUnit*> PingPongDelayBufferPool::units_;
+
+    /**
+     * Guards units_, filling the spare buffers and trimming.
+     */
+    std::mutex PingPongDelayBufferPool::registryMutex_;
+
+    /**
+     * Background thread trimming the units.
+     */
+    std::thread PingPongDelayBufferPool::trimThread_;
+
+    /**
+     * Tells the background thread to keep trimming.
+     */
+    std::atomic<bool> PingPongDelayBufferPool::trimming_(false);
+
+    /**
+     * True while the background thread is being stopped.
+     */
+    bool PingPongDelayBufferPool::stopping_ = false;
+
+
+    /**
+     * Registers a unit to be trimmed when idle, starting the background
+     * thread if this is the first unit of the process. Does nothing
+     * unless the trimming is enabled. Must not be called from the audio
+     * thread.
+     * @param unit a unit to register.
+     */
+    void PingPongDelayBufferPool::Register(PingPongDelayUnit* unit)
+    {
+        // Trimming is opt-in through the environment.
+        const char* idleTrim = getenv("PINGPONGDELAY_IDLE_TRIM");
+        double idleTrimS = (idleTrim && *idleTrim) ? atof(idleTrim) : 0.0;
+        if(idleTrimS <= 0.0)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(registryMutex_);
+        unit->SetIdleTrimMs((int)(idleTrimS * 1000.0));
+        units_.push_back(unit);
+        // While the thread is being stopped, it is restarted by the stopping
+        // Unregister call.
+        if(!trimming_.load() && !stopping_)
+        {
+            trimming_.store(true);
+            trimThread_ = std::thread(TrimLoop);
+        }
+    }
+
+    /**
+     * Unregisters a unit, stopping the background thread and releasing
+     * the spare buffers if this is the last unit of the process. Must be
+     * called before the unit is destroyed, not from the audio thread.
+     * @param unit a unit to unregister.
+     */
+    void PingPongDelayBufferPool::Unregister(PingPongDelayUnit* unit)
+    {
+        std::thread stoppedThread;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex_);
+            std::vector<PingPongDelayUnit*>::iterator found = std::find(units_.begin(), units_.end(), unit);
+            if(found == units_.end())
+            {
+                return;
+            }
+            units_.erase(found);
+            if(units_.empty() && trimming_.load())
+            {
+                trimming_.store(false);
+                stopping_ = true;
+                stoppedThread.swap(trimThread_);
+            }
+        }
+
+        // Joining outside of the lock, the thread may be waiting for it.
+        if(stoppedThread.joinable())
+        {
+            stoppedThread.join();
+            std::lock_guard<std::mutex> lock(registryMutex_);
+            stopping_ = false;
+            if(!units_.empty())
+            {
+                // Another unit was registered meanwhile, keep trimming.
+                trimming_.store(true);
+                trimThread_ = std::thread(TrimLoop);
+            }
+            else
+            {
+                ReleaseSpares();
+            }
+        }
+    }
+
+    /**
+     * Takes a pair of spare buffers. Never locks nor allocates, may be
+     * called from the audio thread.
+     * @param bufferSize a size of the buffers to take.
+     * @param leftBuffer where to store the left channel buffer.
+     * @param rightBuffer where to store the right channel buffer.
+     * @return true if the buffers were taken, false if there are no
+     *      spare buffers of the size.
+     */
+    bool PingPongDelayBufferPool::Take(int bufferSize, float*& leftBuffer, float*& rightBuffer)
+    {
+        for(int i = 0; i < spareCount_; ++i)
+        {
+            Spare& spare = spares_[i];
+            int state = ReadySpare;
+            if(!spare.state.compare_exchange_strong(state, TakenSpare, std::memory_order_acquire))
+            {
+                continue;
+            }
+
+            if(spare.bufferSize != bufferSize)
+            {
+                spare.state.store(ReadySpare, std::memory_order_release);
+                continue;
+            }
+
+            // Spare is left empty for the background thread to refill.
+            leftBuffer = spare.leftBuffer;
+            rightBuffer = spare.rightBuffer;
+            spare.leftBuffer = NULL;
+            spare.rightBuffer = NULL;
+            spare.state.store(EmptySpare, std::memory_order_release);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Trims the idle units and refills or releases the spare buffers.
+     * Must be called with registryMutex_ locked.
+     */
+    void PingPongDelayBufferPool::Trim()
+    {
+        int trimmedBufferSize = 0;
+        for(size_t i = 0; i < units_.size(); ++i)
+        {
+            units_[i]->TrimBuffers();
+            if(units_[i]->IsTrimmed())
+            {
+                trimmedBufferSize = units_[i]->GetBufferSize();
+            }
+        }
+
+        // Spare buffers are worth keeping only while some unit may need them.
+        if(!trimmedBufferSize)
+        {
+            ReleaseSpares();
+            return;
+        }
+
+        for(int i = 0; i < spareCount_; ++i)
+        {
+            Spare& spare = spares_[i];
+            if(spare.state.load(std::memory_order_acquire) != EmptySpare)
+            {
+                continue;
+            }
+
+            // Buffers are written through, so that their pages are faulted
+            // in here rather than on the audio thread.
+            spare.leftBuffer = new float[trimmedBufferSize];
+            spare.rightBuffer = new float[trimmedBufferSize];
+            memset(spare.leftBuffer, 0, trimmedBufferSize * sizeof(float));
+            memset(spare.rightBuffer, 0, trimmedBufferSize * sizeof(float));
+            spare.bufferSize = trimmedBufferSize;
+            spare.state.store(ReadySpare, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Body of the background thread trimming the units.
+     */
+    void PingPongDelayBufferPool::TrimLoop()
+    {
+        while(trimming_.load())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(trimPeriodMs_));
+            std::lock_guard<std::mutex> lock(registryMutex_);
+            Trim();
+        }
+    }
+
+    /**
+     * Releases all the spare buffers not taken. Must be called
+     * with registryMutex_ locked.
+     */
+    void PingPongDelayBufferPool::ReleaseSpares()
+    {
+        for(int i = 0; i < spareCount_; ++i)
+        {
+            Spare& spare = spares_[i];
+            int state = ReadySpare;
+            if(!spare.state.compare_exchange_strong(state, TakenSpare, std::memory_order_acquire))
+            {
+                continue;
+            }
+
+            delete[] spare.leftBuffer;
+            delete[] spare.rightBuffer;
+            spare.leftBuffer = NULL;
+            spare.rightBuffer = NULL;
+            spare.state.store(EmptySpare, std::memory_order_release);
+        }
+    }
+}
+
+
+#endif
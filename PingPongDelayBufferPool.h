@@ -0,0 +1,165 @@
+/**
+ * PingPongDelayBufferPool.h:
+ *
+ * Declaration of PingPongDelayBufferPool class trimming the delay buffers
+ * of idle PingPongDelayUnit instances and keeping prefaulted spare buffers,
+ * from which the units are provided again.
+ *
+ * Whole pool is compiled only when PINGPONGDELAY_TRIMMING is defined,
+ * otherwise this header declares nothing. Even then trimming is opt-in,
+ * units are registered only if the environment variable
+ * PINGPONGDELAY_IDLE_TRIM holds the time of silence in seconds.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayBufferPool
+ * @see PingPongDelayUnit
+ */
+
+
+#ifdef PINGPONGDELAY_TRIMMING
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "PingPongDelayUnit.h"
+
+#ifndef PINGPONGDELAYBUFFERPOOL_H
+#define PINGPONGDELAYBUFFERPOOL_H
+
+
+namespace PingPongDelay
+{
+    /**
+     * Process wide pool of delay buffers. A background thread releases
+     * the buffers units offered after long silence and keeps a few
+     * prefaulted spare buffers while any unit is trimmed, so that the unit
+     * is provided with them again without allocating nor page faulting
+     * on the audio thread.
+     */
+    class PingPongDelayBufferPool
+    {
+    public:
+        /**
+         * Registers a unit to be trimmed when idle, starting the background
+         * thread if this is the first unit of the process. Does nothing
+         * unless the trimming is enabled. Must not be called from the audio
+         * thread.
+         * @param unit a unit to register.
+         */
+        static void Register(PingPongDelayUnit* unit);
+
+        /**
+         * Unregisters a unit, stopping the background thread and releasing
+         * the spare buffers if this is the last unit of the process. Must be
+         * called before the unit is destroyed, not from the audio thread.
+         * @param unit a unit to unregister.
+         */
+        static void Unregister(PingPongDelayUnit* unit);
+
+        /**
+         * Takes a pair of spare buffers. Never locks nor allocates, may be
+         * called from the audio thread.
+         * @param bufferSize a size of the buffers to take.
+         * @param leftBuffer where to store the left channel buffer.
+         * @param rightBuffer where to store the right channel buffer.
+         * @return true if the buffers were taken, false if there are no
+         *      spare buffers of the size.
+         */
+        static bool Take(int bufferSize, float*& leftBuffer, float*& rightBuffer);
+
+    private:
+        /**
+         * An enum for states of the spare buffers.
+         */
+        enum SpareState
+        {
+            EmptySpare,
+            ReadySpare,
+            TakenSpare,
+        };
+
+        /**
+         * One pair of spare buffers. Its state tells whether the buffers
+         * may be taken.
+         */
+        struct Spare
+        {
+            std::atomic<int> state;
+            float* leftBuffer;
+            float* rightBuffer;
+            int bufferSize;
+        };
+
+
+        /**
+         * A constructor. The pool has only static methods.
+         */
+        PingPongDelayBufferPool();
+
+        /**
+         * Trims the idle units and refills or releases the spare buffers.
+         * Must be called with registryMutex_ locked.
+         */
+        static void Trim();
+
+        /**
+         * Body of the background thread trimming the units.
+         */
+        static void TrimLoop();
+
+        /**
+         * Releases all the spare buffers not taken. Must be called
+         * with registryMutex_ locked.
+         */
+        static void ReleaseSpares();
+
+
+        /**
+         * Number of spare buffer pairs kept while any unit is trimmed.
+         */
+        static const int spareCount_ = 2;
+
+        /**
+         * Period of trimming in milliseconds.
+         */
+        static const int trimPeriodMs_;
+
+        /**
+         * Spare buffers.
+         */
+        static Spare spares_[spareCount_];
+
+        /**
+         * Registered units.
+         */
+        static std::vector<PingPongDelayUnit*> units_;
+
+        /**
+         * Guards units_, filling the spare buffers and trimming.
+         */
+        static std::mutex registryMutex_;
+
+        /**
+         * Background thread trimming the units.
+         */
+        static std::thread trimThread_;
+
+        /**
+         * Tells the background thread to keep trimming.
+         */
+        static std::atomic<bool> trimming_;
+
+        /**
+         * True while the background thread is being stopped.
+         */
+        static bool stopping_;
+    };
+}
+
+
+#endif
+#endif
@@ -0,0 +1,733 @@
+/**
+ * PingPongDelayCheck.cpp:
+ *
+ * Command line tool checking that the paths of PingPongDelayUnit, which
+ * are supposed to give the same output, give it bit for bit.
+ *
+ * Usage: PingPongDelayCheck [-b frames] [-r rate] [-o directory]
+ *      -b frames a number of frames processed at once, 512 by default.
+ *      -r rate a sample rate in Hz, 48000 by default.
+ *      -o directory writes the input as input.wav and the script
+ *          as automation.csv into the directory, so that the same render
+ *          may be checked by PingPongDelayRender.
+ *
+ * A fixed input of tone bursts is rendered through a script of parameter
+ * changes, which turns the taps, the interpolations, the freeze,
+ * the economy and a tempo ramp on and off. The blocks are split at
+ * the changes, the same way as by the automation of PingPongDelayRender.
+ *
+ * The render, whose blocks are run by ProcessChannel and MixChannels
+ * wherever CanProcessChannels allows them, is compared with the one
+ * by ProcessBlock only. The state of the unit is saved at intervals
+ * wherever CanSaveState allows it and the render is resumed from each
+ * of the saved states by a new unit, which is compared with the rest
+ * of the render. The settings after each time of the script are written
+ * into a chunk and read back, once with the derived values of the chunk
+ * and once derived again, as from a chunk of another version, and each
+ * of them renders the same as the settings written. A check fails as well
+ * if the script did not take both of the paths it compares.
+ *
+ * Exits with zero if all the checks pass. Run by make check.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayUnit
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "PingPongDelayUnit.h"
+#include "PingPongDelayChunk.h"
+#include "PingPongDelayWav.h"
+
+
+using namespace PingPongDelay;
+
+
+/**
+ * A change of a parameter of the script, named the same way as
+ * in the automation files of PingPongDelayRender.
+ */
+struct CheckPoint
+{
+    /**
+     * Time of the change in seconds.
+     */
+    double seconds;
+
+    /**
+     * Name of the parameter.
+     */
+    const char* param;
+
+    /**
+     * New value of the parameter.
+     */
+    float value;
+};
+
+/**
+ * The script of the checked render, ordered by time. It ends
+ * with the defaults of PingPongDelayRender, so that a render resumed by -R
+ * without options continues it.
+ */
+const CheckPoint checkScript[] =
+{
+    {0.0, "delay", 0.3f},
+    {0.0, "feedback", 0.7f},
+    {0.0, "panorama", 0.3f},
+    {0.0, "wet", 0.5f},
+    {1.0, "taps", 1.0f},
+    {2.0, "interpolation", 0.3f},
+    {3.0, "interpolation", 0.0f},
+    {3.0, "freeze", 1.0f},
+    {4.0, "freeze", 0.0f},
+    {5.0, "economy", 0.5f},
+    {6.0, "economy", 0.0f},
+    {6.0, "sync", 1.0f},
+    {7.0, "tempo", 90.0f},
+    {8.0, "delay", 0.6f},
+    {8.0, "interpolation", 0.9f},
+    {9.0, "interpolation", 0.0f},
+    {9.0, "taps", 0.0f},
+    {9.0, "delay", 0.8f},
+    {9.0, "feedback", 0.25f},
+    {9.0, "panorama", 0.0f},
+    {9.0, "wet", 0.25f},
+    {9.0, "sync", 0.0f},
+    {9.0, "tempo", 120.0f},
+};
+
+/**
+ * Number of the changes of the script.
+ */
+const int checkPointCount = sizeof(checkScript) / sizeof(checkScript[0]);
+
+/**
+ * Length of the checked render in seconds.
+ */
+const double checkSeconds = 10.0;
+
+/**
+ * The lowest tempo of the script in BPM, the buffers are sized for it.
+ */
+const float checkLowestTempo = 90.0f;
+
+/**
+ * Interval between the saved states in seconds, rounded up to whole blocks.
+ */
+const double checkpointSeconds = 0.25;
+
+
+/**
+ * Numbers of the blocks processed by each path.
+ */
+struct CheckCounts
+{
+    /**
+     * Blocks processed by ProcessChannel and MixChannels.
+     */
+    int channelBlocks;
+
+    /**
+     * Blocks processed by ProcessBlock.
+     */
+    int wholeBlocks;
+};
+
+
+/**
+ * Length of the render by the settings read from a chunk in seconds.
+ */
+const double chunkRenderSeconds = 1.0;
+
+
+/**
+ * A state of the unit saved by SaveState.
+ */
+struct CheckState
+{
+    /**
+     * Frame, at which the state was saved.
+     */
+    int frame;
+
+    /**
+     * Number of frames of the state.
+     */
+    int stateFrames;
+
+    /**
+     * Left channel samples of the state.
+     */
+    std::vector<float> left;
+
+    /**
+     * Right channel samples of the state.
+     */
+    std::vector<float> right;
+};
+
+
+/**
+ * Gets the frame of a change of the script.
+ * @param point the change.
+ * @param sampleRate a sample rate in Hz.
+ * @return the frame.
+ */
+int PointFrame(const CheckPoint& point, int sampleRate)
+{
+    return (int)(point.seconds * sampleRate);
+}
+
+/**
+ * Applies a change of the script to the unit. Allocated buffers of another
+ * rate than the one of the economy are replaced, as by PingPongDelayRender.
+ * @param unit a unit to change.
+ * @param timeInfo time info of the unit, holding the tempo.
+ * @param point the change.
+ */
+void ApplyPoint(PingPongDelayUnit& unit, VstTimeInfo& timeInfo, const CheckPoint& point)
+{
+    if(strcmp(point.param, "delay") == 0)
+    {
+        unit.SetDelayParam(point.value);
+    }
+    else if(strcmp(point.param, "feedback") == 0)
+    {
+        unit.SetFeedbackParam(point.value);
+    }
+    else if(strcmp(point.param, "panorama") == 0)
+    {
+        unit.SetPanoramaParam(point.value);
+    }
+    else if(strcmp(point.param, "wet") == 0)
+    {
+        unit.SetWetParam(point.value);
+    }
+    else if(strcmp(point.param, "sync") == 0)
+    {
+        unit.SetSyncParam(point.value);
+    }
+    else if(strcmp(point.param, "tempo") == 0)
+    {
+        timeInfo.tempo = point.value;
+    }
+    else if(strcmp(point.param, "taps") == 0)
+    {
+        unit.SetTapCountParam(point.value);
+    }
+    else if(strcmp(point.param, "interpolation") == 0)
+    {
+        unit.SetInterpolationParam(point.value);
+    }
+    else if(strcmp(point.param, "freeze") == 0)
+    {
+        unit.SetFreezeParam(point.value);
+    }
+    else if(strcmp(point.param, "economy") == 0)
+    {
+        unit.SetEconomyParam(point.value);
+        if(unit.HasBuffers())
+        {
+            unit.AllocateBuffers();
+        }
+    }
+}
+
+/**
+ * Creates a unit with the defaults of PingPongDelayRender and allocates
+ * its buffers.
+ * @param timeInfo where to set up the time info of the unit.
+ * @param sampleRate a sample rate in Hz.
+ * @return the unit.
+ */
+PingPongDelayUnit* CreateUnit(VstTimeInfo& timeInfo, int sampleRate)
+{
+    memset(&timeInfo, 0, sizeof(timeInfo));
+    timeInfo.sampleRate = sampleRate;
+    timeInfo.tempo = 120.0f;
+    timeInfo.flags = kVstTempoValid;
+    PingPongDelayUnit* unit = new PingPongDelayUnit(
+        PingPongDelayUnit::RequiredBufferSize((float)sampleRate, checkLowestTempo), &timeInfo, 0.8f, 0.25f, 0.0f,
+        0.25f, 0.0f);
+    unit->AllocateBuffers();
+    return unit;
+}
+
+/**
+ * Generates the fixed input, bursts of a tone of each channel separated
+ * by silence, so that the echoes ring out between them.
+ * @param input where to store the stereo input.
+ * @param frames number of frames of the input.
+ * @param sampleRate a sample rate in Hz.
+ */
+void GenerateInput(std::vector<float> input[2], int frames, int sampleRate)
+{
+    unsigned int noise = 1;
+    for(int channel = 0; channel < 2; ++channel)
+    {
+        input[channel].resize(frames);
+        double frequency = (channel == 0) ? 220.0 : 330.0;
+        for(int frame = 0; frame < frames; ++frame)
+        {
+            noise = noise * 1664525u + 1013904223u;
+            bool burst = (frame % (sampleRate / 2)) < sampleRate / 8;
+            double sample = 0.4 * sin(2.0 * M_PI * frequency * frame / sampleRate)
+                          + 0.1 * ((double)(noise >> 8) / (1 << 24) - 0.5);
+            input[channel][frame] = burst ? (float)sample : 0.0f;
+        }
+    }
+}
+
+/**
+ * Renders frames of the input by the unit, applying the changes
+ * of the script within them at their frames. The blocks start at the first
+ * frame and are split at the changes.
+ * @param unit a unit to render by.
+ * @param timeInfo time info of the unit, holding the tempo.
+ * @param input the stereo input.
+ * @param output where to store the stereo output.
+ * @param startFrame the first frame to render, the changes before it
+ *      must be applied already.
+ * @param endFrame the frame behind the last one to render.
+ * @param sampleRate a sample rate in Hz.
+ * @param blockFrames number of frames of each block.
+ * @param channels true to run the blocks by ProcessChannel and MixChannels
+ *      wherever CanProcessChannels allows them.
+ * @param counts where to add the numbers of the blocks of each path.
+ */
+void RenderFrames(PingPongDelayUnit& unit, VstTimeInfo& timeInfo, std::vector<float> input[2],
+                  std::vector<float> output[2], int startFrame, int endFrame, int sampleRate, int blockFrames,
+                  bool channels, CheckCounts& counts)
+{
+    int nextPoint = 0;
+    while(nextPoint < checkPointCount && PointFrame(checkScript[nextPoint], sampleRate) < startFrame)
+    {
+        ++nextPoint;
+    }
+
+    int frame = startFrame;
+    while(frame < endFrame)
+    {
+        while(nextPoint < checkPointCount && PointFrame(checkScript[nextPoint], sampleRate) <= frame)
+        {
+            ApplyPoint(unit, timeInfo, checkScript[nextPoint++]);
+        }
+        int blockEnd = std::min(endFrame, frame + blockFrames - (frame - startFrame) % blockFrames);
+        if(nextPoint < checkPointCount)
+        {
+            blockEnd = std::min(blockEnd, PointFrame(checkScript[nextPoint], sampleRate));
+        }
+
+        int frames = blockEnd - frame;
+        float* left = output[0].data() + frame;
+        float* right = output[1].data() + frame;
+        if(channels && unit.CanProcessChannels() && frames <= unit.GetChannelBlockLimit())
+        {
+            unit.ProcessChannel(0, input[0].data() + frame, frames);
+            unit.ProcessChannel(1, input[1].data() + frame, frames);
+            unit.MixChannels(input[0].data() + frame, input[1].data() + frame, left, right, frames);
+            ++counts.channelBlocks;
+        }
+        else
+        {
+            unit.ProcessBlock(input[0].data() + frame, input[1].data() + frame, left, right, frames);
+            ++counts.wholeBlocks;
+        }
+        frame = blockEnd;
+    }
+}
+
+/**
+ * Finds the first frame, at which two stereo outputs differ.
+ * @param a the first output.
+ * @param b the second output.
+ * @param startFrame the first frame to compare.
+ * @param endFrame the frame behind the last one to compare.
+ * @return the frame, -1 if the outputs are the same bit for bit.
+ */
+int FindDifference(std::vector<float> a[2], std::vector<float> b[2], int startFrame, int endFrame)
+{
+    for(int frame = startFrame; frame < endFrame; ++frame)
+    {
+        for(int channel = 0; channel < 2; ++channel)
+        {
+            if(memcmp(&a[channel][frame], &b[channel][frame], sizeof(float)) != 0)
+            {
+                return frame;
+            }
+        }
+    }
+    return -1;
+}
+
+/**
+ * Prints the result of a check.
+ * @param name a name of the check.
+ * @param difference the first frame, at which the outputs differ, -1 if none.
+ * @param firstCount number of the blocks or states of the first path.
+ * @param firstName a name of the first path.
+ * @param secondCount number of the blocks or states of the second path.
+ * @param secondName a name of the second path.
+ * @return true if the check passed, false otherwise.
+ */
+bool Report(const char* name, int difference, int firstCount, const char* firstName, int secondCount,
+            const char* secondName)
+{
+    bool passed = difference < 0 && firstCount > 0 && secondCount > 0;
+    printf("%s: %d %s, %d %s, ", name, firstCount, firstName, secondCount, secondName);
+    if(difference >= 0)
+    {
+        printf("FAILED, the output differs from frame %d on\n", difference);
+    }
+    else if(!passed)
+    {
+        printf("FAILED, a path was not taken\n");
+    }
+    else
+    {
+        printf("the same output\n");
+    }
+    return passed;
+}
+
+/**
+ * Checks that the blocks run by ProcessChannel and MixChannels, wherever
+ * CanProcessChannels allows them, give the same output as ProcessBlock.
+ * @param input the stereo input.
+ * @param reference the output rendered by ProcessBlock only.
+ * @param frames number of frames of the input.
+ * @param sampleRate a sample rate in Hz.
+ * @param blockFrames number of frames of each block.
+ * @return true if the check passed, false otherwise.
+ */
+bool CheckChannels(std::vector<float> input[2], std::vector<float> reference[2], int frames, int sampleRate,
+                   int blockFrames)
+{
+    VstTimeInfo timeInfo;
+    PingPongDelayUnit* unit = CreateUnit(timeInfo, sampleRate);
+    std::vector<float> output[2] = {std::vector<float>(frames), std::vector<float>(frames)};
+    CheckCounts counts = {0, 0};
+    RenderFrames(*unit, timeInfo, input, output, 0, frames, sampleRate, blockFrames, true, counts);
+    delete unit;
+    return Report("channels", FindDifference(reference, output, 0, frames), counts.channelBlocks,
+                  "blocks by channels", counts.wholeBlocks, "by ProcessBlock");
+}
+
+/**
+ * Checks that the render resumed from the states saved by SaveState,
+ * wherever CanSaveState allows it, gives the same output as the whole
+ * render. Each state is loaded by LoadState into a new unit, which gets
+ * the changes of the script before the state first, as the one resumed
+ * by PingPongDelayRender -R.
+ * @param input the stereo input.
+ * @param reference the output rendered by ProcessBlock only.
+ * @param frames number of frames of the input.
+ * @param sampleRate a sample rate in Hz.
+ * @param blockFrames number of frames of each block.
+ * @return true if the check passed, false otherwise.
+ */
+bool CheckCheckpoints(std::vector<float> input[2], std::vector<float> reference[2], int frames, int sampleRate,
+                      int blockFrames)
+{
+    // The intervals are whole blocks, so the render is split into the same
+    // blocks as the reference one.
+    int intervalBlocks = std::max(1, (int)ceil(checkpointSeconds * sampleRate / blockFrames));
+    int intervalFrames = intervalBlocks * blockFrames;
+
+    VstTimeInfo timeInfo;
+    PingPongDelayUnit* unit = CreateUnit(timeInfo, sampleRate);
+    std::vector<float> output[2] = {std::vector<float>(frames), std::vector<float>(frames)};
+    std::vector<CheckState> states;
+    int skippedStates = 0;
+    CheckCounts counts = {0, 0};
+    for(int frame = 0; frame < frames; frame += intervalFrames)
+    {
+        if(frame > 0)
+        {
+            if(unit->CanSaveState())
+            {
+                CheckState state;
+                state.frame = frame;
+                state.stateFrames = unit->GetStateFrames();
+                state.left.resize(state.stateFrames);
+                state.right.resize(state.stateFrames);
+                unit->SaveState(state.left.data(), state.right.data());
+                states.push_back(state);
+            }
+            else
+            {
+                ++skippedStates;
+            }
+        }
+        RenderFrames(*unit, timeInfo, input, output, frame, std::min(frames, frame + intervalFrames), sampleRate,
+                     blockFrames, false, counts);
+    }
+    delete unit;
+
+    int difference = FindDifference(reference, output, 0, frames);
+    for(size_t state = 0; state < states.size() && difference < 0; ++state)
+    {
+        VstTimeInfo resumedTimeInfo;
+        PingPongDelayUnit* resumed = CreateUnit(resumedTimeInfo, sampleRate);
+        for(int point = 0; point < checkPointCount && PointFrame(checkScript[point], sampleRate) < states[state].frame;
+            ++point)
+        {
+            ApplyPoint(*resumed, resumedTimeInfo, checkScript[point]);
+        }
+        resumed->LoadState(states[state].left.data(), states[state].right.data(), states[state].stateFrames);
+        RenderFrames(*resumed, resumedTimeInfo, input, output, states[state].frame, frames, sampleRate, blockFrames,
+                     false, counts);
+        delete resumed;
+        difference = FindDifference(reference, output, states[state].frame, frames);
+    }
+    return Report("checkpoints", difference, (int)states.size(), "states resumed", skippedStates, "skipped");
+}
+
+/**
+ * Renders the start of the input by a new unit with the settings.
+ * @param settings the settings of the unit.
+ * @param input the stereo input.
+ * @param output where to store the stereo output.
+ * @param frames number of frames to render.
+ * @param sampleRate a sample rate in Hz.
+ * @param blockFrames number of frames of each block.
+ * @return true if the unit took the settings, false otherwise.
+ */
+bool RenderSettings(const PingPongDelaySettings& settings, std::vector<float> input[2], std::vector<float> output[2],
+                    int frames, int sampleRate, int blockFrames)
+{
+    VstTimeInfo timeInfo;
+    PingPongDelayUnit* unit = CreateUnit(timeInfo, sampleRate);
+    bool set = unit->SetSettings(settings);
+    for(int frame = 0; frame < frames; frame += blockFrames)
+    {
+        int blockEnd = std::min(frames, frame + blockFrames);
+        unit->ProcessBlock(input[0].data() + frame, input[1].data() + frame, output[0].data() + frame,
+                           output[1].data() + frame, blockEnd - frame);
+    }
+    delete unit;
+    return set;
+}
+
+/**
+ * Reads settings back from a chunk and compares their parameters
+ * and program name with the ones written.
+ * @param chunk the chunk.
+ * @param bytes size of the chunk in bytes.
+ * @param written the settings written into the chunk.
+ * @param programName the program name written into the chunk.
+ * @param settings where to store the settings read, derived again
+ *      if the chunk does not hold the derived values.
+ * @param derived where to store whether the derived values were read.
+ * @return true if the parameters and the name are the same, false otherwise.
+ */
+bool ReadSettings(const unsigned char* chunk, int bytes, const PingPongDelaySettings& written,
+                  const char* programName, PingPongDelaySettings& settings, bool& derived)
+{
+    // Read parameters overwrite the ones of a new unit, as of the effect.
+    VstTimeInfo timeInfo;
+    PingPongDelayUnit* unit = CreateUnit(timeInfo, 48000);
+    unit->GetSettings(settings);
+    delete unit;
+
+    char name[kVstMaxProgNameLen + 1];
+    if(ReadChunk(chunk, bytes, settings, name, derived) != bytes || strcmp(name, programName) != 0)
+    {
+        return false;
+    }
+    if(!derived)
+    {
+        PingPongDelayUnit::DeriveSettings(settings);
+    }
+
+    PingPongDelaySettings writtenCopy = written;
+    float* writtenParams[chunkParamCount];
+    float* readParams[chunkParamCount];
+    ListChunkParams(writtenCopy, writtenParams);
+    ListChunkParams(settings, readParams);
+    for(int param = 0; param < chunkParamCount; ++param)
+    {
+        if(memcmp(writtenParams[param], readParams[param], sizeof(float)) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Checks that the settings written into a chunk and read back render
+ * the same as the settings written, both with the derived values
+ * of the chunk and with the ones derived again from a chunk of another
+ * version. The settings are taken after each time of the script.
+ * @param input the stereo input.
+ * @param sampleRate a sample rate in Hz.
+ * @param blockFrames number of frames of each block.
+ * @return true if the check passed, false otherwise.
+ */
+bool CheckChunks(std::vector<float> input[2], int sampleRate, int blockFrames)
+{
+    int frames = std::min((int)input[0].size(), (int)(chunkRenderSeconds * sampleRate));
+    std::vector<float> reference[2] = {std::vector<float>(frames), std::vector<float>(frames)};
+    std::vector<float> output[2] = {std::vector<float>(frames), std::vector<float>(frames)};
+    int derivedChunks = 0;
+    int derivedAgainChunks = 0;
+    int difference = -1;
+    bool same = true;
+
+    VstTimeInfo timeInfo;
+    PingPongDelayUnit* unit = CreateUnit(timeInfo, sampleRate);
+    for(int point = 0; point < checkPointCount && same && difference < 0; ++point)
+    {
+        ApplyPoint(*unit, timeInfo, checkScript[point]);
+        if(point + 1 < checkPointCount && checkScript[point + 1].seconds == checkScript[point].seconds)
+        {
+            continue;
+        }
+
+        PingPongDelaySettings settings;
+        unit->GetSettings(settings);
+        char programName[kVstMaxProgNameLen + 1];
+        snprintf(programName, sizeof(programName), "Check %d", point);
+        unsigned char chunk[chunkBytes];
+        int bytes = WriteChunk(settings, programName, chunk);
+        same = RenderSettings(settings, input, reference, frames, sampleRate, blockFrames);
+
+        // A chunk of another version keeps the parameters, but its derived
+        // values are derived again.
+        for(int version = 0; version < 2 && same && difference < 0; ++version)
+        {
+            if(version == 1)
+            {
+                unsigned int otherVersion = chunkVersion + 1;
+                for(int i = 0; i < 4; ++i)
+                {
+                    chunk[4 + i] = (unsigned char)(otherVersion >> (8 * i));
+                }
+            }
+            PingPongDelaySettings read;
+            bool derived = false;
+            same = ReadSettings(chunk, bytes, settings, programName, read, derived)
+                && RenderSettings(read, input, output, frames, sampleRate, blockFrames);
+            ++(derived ? derivedChunks : derivedAgainChunks);
+            difference = FindDifference(reference, output, 0, frames);
+        }
+    }
+    delete unit;
+
+    if(!same)
+    {
+        printf("chunks: FAILED, the settings read differ from the ones written\n");
+        return false;
+    }
+    return Report("chunks", difference, derivedChunks, "chunks with derived values", derivedAgainChunks,
+                  "derived again");
+}
+
+/**
+ * Writes the input and the script into a directory, so that the same
+ * render may be checked by PingPongDelayRender.
+ * @param directory a path of the directory.
+ * @param input the stereo input.
+ * @param frames number of frames of the input.
+ * @param sampleRate a sample rate in Hz.
+ * @return true if both of the files were written, false otherwise.
+ */
+bool WriteFiles(const char* directory, std::vector<float> input[2], int frames, int sampleRate)
+{
+    std::string inputPath = std::string(directory) + "/input.wav";
+    PingPongDelayWavWriter writer;
+    const float* channels[2] = {input[0].data(), input[1].data()};
+    if(!writer.Open(inputPath.c_str(), 2, sampleRate, Float32Format, frames)
+       || !writer.Write(channels, frames) || !writer.Close())
+    {
+        fprintf(stderr, "%s: %s\n", inputPath.c_str(), writer.GetError());
+        return false;
+    }
+
+    std::string automationPath = std::string(directory) + "/automation.csv";
+    FILE* file = fopen(automationPath.c_str(), "w");
+    if(!file)
+    {
+        perror(automationPath.c_str());
+        return false;
+    }
+    for(int point = 0; point < checkPointCount; ++point)
+    {
+        fprintf(file, "%g,%s,%g\n", checkScript[point].seconds, checkScript[point].param,
+                checkScript[point].value);
+    }
+    if(fclose(file) != 0)
+    {
+        perror(automationPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    int blockFrames = 512;
+    int sampleRate = 48000;
+    const char* directory = NULL;
+    int option;
+    while((option = getopt(argc, argv, "b:r:o:")) != -1)
+    {
+        switch(option)
+        {
+            case 'b':
+                blockFrames = atoi(optarg);
+                break;
+
+            case 'r':
+                sampleRate = atoi(optarg);
+                break;
+
+            case 'o':
+                directory = optarg;
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-b frames] [-r rate] [-o directory]\n", argv[0]);
+                return 1;
+        }
+    }
+    if(blockFrames < 1 || sampleRate < 8)
+    {
+        fprintf(stderr, "%s: invalid option value\n", argv[0]);
+        return 1;
+    }
+
+    int frames = (int)(checkSeconds * sampleRate);
+    std::vector<float> input[2];
+    GenerateInput(input, frames, sampleRate);
+    if(directory && !WriteFiles(directory, input, frames, sampleRate))
+    {
+        return 1;
+    }
+
+    // The reference render runs every block by ProcessBlock.
+    VstTimeInfo timeInfo;
+    PingPongDelayUnit* unit = CreateUnit(timeInfo, sampleRate);
+    std::vector<float> reference[2] = {std::vector<float>(frames), std::vector<float>(frames)};
+    CheckCounts counts = {0, 0};
+    RenderFrames(*unit, timeInfo, input, reference, 0, frames, sampleRate, blockFrames, false, counts);
+    delete unit;
+
+    bool passed = CheckChannels(input, reference, frames, sampleRate, blockFrames);
+    passed = CheckCheckpoints(input, reference, frames, sampleRate, blockFrames) && passed;
+    passed = CheckChunks(input, sampleRate, blockFrames) && passed;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,252 @@
+/**
+ * PingPongDelayCheckpoint.cpp:
+ *
+ * Implementation of PingPongDelayCheckpointCache class writing and
+ * resuming the checkpoint cache of an offline render.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayCheckpointCache
+ */
+
+
+// Caches over 2 GB must be seekable on 32-bit systems too.
+#define _FILE_OFFSET_BITS 64
+
+#include <unistd.h>
+#include <sys/types.h>
+
+#ifndef PINGPONGDELAYCHECKPOINT_H
+#include "PingPongDelayCheckpoint.h"
+#endif
+
+
+namespace PingPongDelay
+{
+    /**
+     * A constructor. The cache has no file open.
+     */
+    PingPongDelayCheckpointCache::PingPongDelayCheckpointCache() :
+        file_(NULL),
+        error_(NULL)
+    {
+    }
+
+    /**
+     * A destructor. Closes the file, if open.
+     */
+    PingPongDelayCheckpointCache::~PingPongDelayCheckpointCache()
+    {
+        Close();
+    }
+
+    /**
+     * Creates a cache of a render from its start.
+     * @param path a path of the cache.
+     * @param header a header of the cache.
+     * @return true if the cache was created, false otherwise, the error
+     *      is described by GetError.
+     */
+    bool PingPongDelayCheckpointCache::Create(const char* path, const PingPongDelayCheckpointHeader& header)
+    {
+        Close();
+        error_ = NULL;
+        if(!(file_ = fopen(path, "wb")))
+        {
+            error_ = "cannot create the cache";
+            return false;
+        }
+        if(fwrite(&header, sizeof(header), 1, file_) != 1)
+        {
+            error_ = "cannot write the cache";
+            fclose(file_);
+            file_ = NULL;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Opens a cache written by a previous render of the same input
+     * and resumes it at the last checkpoint not later than a frame.
+     * Records following the checkpoint are dropped, the change records
+     * among them earlier than the frame are returned, so that the render
+     * applies them again.
+     * @param path a path of the cache.
+     * @param header a header the cache must have.
+     * @param frame a frame from which the render changes.
+     * @param checkpoint where to store the checkpoint record.
+     * @param leftState where to store the left channel samples of the state.
+     * @param rightState where to store the right channel samples of the state.
+     * @param changes where to store the change records to be applied again.
+     * @return true if the cache was resumed, false otherwise, the error
+     *      is described by GetError.
+     */
+    bool PingPongDelayCheckpointCache::Resume(const char* path, const PingPongDelayCheckpointHeader& header,
+                                              unsigned long long frame, PingPongDelayCheckpointRecord& checkpoint,
+                                              std::vector<float>& leftState, std::vector<float>& rightState,
+                                              std::vector<PingPongDelayCheckpointRecord>& changes)
+    {
+        Close();
+        error_ = NULL;
+        changes.clear();
+        if(!(file_ = fopen(path, "r+b")))
+        {
+            error_ = "cannot open the cache";
+            return false;
+        }
+
+        PingPongDelayCheckpointHeader cachedHeader;
+        if(fread(&cachedHeader, sizeof(cachedHeader), 1, file_) != 1 ||
+           cachedHeader.magic != checkpointMagic || cachedHeader.version != checkpointVersion)
+        {
+            error_ = "not a checkpoint cache";
+            Close();
+            return false;
+        }
+        if(cachedHeader.inputBytes != header.inputBytes || cachedHeader.inputModified != header.inputModified ||
+           cachedHeader.sampleRate != header.sampleRate || cachedHeader.sampleFormat != header.sampleFormat ||
+           cachedHeader.tempo != header.tempo)
+        {
+            error_ = "the cache belongs to another input or settings";
+            Close();
+            return false;
+        }
+
+        // Records are in the order of their frames, the last checkpoint
+        // not later than the frame is looked for. A record cut off by
+        // a crashed render ends the cache.
+        off_t stateOffset = -1;
+        off_t resumedBytes = 0;
+        PingPongDelayCheckpointRecord record;
+        while(fread(&record, sizeof(record), 1, file_) == 1)
+        {
+            if(record.frame > frame || (record.type == ChangeRecord && record.frame == frame))
+            {
+                break;
+            }
+            off_t dataOffset = ftello(file_);
+            off_t stateBytes = (off_t)record.stateFrames * 2 * sizeof(float);
+            if(record.type == CheckpointRecord)
+            {
+                if(fseeko(file_, 0, SEEK_END) != 0 || ftello(file_) < dataOffset + stateBytes)
+                {
+                    break;
+                }
+                checkpoint = record;
+                stateOffset = dataOffset;
+                resumedBytes = dataOffset + stateBytes;
+                changes.clear();
+            }
+            else
+            {
+                changes.push_back(record);
+            }
+            if(fseeko(file_, dataOffset + stateBytes, SEEK_SET) != 0)
+            {
+                break;
+            }
+        }
+        if(stateOffset < 0)
+        {
+            error_ = "no checkpoint before the frame";
+            Close();
+            return false;
+        }
+
+        leftState.resize(checkpoint.stateFrames);
+        rightState.resize(checkpoint.stateFrames);
+        bool resumed = fseeko(file_, stateOffset, SEEK_SET) == 0 &&
+            fread(leftState.data(), sizeof(float), leftState.size(), file_) == leftState.size() &&
+            fread(rightState.data(), sizeof(float), rightState.size(), file_) == rightState.size() &&
+            ftruncate(fileno(file_), resumedBytes) == 0 && fseeko(file_, resumedBytes, SEEK_SET) == 0;
+        if(!resumed)
+        {
+            error_ = "cannot read the cache";
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Appends a change record.
+     * @param frame a frame from which the parameters are set.
+     * @param params the set parameters.
+     * @return true on success, false otherwise.
+     */
+    bool PingPongDelayCheckpointCache::AppendChange(unsigned long long frame, const PingPongDelayCheckpointParams& params)
+    {
+        PingPongDelayCheckpointRecord record;
+        record.type = ChangeRecord;
+        record.stateFrames = 0;
+        record.frame = frame;
+        record.params = params;
+        if(!file_ || fwrite(&record, sizeof(record), 1, file_) != 1)
+        {
+            error_ = "cannot write the cache";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Appends a checkpoint record followed by the state of the delay line.
+     * @param frame a frame of the render the state belongs to.
+     * @param params parameters in effect at the frame.
+     * @param leftState left channel samples of the state.
+     * @param rightState right channel samples of the state.
+     * @param stateFrames number of samples of each channel.
+     * @return true on success, false otherwise.
+     */
+    bool PingPongDelayCheckpointCache::AppendCheckpoint(unsigned long long frame,
+                                                        const PingPongDelayCheckpointParams& params,
+                                                        const float* leftState, const float* rightState,
+                                                        int stateFrames)
+    {
+        PingPongDelayCheckpointRecord record;
+        record.type = CheckpointRecord;
+        record.stateFrames = stateFrames;
+        record.frame = frame;
+        record.params = params;
+        if(!file_ || fwrite(&record, sizeof(record), 1, file_) != 1 ||
+           fwrite(leftState, sizeof(float), stateFrames, file_) != (size_t)stateFrames ||
+           fwrite(rightState, sizeof(float), stateFrames, file_) != (size_t)stateFrames)
+        {
+            error_ = "cannot write the cache";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Closes the cache.
+     * @return true if all the records were written, false otherwise.
+     */
+    bool PingPongDelayCheckpointCache::Close()
+    {
+        if(!file_)
+        {
+            return false;
+        }
+
+        bool written = (fclose(file_) == 0);
+        file_ = NULL;
+        if(!written && !error_)
+        {
+            error_ = "cannot write the cache";
+        }
+        return written;
+    }
+
+    /**
+     * Gets the description of the last error.
+     * @return description of the error, NULL if none.
+     */
+    const char* PingPongDelayCheckpointCache::GetError()
+    {
+        return error_;
+    }
+}
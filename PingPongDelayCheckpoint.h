@@ -0,0 +1,249 @@
+/**
+ * PingPongDelayCheckpoint.h:
+ *
+ * Declaration of PingPongDelayCheckpointParams, PingPongDelayCheckpointHeader
+ * and PingPongDelayCheckpointRecord structures describing the checkpoint
+ * cache of an offline render.
+ *
+ * Declaration of PingPongDelayCheckpointCache class writing the state of
+ * the unit at intervals of a render into the cache and resuming a later
+ * render from it, so that only the audio following a change of
+ * the parameters is rendered again.
+ *
+ * The cache is a stream of records in the order of their frames, written
+ * in the native byte order, as it is read only by the same tools on
+ * the same host.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayCheckpointCache
+ */
+
+
+#include <stdio.h>
+#include <vector>
+#include "PingPongDelayUnit.h"
+
+#ifndef PINGPONGDELAYCHECKPOINT_H
+#define PINGPONGDELAYCHECKPOINT_H
+
+
+namespace PingPongDelay
+{
+    /**
+     * Magic number identifying the checkpoint cache ("PPDC").
+     */
+    const unsigned int checkpointMagic = 0x50504443;
+
+    /**
+     * Version of the layout of the checkpoint cache.
+     */
+    const unsigned int checkpointVersion = 6;
+
+
+    /**
+     * An enum for types of the records of the checkpoint cache.
+     */
+    enum PingPongDelayCheckpointRecordType
+    {
+        ChangeRecord,
+        CheckpointRecord,
+    };
+
+
+    /**
+     * Parameters of the unit, the same as the ones of the effect, and
+     * the tempo the delay is synchronized to in BPM.
+     */
+    struct PingPongDelayCheckpointParams
+    {
+        float delayParam;
+        float feedbackParam;
+        float panoramaParam;
+        float wetParam;
+        float syncParam;
+        float tempo;
+        float tapCountParam;
+        float tapTimeParams[maxTapCount];
+        float tapGainParams[maxTapCount];
+        float tapPanoramaParams[maxTapCount];
+        float interpolationParam;
+        float freezeParam;
+        float economyParam;
+    };
+
+
+    /**
+     * Header of the checkpoint cache, identifying the render it belongs to.
+     */
+    struct PingPongDelayCheckpointHeader
+    {
+        /**
+         * Magic number, equal to checkpointMagic.
+         */
+        unsigned int magic;
+
+        /**
+         * Version of the layout, equal to checkpointVersion.
+         */
+        unsigned int version;
+
+        /**
+         * Size of the input file in bytes.
+         */
+        unsigned long long inputBytes;
+
+        /**
+         * Modification time of the input file in seconds since the epoch.
+         */
+        long long inputModified;
+
+        /**
+         * Sample rate of the render in Hz.
+         */
+        int sampleRate;
+
+        /**
+         * Sample format of the output, a PingPongDelaySampleFormat.
+         */
+        int sampleFormat;
+
+        /**
+         * Tempo the delay is synchronized to at the start in BPM.
+         */
+        float tempo;
+
+        /**
+         * Unused, zero.
+         */
+        int reserved;
+    };
+
+
+    /**
+     * One record of the checkpoint cache. Change record sets the parameters
+     * from its frame on. Checkpoint record holds the parameters in effect
+     * at its frame and is followed by the state of the delay line, first
+     * the left and then the right channel samples.
+     */
+    struct PingPongDelayCheckpointRecord
+    {
+        /**
+         * Type of the record, a PingPongDelayCheckpointRecordType.
+         */
+        int type;
+
+        /**
+         * Number of samples of each channel of the state following
+         * the checkpoint record, zero for the change record.
+         */
+        int stateFrames;
+
+        /**
+         * Frame of the render the record belongs to.
+         */
+        unsigned long long frame;
+
+        /**
+         * Parameters of the unit from the frame on.
+         */
+        PingPongDelayCheckpointParams params;
+    };
+
+
+    /**
+     * Checkpoint cache of an offline render. The render appends the change
+     * records and the checkpoints as it passes their frames, a later render
+     * resumes it at a checkpoint, dropping the records following it.
+     */
+    class PingPongDelayCheckpointCache
+    {
+    public:
+        /**
+         * A constructor. The cache has no file open.
+         */
+        PingPongDelayCheckpointCache();
+
+        /**
+         * A destructor. Closes the file, if open.
+         */
+        ~PingPongDelayCheckpointCache();
+
+        /**
+         * Creates a cache of a render from its start.
+         * @param path a path of the cache.
+         * @param header a header of the cache.
+         * @return true if the cache was created, false otherwise, the error
+         *      is described by GetError.
+         */
+        bool Create(const char* path, const PingPongDelayCheckpointHeader& header);
+
+        /**
+         * Opens a cache written by a previous render of the same input
+         * and resumes it at the last checkpoint not later than a frame.
+         * Records following the checkpoint are dropped, the change records
+         * among them earlier than the frame are returned, so that the render
+         * applies them again.
+         * @param path a path of the cache.
+         * @param header a header the cache must have.
+         * @param frame a frame from which the render changes.
+         * @param checkpoint where to store the checkpoint record.
+         * @param leftState where to store the left channel samples of the state.
+         * @param rightState where to store the right channel samples of the state.
+         * @param changes where to store the change records to be applied again.
+         * @return true if the cache was resumed, false otherwise, the error
+         *      is described by GetError.
+         */
+        bool Resume(const char* path, const PingPongDelayCheckpointHeader& header, unsigned long long frame,
+                    PingPongDelayCheckpointRecord& checkpoint, std::vector<float>& leftState,
+                    std::vector<float>& rightState, std::vector<PingPongDelayCheckpointRecord>& changes);
+
+        /**
+         * Appends a change record.
+         * @param frame a frame from which the parameters are set.
+         * @param params the set parameters.
+         * @return true on success, false otherwise.
+         */
+        bool AppendChange(unsigned long long frame, const PingPongDelayCheckpointParams& params);
+
+        /**
+         * Appends a checkpoint record followed by the state of the delay line.
+         * @param frame a frame of the render the state belongs to.
+         * @param params parameters in effect at the frame.
+         * @param leftState left channel samples of the state.
+         * @param rightState right channel samples of the state.
+         * @param stateFrames number of samples of each channel.
+         * @return true on success, false otherwise.
+         */
+        bool AppendCheckpoint(unsigned long long frame, const PingPongDelayCheckpointParams& params,
+                              const float* leftState, const float* rightState, int stateFrames);
+
+        /**
+         * Closes the cache.
+         * @return true if all the records were written, false otherwise.
+         */
+        bool Close();
+
+        /**
+         * Gets the description of the last error.
+         * @return description of the error, NULL if none.
+         */
+        const char* GetError();
+
+    private:
+        /**
+         * Open file, NULL if none.
+         */
+        FILE* file_;
+
+        /**
+         * Description of the last error, NULL if none.
+         */
+        const char* error_;
+    };
+}
+
+
+#endif
@@ -0,0 +1,224 @@
+/**
+ * PingPongDelayChunk.cpp:
+ *
+ * Implementation of functions writing and reading the chunk, in which
+ * PingPongDelayEffect hands its program over to the host.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see WriteChunk
+ * @see ReadChunk
+ */
+
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef PINGPONGDELAYCHUNK_H
+#include "PingPongDelayChunk.h"
+#endif
+
+
+namespace PingPongDelay
+{
+    /**
+     * Writes a little endian word and moves behind it.
+     * @param data where to store the bytes of the word.
+     * @param word the word.
+     */
+    static void PutWord(unsigned char*& data, uint32_t word)
+    {
+        for(int i = 0; i < 4; ++i)
+        {
+            *data++ = (unsigned char)(word >> (8 * i));
+        }
+    }
+
+    /**
+     * Writes a float as a little endian word of its bits and moves behind it.
+     * @param data where to store the bytes of the float.
+     * @param value the float.
+     */
+    static void PutFloat(unsigned char*& data, float value)
+    {
+        uint32_t word;
+        memcpy(&word, &value, sizeof(word));
+        PutWord(data, word);
+    }
+
+    /**
+     * Reads a little endian word and moves behind it.
+     * @param data bytes of the word.
+     * @return the word.
+     */
+    static uint32_t GetWord(const unsigned char*& data)
+    {
+        uint32_t word = 0;
+        for(int i = 3; i >= 0; --i)
+        {
+            word = (word << 8) | data[i];
+        }
+        data += 4;
+        return word;
+    }
+
+    /**
+     * Reads a float from a little endian word of its bits and moves
+     * behind it.
+     * @param data bytes of the float.
+     * @return the float.
+     */
+    static float GetFloat(const unsigned char*& data)
+    {
+        uint32_t word = GetWord(data);
+        float value;
+        memcpy(&value, &word, sizeof(value));
+        return value;
+    }
+
+    /**
+     * Lists the parameters of settings in the order they are stored
+     * in the chunk, which is the order of PingPongDelayParameter.
+     * @param settings the settings.
+     * @param params where to store chunkParamCount pointers to the parameters.
+     */
+    void ListChunkParams(PingPongDelaySettings& settings, float** params)
+    {
+        float* first[] = {&settings.delayParam, &settings.feedbackParam, &settings.panoramaParam, &settings.wetParam,
+                          &settings.syncParam, &settings.interpolationParam, &settings.tapCountParam};
+        int count = sizeof(first) / sizeof(first[0]);
+        memcpy(params, first, sizeof(first));
+        for(int tap = 0; tap < maxTapCount; ++tap)
+        {
+            params[count++] = &settings.tapTimeParams[tap];
+            params[count++] = &settings.tapGainParams[tap];
+            params[count++] = &settings.tapPanoramaParams[tap];
+        }
+    }
+
+
+    /**
+     * Writes the chunk of a program.
+     * @param settings settings of the unit of the program.
+     * @param programName a name of the program.
+     * @param chunk where to store chunkBytes bytes of the chunk.
+     * @return size of the chunk in bytes.
+     */
+    int WriteChunk(const PingPongDelaySettings& settings, const char* programName, unsigned char* chunk)
+    {
+        unsigned char* data = chunk;
+        PutWord(data, chunkMagic);
+        PutWord(data, chunkVersion);
+        PutWord(data, chunkParamCount);
+        PutWord(data, chunkDerivedCount);
+
+        PingPongDelaySettings copy = settings;
+        float* params[chunkParamCount];
+        ListChunkParams(copy, params);
+        for(int param = 0; param < chunkParamCount; ++param)
+        {
+            PutFloat(data, *params[param]);
+        }
+
+        // Name is padded by zeros, so that the chunk holds no stale memory.
+        memset(data, 0, kVstMaxProgNameLen);
+        strncpy((char*)data, programName, kVstMaxProgNameLen);
+        data += kVstMaxProgNameLen;
+
+        PutWord(data, settings.asyncDelayMs);
+        PutWord(data, settings.syncDelayRatioIndex);
+        PutFloat(data, settings.feedback);
+        PutFloat(data, settings.panoramaParamC);
+        PutFloat(data, settings.primaryPanningQuotient);
+        PutFloat(data, settings.secondaryPanningQuotient);
+        PutFloat(data, settings.wetParamC);
+        PutWord(data, settings.isAsync ? 1 : 0);
+        PutWord(data, settings.tapCount);
+        PutWord(data, settings.interpolation);
+        for(int tap = 0; tap < maxTapCount; ++tap)
+        {
+            PutFloat(data, settings.tapTimeRatios[tap]);
+            PutFloat(data, settings.tapLeftGains[tap]);
+            PutFloat(data, settings.tapRightGains[tap]);
+        }
+        return (int)(data - chunk);
+    }
+
+    /**
+     * Reads the chunk of a program. Parameters out of [0, 1] and the ones
+     * missing in the chunk are left as they are.
+     * @param chunk bytes of the chunk.
+     * @param bytes size of the chunk in bytes.
+     * @param settings the current settings of the unit, where to store
+     *      the settings read.
+     * @param programName where to store the name of the program, at least
+     *      kVstMaxProgNameLen + 1 bytes.
+     * @param derived where to store whether the derived values were read
+     *      as well. If not, they must be derived from the parameters again.
+     * @return size of the chunk in bytes, zero if it is not a chunk
+     *      of the effect and nothing was stored.
+     */
+    int ReadChunk(const unsigned char* chunk, int bytes, PingPongDelaySettings& settings, char* programName, bool& derived)
+    {
+        if(!chunk || bytes < 4 * chunkHeaderWords)
+        {
+            return 0;
+        }
+
+        // Counts are checked against the size before anything is read,
+        // so that a damaged chunk is never read beyond its end.
+        const unsigned char* data = chunk;
+        uint32_t magic = GetWord(data);
+        uint32_t version = GetWord(data);
+        uint32_t paramCount = GetWord(data);
+        uint32_t derivedCount = GetWord(data);
+        unsigned long long requiredBytes = 4ULL * (chunkHeaderWords + (unsigned long long)paramCount +
+                                                   derivedCount) + kVstMaxProgNameLen;
+        if(magic != chunkMagic || version == 0 || requiredBytes > (unsigned long long)bytes)
+        {
+            return 0;
+        }
+
+        float* params[chunkParamCount];
+        ListChunkParams(settings, params);
+        for(uint32_t param = 0; param < paramCount; ++param)
+        {
+            float value = GetFloat(data);
+            if(param < (uint32_t)chunkParamCount && value >= 0.0f && value <= 1.0f)
+            {
+                *params[param] = value;
+            }
+        }
+
+        memcpy(programName, data, kVstMaxProgNameLen);
+        programName[kVstMaxProgNameLen] = 0;
+        data += kVstMaxProgNameLen;
+
+        // Derived values of other versions may mean anything, as well as
+        // the ones of parameters which were left as they are.
+        derived = (version == chunkVersion && paramCount == (uint32_t)chunkParamCount &&
+                   derivedCount == (uint32_t)chunkDerivedCount);
+        if(derived)
+        {
+            settings.asyncDelayMs = (int)GetWord(data);
+            settings.syncDelayRatioIndex = (int)GetWord(data);
+            settings.feedback = GetFloat(data);
+            settings.panoramaParamC = GetFloat(data);
+            settings.primaryPanningQuotient = GetFloat(data);
+            settings.secondaryPanningQuotient = GetFloat(data);
+            settings.wetParamC = GetFloat(data);
+            settings.isAsync = (GetWord(data) != 0);
+            settings.tapCount = (int)GetWord(data);
+            settings.interpolation = (int)GetWord(data);
+            for(int tap = 0; tap < maxTapCount; ++tap)
+            {
+                settings.tapTimeRatios[tap] = GetFloat(data);
+                settings.tapLeftGains[tap] = GetFloat(data);
+                settings.tapRightGains[tap] = GetFloat(data);
+            }
+        }
+        return (int)requiredBytes;
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ * PingPongDelayChunk.h:
+ *
+ * Declaration of functions writing and reading the chunk, in which
+ * PingPongDelayEffect hands its program over to the host.
+ *
+ * The chunk is a sequence of little endian 32-bit words, floats stored
+ * by their IEEE 754 bits, so that a chunk saved on one host restores
+ * on any other one. The header is followed by the parameters in the order
+ * of PingPongDelayParameter, by the program name and by the values derived
+ * from the parameters:
+ *
+ *      magic, version, parameter count, derived value count,
+ *      parameters, program name (kVstMaxProgNameLen bytes), derived values.
+ *
+ * The chunk of a bank holds the chunks of all its programs one after
+ * another.
+ *
+ * Later versions may only append parameters, while their derived values
+ * may change freely. The parameters known to the reader are restored from
+ * a chunk of any version, the derived values only from a chunk of its own
+ * version, otherwise they are derived from the parameters again.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see WriteChunk
+ * @see ReadChunk
+ */
+
+
+#include "public.sdk/source/vst2.x/audioeffectx.h"
+#include "PingPongDelayUnit.h"
+
+#ifndef PINGPONGDELAYCHUNK_H
+#define PINGPONGDELAYCHUNK_H
+
+
+namespace PingPongDelay
+{
+    /**
+     * Magic number identifying the chunk ("PPDK").
+     */
+    const unsigned int chunkMagic = 0x5050444B;
+
+    /**
+     * Version of the layout of the chunk.
+     */
+    const unsigned int chunkVersion = 1;
+
+    /**
+     * Number of words of the chunk header.
+     */
+    const int chunkHeaderWords = 4;
+
+    /**
+     * Number of parameters stored in the chunk.
+     */
+    const int chunkParamCount = 7 + 3 * maxTapCount;
+
+    /**
+     * Number of derived values stored in the chunk.
+     */
+    const int chunkDerivedCount = 10 + 3 * maxTapCount;
+
+    /**
+     * Size of the chunk in bytes.
+     */
+    const int chunkBytes = 4 * (chunkHeaderWords + chunkParamCount + chunkDerivedCount) + kVstMaxProgNameLen;
+
+
+    /**
+     * Lists the parameters of settings in the order they are stored
+     * in the chunk, which is the order of PingPongDelayParameter.
+     * @param settings the settings.
+     * @param params where to store chunkParamCount pointers to the parameters.
+     */
+    void ListChunkParams(PingPongDelaySettings& settings, float** params);
+
+    /**
+     * Writes the chunk of a program.
+     * @param settings settings of the unit of the program.
+     * @param programName a name of the program.
+     * @param chunk where to store chunkBytes bytes of the chunk.
+     * @return size of the chunk in bytes.
+     */
+    int WriteChunk(const PingPongDelaySettings& settings, const char* programName, unsigned char* chunk);
+
+    /**
+     * Reads the chunk of a program. Parameters out of [0, 1] and the ones
+     * missing in the chunk are left as they are.
+     * @param chunk bytes of the chunk.
+     * @param bytes size of the chunk in bytes.
+     * @param settings the current settings of the unit, where to store
+     *      the settings read.
+     * @param programName where to store the name of the program, at least
+     *      kVstMaxProgNameLen + 1 bytes.
+     * @param derived where to store whether the derived values were read
+     *      as well. If not, they must be derived from the parameters again.
+     * @return size of the chunk in bytes, zero if it is not a chunk
+     *      of the effect and nothing was stored.
+     */
+    int ReadChunk(const unsigned char* chunk, int bytes, PingPongDelaySettings& settings, char* programName, bool& derived);
+}
+
+
+#endif
@@ -14,7 +14,9 @@
 
 
 #include <stdio.h>
+#include <string.h>
 #include "PingPongDelayEffect.h"
+#include "PingPongDelayBitmapCache.h"
 
 #ifndef PINGPONGDELAYEDITOR_H
 #include "PingPongDelayEditor.h"
@@ -24,6 +26,13 @@
 namespace PingPongDelay
 {
     // Fields holding the PingPongDelayEditor settings.
+    /**
+     * Minimal interval between the updates of the controls and
+     * the meters in milliseconds, it matches the display rate.
+     */
+    const VstInt32 PingPongDelayEditor::updateIntervalMs_ = 16;
+
+
     // Bitmap ids.
     /**
      * Id of background bitmap resource.
@@ -76,6 +85,37 @@ namespace PingPongDelay
     const short PingPongDelayEditor::syncButtonX_ = 131;
     const short PingPongDelayEditor::syncButtonY_ = 316;
 
+    // Fields holding meter positions.
+    /**
+     * Horizontal coor GUI position of the first meter.
+     */
+    const short PingPongDelayEditor::meterX_ = 172;
+
+    /**
+     * Meters vertical coor GUI position.
+     */
+    const short PingPongDelayEditor::meterY_ = 308;
+
+    /**
+     * Width of one meter.
+     */
+    const short PingPongDelayEditor::meterWidth_ = 6;
+
+    /**
+     * Height of one meter.
+     */
+    const short PingPongDelayEditor::meterHeight_ = 40;
+
+    /**
+     * Horizontal distance between the meters of channels of one point.
+     */
+    const short PingPongDelayEditor::meterChannelSpacing_ = 7;
+
+    /**
+     * Horizontal distance between the meters of adjacent points.
+     */
+    const short PingPongDelayEditor::meterPointSpacing_ = 20;
+
 
     /**
      * Overriden AEffGUIEditor::AEffGUIEditor(AudioEffect* effect) constructor.
@@ -83,14 +123,18 @@ namespace PingPongDelay
      */
     PingPongDelayEditor::PingPongDelayEditor(AudioEffect *effect) :
         AEffGUIEditor (effect),
+        lastUpdateTicks_(0),
         delayFader_(NULL),
         feedbackFader_(NULL),
         panoramaFader_(NULL),
         wetFader_(NULL),
         syncButton_(NULL)
     {
-        // Loading GUI background bitmap.
-        guiBackground_  = new CBitmap(backgroundBitmapId_);
+        memset(meters_, 0, sizeof(meters_));
+        dirtyParams_.store(0, std::memory_order_relaxed);
+
+        // Getting GUI background bitmap shared by all the editors.
+        guiBackground_  = PingPongDelayBitmapCache::Acquire(backgroundBitmapId_);
 
         // Inicializing the GUI size.
         rect.left   = 0;
@@ -104,10 +148,10 @@ namespace PingPongDelay
      */
     PingPongDelayEditor::~PingPongDelayEditor()
     {
-        // Forgetting background bitmap.
+        // Releasing background bitmap.
         if(guiBackground_)
         {
-            guiBackground_->forget();
+            PingPongDelayBitmapCache::Release(backgroundBitmapId_);
         }
         guiBackground_ = NULL;
     }
@@ -123,14 +167,17 @@ namespace PingPongDelay
         // While opening it is necessary to call original open method!!!
         AEffGUIEditor::open(ptr);
 
+        // Controls are created with the current values, so nothing is dirty.
+        dirtyParams_.store(0, std::memory_order_relaxed);
+
         // Creating new CFrame for GUI.
-        CBitmap* faderBackgroundBitmap = new CBitmap(faderBackgroundBitmapId_);
+        CBitmap* faderBackgroundBitmap = PingPongDelayBitmapCache::Acquire(faderBackgroundBitmapId_);
         CRect guiSizeRect(0, 0, guiBackground_->getWidth(), guiBackground_->getHeight());
         CFrame* guiFrame = new CFrame(guiSizeRect, ptr, this);
         guiFrame->setBackground(guiBackground_);
 
         // Creating faders.
-        CBitmap* faderBitmap = new CBitmap(faderBitmapId_);
+        CBitmap* faderBitmap = PingPongDelayBitmapCache::Acquire(faderBitmapId_);
         int minXFaderPos = faderX_;
         int maxXFaderPos = faderX_ + faderBackgroundBitmap->getWidth() - faderBitmap->getWidth();
         CPoint offset(0, 0);
@@ -160,18 +207,27 @@ namespace PingPongDelay
         guiFrame->addView(wetFader_);
 
         // Creating Sync Button.
-        CBitmap* syncButtonBitmap = new CBitmap(syncButtonBitmapId_);
+        CBitmap* syncButtonBitmap = PingPongDelayBitmapCache::Acquire(syncButtonBitmapId_);
         CRect syncButtonSizeRect(syncButtonX_, syncButtonY_, syncButtonX_ + syncButtonBitmap->getWidth(),
                                  syncButtonY_ + (syncButtonBitmap->getHeight() / 2));
         syncButton_ = new COnOffButton(syncButtonSizeRect, this, SyncParam, syncButtonBitmap);
         syncButton_->setValue(effect->getParameter(SyncParam));
         guiFrame->addView(syncButton_);
 
-        // Decrementing numbers of references. We cannot delete them
-        // directly as far as some CControls use these bitmaps.
-        faderBackgroundBitmap->forget();
-        faderBitmap->forget();
-        syncButtonBitmap->forget();
+        // Creating level meters, channels of each point side by side.
+        for(int point = 0; point < meterPointCount; ++point)
+        {
+            for(int channel = 0; channel < meterChannelCount; ++channel)
+            {
+                int meterX = meterX_ + (point * meterPointSpacing_) + (channel * meterChannelSpacing_);
+                CRect meterSizeRect(meterX, meterY_, meterX + meterWidth_, meterY_ + meterHeight_);
+                meters_[point][channel] = new PingPongDelayMeter(meterSizeRect);
+                guiFrame->addView(meters_[point][channel]);
+            }
+        }
+
+        // Control bitmaps stay acquired while the editor is open, so that
+        // other editors opened meanwhile do not load them again.
 
         // Assigning created guiFrame as VST's GUI main frame.
         frame = guiFrame;
@@ -184,50 +240,131 @@ namespace PingPongDelay
      */
     void PingPongDelayEditor::close()
     {
-        // Dispozing the frame.
+        if(!frame)
+        {
+            return;
+        }
+
+        // Dispozing the frame, it deletes all its views.
         delete frame;
         frame = NULL;
+        memset(meters_, 0, sizeof(meters_));
+
+        // Releasing control bitmaps acquired by open.
+        PingPongDelayBitmapCache::Release(faderBackgroundBitmapId_);
+        PingPongDelayBitmapCache::Release(faderBitmapId_);
+        PingPongDelayBitmapCache::Release(syncButtonBitmapId_);
     }
 
     /**
      * Overriden AEffGUIEditor::setParameter(VstInt32 index, float value) method.
-     * Called when parameter is set via editor.
+     * Called when parameter is set via editor. It only marks the parameter
+     * dirty, its control is updated by the next idle update, so that it is
+     * cheap to call from any thread as often as the host automates.
      * @param index an index of a parameter.
-     * @param value a value from [0, 1] of parameter to set.
+     * @param value a value from [0, 1] of parameter to set, ignored,
+     *      idle() reads the current value from the effect.
      */
     void PingPongDelayEditor::setParameter (VstInt32 index, float value)
     {
-        if(!frame)
+        (void)value;
+        if(index < 0 || index >= (VstInt32)(sizeof(unsigned int) * 8))
         {
             return;
         }
 
-        switch (index)
+        // Dense automation mostly hits parameters already marked, those
+        // are recognized by the plain load without the locked operation.
+        unsigned int mask = (1u << index);
+        if(!(dirtyParams_.load(std::memory_order_relaxed) & mask))
+        {
+            dirtyParams_.fetch_or(mask, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Overriden AEffGUIEditor::idle() method.
+     * Called periodically by VST host. At most once per update interval
+     * it updates the controls of dirty parameters and the meters.
+     */
+    void PingPongDelayEditor::idle()
+    {
+        if(frame)
+        {
+            VstInt32 ticks = getTicks();
+            if(ticks - lastUpdateTicks_ >= updateIntervalMs_ || ticks < lastUpdateTicks_)
+            {
+                lastUpdateTicks_ = ticks;
+                UpdateControls();
+                UpdateMeters();
+            }
+        }
+
+        // Original idle method redraws the dirty views.
+        AEffGUIEditor::idle();
+    }
+
+    /**
+     * Updates the controls of parameters marked dirty since
+     * the last update and clears their marks.
+     */
+    void PingPongDelayEditor::UpdateControls()
+    {
+        // Parameters marked after the exchange are left for the next update.
+        unsigned int dirtyParams = dirtyParams_.exchange(0, std::memory_order_acquire);
+        for(VstInt32 index = 0; dirtyParams != 0; ++index, dirtyParams >>= 1)
+        {
+            if(!(dirtyParams & 1))
+            {
+                continue;
+            }
+
+            switch (index)
+            {
+                case DelayParam:
+                    if (delayFader_)
+                        delayFader_->setValue(effect->getParameter (index));
+                    break;
+
+                case FeedbackParam:
+                    if (feedbackFader_)
+                        feedbackFader_->setValue(effect->getParameter (index));
+                    break;
+
+                case PanoramaParam:
+                    if (panoramaFader_)
+                        panoramaFader_->setValue(effect->getParameter (index));
+                    break;
+
+                case WetParam:
+                    if (wetFader_)
+                        wetFader_->setValue(effect->getParameter (index));
+                    break;
+
+                case SyncParam:
+                    if (syncButton_)
+                        syncButton_->setValue(effect->getParameter (index));
+                    break;
+            }
+        }
+    }
+
+    /**
+     * Polls the levels metered by the effect and updates the meters.
+     */
+    void PingPongDelayEditor::UpdateMeters()
+    {
+        PingPongDelayLevels levels;
+        ((PingPongDelayEffect*)effect)->GetLevels(levels);
+        for(int point = 0; point < meterPointCount; ++point)
         {
-            case DelayParam:
-                if (delayFader_)
-                    delayFader_->setValue(effect->getParameter (index));
-                break;
-
-            case FeedbackParam:
-                if (feedbackFader_)
-                    feedbackFader_->setValue(effect->getParameter (index));
-                break;
-
-            case PanoramaParam:
-                if (panoramaFader_)
-                    panoramaFader_->setValue(effect->getParameter (index));
-                break;
-
-            case WetParam:
-                if (wetFader_)
-                    wetFader_->setValue(effect->getParameter (index));
-                break;
-
-            case SyncParam:
-                if (syncButton_)
-                    syncButton_->setValue(effect->getParameter (index));
-                break;
+            for(int channel = 0; channel < meterChannelCount; ++channel)
+            {
+                if(meters_[point][channel])
+                {
+                    meters_[point][channel]->SetLevels(levels.peak[point][channel], levels.rms[point][channel]);
+                }
+            }
         }
     }
 
@@ -14,7 +14,10 @@
  */
 
 
+#include <atomic>
 #include "vstgui.sf/vstgui/vstgui.h"
+#include "PingPongDelayLevels.h"
+#include "PingPongDelayMeter.h"
 
 #ifndef GUIEDITOR_H
 #define GUIEDITOR_H
@@ -56,12 +59,22 @@ namespace PingPongDelay
 
         /**
          * Overriden AEffGUIEditor::setParameter(VstInt32 index, float value) method.
-         * Called when parameter is set via editor.
+         * Called when parameter is set via editor. It only marks the parameter
+         * dirty, its control is updated by the next idle update, so that it is
+         * cheap to call from any thread as often as the host automates.
          * @param index an index of a parameter.
-         * @param value a value from [0, 1] of parameter to set.
+         * @param value a value from [0, 1] of parameter to set, ignored,
+         *      idle() reads the current value from the effect.
          */
         void setParameter(VstInt32 index, float value);
 
+        /**
+         * Overriden AEffGUIEditor::idle() method.
+         * Called periodically by VST host. At most once per update interval
+         * it updates the controls of dirty parameters and the meters.
+         */
+        void idle();
+
         /**
          * Overriden CControlListener::valueChanged(CDrawContext* context, CControl* control) method.
          * Called when anything is changed elsewhere than in editor.
@@ -71,6 +84,29 @@ namespace PingPongDelay
         void valueChanged(CDrawContext* context, CControl* control);
 
     private:
+        /**
+         * Updates the controls of parameters marked dirty since
+         * the last update and clears their marks.
+         */
+        void UpdateControls();
+
+        /**
+         * Polls the levels metered by the effect and updates the meters.
+         */
+        void UpdateMeters();
+
+
+        /**
+         * Bit mask of parameters changed since the last update of the
+         * controls, bit index is the index of the parameter.
+         */
+        std::atomic<unsigned int> dirtyParams_;
+
+        /**
+         * Ticks of the last update of the controls and the meters.
+         */
+        VstInt32 lastUpdateTicks_;
+
         /**
          * GUI Background bitmap.
          */
@@ -104,7 +140,20 @@ namespace PingPongDelay
         COnOffButton* syncButton_;
 
 
+        /**
+         * GUI level meters, indexed by PingPongDelayMeterPoint and channel.
+         */
+        PingPongDelayMeter* meters_[meterPointCount][meterChannelCount];
+
+
         // Fields holding the PingPongDelayEditor settings.
+        /**
+         * Minimal interval between the updates of the controls and
+         * the meters in milliseconds, it matches the display rate.
+         */
+        static const VstInt32 updateIntervalMs_;
+
+
         // Resource bitmap ids.
         /**
          * Id of background bitmap resource.
@@ -164,6 +213,38 @@ namespace PingPongDelay
          * Sync button vertical coor GUI position.
          */
         static const short syncButtonY_;
+
+
+        // Fields holding meter positions.
+        /**
+         * Horizontal coor GUI position of the first meter.
+         */
+        static const short meterX_;
+
+        /**
+         * Meters vertical coor GUI position.
+         */
+        static const short meterY_;
+
+        /**
+         * Width of one meter.
+         */
+        static const short meterWidth_;
+
+        /**
+         * Height of one meter.
+         */
+        static const short meterHeight_;
+
+        /**
+         * Horizontal distance between the meters of channels of one point.
+         */
+        static const short meterChannelSpacing_;
+
+        /**
+         * Horizontal distance between the meters of adjacent points.
+         */
+        static const short meterPointSpacing_;
     };
 }
 
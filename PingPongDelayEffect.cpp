@@ -12,12 +12,19 @@
  */
 
 
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
 #include "public.sdk/source/vst2.x/audioeffectx.h"
 #include "PingPongDelayUnit.h"
+#include "PingPongDelaySurround.h"
+#ifndef PINGPONGDELAY_NO_EDITOR
 #include "PingPongDelayEditor.h"
+#endif
+#include "PingPongDelayBufferPool.h"
 
 #ifndef PINGPONGDELAYEFFECT_H
-#include "PingPongDelayEFFECT.h"
+#include "PingPongDelayEffect.h"
 #endif
 
 
@@ -55,17 +62,48 @@ namespace PingPongDelay
      */
     const float PingPongDelayEffect::defaultSyncParam_ = 0.0f;
 
+    /**
+     * Initial interpolation parameter of the unit.
+     */
+    const float PingPongDelayEffect::defaultInterpolationParam_ = 0.0f;
+
+    /**
+     * Initial tap count parameter of the unit.
+     */
+    const float PingPongDelayEffect::defaultTapCountParam_ = 0.0f;
+
+    /**
+     * Tempo of the unit until the host gives a valid one.
+     */
+    const double PingPongDelayEffect::defaultTempo_ = 120.0;
+
 
-    // Fields holding the basic PING PONG DELAY VST information.
     /**
      * Number of programs of plugin.
      */
-    const VstInt32 PingPongDelayEffect::numPrograms_ = 1;
+    const VstInt32 PingPongDelayEffect::numPrograms_;
 
+    /**
+     * Maximal number of speakers of the accepted arrangements.
+     */
+    const int PingPongDelayEffect::maxSpeakerCount_;
+
+    /**
+     * Maximal number of speakers of a ring processed by a surround unit.
+     */
+    const int PingPongDelayEffect::maxRingCount_;
+
+    /**
+     * Number of the surround speaker layouts.
+     */
+    const int PingPongDelayEffect::speakerLayoutCount_;
+
+
+    // Fields holding the basic PING PONG DELAY VST information.
     /**
      * Number of parameters of plugin.
      */
-    const VstInt32 PingPongDelayEffect::numParams_ = 5;
+    const VstInt32 PingPongDelayEffect::numParams_ = EconomyParam + 1;
 
     /**
      * Number of input channels of plugin.
@@ -107,6 +145,23 @@ namespace PingPongDelay
      */
     const VstInt32 PingPongDelayEffect::vendorVersion_ = 1000;
 
+    /**
+     * Surround speaker layouts accepted by setSpeakerArrangement, the same
+     * rings as the ones of the surround files rendered by PingPongDelayRender.
+     */
+    const PingPongDelayEffect::SpeakerLayout PingPongDelayEffect::speakerLayouts_[speakerLayoutCount_] =
+    {
+        // Quad.
+        {4, 4, {kSpeakerL, kSpeakerR, kSpeakerRs, kSpeakerLs}},
+        // 5.1.
+        {6, 5, {kSpeakerL, kSpeakerC, kSpeakerR, kSpeakerRs, kSpeakerLs}},
+        // 7.1, passing the side speakers between the front and the rear ones.
+        {8, 7, {kSpeakerL, kSpeakerC, kSpeakerR, kSpeakerSr, kSpeakerRs, kSpeakerLs, kSpeakerSl}},
+        // 7.1.4, continuing from the bed to the height speakers.
+        {12, 11, {kSpeakerL, kSpeakerC, kSpeakerR, kSpeakerSr, kSpeakerRs, kSpeakerLs, kSpeakerSl,
+                  kSpeakerTfl, kSpeakerTfr, kSpeakerTrr, kSpeakerTrl}},
+    };
+
 
     // Fields holding the parameter names, labels.
     /**
@@ -134,6 +189,41 @@ namespace PingPongDelay
      */
     const char* PingPongDelayEffect::syncParamName_ = "Sync";
 
+    /**
+     * Display string of the interpolation parameter.
+     */
+    const char* PingPongDelayEffect::interpolationParamName_ = "Interpolation";
+
+    /**
+     * Display string of the tap count parameter.
+     */
+    const char* PingPongDelayEffect::tapCountParamName_ = "Taps";
+
+    /**
+     * Format of the display strings of the tap time parameters.
+     */
+    const char* PingPongDelayEffect::tapTimeParamName_ = "Tap %d Time";
+
+    /**
+     * Format of the display strings of the tap gain parameters.
+     */
+    const char* PingPongDelayEffect::tapGainParamName_ = "Tap %d Gain";
+
+    /**
+     * Format of the display strings of the tap panorama parameters.
+     */
+    const char* PingPongDelayEffect::tapPanoramaParamName_ = "Tap %d Pan";
+
+    /**
+     * Display string of the freeze parameter.
+     */
+    const char* PingPongDelayEffect::freezeParamName_ = "Freeze";
+
+    /**
+     * Display string of the economy parameter.
+     */
+    const char* PingPongDelayEffect::economyParamName_ = "Economy";
+
     /**
      * Display string of the millisecond unit.
      */
@@ -149,6 +239,21 @@ namespace PingPongDelay
      */
     const char* PingPongDelayEffect::stateLabel_ = "state";
 
+    /**
+     * Display string of the count unit.
+     */
+    const char* PingPongDelayEffect::countLabel_ = "count";
+
+    /**
+     * Display string of the mode unit.
+     */
+    const char* PingPongDelayEffect::modeLabel_ = "mode";
+
+    /**
+     * Display string of the unit of the parameters applied on restart.
+     */
+    const char* PingPongDelayEffect::restartLabel_ = "restart";
+
     /**
      * Display string of the off label.
      */
@@ -160,33 +265,79 @@ namespace PingPongDelay
     const char* PingPongDelayEffect::onLabel_ = "On";
 
 
+#ifdef PINGPONGDELAY_PROFILING
+    /**
+     * Identifier of vendor specific request for the profile.
+     */
+    const VstInt32 PingPongDelayEffect::getProfileRequest_ = 'PPDp';
+#endif
+
+
     /**
      * Overriden AudioEffectX::AudioEffectX(audioMasterCallback audioMaster) constructor.
      * @param audioMaster an audio VST host master.
      */
     PingPongDelayEffect::PingPongDelayEffect(audioMasterCallback audioMaster) :
         AudioEffectX(audioMaster, numPrograms_, numParams_),
+        programsLocked_(false),
+        fallbackTimeInfo_(),
         unit_(defaultUnitBufferSize_,
-              getTimeInfo(kVstTempoValid),
+              GetValidTimeInfo(kVstTempoValid),
               defaultDelayParam_,
               defaultFeedbackParam_,
               defaultPanoramaParam_,
               defaultWetParam_,
-              defaultSyncParam_)
+              defaultSyncParam_),
+        ringCount_(0),
+        lfeChannel_(-1),
+        quadUnit_(NULL),
+        surround51Unit_(NULL),
+        surround71Unit_(NULL),
+        surround714Unit_(NULL),
+        surroundSettings_(NULL)
     {
         // Setting stereo input and output.
         setNumInputs(numInputs_);
         setNumOutputs(numOutputs_);
+        SpeakerArrangement* arrangements[] = {&inputArrangement_, &outputArrangement_};
+        for(int i = 0; i < 2; ++i)
+        {
+            memset(arrangements[i], 0, sizeof(SpeakerArrangement));
+            arrangements[i]->arrangement.type = kSpeakerArrStereo;
+            arrangements[i]->arrangement.numChannels = numInputs_;
+            arrangements[i]->arrangement.speakers[0].type = kSpeakerL;
+            arrangements[i]->arrangement.speakers[1].type = kSpeakerR;
+        }
         // Identifying.
         setUniqueID(uniqueId_);
         // Supporting 32bit processing.
         canProcessReplacing();
+        // Handing the program over as a versioned chunk, so that it
+        // survives the changes of the parameters and of their meaning.
+        programsAreChunks();
+
+        // Delay is truncated to whole samples until interpolation is set,
+        // taps keep the defaults of the unit until enabled.
+        unit_.SetInterpolationParam(defaultInterpolationParam_);
+        unit_.SetTapCountParam(defaultTapCountParam_);
+
+        // Setting all the programs of the bank to the default one.
+        for(int program = 0; program < numPrograms_; ++program)
+        {
+            unit_.GetSettings(programs_[program]);
+            vst_strncpy(programNames_[program], defaultProgramName_, kVstMaxProgNameLen);
+        }
 
-        // Setting default program name.
-        vst_strncpy(programName, defaultProgramName_, kVstMaxProgNameLen);
+#ifndef PINGPONGDELAY_NO_EDITOR
+        // Announcing GUI, the editor itself is created only once the host
+        // asks for it, so that scanning hosts never load its bitmaps.
+        cEffect.flags |= effFlagsHasEditor;
+#endif
 
-        // Setting GUI.
-        editor = new PingPongDelayEditor(this);
+#ifdef PINGPONGDELAY_TRIMMING
+        // Letting the pool trim the buffers of the idle unit.
+        PingPongDelayBufferPool::Register(&unit_);
+#endif
     }
 
     /**
@@ -194,6 +345,11 @@ namespace PingPongDelay
      */
     PingPongDelayEffect::~PingPongDelayEffect()
     {
+#ifdef PINGPONGDELAY_TRIMMING
+        // The pool must not trim the unit being destroyed.
+        PingPongDelayBufferPool::Unregister(&unit_);
+#endif
+        DeleteSurroundUnits();
     }
 
     /**
@@ -205,25 +361,215 @@ namespace PingPongDelay
      */
     void PingPongDelayEffect::processReplacing(float** inputs, float** outputs, VstInt32 sampleFrames)
     {
-        float* leftInputChannel  =  inputs[0];
-        float* rightInputChannel  =  inputs[1];
-        float* leftOutputChannel = outputs[0];
-        float* rightOutputChannel = outputs[1];
+#if defined(PINGPONGDELAY_AUDIT) && defined(__linux__)
+        // Nothing below may allocate, free or lock.
+        PingPongDelayAuditScope auditScope;
+#endif
 
-        while(--sampleFrames >= 0)
+#ifdef PINGPONGDELAY_PROFILING
+        profiler_.BeginBlock();
+#endif
+#if defined(PINGPONGDELAY_STATS) && defined(__unix__)
+        stats_.BeginBlock();
+#endif
+#ifdef PINGPONGDELAY_TRACING
+        tracer_.Record(ProcessBeginEvent, sampleFrames);
+#endif
+
+        switch(ringCount_)
         {
-            // Passing the current stereo sample to the ping pong delay unit.
-            StereoSample stereoSample = unit_.GetSample(StereoSample(*leftInputChannel, *rightInputChannel));
-            // Rewriting output channel stereo sample with the sample returned
-            // from ping pong delay unit.
-            *leftOutputChannel = stereoSample.first;
-            *rightOutputChannel = stereoSample.second;
+            case 4:
+                ProcessSurround(quadUnit_, inputs, outputs, sampleFrames);
+                break;
+
+            case 5:
+                ProcessSurround(surround51Unit_, inputs, outputs, sampleFrames);
+                break;
 
-            ++leftInputChannel;
-            ++rightInputChannel;
-            ++leftOutputChannel;
-            ++rightOutputChannel;
+            case 7:
+                ProcessSurround(surround71Unit_, inputs, outputs, sampleFrames);
+                break;
+
+            case 11:
+                ProcessSurround(surround714Unit_, inputs, outputs, sampleFrames);
+                break;
+
+            default:
+                // Refreshing the tempo and the position of the block, the unit ramps
+                // its synchronized delay between the tempos of the blocks.
+                unit_.SetTimeInfo(GetValidTimeInfo(kVstTempoValid | kVstPpqPosValid));
+
+                // Passing the whole block of both channels to the ping pong delay unit.
+                unit_.ProcessBlock(inputs[0], inputs[1], outputs[0], outputs[1], sampleFrames);
+                break;
         }
+
+#ifdef PINGPONGDELAY_PROFILING
+        profiler_.EndBlock(sampleFrames);
+#endif
+#if defined(PINGPONGDELAY_STATS) && defined(__unix__)
+        stats_.EndBlock(sampleFrames, sampleRate);
+#endif
+#ifdef PINGPONGDELAY_TRACING
+        tracer_.Record(ProcessEndEvent);
+#endif
+    }
+
+    /**
+     * Overriden AudioEffectX::dispatcher(VstInt32 opcode, VstInt32 index, VstIntPtr value, void* ptr, float opt) method.
+     * Creates the editor when the host asks for it for the first time.
+     * @param opcode an opcode of the request.
+     * @param index a request specific index.
+     * @param value a request specific value.
+     * @param ptr a request specific pointer.
+     * @param opt a request specific float value.
+     * @return request specific result.
+     */
+    VstIntPtr PingPongDelayEffect::dispatcher(VstInt32 opcode, VstInt32 index, VstIntPtr value, void* ptr, float opt)
+    {
+#ifndef PINGPONGDELAY_NO_EDITOR
+        if(!editor && (opcode == effEditGetRect || opcode == effEditOpen))
+        {
+            // Setting GUI.
+            editor = new PingPongDelayEditor(this);
+        }
+#endif
+        return AudioEffectX::dispatcher(opcode, index, value, ptr, opt);
+    }
+
+    /**
+     * Overriden AudioEffectX::suspend() method.
+     * Called when the host turns the effect off.
+     */
+    void PingPongDelayEffect::suspend()
+    {
+#if defined(PINGPONGDELAY_STATS) && defined(__unix__)
+        stats_.SetSuspended(true);
+#endif
+#ifdef PINGPONGDELAY_TRACING
+        tracer_.Record(SuspendEvent);
+#endif
+    }
+
+    /**
+     * Overriden AudioEffectX::resume() method.
+     * Called when the host turns the effect on. Allocates the delay
+     * buffers the first time and once the economy changed, and resets
+     * the delay line. The surround speaker arrangements get their surround
+     * unit instead.
+     */
+    void PingPongDelayEffect::resume()
+    {
+        // Refreshing the sample rate and the tempo before the first block.
+        unit_.SetTimeInfo(GetValidTimeInfo(kVstTempoValid));
+
+        // Buffers are allocated by the first resume, so that instances
+        // which never process cost nothing, and replaced by the ones
+        // of the rate of a changed economy. Surround arrangements leave
+        // the stereo unit without them.
+        if(ringCount_ > 0)
+        {
+            ProvideSurroundUnit();
+        }
+        else if(unit_.AllocateBuffers())
+        {
+#if defined(PINGPONGDELAY_STATS) && defined(__unix__)
+            stats_.SetBufferBytes(unit_.GetBufferMemory());
+#endif
+#ifdef PINGPONGDELAY_TRACING
+            tracer_.Record(BufferAllocationEvent, 0, (float)unit_.GetBufferMemory());
+#endif
+        }
+        // Starting with the silent delay line, which costs nothing
+        // regardless of the buffer size.
+        unit_.ResetBuffers();
+
+#if defined(PINGPONGDELAY_STATS) && defined(__unix__)
+        stats_.SetSuspended(false);
+#endif
+#ifdef PINGPONGDELAY_TRACING
+        tracer_.Record(ResumeEvent);
+#endif
+    }
+
+    /**
+     * Overriden AudioEffectX::setSpeakerArrangement(VstSpeakerArrangement* pluginInput, VstSpeakerArrangement* pluginOutput) method.
+     * Accepts any stereo arrangement, processed by the stereo unit, and
+     * the quad, 5.1, 7.1 and 7.1.4 ones, whose rings of speakers are
+     * processed by a surround unit created by the next resume, while
+     * the LFE channel passes through. The host calls it while the effect
+     * is suspended.
+     * @param pluginInput an arrangement of the input speakers.
+     * @param pluginOutput an arrangement of the output speakers, must
+     *      hold the same speakers in the same order as the input one.
+     * @return true if the arrangements were accepted, false otherwise.
+     */
+    bool PingPongDelayEffect::setSpeakerArrangement(VstSpeakerArrangement* pluginInput,
+                                                    VstSpeakerArrangement* pluginOutput)
+    {
+        if(!pluginInput || !pluginOutput || pluginInput->numChannels != pluginOutput->numChannels)
+        {
+            return false;
+        }
+        int speakerCount = pluginInput->numChannels;
+        for(int channel = 0; channel < speakerCount; ++channel)
+        {
+            if(pluginInput->speakers[channel].type != pluginOutput->speakers[channel].type)
+            {
+                return false;
+            }
+        }
+
+        int ringCount = 0;
+        int ringChannels[maxRingCount_];
+        int lfeChannel = -1;
+        if(speakerCount != numInputs_)
+        {
+            int layout = 0;
+            while(layout < speakerLayoutCount_ && speakerLayouts_[layout].speakerCount != speakerCount)
+            {
+                ++layout;
+            }
+            if(layout == speakerLayoutCount_ || !FindRing(speakerLayouts_[layout], pluginInput, ringChannels, lfeChannel))
+            {
+                return false;
+            }
+            ringCount = speakerLayouts_[layout].ringCount;
+        }
+
+        // Surround unit of another ring is no longer needed, the one
+        // of the new ring is created by the next resume.
+        if(ringCount != ringCount_)
+        {
+            LockPrograms();
+            DeleteSurroundUnits();
+            UnlockPrograms();
+        }
+        ringCount_ = ringCount;
+        memcpy(ringChannels_, ringChannels, ringCount * sizeof(int));
+        lfeChannel_ = lfeChannel;
+
+        setNumInputs(speakerCount);
+        setNumOutputs(speakerCount);
+        size_t arrangementBytes = offsetof(VstSpeakerArrangement, speakers) + speakerCount * sizeof(VstSpeakerProperties);
+        memcpy(&inputArrangement_, pluginInput, arrangementBytes);
+        memcpy(&outputArrangement_, pluginOutput, arrangementBytes);
+        return true;
+    }
+
+    /**
+     * Overriden AudioEffectX::getSpeakerArrangement(VstSpeakerArrangement** pluginInput, VstSpeakerArrangement** pluginOutput) method.
+     * Gets the arrangements accepted the last, stereo until any is.
+     * @param pluginInput where to store the arrangement of the input speakers.
+     * @param pluginOutput where to store the arrangement of the output speakers.
+     * @return true, beacause the method is supported.
+     */
+    bool PingPongDelayEffect::getSpeakerArrangement(VstSpeakerArrangement** pluginInput,
+                                                    VstSpeakerArrangement** pluginOutput)
+    {
+        *pluginInput = &inputArrangement_.arrangement;
+        *pluginOutput = &outputArrangement_.arrangement;
+        return true;
     }
 
     /**
@@ -233,7 +579,7 @@ namespace PingPongDelay
      */
     void PingPongDelayEffect::setProgramName(char* name)
     {
-        vst_strncpy(programName, name, kVstMaxProgNameLen);
+        vst_strncpy(programNames_[curProgram], name, kVstMaxProgNameLen);
     }
 
     /**
@@ -243,7 +589,117 @@ namespace PingPongDelay
      */
     void PingPongDelayEffect::getProgramName(char* name)
     {
-        vst_strncpy(name, programName, kVstMaxProgNameLen);
+        vst_strncpy(name, programNames_[curProgram], kVstMaxProgNameLen);
+    }
+
+    /**
+     * Overriden AudioEffectX::setProgram(VstInt32 program) method.
+     * Switches to a program of the bank. Its settings are published
+     * to the audio thread at once, which crossfades to them.
+     * @param program an index of the program.
+     */
+    void PingPongDelayEffect::setProgram(VstInt32 program)
+    {
+        if(program < 0 || program >= numPrograms_)
+        {
+            return;
+        }
+
+        LockPrograms();
+        curProgram = program;
+        PublishSettings(programs_[curProgram]);
+        UnlockPrograms();
+        UpdateEditor(programs_[curProgram]);
+    }
+
+    /**
+     * Overriden AudioEffectX::getProgramNameIndexed(VstInt32 category, VstInt32 index, char* text) method.
+     * Gets the name of a program of the bank.
+     * @param category a category of the program, ignored.
+     * @param index an index of the program.
+     * @param text where to store the name of the program.
+     * @return true if there is such a program, false otherwise.
+     */
+    bool PingPongDelayEffect::getProgramNameIndexed(VstInt32 category, VstInt32 index, char* text)
+    {
+        (void)category;
+        if(index < 0 || index >= numPrograms_)
+        {
+            return false;
+        }
+        vst_strncpy(text, programNames_[index], kVstMaxProgNameLen);
+        return true;
+    }
+
+    /**
+     * Overriden AudioEffectX::getChunk(void** data, bool isPreset) method.
+     * Stores the current program or the whole bank into versioned chunks,
+     * see PingPongDelayChunk.h.
+     * @param data where to store the pointer to the chunk, valid until
+     *      the next call.
+     * @param isPreset true for a single program, false for the bank.
+     * @return size of the chunk in bytes.
+     */
+    VstInt32 PingPongDelayEffect::getChunk(void** data, bool isPreset)
+    {
+        LockPrograms();
+        int firstProgram = isPreset ? curProgram : 0;
+        int programCount = isPreset ? 1 : numPrograms_;
+        int bytes = 0;
+        for(int program = firstProgram; program < firstProgram + programCount; ++program)
+        {
+            bytes += WriteChunk(programs_[program], programNames_[program], chunk_ + bytes);
+        }
+        UnlockPrograms();
+        *data = chunk_;
+        return bytes;
+    }
+
+    /**
+     * Overriden AudioEffectX::setChunk(void* data, VstInt32 byteSize, bool isPreset) method.
+     * Restores the current program or the whole bank from chunks stored
+     * by getChunk of this or any other version of the effect.
+     * @param data the chunk.
+     * @param byteSize size of the chunk in bytes.
+     * @param isPreset true for a single program, false for the bank.
+     * @return 1 if the chunk was restored, 0 otherwise.
+     */
+    VstInt32 PingPongDelayEffect::setChunk(void* data, VstInt32 byteSize, bool isPreset)
+    {
+        // Parameters missing in the chunks keep the current values.
+        LockPrograms();
+        const unsigned char* chunk = (const unsigned char*)data;
+        int firstProgram = isPreset ? curProgram : 0;
+        int programCount = isPreset ? 1 : numPrograms_;
+        int program = firstProgram;
+        for(; program < firstProgram + programCount; ++program)
+        {
+            bool derived;
+            int bytes = ReadChunk(chunk, byteSize, programs_[program], programNames_[program], derived);
+            if(bytes == 0)
+            {
+                break;
+            }
+
+            // Derived values of the same version are taken as they are,
+            // otherwise they are derived again.
+            if(!derived || !PingPongDelayUnit::IsValidSettings(programs_[program]))
+            {
+                PingPongDelayUnit::DeriveSettings(programs_[program]);
+            }
+            chunk += bytes;
+            byteSize -= bytes;
+        }
+        if(program == firstProgram)
+        {
+            UnlockPrograms();
+            return 0;
+        }
+
+        PublishSettings(programs_[curProgram]);
+        UnlockPrograms();
+        UpdateEditor(programs_[curProgram]);
+        return 1;
     }
 
     /**
@@ -254,33 +710,51 @@ namespace PingPongDelay
      */
     void PingPongDelayEffect::setParameter(VstInt32 index, float value)
     {
+#ifdef PINGPONGDELAY_TRACING
+        tracer_.Record(ParameterEvent, index, value);
+        bool wasAsync = programs_[curProgram].isAsync;
+#endif
+
         switch (index)
         {
-            case DelayParam:
-                unit_.SetDelayParam(value);
-                break;
-
-            case FeedbackParam:
-                unit_.SetFeedbackParam(value);
+            case FreezeParam:
+                unit_.SetFreezeParam(value);
                 break;
 
-            case PanoramaParam:
-                unit_.SetPanoramaParam(value);
+            case EconomyParam:
+                unit_.SetEconomyParam(value);
                 break;
 
-            case WetParam:
-                unit_.SetWetParam(value);
+            default:
+                // Parameters of the program reach the audio thread only
+                // as the whole program with the values derived, so that
+                // the settings of the unit are set by the audio thread alone.
+                if(index >= 0 && index < chunkParamCount)
+                {
+                    LockPrograms();
+                    float* params[chunkParamCount];
+                    ListChunkParams(programs_[curProgram], params);
+                    *params[index] = value;
+                    PingPongDelayUnit::DeriveSettings(programs_[curProgram]);
+                    PublishSettings(programs_[curProgram]);
+                    UnlockPrograms();
+                }
                 break;
+        }
 
-            case SyncParam:
-                unit_.SetSyncParam(value);
-                break;
+#ifdef PINGPONGDELAY_TRACING
+        if(programs_[curProgram].isAsync != wasAsync)
+        {
+            tracer_.Record(ModeSwitchEvent, SyncParam, programs_[curProgram].isAsync ? 0.0f : 1.0f);
         }
+#endif
 
+#ifndef PINGPONGDELAY_NO_EDITOR
         if(editor)
         {
             ((AEffGUIEditor*)editor)->setParameter(index, value);
         }
+#endif
     }
 
     /**
@@ -294,24 +768,23 @@ namespace PingPongDelay
         float parameter = 0;
         switch (index)
         {
-            case DelayParam:
-                parameter = unit_.GetDelayParam();
-                break;
-
-            case FeedbackParam:
-                parameter = unit_.GetFeedbackParam();
-                break;
-
-            case PanoramaParam:
-                parameter = unit_.GetPanoramaParam();
+            case FreezeParam:
+                parameter = unit_.GetFreezeParam();
                 break;
 
-            case WetParam:
-                parameter = unit_.GetWetParam();
+            case EconomyParam:
+                parameter = unit_.GetEconomyParam();
                 break;
 
-            case SyncParam:
-                parameter = unit_.GetSyncParam();
+            default:
+                // The current program holds the parameters set last, even
+                // before the audio thread takes them over.
+                if(index >= 0 && index < chunkParamCount)
+                {
+                    float* params[chunkParamCount];
+                    ListChunkParams(programs_[curProgram], params);
+                    parameter = *params[index];
+                }
                 break;
         }
         return parameter;
@@ -346,6 +819,32 @@ namespace PingPongDelay
             case SyncParam :
                 vst_strncpy(text, syncParamName_, kVstMaxLabelLen);
                 break;
+
+            case InterpolationParam :
+                vst_strncpy(text, interpolationParamName_, kVstMaxLabelLen);
+                break;
+
+            case TapCountParam :
+                vst_strncpy(text, tapCountParamName_, kVstMaxLabelLen);
+                break;
+
+            case FreezeParam :
+                vst_strncpy(text, freezeParamName_, kVstMaxLabelLen);
+                break;
+
+            case EconomyParam :
+                vst_strncpy(text, economyParamName_, kVstMaxLabelLen);
+                break;
+
+            default :
+                if(index >= FirstTapParam && index < FreezeParam)
+                {
+                    // Taps are numbered from one for the user.
+                    int tap = (index - FirstTapParam) / TapParamCount;
+                    const char* names[TapParamCount] = {tapTimeParamName_, tapGainParamName_, tapPanoramaParamName_};
+                    snprintf(text, kVstMaxLabelLen, names[(index - FirstTapParam) % TapParamCount], tap + 1);
+                }
+                break;
         }
     }
 
@@ -385,6 +884,29 @@ namespace PingPongDelay
             case SyncParam :
                 vst_strncpy(label, stateLabel_, kVstMaxLabelLen);
                 break;
+
+            case InterpolationParam :
+                vst_strncpy(label, modeLabel_, kVstMaxLabelLen);
+                break;
+
+            case TapCountParam :
+                vst_strncpy(label, countLabel_, kVstMaxLabelLen);
+                break;
+
+            case FreezeParam :
+                vst_strncpy(label, stateLabel_, kVstMaxLabelLen);
+                break;
+
+            case EconomyParam :
+                vst_strncpy(label, restartLabel_, kVstMaxLabelLen);
+                break;
+
+            default :
+                if(index >= FirstTapParam && index < FreezeParam)
+                {
+                    vst_strncpy(label, ratioLabel_, kVstMaxLabelLen);
+                }
+                break;
         }
     }
 
@@ -431,9 +953,60 @@ namespace PingPongDelay
                     vst_strncpy(text, onLabel_, kVstMaxParamStrLen);
                 }
                 break;
+
+            case InterpolationParam :
+                vst_strncpy(text, unit_.GetInterpolationName(), kVstMaxParamStrLen);
+                break;
+
+            case TapCountParam :
+                int2string(unit_.GetTapCount(), text, kVstMaxParamStrLen);
+                break;
+
+            case FreezeParam :
+                if(unit_.IsFrozen())
+                {
+                    vst_strncpy(text, onLabel_, kVstMaxParamStrLen);
+                }
+                else
+                {
+                    vst_strncpy(text, offLabel_, kVstMaxParamStrLen);
+                }
+                break;
+
+            case EconomyParam :
+                vst_strncpy(text, unit_.GetEconomyName(), kVstMaxParamStrLen);
+                break;
+
+            default :
+                if(index >= FirstTapParam && index < FreezeParam)
+                {
+                    // Time is displayed as the ratio of the delay.
+                    int tap = (index - FirstTapParam) / TapParamCount;
+                    if((index - FirstTapParam) % TapParamCount == TapTimeParam)
+                    {
+                        float2string(unit_.GetTapTimeRatio(tap), text, kVstMaxParamStrLen);
+                    }
+                    else
+                    {
+                        float2string(getParameter(index), text, kVstMaxParamStrLen);
+                    }
+                }
+                break;
         }
     }
 
+    /**
+     * Overriden AudioEffectX::canParameterBeAutomated(VstInt32 index) method.
+     * Tells whether a Ping Pong Delay parameter can be automated. The economy
+     * can not, it takes effect only once the host resumes the effect.
+     * @param index an index of parameter to tell.
+     * @return false for the economy, true otherwise.
+     */
+    bool PingPongDelayEffect::canParameterBeAutomated(VstInt32 index)
+    {
+        return index != EconomyParam;
+    }
+
     /**
      * Overriden AudioEffectX::getEffectName(char* name) method.
      * Gets the name of the Ping Pong Delay.
@@ -490,4 +1063,291 @@ namespace PingPongDelay
     {
         return kPlugCategRoomFx;
     }
+
+    /**
+     * Overriden AudioEffectX::vendorSpecific(VstInt32 lArg, VstIntPtr lArg2, void* ptrArg, float floatArg) method.
+     * Provides the Ping Pong Delay specific requests of the host.
+     * While profiling is compiled in, lArg equal to getProfileRequest_
+     * fills the PingPongDelayProfile pointed by ptrArg.
+     * @param lArg a request identifier.
+     * @param lArg2 a request specific value.
+     * @param ptrArg a request specific pointer.
+     * @param floatArg a request specific float value.
+     * @return 1 if the request was handled, 0 otherwise.
+     */
+    VstIntPtr PingPongDelayEffect::vendorSpecific(VstInt32 lArg, VstIntPtr lArg2, void* ptrArg, float floatArg)
+    {
+#ifdef PINGPONGDELAY_PROFILING
+        if(lArg == getProfileRequest_ && ptrArg)
+        {
+            profiler_.GetProfile(*(PingPongDelayProfile*)ptrArg);
+            return 1;
+        }
+#endif
+        return AudioEffectX::vendorSpecific(lArg, lArg2, ptrArg, floatArg);
+    }
+
+    /**
+     * Gets the latest levels metered by the unit. May be called from
+     * any thread, it never blocks the processing.
+     * @param levels where to store the levels.
+     */
+    void PingPongDelayEffect::GetLevels(PingPongDelayLevels& levels)
+    {
+        unit_.GetLevels(levels);
+    }
+
+    /**
+     * Locks the programs against the other threads changing them or
+     * publishing them to the unit. They are held only while a program
+     * is copied, so spinning costs less than any blocking lock would.
+     */
+    void PingPongDelayEffect::LockPrograms()
+    {
+        bool locked = false;
+        while(!programsLocked_.compare_exchange_weak(locked, true, std::memory_order_acquire))
+        {
+            locked = false;
+        }
+    }
+
+    /**
+     * Unlocks the programs locked by LockPrograms.
+     */
+    void PingPongDelayEffect::UnlockPrograms()
+    {
+        programsLocked_.store(false, std::memory_order_release);
+    }
+
+    /**
+     * Sets the parameters of settings to the editor, if it is open.
+     * @param settings the settings.
+     */
+    void PingPongDelayEffect::UpdateEditor(PingPongDelaySettings& settings)
+    {
+#ifndef PINGPONGDELAY_NO_EDITOR
+        if(!editor)
+        {
+            return;
+        }
+
+        float* params[chunkParamCount];
+        ListChunkParams(settings, params);
+        for(VstInt32 index = 0; index < numParams_ && index < chunkParamCount; ++index)
+        {
+            ((AEffGUIEditor*)editor)->setParameter(index, *params[index]);
+        }
+#else
+        (void)settings;
+#endif
+    }
+
+    /**
+     * Gets the time info of the host, unless the host gives none
+     * or one without a valid tempo. Then it gets the time info holding
+     * the last valid tempo and the current sample rate instead.
+     * @param filter flags of the requested time info.
+     * @return time info with valid tempo information.
+     */
+    VstTimeInfo* PingPongDelayEffect::GetValidTimeInfo(VstInt32 filter)
+    {
+        VstTimeInfo* timeInfo = getTimeInfo(filter);
+        if(timeInfo && (timeInfo->flags & kVstTempoValid) && timeInfo->tempo > 0.0 && timeInfo->sampleRate > 0.0)
+        {
+            // Remembering the tempo, should the host stop giving it.
+            fallbackTimeInfo_.tempo = timeInfo->tempo;
+            return timeInfo;
+        }
+
+        // Holding the last tempo, the delay does not ramp, as neither
+        // the position nor the transport are known.
+        fallbackTimeInfo_.sampleRate = sampleRate;
+        fallbackTimeInfo_.flags = kVstTempoValid;
+        if(fallbackTimeInfo_.tempo <= 0.0)
+        {
+            fallbackTimeInfo_.tempo = defaultTempo_;
+        }
+        return &fallbackTimeInfo_;
+    }
+
+    /**
+     * Publishes the settings to the stereo unit and to the surround
+     * one, if there is any. Must be called with the programs locked.
+     * @param settings the settings.
+     */
+    void PingPongDelayEffect::PublishSettings(const PingPongDelaySettings& settings)
+    {
+        unit_.PublishSettings(settings);
+        if(surroundSettings_)
+        {
+            surroundSettings_->PublishSettings(settings);
+        }
+    }
+
+    /**
+     * Creates the surround unit of the ring of the accepted speaker
+     * arrangement, unless it exists, and resets its delay line.
+     */
+    void PingPongDelayEffect::ProvideSurroundUnit()
+    {
+        switch(ringCount_)
+        {
+            case 4:
+                ProvideSurroundUnit(quadUnit_);
+                break;
+
+            case 5:
+                ProvideSurroundUnit(surround51Unit_);
+                break;
+
+            case 7:
+                ProvideSurroundUnit(surround71Unit_);
+                break;
+
+            case 11:
+                ProvideSurroundUnit(surround714Unit_);
+                break;
+        }
+    }
+
+    /**
+     * Creates the surround unit of a ring, unless it exists, and resets
+     * its delay line.
+     * @param surroundUnit the surround unit of the ring, NULL if none.
+     */
+    template<int ringCount>
+    void PingPongDelayEffect::ProvideSurroundUnit(PingPongDelaySurroundUnit<ringCount>*& surroundUnit)
+    {
+        if(!surroundUnit)
+        {
+            // Each speaker covers the delays the stereo unit covers.
+            int bufferSize = ringCount * ((defaultUnitBufferSize_ - 3) / 2) + 1;
+            PingPongDelaySurroundUnit<ringCount>* createdUnit = new PingPongDelaySurroundUnit<ringCount>(
+                bufferSize, GetValidTimeInfo(kVstTempoValid), defaultDelayParam_, defaultFeedbackParam_,
+                defaultPanoramaParam_, defaultWetParam_, defaultSyncParam_);
+            createdUnit->AllocateBuffers();
+
+            // Starting with the current program, the later ones are published.
+            LockPrograms();
+            createdUnit->GetUnit().SetSettings(programs_[curProgram]);
+            surroundUnit = createdUnit;
+            surroundSettings_ = &createdUnit->GetUnit();
+            UnlockPrograms();
+        }
+        surroundUnit->GetUnit().SetTimeInfo(GetValidTimeInfo(kVstTempoValid));
+        surroundUnit->ResetBuffers();
+    }
+
+    /**
+     * Deletes the surround units. Must be called with the programs locked.
+     */
+    void PingPongDelayEffect::DeleteSurroundUnits()
+    {
+        surroundSettings_ = NULL;
+        delete quadUnit_;
+        quadUnit_ = NULL;
+        delete surround51Unit_;
+        surround51Unit_ = NULL;
+        delete surround71Unit_;
+        surround71Unit_ = NULL;
+        delete surround714Unit_;
+        surround714Unit_ = NULL;
+    }
+
+    /**
+     * Processes the block of the surround speaker arrangement, the ring
+     * by a surround unit and the LFE channel passing through.
+     * @param surroundUnit the surround unit of the ring.
+     * @param inputs arrays of samples for each input channel.
+     * @param outputs arrays of samples for each output channel.
+     * @param sampleFrames number of samples for each channel.
+     */
+    template<int ringCount>
+    void PingPongDelayEffect::ProcessSurround(PingPongDelaySurroundUnit<ringCount>* surroundUnit, float** inputs,
+                                              float** outputs, VstInt32 sampleFrames)
+    {
+        // Refreshing the tempo of the block, the delay of the ring
+        // does not ramp.
+        surroundUnit->GetUnit().SetTimeInfo(GetValidTimeInfo(kVstTempoValid | kVstPpqPosValid));
+
+        const float* ringInputs[ringCount];
+        float* ringOutputs[ringCount];
+        for(int speaker = 0; speaker < ringCount; ++speaker)
+        {
+            ringInputs[speaker] = inputs[ringChannels_[speaker]];
+            ringOutputs[speaker] = outputs[ringChannels_[speaker]];
+        }
+        surroundUnit->ProcessBlock(ringInputs, ringOutputs, sampleFrames);
+
+        if(lfeChannel_ >= 0 && outputs[lfeChannel_] != inputs[lfeChannel_])
+        {
+            memcpy(outputs[lfeChannel_], inputs[lfeChannel_], sampleFrames * sizeof(float));
+        }
+    }
+
+    /**
+     * Finds the channels of the speakers of a layout in an arrangement.
+     * @param layout the layout.
+     * @param arrangement the arrangement of as many speakers as the layout.
+     * @param ringChannels where to store the channels of the speakers
+     *      of the ring.
+     * @param lfeChannel where to store the channel of the LFE speaker,
+     *      -1 if the layout has none.
+     * @return true if the arrangement holds just the speakers
+     *      of the layout, false otherwise.
+     */
+    bool PingPongDelayEffect::FindRing(const SpeakerLayout& layout, const VstSpeakerArrangement* arrangement,
+                                       int* ringChannels, int& lfeChannel)
+    {
+        lfeChannel = -1;
+        for(int speaker = 0; speaker < layout.ringCount; ++speaker)
+        {
+            ringChannels[speaker] = -1;
+        }
+
+        // Speakers past the eight of VstSpeakerArrangement follow them
+        // in the memory of the host.
+        for(int channel = 0; channel < arrangement->numChannels; ++channel)
+        {
+            VstInt32 type = arrangement->speakers[channel].type;
+            int speaker = 0;
+            while(speaker < layout.ringCount && layout.ringSpeakers[speaker] != type)
+            {
+                ++speaker;
+            }
+            if(speaker < layout.ringCount && ringChannels[speaker] < 0)
+            {
+                ringChannels[speaker] = channel;
+            }
+            else if(type == kSpeakerLfe && lfeChannel < 0 && layout.speakerCount > layout.ringCount)
+            {
+                lfeChannel = channel;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        for(int speaker = 0; speaker < layout.ringCount; ++speaker)
+        {
+            if(ringChannels[speaker] < 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+#ifdef PINGPONGDELAY_PROFILING
+    /**
+     * Gets the profiler measuring the processing cost of the effect.
+     * It may be read from any thread.
+     * @return profiler of the effect.
+     */
+    const PingPongDelayProfiler& PingPongDelayEffect::GetProfiler()
+    {
+        return profiler_;
+    }
+#endif
 }
@@ -16,8 +16,15 @@
  */
 
 
+#include <atomic>
 #include "public.sdk/source/vst2.x/audioeffectx.h"
 #include "PingPongDelayUnit.h"
+#include "PingPongDelaySurround.h"
+#include "PingPongDelayChunk.h"
+#include "PingPongDelayProfiler.h"
+#include "PingPongDelayStats.h"
+#include "PingPongDelayTracer.h"
+#include "PingPongDelayAudit.h"
 
 #ifndef PINGPONGDELAYEFFECT_H
 #define PINGPONGDELAYEFFECT_H
@@ -35,8 +42,34 @@ namespace PingPongDelay
         PanoramaParam,
         WetParam,
         SyncParam,
+        InterpolationParam,
+        TapCountParam,
+        FirstTapParam,
     };
 
+    /**
+     * An enum for parameters of each tap reference. Parameter of a tap
+     * is placed at FirstTapParam + tap * TapParamCount + its tap parameter.
+     */
+    enum PingPongDelayTapParameter
+    {
+        TapTimeParam,
+        TapGainParam,
+        TapPanoramaParam,
+        TapParamCount,
+    };
+
+    /**
+     * Index of the freeze parameter. It follows the parameters of all
+     * the taps, so that the parameters kept by the programs do not move.
+     */
+    const int FreezeParam = FirstTapParam + maxTapCount * TapParamCount;
+
+    /**
+     * Index of the economy parameter, following the freeze parameter.
+     */
+    const int EconomyParam = FreezeParam + 1;
+
     /**
      * Class deriving vst.sdk2.4 AudioEffectX class providing
      * ping pong delay VST.
@@ -64,6 +97,54 @@ namespace PingPongDelay
          */
         void processReplacing(float** inputs, float** outputs, VstInt32 sampleFrames);
 
+        /**
+         * Overriden AudioEffectX::dispatcher(VstInt32 opcode, VstInt32 index, VstIntPtr value, void* ptr, float opt) method.
+         * Creates the editor when the host asks for it for the first time.
+         * @param opcode an opcode of the request.
+         * @param index a request specific index.
+         * @param value a request specific value.
+         * @param ptr a request specific pointer.
+         * @param opt a request specific float value.
+         * @return request specific result.
+         */
+        VstIntPtr dispatcher(VstInt32 opcode, VstInt32 index, VstIntPtr value, void* ptr, float opt);
+
+        /**
+         * Overriden AudioEffectX::suspend() method.
+         * Called when the host turns the effect off.
+         */
+        void suspend();
+
+        /**
+         * Overriden AudioEffectX::resume() method.
+         * Called when the host turns the effect on. Allocates the delay
+         * buffers the first time and resets the delay line.
+         */
+        void resume();
+
+        /**
+         * Overriden AudioEffectX::setSpeakerArrangement(VstSpeakerArrangement* pluginInput, VstSpeakerArrangement* pluginOutput) method.
+         * Accepts any stereo arrangement, processed by the stereo unit, and
+         * the quad, 5.1, 7.1 and 7.1.4 ones, whose rings of speakers are
+         * processed by a surround unit created by the next resume, while
+         * the LFE channel passes through. The host calls it while the effect
+         * is suspended.
+         * @param pluginInput an arrangement of the input speakers.
+         * @param pluginOutput an arrangement of the output speakers, must
+         *      hold the same speakers in the same order as the input one.
+         * @return true if the arrangements were accepted, false otherwise.
+         */
+        bool setSpeakerArrangement(VstSpeakerArrangement* pluginInput, VstSpeakerArrangement* pluginOutput);
+
+        /**
+         * Overriden AudioEffectX::getSpeakerArrangement(VstSpeakerArrangement** pluginInput, VstSpeakerArrangement** pluginOutput) method.
+         * Gets the arrangements accepted the last, stereo until any is.
+         * @param pluginInput where to store the arrangement of the input speakers.
+         * @param pluginOutput where to store the arrangement of the output speakers.
+         * @return true, beacause the method is supported.
+         */
+        bool getSpeakerArrangement(VstSpeakerArrangement** pluginInput, VstSpeakerArrangement** pluginOutput);
+
         /**
          * Overriden AudioEffectX::setProgramName(char* name) method
          * Sets the program name.
@@ -78,6 +159,46 @@ namespace PingPongDelay
          */
         void getProgramName(char* name);
 
+        /**
+         * Overriden AudioEffectX::setProgram(VstInt32 program) method.
+         * Switches to a program of the bank. Its settings are published
+         * to the audio thread at once, which crossfades to them.
+         * @param program an index of the program.
+         */
+        void setProgram(VstInt32 program);
+
+        /**
+         * Overriden AudioEffectX::getProgramNameIndexed(VstInt32 category, VstInt32 index, char* text) method.
+         * Gets the name of a program of the bank.
+         * @param category a category of the program, ignored.
+         * @param index an index of the program.
+         * @param text where to store the name of the program.
+         * @return true if there is such a program, false otherwise.
+         */
+        bool getProgramNameIndexed(VstInt32 category, VstInt32 index, char* text);
+
+        /**
+         * Overriden AudioEffectX::getChunk(void** data, bool isPreset) method.
+         * Stores the current program or the whole bank into versioned chunks,
+         * see PingPongDelayChunk.h.
+         * @param data where to store the pointer to the chunk, valid until
+         *      the next call.
+         * @param isPreset true for a single program, false for the bank.
+         * @return size of the chunk in bytes.
+         */
+        VstInt32 getChunk(void** data, bool isPreset = false);
+
+        /**
+         * Overriden AudioEffectX::setChunk(void* data, VstInt32 byteSize, bool isPreset) method.
+         * Restores the current program or the whole bank from chunks stored
+         * by getChunk of this or any other version of the effect.
+         * @param data the chunk.
+         * @param byteSize size of the chunk in bytes.
+         * @param isPreset true for a single program, false for the bank.
+         * @return 1 if the chunk was restored, 0 otherwise.
+         */
+        VstInt32 setChunk(void* data, VstInt32 byteSize, bool isPreset = false);
+
         /**
          * Overriden AudioEffectX::setParameter(VstInt32 index, float value) method.
          * Sets the value of a Ping Pong Delay parameter.
@@ -118,6 +239,15 @@ namespace PingPongDelay
          */
         void getParameterDisplay(VstInt32 index, char* text);
 
+        /**
+         * Overriden AudioEffectX::canParameterBeAutomated(VstInt32 index) method.
+         * Tells whether a Ping Pong Delay parameter can be automated. The economy
+         * can not, it takes effect only once the host resumes the effect.
+         * @param index an index of parameter to tell.
+         * @return false for the economy, true otherwise.
+         */
+        bool canParameterBeAutomated(VstInt32 index);
+
         /**
          * Overriden AudioEffectX::getEffectName(char* name) method.
          * Gets the name of the Ping Pong Delay.
@@ -157,17 +287,287 @@ namespace PingPongDelay
          */
         VstPlugCategory getPlugCategory();
 
+        /**
+         * Overriden AudioEffectX::vendorSpecific(VstInt32 lArg, VstIntPtr lArg2, void* ptrArg, float floatArg) method.
+         * Provides the Ping Pong Delay specific requests of the host.
+         * While profiling is compiled in, lArg equal to getProfileRequest_
+         * fills the PingPongDelayProfile pointed by ptrArg.
+         * @param lArg a request identifier.
+         * @param lArg2 a request specific value.
+         * @param ptrArg a request specific pointer.
+         * @param floatArg a request specific float value.
+         * @return 1 if the request was handled, 0 otherwise.
+         */
+        VstIntPtr vendorSpecific(VstInt32 lArg, VstIntPtr lArg2, void* ptrArg, float floatArg);
+
+        /**
+         * Gets the latest levels metered by the unit. May be called from
+         * any thread, it never blocks the processing.
+         * @param levels where to store the levels.
+         */
+        void GetLevels(PingPongDelayLevels& levels);
+
+#ifdef PINGPONGDELAY_PROFILING
+        /**
+         * Gets the profiler measuring the processing cost of the effect.
+         * It may be read from any thread.
+         * @return profiler of the effect.
+         */
+        const PingPongDelayProfiler& GetProfiler();
+#endif
+
     private:
         /**
-         * String for the current program name.
+         * Locks the programs against the other threads changing them or
+         * publishing them to the unit. They are held only while a program
+         * is copied, so spinning costs less than any blocking lock would.
+         */
+        void LockPrograms();
+
+        /**
+         * Unlocks the programs locked by LockPrograms.
+         */
+        void UnlockPrograms();
+
+        /**
+         * Sets the parameters of settings to the editor, if it is open.
+         * @param settings the settings.
+         */
+        void UpdateEditor(PingPongDelaySettings& settings);
+
+        /**
+         * Gets the time info of the host, unless the host gives none
+         * or one without a valid tempo. Then it gets the time info holding
+         * the last valid tempo and the current sample rate instead.
+         * @param filter flags of the requested time info.
+         * @return time info with valid tempo information.
+         */
+        VstTimeInfo* GetValidTimeInfo(VstInt32 filter);
+
+        /**
+         * Publishes the settings to the stereo unit and to the surround
+         * one, if there is any. Must be called with the programs locked.
+         * @param settings the settings.
+         */
+        void PublishSettings(const PingPongDelaySettings& settings);
+
+        /**
+         * Creates the surround unit of the ring of the accepted speaker
+         * arrangement, unless it exists, and resets its delay line.
+         */
+        void ProvideSurroundUnit();
+
+        /**
+         * Creates the surround unit of a ring, unless it exists, and resets
+         * its delay line.
+         * @param surroundUnit the surround unit of the ring, NULL if none.
+         */
+        template<int ringCount>
+        void ProvideSurroundUnit(PingPongDelaySurroundUnit<ringCount>*& surroundUnit);
+
+        /**
+         * Deletes the surround units. Must be called with the programs locked.
+         */
+        void DeleteSurroundUnits();
+
+        /**
+         * Processes the block of the surround speaker arrangement, the ring
+         * by a surround unit and the LFE channel passing through.
+         * @param surroundUnit the surround unit of the ring.
+         * @param inputs arrays of samples for each input channel.
+         * @param outputs arrays of samples for each output channel.
+         * @param sampleFrames number of samples for each channel.
+         */
+        template<int ringCount>
+        void ProcessSurround(PingPongDelaySurroundUnit<ringCount>* surroundUnit, float** inputs, float** outputs,
+                             VstInt32 sampleFrames);
+
+
+        /**
+         * Maximal number of speakers of the accepted arrangements.
+         */
+        static const int maxSpeakerCount_ = 12;
+
+        /**
+         * Maximal number of speakers of a ring processed by a surround unit.
+         */
+        static const int maxRingCount_ = 11;
+
+        /**
+         * Number of the surround speaker layouts.
+         */
+        static const int speakerLayoutCount_ = 4;
+
+        /**
+         * Surround speaker layout, the speakers of its ring listed clockwise
+         * from the front left one.
+         */
+        struct SpeakerLayout
+        {
+            /**
+             * Number of the speakers, the LFE one included.
+             */
+            int speakerCount;
+
+            /**
+             * Number of the speakers of the ring.
+             */
+            int ringCount;
+
+            /**
+             * Types of the speakers of the ring.
+             */
+            VstInt32 ringSpeakers[maxRingCount_];
+        };
+
+        /**
+         * Speaker arrangement of the host, with room for the speakers
+         * past the eight held by VstSpeakerArrangement itself.
+         */
+        struct SpeakerArrangement
+        {
+            /**
+             * The arrangement with its first speakers.
+             */
+            VstSpeakerArrangement arrangement;
+
+            /**
+             * The speakers following the first ones.
+             */
+            VstSpeakerProperties moreSpeakers[maxSpeakerCount_ - 8];
+        };
+
+        /**
+         * Finds the channels of the speakers of a layout in an arrangement.
+         * @param layout the layout.
+         * @param arrangement the arrangement of as many speakers as the layout.
+         * @param ringChannels where to store the channels of the speakers
+         *      of the ring.
+         * @param lfeChannel where to store the channel of the LFE speaker,
+         *      -1 if the layout has none.
+         * @return true if the arrangement holds just the speakers
+         *      of the layout, false otherwise.
+         */
+        static bool FindRing(const SpeakerLayout& layout, const VstSpeakerArrangement* arrangement, int* ringChannels,
+                             int& lfeChannel);
+
+
+        /**
+         * Number of programs of plugin.
+         */
+        static const VstInt32 numPrograms_ = 16;
+
+        /**
+         * Settings of the programs of the bank, the values derived from
+         * the parameters included, so that switching the programs derives
+         * nothing.
+         */
+        PingPongDelaySettings programs_[numPrograms_];
+
+        /**
+         * Names of the programs of the bank.
+         */
+        char programNames_[numPrograms_][kVstMaxProgNameLen + 1];
+
+        /**
+         * Chunk handed over to the host by getChunk.
+         */
+        unsigned char chunk_[numPrograms_ * chunkBytes];
+
+        /**
+         * Tells whether a thread holds the lock of the programs.
+         */
+        std::atomic<bool> programsLocked_;
+
+        /**
+         * Time info of the unit while the host gives none, it must be
+         * initialized before the unit.
          */
-        char programName[kVstMaxProgNameLen];
+        VstTimeInfo fallbackTimeInfo_;
 
         /**
          * Ping pong delay processing unit.
          */
         PingPongDelayUnit unit_;
 
+        /**
+         * Arrangement of the input speakers accepted the last.
+         */
+        SpeakerArrangement inputArrangement_;
+
+        /**
+         * Arrangement of the output speakers accepted the last.
+         */
+        SpeakerArrangement outputArrangement_;
+
+        /**
+         * Number of the speakers of the ring of the accepted arrangement,
+         * zero for stereo.
+         */
+        int ringCount_;
+
+        /**
+         * Channels of the speakers of the ring.
+         */
+        int ringChannels_[maxRingCount_];
+
+        /**
+         * Channel of the LFE speaker passing through, -1 if there is none.
+         */
+        int lfeChannel_;
+
+        /**
+         * Surround unit of the quad ring, NULL until created by resume.
+         */
+        PingPongDelaySurroundUnit<4>* quadUnit_;
+
+        /**
+         * Surround unit of the 5.1 ring, NULL until created by resume.
+         */
+        PingPongDelaySurroundUnit<5>* surround51Unit_;
+
+        /**
+         * Surround unit of the 7.1 ring, NULL until created by resume.
+         */
+        PingPongDelaySurroundUnit<7>* surround71Unit_;
+
+        /**
+         * Surround unit of the 7.1.4 ring, NULL until created by resume.
+         */
+        PingPongDelaySurroundUnit<11>* surround714Unit_;
+
+        /**
+         * Unit holding the settings of the existing surround unit, NULL
+         * if there is none. Guarded by the lock of the programs.
+         */
+        PingPongDelayUnit* surroundSettings_;
+
+#ifdef PINGPONGDELAY_PROFILING
+        /**
+         * Profiler measuring the cost of processReplacing calls.
+         */
+        PingPongDelayProfiler profiler_;
+
+        /**
+         * Identifier of vendor specific request for the profile.
+         */
+        static const VstInt32 getProfileRequest_;
+#endif
+
+#if defined(PINGPONGDELAY_STATS) && defined(__unix__)
+        /**
+         * Publisher of the effect counters to the shared memory.
+         */
+        PingPongDelayStatsPublisher stats_;
+#endif
+
+#ifdef PINGPONGDELAY_TRACING
+        /**
+         * Tracer recording the processing timeline of the effect.
+         */
+        PingPongDelayTracer tracer_;
+#endif
+
 
         // Fields holding the inicial settings for ping pong delay
         // parameters.
@@ -201,13 +601,23 @@ namespace PingPongDelay
          */
         static const float defaultSyncParam_;
 
+        /**
+         * Initial interpolation parameter of the unit.
+         */
+        static const float defaultInterpolationParam_;
 
-        // Fields holding the basic PING PONG DELAY VST information.
         /**
-         * Number of programs of plugin.
+         * Initial tap count parameter of the unit.
          */
-        static const VstInt32 numPrograms_;
+        static const float defaultTapCountParam_;
 
+        /**
+         * Tempo of the unit until the host gives a valid one.
+         */
+        static const double defaultTempo_;
+
+
+        // Fields holding the basic PING PONG DELAY VST information.
         /**
          * Number of parameters of plugin.
          */
@@ -248,6 +658,11 @@ namespace PingPongDelay
          */
         static const char* vendorString_;
 
+        /**
+         * Surround speaker layouts accepted by setSpeakerArrangement.
+         */
+        static const SpeakerLayout speakerLayouts_[speakerLayoutCount_];
+
         /**
          * Version of the plugin.
          */
@@ -280,6 +695,41 @@ namespace PingPongDelay
          */
         static const char* syncParamName_;
 
+        /**
+         * Display string of the interpolation parameter.
+         */
+        static const char* interpolationParamName_;
+
+        /**
+         * Display string of the tap count parameter.
+         */
+        static const char* tapCountParamName_;
+
+        /**
+         * Format of the display strings of the tap time parameters.
+         */
+        static const char* tapTimeParamName_;
+
+        /**
+         * Format of the display strings of the tap gain parameters.
+         */
+        static const char* tapGainParamName_;
+
+        /**
+         * Format of the display strings of the tap panorama parameters.
+         */
+        static const char* tapPanoramaParamName_;
+
+        /**
+         * Display string of the freeze parameter.
+         */
+        static const char* freezeParamName_;
+
+        /**
+         * Display string of the economy parameter.
+         */
+        static const char* economyParamName_;
+
         /**
          * Display string of the millisecond unit.
          */
@@ -295,6 +745,21 @@ namespace PingPongDelay
          */
         static const char* stateLabel_;
 
+        /**
+         * Display string of the count unit.
+         */
+        static const char* countLabel_;
+
+        /**
+         * Display string of the mode unit.
+         */
+        static const char* modeLabel_;
+
+        /**
+         * Display string of the unit of the parameters applied on restart.
+         */
+        static const char* restartLabel_;
+
         /**
          * Display string of the off label.
          */
@@ -0,0 +1,87 @@
+/**
+ * PingPongDelayLevels.cpp:
+ *
+ * Implementation of PingPongDelayLevelsSnapshot class passing the levels
+ * lock-free from the audio thread to the editor.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayLevelsSnapshot
+ */
+
+
+#ifndef PINGPONGDELAYLEVELS_H
+#include "PingPongDelayLevels.h"
+#endif
+
+
+namespace PingPongDelay
+{
+    /**
+     * A constructor. The snapshot holds silence.
+     */
+    PingPongDelayLevelsSnapshot::PingPongDelayLevelsSnapshot()
+    {
+        sequence_.store(0, std::memory_order_relaxed);
+        for(int point = 0; point < meterPointCount; ++point)
+        {
+            for(int channel = 0; channel < meterChannelCount; ++channel)
+            {
+                peak_[point][channel].store(0.0f, std::memory_order_relaxed);
+                rms_[point][channel].store(0.0f, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Publishes new levels. Must be called from the audio thread only.
+     * @param levels levels to publish.
+     */
+    void PingPongDelayLevelsSnapshot::Publish(const PingPongDelayLevels& levels)
+    {
+        // Seqlock writing, the odd sequence makes readers retry.
+        unsigned int sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for(int point = 0; point < meterPointCount; ++point)
+        {
+            for(int channel = 0; channel < meterChannelCount; ++channel)
+            {
+                peak_[point][channel].store(levels.peak[point][channel], std::memory_order_relaxed);
+                rms_[point][channel].store(levels.rms[point][channel], std::memory_order_relaxed);
+            }
+        }
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * Reads the consistent copy of the latest levels. May be called
+     * from any thread, it retries while the levels are being written.
+     * @param levels where to store the copy.
+     */
+    void PingPongDelayLevelsSnapshot::Read(PingPongDelayLevels& levels) const
+    {
+        unsigned int sequence;
+        do
+        {
+            // Odd sequence means the writer is in the middle of writing.
+            sequence = sequence_.load(std::memory_order_acquire);
+            if(sequence & 1)
+            {
+                continue;
+            }
+            for(int point = 0; point < meterPointCount; ++point)
+            {
+                for(int channel = 0; channel < meterChannelCount; ++channel)
+                {
+                    levels.peak[point][channel] = peak_[point][channel].load(std::memory_order_relaxed);
+                    levels.rms[point][channel] = rms_[point][channel].load(std::memory_order_relaxed);
+                }
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        while((sequence & 1) || sequence != sequence_.load(std::memory_order_relaxed));
+    }
+}
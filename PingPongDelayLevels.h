@@ -0,0 +1,115 @@
+/**
+ * PingPongDelayLevels.h:
+ *
+ * Declaration of PingPongDelayMeterPoint enum for reference of points
+ * of the signal path being metered.
+ *
+ * Declaration of PingPongDelayLevels structure holding peak and RMS
+ * levels of the metered points.
+ *
+ * Declaration of PingPongDelayLevelsSnapshot class passing the levels
+ * lock-free from the audio thread to the editor.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayLevels
+ * @see PingPongDelayLevelsSnapshot
+ */
+
+
+#include <atomic>
+
+#ifndef PINGPONGDELAYLEVELS_H
+#define PINGPONGDELAYLEVELS_H
+
+
+namespace PingPongDelay
+{
+    /**
+     * An enum for reference of metered points of the signal path.
+     */
+    enum PingPongDelayMeterPoint
+    {
+        InputMeter,
+        DelayMeter,
+        OutputMeter,
+    };
+
+    /**
+     * Number of metered points.
+     */
+    const int meterPointCount = 3;
+
+    /**
+     * Number of metered channels of each point.
+     */
+    const int meterChannelCount = 2;
+
+
+    /**
+     * Peak and RMS levels of the metered points over one metering
+     * window. First index is PingPongDelayMeterPoint, second one is
+     * the channel, zero for the left and one for the right.
+     */
+    struct PingPongDelayLevels
+    {
+        /**
+         * Maximal absolute sample values.
+         */
+        float peak[meterPointCount][meterChannelCount];
+
+        /**
+         * Root mean square sample values.
+         */
+        float rms[meterPointCount][meterChannelCount];
+    };
+
+
+    /**
+     * Snapshot of the latest levels. It is written only by the audio
+     * thread and guarded by the sequence number working as a seqlock,
+     * so that the editor never blocks the audio thread.
+     */
+    class PingPongDelayLevelsSnapshot
+    {
+    public:
+        /**
+         * A constructor. The snapshot holds silence.
+         */
+        PingPongDelayLevelsSnapshot();
+
+        /**
+         * Publishes new levels. Must be called from the audio thread only.
+         * @param levels levels to publish.
+         */
+        void Publish(const PingPongDelayLevels& levels);
+
+        /**
+         * Reads the consistent copy of the latest levels. May be called
+         * from any thread, it retries while the levels are being written.
+         * @param levels where to store the copy.
+         */
+        void Read(PingPongDelayLevels& levels) const;
+
+    private:
+        /**
+         * Seqlock sequence number, odd while the levels are being written.
+         */
+        std::atomic<unsigned int> sequence_;
+
+        /**
+         * Published peak levels.
+         */
+        std::atomic<float> peak_[meterPointCount][meterChannelCount];
+
+        /**
+         * Published RMS levels.
+         */
+        std::atomic<float> rms_[meterPointCount][meterChannelCount];
+    };
+}
+
+
+#endif
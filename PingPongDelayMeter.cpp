@@ -0,0 +1,128 @@
+/**
+ * PingPongDelayMeter.cpp:
+ *
+ * Implementation of PingPongDelayMeter class deriving vstgui CView class,
+ * drawing the level of one metered channel of PingPongDelayEffect.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayMeter
+ */
+
+
+#include <math.h>
+
+#ifndef PINGPONGDELAYMETER_H
+#include "PingPongDelayMeter.h"
+#endif
+
+
+namespace PingPongDelay
+{
+    /**
+     * Level in decibels shown at the bottom of the meter.
+     */
+    const float PingPongDelayMeter::minDb_ = -60.0f;
+
+    /**
+     * Color of the meter background.
+     */
+    const CColor PingPongDelayMeter::backgroundColor_ = {32, 8, 24, 0};
+
+    /**
+     * Color of the RMS bar.
+     */
+    const CColor PingPongDelayMeter::rmsColor_ = {240, 120, 200, 0};
+
+    /**
+     * Color of the peak line.
+     */
+    const CColor PingPongDelayMeter::peakColor_ = {255, 255, 255, 0};
+
+
+    /**
+     * Overriden CView::CView(const CRect& size) constructor.
+     * @param size a size of the meter.
+     */
+    PingPongDelayMeter::PingPongDelayMeter(const CRect& size) :
+        CView(size),
+        peakHeight_(0),
+        rmsHeight_(0)
+    {
+    }
+
+    /**
+     * Overriden CView::draw(CDrawContext* context) method.
+     * Draws the meter.
+     * @param context a draw context to draw into.
+     */
+    void PingPongDelayMeter::draw(CDrawContext* context)
+    {
+        context->setFillColor(backgroundColor_);
+        context->fillRect(size);
+
+        // RMS bar grows from the bottom.
+        if(rmsHeight_ > 0)
+        {
+            CRect rmsRect(size.left, size.bottom - rmsHeight_, size.right, size.bottom);
+            context->setFillColor(rmsColor_);
+            context->fillRect(rmsRect);
+        }
+
+        // Peak is a one pixel line.
+        if(peakHeight_ > 0)
+        {
+            CRect peakRect(size.left, size.bottom - peakHeight_, size.right, size.bottom - peakHeight_ + 1);
+            context->setFillColor(peakColor_);
+            context->fillRect(peakRect);
+        }
+
+        setDirty(false);
+    }
+
+    /**
+     * Sets the levels to be shown. Marks the meter dirty only if its
+     * drawing changes.
+     * @param peak a peak level, absolute sample value.
+     * @param rms a RMS level, absolute sample value.
+     */
+    void PingPongDelayMeter::SetLevels(float peak, float rms)
+    {
+        int peakHeight = LevelHeight(peak);
+        int rmsHeight = LevelHeight(rms);
+        if(peakHeight != peakHeight_ || rmsHeight != rmsHeight_)
+        {
+            peakHeight_ = peakHeight;
+            rmsHeight_ = rmsHeight;
+            setDirty();
+        }
+    }
+
+    /**
+     * Calculates the height of the bar corresponding to a level.
+     * @param level a level, absolute sample value.
+     * @return height in pixels between [0, meter height].
+     */
+    int PingPongDelayMeter::LevelHeight(float level)
+    {
+        int height = size.bottom - size.top;
+        if(level <= 0.0f)
+        {
+            return 0;
+        }
+
+        // Decibels between [minDb_, 0] are spread evenly over the height.
+        float db = 20.0f * log10f(level);
+        if(db <= minDb_)
+        {
+            return 0;
+        }
+        if(db >= 0.0f)
+        {
+            return height;
+        }
+        return (int)(height * (1.0f - db / minDb_));
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * PingPongDelayMeter.h:
+ *
+ * Declaration of PingPongDelayMeter class deriving vstgui CView class,
+ * drawing the level of one metered channel of PingPongDelayEffect.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayMeter
+ * @see PingPongDelayLevels
+ */
+
+
+#include "vstgui.sf/vstgui/vstgui.h"
+
+#ifndef PINGPONGDELAYMETER_H
+#define PINGPONGDELAYMETER_H
+
+
+namespace PingPongDelay
+{
+    /**
+     * Class deriving vstgui CView class, drawing the level of one metered
+     * channel as a vertical bar. The bar shows the RMS level, the line
+     * above it shows the peak level, both in decibels.
+     */
+    class PingPongDelayMeter : public CView
+    {
+    public:
+        /**
+         * Overriden CView::CView(const CRect& size) constructor.
+         * @param size a size of the meter.
+         */
+        PingPongDelayMeter(const CRect& size);
+
+        /**
+         * Overriden CView::draw(CDrawContext* context) method.
+         * Draws the meter.
+         * @param context a draw context to draw into.
+         */
+        void draw(CDrawContext* context);
+
+        /**
+         * Sets the levels to be shown. Marks the meter dirty only if its
+         * drawing changes.
+         * @param peak a peak level, absolute sample value.
+         * @param rms a RMS level, absolute sample value.
+         */
+        void SetLevels(float peak, float rms);
+
+    private:
+        /**
+         * Calculates the height of the bar corresponding to a level.
+         * @param level a level, absolute sample value.
+         * @return height in pixels between [0, meter height].
+         */
+        int LevelHeight(float level);
+
+
+        /**
+         * Height of the peak line in pixels.
+         */
+        int peakHeight_;
+
+        /**
+         * Height of the RMS bar in pixels.
+         */
+        int rmsHeight_;
+
+
+        /**
+         * Level in decibels shown at the bottom of the meter.
+         */
+        static const float minDb_;
+
+        /**
+         * Color of the meter background.
+         */
+        static const CColor backgroundColor_;
+
+        /**
+         * Color of the RMS bar.
+         */
+        static const CColor rmsColor_;
+
+        /**
+         * Color of the peak line.
+         */
+        static const CColor peakColor_;
+    };
+}
+
+
+#endif
@@ -0,0 +1,180 @@
+/**
+ * PingPongDelayProfiler.cpp:
+ *
+ * Implementation of PingPongDelayProfiler class providing low overhead
+ * measurement of the block processing cost of PingPongDelayEffect.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayProfiler
+ */
+
+
+#ifdef PINGPONGDELAY_PROFILING
+
+#ifndef PINGPONGDELAYPROFILER_H
+#include "PingPongDelayProfiler.h"
+#endif
+
+
+namespace PingPongDelay
+{
+    /**
+     * A constructor.
+     */
+    PingPongDelayProfiler::PingPongDelayProfiler() :
+        blockStart_(0),
+        maxCostPerFrame_(0),
+        maxBlockCost_(0)
+    {
+        for(int i = 0; i < profileCostBucketCount; ++i)
+        {
+            costCounts_[i].store(0, std::memory_order_relaxed);
+        }
+        for(int i = 0; i < profileBlockSizeBucketCount; ++i)
+        {
+            blockSizeCounts_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Fills the snapshot of the measured costs. May be called from
+     * any thread.
+     * @param profile where to store the snapshot.
+     */
+    void PingPongDelayProfiler::GetProfile(PingPongDelayProfile& profile) const
+    {
+        // Copying the histogram first, the block count is then taken from
+        // the copy so that the percentiles are consistent with it.
+        unsigned long long costCounts[profileCostBucketCount];
+        unsigned long long blockCount = 0;
+        for(int i = 0; i < profileCostBucketCount; ++i)
+        {
+            costCounts[i] = costCounts_[i].load(std::memory_order_relaxed);
+            blockCount += costCounts[i];
+        }
+
+        profile.blockCount = blockCount;
+        profile.medianCostPerFrame = Percentile(costCounts, blockCount, 0.5);
+        profile.p99CostPerFrame = Percentile(costCounts, blockCount, 0.99);
+        profile.maxCostPerFrame = maxCostPerFrame_.load(std::memory_order_relaxed);
+        profile.maxBlockCost = maxBlockCost_.load(std::memory_order_relaxed);
+        for(int i = 0; i < profileBlockSizeBucketCount; ++i)
+        {
+            profile.blockSizeCounts[i] = blockSizeCounts_[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Accounts the cost of one block into the histograms.
+     * @param cost ticks spent processing the block.
+     * @param sampleFrames number of frames processed in the block.
+     */
+    void PingPongDelayProfiler::Account(unsigned long long cost, int sampleFrames)
+    {
+        // Empty blocks are accounted as one frame blocks, they cost
+        // the call overhead anyway.
+        unsigned long long costPerFrame = cost / (sampleFrames > 0 ? sampleFrames : 1);
+        Increment(costCounts_[CostBucket(costPerFrame)]);
+
+        // Bucket of the block size is the number of its significant bits.
+        int sizeBucket = 0;
+        for(unsigned int frames = (sampleFrames > 0 ? sampleFrames : 0); frames != 0; frames >>= 1)
+        {
+            ++sizeBucket;
+        }
+        if(sizeBucket >= profileBlockSizeBucketCount)
+        {
+            sizeBucket = profileBlockSizeBucketCount - 1;
+        }
+        Increment(blockSizeCounts_[sizeBucket]);
+
+        if(costPerFrame > maxCostPerFrame_.load(std::memory_order_relaxed))
+        {
+            maxCostPerFrame_.store(costPerFrame, std::memory_order_relaxed);
+        }
+        if(cost > maxBlockCost_.load(std::memory_order_relaxed))
+        {
+            maxBlockCost_.store(cost, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Calculates the cost histogram bucket of a cost per frame.
+     * @param costPerFrame a cost per frame.
+     * @return index of the bucket.
+     */
+    int PingPongDelayProfiler::CostBucket(unsigned long long costPerFrame)
+    {
+        // Costs lower than 4 have their own buckets.
+        if(costPerFrame < 4)
+        {
+            return (int)costPerFrame;
+        }
+
+        // Otherwise the bucket is given by the most significant bit
+        // and the two bits following it.
+        int msb = 0;
+        for(unsigned long long cost = costPerFrame; cost > 1; cost >>= 1)
+        {
+            ++msb;
+        }
+        int bucket = 4 * (msb - 1) + (int)((costPerFrame >> (msb - 2)) & 3);
+        return (bucket < profileCostBucketCount) ? bucket : (profileCostBucketCount - 1);
+    }
+
+    /**
+     * Calculates the lower bound of cost per frame of a bucket.
+     * @param bucket index of the bucket.
+     * @return the lowest cost per frame falling into the bucket.
+     */
+    unsigned long long PingPongDelayProfiler::CostBucketBound(int bucket)
+    {
+        if(bucket < 4)
+        {
+            return bucket;
+        }
+        int msb = (bucket / 4) + 1;
+        return (unsigned long long)(4 + (bucket % 4)) << (msb - 2);
+    }
+
+    /**
+     * Calculates the evenly corresponding percentile from the cost
+     * histogram.
+     * @param costCounts a copy of the cost histogram.
+     * @param blockCount a number of blocks in the histogram.
+     * @param ratio a percentile ratio between [0, 1].
+     * @return the lower bound of the bucket containing the percentile.
+     */
+    unsigned long long PingPongDelayProfiler::Percentile(const unsigned long long* costCounts,
+                                                         unsigned long long blockCount, double ratio)
+    {
+        if(blockCount == 0)
+        {
+            return 0;
+        }
+
+        // Rank of the block standing for the percentile, counted from one.
+        unsigned long long rank = (unsigned long long)(ratio * blockCount);
+        if(rank < ratio * blockCount || rank == 0)
+        {
+            ++rank;
+        }
+
+        unsigned long long cumulated = 0;
+        for(int i = 0; i < profileCostBucketCount; ++i)
+        {
+            cumulated += costCounts[i];
+            if(cumulated >= rank)
+            {
+                return CostBucketBound(i);
+            }
+        }
+        return CostBucketBound(profileCostBucketCount - 1);
+    }
+}
+
+
+#endif
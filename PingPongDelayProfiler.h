@@ -0,0 +1,232 @@
+/**
+ * PingPongDelayProfiler.h:
+ *
+ * Declaration of PingPongDelayProfile structure holding the snapshot
+ * of measured processing cost.
+ *
+ * Declaration of PingPongDelayProfiler class providing low overhead
+ * measurement of the block processing cost of PingPongDelayEffect.
+ *
+ * Whole profiler is compiled only when PINGPONGDELAY_PROFILING is
+ * defined, otherwise this header declares nothing.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayProfiler
+ * @see PingPongDelayProfile
+ */
+
+
+#ifdef PINGPONGDELAY_PROFILING
+
+#include <atomic>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+#ifndef PINGPONGDELAYPROFILER_H
+#define PINGPONGDELAYPROFILER_H
+
+
+namespace PingPongDelay
+{
+    /**
+     * Number of buckets of the histogram of processing cost per frame.
+     * Each power of two is split into 4 buckets, so that the histogram
+     * covers [0, 2^25) ticks per frame with precision of about 19%,
+     * higher costs fall into the last bucket.
+     */
+    const int profileCostBucketCount = 96;
+
+    /**
+     * Number of buckets of the histogram of block sizes. Bucket i counts
+     * blocks of [2^(i-1), 2^i) frames, the last one also all bigger blocks.
+     */
+    const int profileBlockSizeBucketCount = 16;
+
+
+    /**
+     * Snapshot of the measured processing cost filled by
+     * PingPongDelayProfiler::GetProfile(PingPongDelayProfile& profile).
+     * All the costs are in ticks of the profiler clock per one frame,
+     * which are CPU cycles where the rdtsc instruction is available
+     * and nanoseconds otherwise.
+     *
+     * @see PingPongDelayProfiler
+     */
+    struct PingPongDelayProfile
+    {
+        /**
+         * Number of measured blocks.
+         */
+        unsigned long long blockCount;
+
+        /**
+         * Median of block cost per frame.
+         */
+        unsigned long long medianCostPerFrame;
+
+        /**
+         * 99th percentile of block cost per frame.
+         */
+        unsigned long long p99CostPerFrame;
+
+        /**
+         * Maximal block cost per frame.
+         */
+        unsigned long long maxCostPerFrame;
+
+        /**
+         * Maximal cost of a whole block.
+         */
+        unsigned long long maxBlockCost;
+
+        /**
+         * Distribution of block sizes.
+         *
+         * @see profileBlockSizeBucketCount
+         */
+        unsigned long long blockSizeCounts[profileBlockSizeBucketCount];
+    };
+
+
+    /**
+     * Profiler measuring the cost of each processed block. Measurements
+     * are written only by the audio thread through BeginBlock() and
+     * EndBlock(int sampleFrames) and may be read at any time from any other
+     * thread through GetProfile(PingPongDelayProfile& profile), nothing
+     * of that ever locks.
+     */
+    class PingPongDelayProfiler
+    {
+    public:
+        /**
+         * A constructor.
+         */
+        PingPongDelayProfiler();
+
+        /**
+         * Marks the beginning of a measured block. Must be called
+         * from the audio thread only.
+         */
+        inline void BeginBlock()
+        {
+            blockStart_ = Ticks();
+        }
+
+        /**
+         * Marks the end of a measured block and accounts its cost.
+         * Must be called from the audio thread only.
+         * @param sampleFrames number of frames processed in the block.
+         */
+        inline void EndBlock(int sampleFrames)
+        {
+            Account(Ticks() - blockStart_, sampleFrames);
+        }
+
+        /**
+         * Fills the snapshot of the measured costs. May be called from
+         * any thread.
+         * @param profile where to store the snapshot.
+         */
+        void GetProfile(PingPongDelayProfile& profile) const;
+
+        /**
+         * Reads the profiler clock.
+         * @return ticks of the profiler clock.
+         */
+        static inline unsigned long long Ticks()
+        {
+#if defined(_MSC_VER) || defined(__i386__) || defined(__x86_64__)
+            return __rdtsc();
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+    private:
+        /**
+         * Accounts the cost of one block into the histograms.
+         * @param cost ticks spent processing the block.
+         * @param sampleFrames number of frames processed in the block.
+         */
+        void Account(unsigned long long cost, int sampleFrames);
+
+        /**
+         * Increments the counter owned by the audio thread. As far as there
+         * is just one writer, there is no need for a locked read-modify-write.
+         * @param counter a counter to increment.
+         */
+        static inline void Increment(std::atomic<unsigned long long>& counter)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        /**
+         * Calculates the cost histogram bucket of a cost per frame.
+         * @param costPerFrame a cost per frame.
+         * @return index of the bucket.
+         */
+        static int CostBucket(unsigned long long costPerFrame);
+
+        /**
+         * Calculates the lower bound of cost per frame of a bucket.
+         * @param bucket index of the bucket.
+         * @return the lowest cost per frame falling into the bucket.
+         */
+        static unsigned long long CostBucketBound(int bucket);
+
+        /**
+         * Calculates the evenly corresponding percentile from the cost
+         * histogram.
+         * @param costCounts a copy of the cost histogram.
+         * @param blockCount a number of blocks in the histogram.
+         * @param ratio a percentile ratio between [0, 1].
+         * @return the lower bound of the bucket containing the percentile.
+         */
+        static unsigned long long Percentile(const unsigned long long* costCounts,
+                                             unsigned long long blockCount, double ratio);
+
+
+        /**
+         * Profiler clock at the beginning of currently measured block.
+         */
+        unsigned long long blockStart_;
+
+        /**
+         * Maximal block cost per frame.
+         */
+        std::atomic<unsigned long long> maxCostPerFrame_;
+
+        /**
+         * Maximal cost of a whole block.
+         */
+        std::atomic<unsigned long long> maxBlockCost_;
+
+        /**
+         * Histogram of block costs per frame.
+         *
+         * @see profileCostBucketCount
+         */
+        std::atomic<unsigned long long> costCounts_[profileCostBucketCount];
+
+        /**
+         * Histogram of block sizes.
+         *
+         * @see profileBlockSizeBucketCount
+         */
+        std::atomic<unsigned long long> blockSizeCounts_[profileBlockSizeBucketCount];
+    };
+}
+
+
+#endif
+#endif
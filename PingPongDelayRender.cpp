@@ -0,0 +1,1709 @@
+/**
+ * PingPongDelayRender.cpp:
+ *
+ * Command line tool rendering WAV and RF64 files through PingPongDelayUnit
+ * offline, without a host.
+ *
+ * Usage: PingPongDelayRender [options] input.wav output.wav
+ *        PingPongDelayRender [options] -o directory [-j workers] [-L list] input.wav ...
+ *        PingPongDelayRender [options] -S sweep -o directory [-j workers] [-L list] input.wav ...
+ *      -d delay a delay parameter between [0, 1], 0.8 by default.
+ *      -f feedback a feedback parameter between [0, 1], 0.25 by default.
+ *      -p panorama a panorama parameter between [0, 1], 0 by default.
+ *      -w wet a wet parameter between [0, 1], 0.25 by default.
+ *      -s sync a synchronization parameter between [0, 1], 0 by default.
+ *      -t tempo a tempo the delay is synchronized to in BPM, 120 by default.
+ *      -T taps a tap count parameter between [0, 1], 0 by default.
+ *      -P tap,time,gain,panorama the parameters of the tap numbered from 1,
+ *          each between [0, 1]. By default the taps are spread evenly up
+ *          to the echo fed back, their gains and panoramas are 0.5.
+ *      -i interpolation an interpolation parameter between [0, 1],
+ *          0 by default.
+ *      -z freeze a freeze parameter between [0, 1], 0 by default.
+ *      -e economy an economy parameter between [0, 1], 0 by default.
+ *      -l seconds a length of the tail rendered after the input, 0 by default.
+ *      -F format an output sample format, one of pcm16, pcm24, pcm32,
+ *          float32 and float64, the input one by default.
+ *      -b frames a number of frames processed at once, 65536 by default.
+ *      -o directory a directory to render the input files into in batch
+ *          mode, each output file is named after its input file.
+ *      -j workers a number of files rendered at once in batch mode,
+ *          the number of cores by default.
+ *      -L list a file listing paths of additional input files in batch
+ *          mode, one per line.
+ *      -c runs the feedback loops of the two channels on two threads.
+ *      -S sweep a file listing variants of the parameters in sweep mode,
+ *          one per line as delay, feedback, panorama, wet and sync,
+ *          the other parameters are the ones of the options.
+ *      -C cache a checkpoint cache of a single file render.
+ *      -I seconds an interval between the checkpoints, 60 by default,
+ *          rounded up to whole blocks.
+ *      -R seconds resumes the render cached by -C, with the parameters
+ *          changed from the given time on.
+ *      -A automation a CSV file of automation points, each line holds
+ *          the time in seconds, the name of the parameter (delay, feedback,
+ *          panorama, wet, sync, tempo, taps, interpolation, freeze,
+ *          economy, or tapNtime, tapNgain and tapNpan of the tap N)
+ *          and its value.
+ *
+ * Files are streamed in blocks, reading ahead and writing behind on
+ * background threads, so that the memory stays bounded whatever the length
+ * of the file. Mono input is rendered as stereo.
+ *
+ * In batch mode each worker thread renders files by its own unit, taking
+ * them from a work stealing queue from the largest one.
+ *
+ * The feedback loops of the left and the right delay line never read each
+ * other, they meet only in the output mix. With -c each block runs the loop
+ * of the right channel on a helper thread while the loop of the left one
+ * runs on the rendering thread, then the output is mixed from both delay
+ * lines. It speeds up rendering of a single long file on spare cores.
+ * The channels read the delay line only at whole samples and always write
+ * it at the full rate, so the blocks with interpolation, in the economy
+ * or with the delay line frozen or thawing run both of them
+ * on the rendering thread.
+ *
+ * In sweep mode each input file is decoded once and each block is rendered
+ * through the units of all the variants, split among the worker threads,
+ * before the next block is decoded. Output of a variant is named after
+ * the input followed by the line number of the variant.
+ *
+ * With -C the state of the unit is saved into the checkpoint cache at
+ * intervals of the render. A render with -R changes the parameters from
+ * the given time on, resuming from the last checkpoint before it.
+ * The output rendered before the checkpoint is kept as it is. Checkpoints
+ * are skipped while the state of the delay line is not everything
+ * the output depends on, with the allpass interpolation, while the delay
+ * ramps from the previous tempo, while the delay line is frozen
+ * or thawing or in the economy.
+ *
+ * Changes of the economy replace the buffers of the unit by the ones
+ * of the new rate, which clears the echoes as resuming the effect does.
+ *
+ * Automation points set a parameter from their frame on. Blocks are split
+ * at the points, so that they take place at their exact frames while
+ * the unit still processes whole pieces of the blocks at once.
+ *
+ * Quad, 5.1, 7.1 and 7.1.4 files are rendered through the surround unit,
+ * the echoes circle the ring of their speakers while the LFE channel is
+ * passed through untouched. The surround unit ignores the taps,
+ * the interpolation, the freeze and the economy. Checkpoints, channel
+ * threads and sweeps support only mono and stereo files.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayUnit
+ * @see PingPongDelaySurroundUnit
+ * @see PingPongDelayWavReader
+ * @see PingPongDelayWavWriter
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PingPongDelayUnit.h"
+#include "PingPongDelayWav.h"
+#include "PingPongDelayCheckpoint.h"
+#include "PingPongDelaySurround.h"
+#include "PingPongDelayRenderQueue.h"
+
+
+using namespace PingPongDelay;
+
+
+/**
+ * Point of the automation setting a parameter from its time on.
+ */
+struct RenderAutomationPoint
+{
+    /**
+     * Time of the point in seconds.
+     */
+    double seconds;
+
+    /**
+     * Index of the parameter in automationParamNames.
+     */
+    int param;
+
+    /**
+     * Value of the parameter, between [0, 1] or the tempo in BPM.
+     */
+    float value;
+};
+
+
+/**
+ * Settings of a render, parameters of the unit are the same as
+ * the ones of the effect.
+ */
+struct RenderSettings
+{
+    float delayParam;
+    float feedbackParam;
+    float panoramaParam;
+    float wetParam;
+    float syncParam;
+    float tempo;
+    float tapCountParam;
+    float tapTimeParams[maxTapCount];
+    float tapGainParams[maxTapCount];
+    float tapPanoramaParams[maxTapCount];
+    float interpolationParam;
+    float freezeParam;
+    float economyParam;
+    double tailSeconds;
+    int blockFrames;
+
+    /**
+     * True if the output is written in the sample format of the input.
+     */
+    bool keepSampleFormat;
+
+    /**
+     * Sample format of the output, unless keepSampleFormat is true.
+     */
+    PingPongDelaySampleFormat sampleFormat;
+
+    /**
+     * True if the feedback loops of the channels run on two threads.
+     */
+    bool channelParallel;
+
+    /**
+     * Path of the checkpoint cache, NULL if none.
+     */
+    const char* cachePath;
+
+    /**
+     * Interval between the checkpoints in seconds.
+     */
+    double checkpointSeconds;
+
+    /**
+     * Time from which the parameters change when resuming the render
+     * from the cache in seconds, negative if the render starts anew.
+     */
+    double resumeSeconds;
+
+    /**
+     * Automation points in the order of their time.
+     */
+    std::vector<RenderAutomationPoint> automation;
+};
+
+
+/**
+ * Helper thread running the feedback loop of the right channel of
+ * the blocks, while the rendering thread runs the left one.
+ */
+class ChannelWorker
+{
+public:
+    /**
+     * A constructor. Starts the thread.
+     * @param unit a unit whose right channel the thread runs.
+     */
+    ChannelWorker(PingPongDelayUnit& unit) :
+        unit_(unit),
+        input_(NULL),
+        sampleFrames_(0),
+        pending_(false),
+        stopping_(false)
+    {
+        thread_ = std::thread(&ChannelWorker::Run, this);
+    }
+
+    /**
+     * A destructor. Stops the thread.
+     */
+    ~ChannelWorker()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        condition_.notify_all();
+        thread_.join();
+    }
+
+    /**
+     * Starts running the right channel of a block.
+     * @param input an array of right channel samples of the block.
+     * @param sampleFrames number of samples of the block.
+     */
+    void Start(const float* input, int sampleFrames)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            input_ = input;
+            sampleFrames_ = sampleFrames;
+            pending_ = true;
+        }
+        condition_.notify_all();
+    }
+
+    /**
+     * Waits until the right channel of the started block is run.
+     */
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this] { return !pending_; });
+    }
+
+private:
+    /**
+     * Body of the thread.
+     */
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for(;;)
+        {
+            condition_.wait(lock, [this] { return pending_ || stopping_; });
+            if(!pending_)
+            {
+                return;
+            }
+
+            // The block is not touched by the rendering thread until
+            // the wait for it returns.
+            lock.unlock();
+            unit_.ProcessChannel(1, input_, sampleFrames_);
+            lock.lock();
+            pending_ = false;
+            condition_.notify_all();
+        }
+    }
+
+    PingPongDelayUnit& unit_;
+    const float* input_;
+    int sampleFrames_;
+    bool pending_;
+    bool stopping_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::thread thread_;
+};
+
+
+/**
+ * One variant of a sweep, rendered by its own unit into its own file.
+ */
+struct SweepVariant
+{
+    /**
+     * Unit rendering the variant.
+     */
+    PingPongDelayUnit* unit;
+
+    /**
+     * Writer of the output file of the variant.
+     */
+    PingPongDelayWavWriter writer;
+
+    /**
+     * Path of the output file.
+     */
+    std::string outputPath;
+
+    /**
+     * Rendered left channel samples of the block.
+     */
+    float* left;
+
+    /**
+     * Rendered right channel samples of the block.
+     */
+    float* right;
+
+    /**
+     * True once the variant failed, it is not rendered any more.
+     */
+    bool failed;
+};
+
+
+/**
+ * Speaker layout of surround WAV files, the order of its speakers
+ * in the ring the echoes circle.
+ */
+struct SurroundLayout
+{
+    /**
+     * Number of channels of the file.
+     */
+    int channelCount;
+
+    /**
+     * Channels of the file in the order of the ring.
+     */
+    int ring[11];
+
+    /**
+     * Channel of the LFE passed through untouched, negative if none.
+     */
+    int lfeChannel;
+};
+
+
+/**
+ * Names of the sample formats, indexed by PingPongDelaySampleFormat.
+ */
+const char* sampleFormatNames[] = {"pcm16", "pcm24", "pcm32", "float32", "float64"};
+
+/**
+ * Names of the automated parameters besides the ones of the taps, in the order
+ * of the fields of PingPongDelayCheckpointParams.
+ */
+const char* automationParamNames[] = {"delay", "feedback", "panorama", "wet", "sync", "tempo", "taps", "interpolation",
+                                      "freeze", "economy"};
+
+/**
+ * Index of the tempo in automationParamNames.
+ */
+const int automationTempoParam = 5;
+
+/**
+ * Index of the first parameter of the taps, following automationParamNames.
+ * Parameters of each kind of automationTapParamNames follow for all the taps.
+ */
+const int automationTapParam = (int)(sizeof(automationParamNames) / sizeof(automationParamNames[0]));
+
+/**
+ * Names of the kinds of the parameters of a tap, following "tap" and
+ * the number of the tap from 1, such as "tap2gain".
+ */
+const char* automationTapParamNames[] = {"time", "gain", "pan"};
+
+/**
+ * Speaker layouts of the surround files in the WAV channel order. The rings
+ * go clockwise from the front left speaker, 7.1.4 ring continues from
+ * the bed to the height speakers.
+ */
+const SurroundLayout surroundLayouts[] =
+{
+    // Quad: FL FR BL BR.
+    {4, {0, 1, 3, 2}, -1},
+    // 5.1: FL FR FC LFE BL BR.
+    {6, {0, 2, 1, 5, 4}, 3},
+    // 7.1: FL FR FC LFE BL BR SL SR.
+    {8, {0, 2, 1, 7, 5, 4, 6}, 3},
+    // 7.1.4: FL FR FC LFE BL BR SL SR TFL TFR TBL TBR.
+    {12, {0, 2, 1, 7, 5, 4, 6, 8, 9, 11, 10}, 3},
+};
+
+
+/**
+ * Reads the monotonic clock.
+ * @return monotonic time in seconds.
+ */
+double Now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Parses a parameter of the unit.
+ * @param text a text of the option.
+ * @param param where to store the parameter.
+ * @return true if the text holds a value between [0, 1], false otherwise.
+ */
+bool ParseParam(const char* text, float& param)
+{
+    char* end;
+    double value = strtod(text, &end);
+    if(end == text || *end || value < 0.0 || value > 1.0)
+    {
+        return false;
+    }
+    param = (float)value;
+    return true;
+}
+
+/**
+ * Parses the parameters of a tap, its number from 1 followed by its time,
+ * gain and panorama parameters separated by commas.
+ * @param text a text of the option.
+ * @param settings settings of the render to store the parameters into.
+ * @return true if the text holds a valid tap, false otherwise.
+ */
+bool ParseTap(const char* text, RenderSettings& settings)
+{
+    int tap;
+    float params[3];
+    int length = 0;
+    if(sscanf(text, "%d,%f,%f,%f%n", &tap, &params[0], &params[1], &params[2], &length) != 4 || text[length] ||
+       tap < 1 || tap > maxTapCount)
+    {
+        return false;
+    }
+    for(int i = 0; i < 3; ++i)
+    {
+        if(params[i] < 0.0f || params[i] > 1.0f)
+        {
+            return false;
+        }
+    }
+    settings.tapTimeParams[tap - 1] = params[0];
+    settings.tapGainParams[tap - 1] = params[1];
+    settings.tapPanoramaParams[tap - 1] = params[2];
+    return true;
+}
+
+/**
+ * Parses a sample format.
+ * @param text a name of the format.
+ * @param sampleFormat where to store the format.
+ * @return true if the name is known, false otherwise.
+ */
+bool ParseSampleFormat(const char* text, PingPongDelaySampleFormat& sampleFormat)
+{
+    for(int i = 0; i < (int)(sizeof(sampleFormatNames) / sizeof(sampleFormatNames[0])); ++i)
+    {
+        if(strcmp(text, sampleFormatNames[i]) == 0)
+        {
+            sampleFormat = (PingPongDelaySampleFormat)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Reads a stereo block of the input, followed by the tail of silence.
+ * Mono input is duplicated to both channels.
+ * @param reader a reader of the input.
+ * @param left where to store the left channel samples.
+ * @param right where to store the right channel samples.
+ * @param blockFrames number of frames to read.
+ * @param tailFrames number of frames of the tail not read yet, decreased
+ *      by the read tail frames.
+ * @return number of read frames, zero at the end of the tail.
+ */
+int ReadBlock(PingPongDelayWavReader& reader, float* left, float* right, int blockFrames,
+              unsigned long long& tailFrames)
+{
+    float* channels[2] = {left, right};
+    int frames = reader.Read(channels, blockFrames);
+    if(frames < blockFrames)
+    {
+        // Tail of silence follows the input.
+        int silentFrames = (int)std::min((unsigned long long)(blockFrames - frames), tailFrames);
+        memset(left + frames, 0, silentFrames * sizeof(float));
+        memset(right + frames, 0, silentFrames * sizeof(float));
+        tailFrames -= silentFrames;
+        if(reader.GetFormat().channelCount == 1)
+        {
+            memcpy(right, left, frames * sizeof(float));
+        }
+        frames += silentFrames;
+    }
+    else if(reader.GetFormat().channelCount == 1)
+    {
+        memcpy(right, left, frames * sizeof(float));
+    }
+    return frames;
+}
+
+/**
+ * Finds the automated parameter of a name.
+ * @param name a name of the parameter.
+ * @return index of the parameter as taken by AutomatedParam, negative
+ *      if the name is not known.
+ */
+int FindAutomationParam(const char* name)
+{
+    for(int i = 0; i < automationTapParam; ++i)
+    {
+        if(strcmp(name, automationParamNames[i]) == 0)
+        {
+            return i;
+        }
+    }
+
+    int tap;
+    char kind[8];
+    int length = 0;
+    if(sscanf(name, "tap%d%7[a-z]%n", &tap, kind, &length) != 2 || name[length] || tap < 1 || tap > maxTapCount)
+    {
+        return -1;
+    }
+    for(int i = 0; i < (int)(sizeof(automationTapParamNames) / sizeof(automationTapParamNames[0])); ++i)
+    {
+        if(strcmp(kind, automationTapParamNames[i]) == 0)
+        {
+            return automationTapParam + i * maxTapCount + tap - 1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Gets the field of an automated parameter.
+ * @param params the parameters of the unit.
+ * @param param an index of the parameter returned by FindAutomationParam.
+ * @return the field holding the parameter.
+ */
+float* AutomatedParam(PingPongDelayCheckpointParams& params, int param)
+{
+    float* fields[] = {&params.delayParam, &params.feedbackParam, &params.panoramaParam,
+                       &params.wetParam, &params.syncParam, &params.tempo, &params.tapCountParam,
+                       &params.interpolationParam, &params.freezeParam, &params.economyParam};
+    if(param < automationTapParam)
+    {
+        return fields[param];
+    }
+    float* tapFields[] = {params.tapTimeParams, params.tapGainParams, params.tapPanoramaParams};
+    param -= automationTapParam;
+    return tapFields[param / maxTapCount] + param % maxTapCount;
+}
+
+/**
+ * Gathers the parameters of the unit a render starts with.
+ * @param settings settings of the render.
+ * @return the parameters.
+ */
+PingPongDelayCheckpointParams StartParams(const RenderSettings& settings)
+{
+    PingPongDelayCheckpointParams params;
+    params.delayParam = settings.delayParam;
+    params.feedbackParam = settings.feedbackParam;
+    params.panoramaParam = settings.panoramaParam;
+    params.wetParam = settings.wetParam;
+    params.syncParam = settings.syncParam;
+    params.tempo = settings.tempo;
+    params.tapCountParam = settings.tapCountParam;
+    memcpy(params.tapTimeParams, settings.tapTimeParams, sizeof(params.tapTimeParams));
+    memcpy(params.tapGainParams, settings.tapGainParams, sizeof(params.tapGainParams));
+    memcpy(params.tapPanoramaParams, settings.tapPanoramaParams, sizeof(params.tapPanoramaParams));
+    params.interpolationParam = settings.interpolationParam;
+    params.freezeParam = settings.freezeParam;
+    params.economyParam = settings.economyParam;
+    return params;
+}
+
+/**
+ * Reads the automation points, each line holds the time in seconds,
+ * the name of the parameter and its value separated by commas. Empty
+ * lines and lines starting with # are skipped.
+ * @param automationPath a path of the automation file.
+ * @param automation where to store the points in the order of their time.
+ * @return true on success, false if the file cannot be read or a line is
+ *      not valid, the error is printed to the standard error.
+ */
+bool ReadAutomation(const char* automationPath, std::vector<RenderAutomationPoint>& automation)
+{
+    FILE* file = fopen(automationPath, "r");
+    if(!file)
+    {
+        fprintf(stderr, "%s: cannot read the automation\n", automationPath);
+        return false;
+    }
+
+    char line[4096];
+    int lineNumber = 0;
+    bool valid = true;
+    while(valid && fgets(line, sizeof(line), file))
+    {
+        ++lineNumber;
+        char* seconds = strtok(line, ", \t\r\n");
+        if(!seconds || seconds[0] == '#')
+        {
+            continue;
+        }
+        char* name = strtok(NULL, ", \t\r\n");
+        char* value = strtok(NULL, ", \t\r\n");
+
+        RenderAutomationPoint point;
+        char* end;
+        point.seconds = strtod(seconds, &end);
+        valid = (*end == 0) && point.seconds >= 0.0 && name && value && !strtok(NULL, ", \t\r\n");
+        point.param = valid ? FindAutomationParam(name) : -1;
+        if(valid && point.param == automationTempoParam)
+        {
+            point.value = (float)strtod(value, &end);
+            valid = (*end == 0) && point.value > 0.0f;
+        }
+        else if(valid && point.param >= 0)
+        {
+            valid = ParseParam(value, point.value);
+        }
+        if(!valid || point.param < 0)
+        {
+            fprintf(stderr, "%s:%d: expected time, parameter name and value\n", automationPath, lineNumber);
+            valid = false;
+            break;
+        }
+        automation.push_back(point);
+    }
+    fclose(file);
+
+    // Points of the same time keep the order of the file.
+    std::stable_sort(automation.begin(), automation.end(),
+                     [](const RenderAutomationPoint& a, const RenderAutomationPoint& b) { return a.seconds < b.seconds; });
+    return valid;
+}
+
+/**
+ * Sets the parameters of the unit. Allocated buffers of another rate than
+ * the one of the economy are replaced, clearing the delay line.
+ * @param unit a unit to set the parameters of.
+ * @param timeInfo time info of the unit, holding the tempo.
+ * @param params the parameters to set.
+ */
+void ApplyParams(PingPongDelayUnit& unit, VstTimeInfo& timeInfo, const PingPongDelayCheckpointParams& params)
+{
+    timeInfo.tempo = params.tempo;
+    unit.SetDelayParam(params.delayParam);
+    unit.SetFeedbackParam(params.feedbackParam);
+    unit.SetPanoramaParam(params.panoramaParam);
+    unit.SetWetParam(params.wetParam);
+    unit.SetSyncParam(params.syncParam);
+    unit.SetTapCountParam(params.tapCountParam);
+    for(int tap = 0; tap < maxTapCount; ++tap)
+    {
+        unit.SetTapTimeParam(tap, params.tapTimeParams[tap]);
+        unit.SetTapGainParam(tap, params.tapGainParams[tap]);
+        unit.SetTapPanoramaParam(tap, params.tapPanoramaParams[tap]);
+    }
+    unit.SetInterpolationParam(params.interpolationParam);
+    unit.SetFreezeParam(params.freezeParam);
+    unit.SetEconomyParam(params.economyParam);
+    if(unit.HasBuffers())
+    {
+        unit.AllocateBuffers();
+    }
+}
+
+/**
+ * Processes frames in place, running the channels on two threads if
+ * there is a channel worker and the unit can process them separately.
+ * @param unit a unit to process the frames by.
+ * @param channelWorker a worker running the right channel, NULL if none.
+ * @param left left channel samples to be processed.
+ * @param right right channel samples to be processed.
+ * @param frames number of frames to process.
+ */
+void ProcessFrames(PingPongDelayUnit& unit, ChannelWorker* channelWorker, float* left, float* right, int frames)
+{
+    if(channelWorker && unit.CanProcessChannels())
+    {
+        channelWorker->Start(right, frames);
+        unit.ProcessChannel(0, left, frames);
+        channelWorker->Wait();
+        unit.MixChannels(left, right, left, right, frames);
+    }
+    else
+    {
+        unit.ProcessBlock(left, right, left, right, frames);
+    }
+}
+
+/**
+ * Renders a surround file through the surround unit of its speaker ring,
+ * the LFE channel is passed through untouched.
+ * @param settings settings of the render.
+ * @param reader a reader of the opened input file.
+ * @param layout a speaker layout of the input file.
+ * @param outputPath a path of the output file.
+ * @param sampleFormat a sample format of the output file.
+ * @param renderedSeconds where to store the length of the rendered audio.
+ * @return true on success, false otherwise, the error is printed to
+ *      the standard error.
+ */
+template<int channelCount>
+bool RenderSurround(const RenderSettings& settings, PingPongDelayWavReader& reader, const SurroundLayout& layout,
+                    const char* outputPath, PingPongDelaySampleFormat sampleFormat, double& renderedSeconds)
+{
+    const PingPongDelayWavFormat& format = reader.GetFormat();
+    VstTimeInfo timeInfo;
+    memset(&timeInfo, 0, sizeof(timeInfo));
+    timeInfo.sampleRate = format.sampleRate;
+    timeInfo.tempo = settings.tempo;
+    timeInfo.flags = kVstTempoValid;
+
+    float lowestTempo = settings.tempo;
+    for(size_t i = 0; i < settings.automation.size(); ++i)
+    {
+        if(settings.automation[i].param == automationTempoParam)
+        {
+            lowestTempo = std::min(lowestTempo, settings.automation[i].value);
+        }
+    }
+    PingPongDelaySurroundUnit<channelCount> unit(
+        PingPongDelaySurroundUnit<channelCount>::RequiredBufferSize((float)format.sampleRate, lowestTempo), &timeInfo,
+        settings.delayParam, settings.feedbackParam, settings.panoramaParam, settings.wetParam, settings.syncParam);
+    unit.AllocateBuffers();
+    PingPongDelayCheckpointParams params = StartParams(settings);
+    ApplyParams(unit.GetUnit(), timeInfo, params);
+
+    PingPongDelayWavWriter writer;
+    if(!writer.Open(outputPath, format.channelCount, format.sampleRate, sampleFormat, settings.blockFrames))
+    {
+        fprintf(stderr, "%s: %s\n", outputPath, writer.GetError());
+        return false;
+    }
+
+    std::vector<float> samples((size_t)format.channelCount * settings.blockFrames);
+    std::vector<float*> channels(format.channelCount);
+    for(int channel = 0; channel < format.channelCount; ++channel)
+    {
+        channels[channel] = samples.data() + (size_t)channel * settings.blockFrames;
+    }
+    float* ring[channelCount];
+    for(int speaker = 0; speaker < channelCount; ++speaker)
+    {
+        ring[speaker] = channels[layout.ring[speaker]];
+    }
+
+    std::vector<unsigned long long> pointFrames(settings.automation.size());
+    for(size_t i = 0; i < settings.automation.size(); ++i)
+    {
+        pointFrames[i] = (unsigned long long)(settings.automation[i].seconds * format.sampleRate);
+    }
+    size_t nextPoint = 0;
+
+    unsigned long long tailFrames = (unsigned long long)(settings.tailSeconds * format.sampleRate);
+    unsigned long long frame = 0;
+    bool written = true;
+    for(;;)
+    {
+        int frames = reader.Read(channels.data(), settings.blockFrames);
+        if(frames < settings.blockFrames)
+        {
+            // Tail of silence follows the input.
+            int silentFrames = (int)std::min((unsigned long long)(settings.blockFrames - frames), tailFrames);
+            for(int channel = 0; channel < format.channelCount; ++channel)
+            {
+                memset(channels[channel] + frames, 0, silentFrames * sizeof(float));
+            }
+            tailFrames -= silentFrames;
+            frames += silentFrames;
+        }
+        if(frames == 0)
+        {
+            break;
+        }
+
+        // Blocks are split at the automation points.
+        int processedFrames = 0;
+        while(processedFrames < frames)
+        {
+            bool changed = false;
+            while(nextPoint < pointFrames.size() && pointFrames[nextPoint] <= frame)
+            {
+                *AutomatedParam(params, settings.automation[nextPoint].param) = settings.automation[nextPoint].value;
+                ++nextPoint;
+                changed = true;
+            }
+            if(changed)
+            {
+                ApplyParams(unit.GetUnit(), timeInfo, params);
+            }
+
+            unsigned long long pieceEnd = frame + (frames - processedFrames);
+            if(nextPoint < pointFrames.size())
+            {
+                pieceEnd = std::min(pieceEnd, pointFrames[nextPoint]);
+            }
+            int pieceFrames = (int)(pieceEnd - frame);
+            float* piece[channelCount];
+            for(int speaker = 0; speaker < channelCount; ++speaker)
+            {
+                piece[speaker] = ring[speaker] + processedFrames;
+            }
+            unit.ProcessBlock(piece, piece, pieceFrames);
+            processedFrames += pieceFrames;
+            frame += pieceFrames;
+        }
+
+        if(!(written = writer.Write(channels.data(), frames)))
+        {
+            break;
+        }
+    }
+    renderedSeconds = (double)frame / format.sampleRate;
+
+    written = writer.Close() && written;
+    if(!written)
+    {
+        fprintf(stderr, "%s: %s\n", outputPath, writer.GetError());
+    }
+    return written;
+}
+
+/**
+ * Renders a file of more than two channels through the surround unit
+ * of its speaker layout.
+ * @param settings settings of the render.
+ * @param reader a reader of the opened input file.
+ * @param inputPath a path of the input file.
+ * @param outputPath a path of the output file.
+ * @param sampleFormat a sample format of the output file.
+ * @param renderedSeconds where to store the length of the rendered audio.
+ * @return true on success, false otherwise, the error is printed to
+ *      the standard error.
+ */
+bool RenderSurroundFile(const RenderSettings& settings, PingPongDelayWavReader& reader, const char* inputPath,
+                        const char* outputPath, PingPongDelaySampleFormat sampleFormat, double& renderedSeconds)
+{
+    if(settings.cachePath || settings.channelParallel)
+    {
+        fprintf(stderr, "%s: checkpoints and channel threads support only mono and stereo files\n", inputPath);
+        return false;
+    }
+
+    for(size_t i = 0; i < sizeof(surroundLayouts) / sizeof(surroundLayouts[0]); ++i)
+    {
+        const SurroundLayout& layout = surroundLayouts[i];
+        if(layout.channelCount != reader.GetFormat().channelCount)
+        {
+            continue;
+        }
+        switch(layout.channelCount - ((layout.lfeChannel >= 0) ? 1 : 0))
+        {
+            case 4:
+                return RenderSurround<4>(settings, reader, layout, outputPath, sampleFormat, renderedSeconds);
+
+            case 5:
+                return RenderSurround<5>(settings, reader, layout, outputPath, sampleFormat, renderedSeconds);
+
+            case 7:
+                return RenderSurround<7>(settings, reader, layout, outputPath, sampleFormat, renderedSeconds);
+
+            case 11:
+                return RenderSurround<11>(settings, reader, layout, outputPath, sampleFormat, renderedSeconds);
+        }
+    }
+
+    fprintf(stderr, "%s: only mono, stereo, quad, 5.1, 7.1 and 7.1.4 files are supported\n", inputPath);
+    return false;
+}
+
+/**
+ * Renders one file. With a checkpoint cache the state of the unit is
+ * saved into it at intervals. Resuming, the render continues from the last
+ * checkpoint before the change of the parameters, keeping the output
+ * rendered before it.
+ * @param settings settings of the render.
+ * @param inputPath a path of the input file.
+ * @param outputPath a path of the output file.
+ * @param renderedSeconds where to store the length of the rendered audio
+ *      in seconds.
+ * @return true on success, false if the render failed, the error is
+ *      printed to the standard error.
+ */
+bool RenderFile(const RenderSettings& settings, const char* inputPath, const char* outputPath,
+                double& renderedSeconds)
+{
+    renderedSeconds = 0.0;
+    PingPongDelayWavReader reader;
+    if(!reader.Open(inputPath, settings.blockFrames, 0))
+    {
+        fprintf(stderr, "%s: %s\n", inputPath, reader.GetError());
+        return false;
+    }
+    // Copied, as the reader is opened again when resuming.
+    PingPongDelayWavFormat format = reader.GetFormat();
+    PingPongDelaySampleFormat sampleFormat = settings.keepSampleFormat ? format.sampleFormat : settings.sampleFormat;
+    if(format.channelCount > 2)
+    {
+        return RenderSurroundFile(settings, reader, inputPath, outputPath, sampleFormat, renderedSeconds);
+    }
+
+    // Fixed tempo stands for the time info of the host.
+    VstTimeInfo timeInfo;
+    memset(&timeInfo, 0, sizeof(timeInfo));
+    timeInfo.sampleRate = format.sampleRate;
+    timeInfo.tempo = settings.tempo;
+    timeInfo.flags = kVstTempoValid;
+    // Running the channels separately, the delay line holds the delayed
+    // samples of the whole block at once.
+    // Buffers are sized for the lowest tempo of the automation.
+    float lowestTempo = settings.tempo;
+    for(size_t i = 0; i < settings.automation.size(); ++i)
+    {
+        if(settings.automation[i].param == automationTempoParam)
+        {
+            lowestTempo = std::min(lowestTempo, settings.automation[i].value);
+        }
+    }
+    int bufferSize = PingPongDelayUnit::RequiredBufferSize((float)format.sampleRate, lowestTempo);
+    if(settings.channelParallel)
+    {
+        bufferSize += settings.blockFrames;
+    }
+    PingPongDelayUnit unit(bufferSize, &timeInfo,
+                           settings.delayParam, settings.feedbackParam, settings.panoramaParam,
+                           settings.wetParam, settings.syncParam);
+
+    // Parameters of the command line apply from the start, unless
+    // the render is resumed. Buffers are allocated for their economy.
+    PingPongDelayCheckpointParams params = StartParams(settings);
+    ApplyParams(unit, timeInfo, params);
+    unit.AllocateBuffers();
+    std::vector<PingPongDelayCheckpointRecord> changes;
+    unsigned long long frame = 0;
+    PingPongDelayCheckpointCache cache;
+    bool checkpointing = (settings.cachePath != NULL);
+    if(checkpointing)
+    {
+        struct stat status;
+        if(stat(inputPath, &status) != 0)
+        {
+            fprintf(stderr, "%s: cannot open the file\n", inputPath);
+            return false;
+        }
+        PingPongDelayCheckpointHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = checkpointMagic;
+        header.version = checkpointVersion;
+        header.inputBytes = (unsigned long long)status.st_size;
+        header.inputModified = (long long)status.st_mtime;
+        header.sampleRate = format.sampleRate;
+        header.sampleFormat = sampleFormat;
+        header.tempo = settings.tempo;
+
+        bool opened;
+        if(settings.resumeSeconds >= 0.0)
+        {
+            // Changes of the previous renders between the checkpoint and
+            // the resumed frame are applied again, the parameters of
+            // the command line follow them.
+            PingPongDelayCheckpointRecord checkpoint;
+            std::vector<float> leftState;
+            std::vector<float> rightState;
+            unsigned long long changeFrame = (unsigned long long)(settings.resumeSeconds * format.sampleRate);
+            if((opened = cache.Resume(settings.cachePath, header, changeFrame, checkpoint, leftState, rightState, changes)))
+            {
+                PingPongDelayCheckpointRecord change;
+                change.type = ChangeRecord;
+                change.stateFrames = 0;
+                change.frame = changeFrame;
+                change.params = params;
+                changes.push_back(change);
+
+                params = checkpoint.params;
+                ApplyParams(unit, timeInfo, params);
+                unit.LoadState(leftState.data(), rightState.data(), checkpoint.stateFrames);
+                frame = checkpoint.frame;
+            }
+        }
+        else
+        {
+            opened = cache.Create(settings.cachePath, header);
+        }
+        if(!opened)
+        {
+            fprintf(stderr, "%s: %s\n", settings.cachePath, cache.GetError());
+            return false;
+        }
+    }
+
+    // Resumed render keeps the output before the checkpoint and skips
+    // the input before it.
+    PingPongDelayWavWriter writer;
+    bool opened;
+    if(frame > 0)
+    {
+        if(!reader.Open(inputPath, settings.blockFrames, frame))
+        {
+            fprintf(stderr, "%s: %s\n", inputPath, reader.GetError());
+            return false;
+        }
+        opened = writer.Resume(outputPath, 2, format.sampleRate, sampleFormat, settings.blockFrames, frame);
+    }
+    else
+    {
+        opened = writer.Open(outputPath, 2, format.sampleRate, sampleFormat, settings.blockFrames);
+    }
+    if(!opened)
+    {
+        fprintf(stderr, "%s: %s\n", outputPath, writer.GetError());
+        return false;
+    }
+    if(frame > 0)
+    {
+        fprintf(stderr, "%s: resumed at %.1f s\n", outputPath, (double)frame / format.sampleRate);
+    }
+
+    ChannelWorker* channelWorker = settings.channelParallel ? new ChannelWorker(unit) : NULL;
+    float* left = new float[settings.blockFrames];
+    float* right = new float[settings.blockFrames];
+    float* channels[2] = {left, right};
+    float* leftState = new float[bufferSize];
+    float* rightState = new float[bufferSize];
+    unsigned long long tailFrames = (unsigned long long)(settings.tailSeconds * format.sampleRate);
+    if(frame > format.frameCount)
+    {
+        tailFrames -= std::min(tailFrames, frame - format.frameCount);
+    }
+    // Checkpoints fall on the boundaries of the blocks, so that a resumed
+    // render splits the rest of the file into the same blocks and its delay
+    // ramps across the same frames after changes of the tempo.
+    unsigned long long checkpointFrames = std::max((unsigned long long)(settings.checkpointSeconds * format.sampleRate), 1ULL);
+    checkpointFrames = (checkpointFrames + settings.blockFrames - 1) / settings.blockFrames * settings.blockFrames;
+    // The checkpoint the render is resumed at is in the cache already.
+    unsigned long long nextCheckpoint = (frame > 0) ? (frame + checkpointFrames) : 0;
+    size_t nextChange = 0;
+
+    // Automation points before the resumed change are replayed from
+    // the cache, the points of the same frame follow the change.
+    std::vector<unsigned long long> pointFrames(settings.automation.size());
+    for(size_t i = 0; i < settings.automation.size(); ++i)
+    {
+        pointFrames[i] = (unsigned long long)(settings.automation[i].seconds * format.sampleRate);
+    }
+    size_t nextPoint = 0;
+    while(!changes.empty() && nextPoint < pointFrames.size() && pointFrames[nextPoint] < changes.back().frame)
+    {
+        ++nextPoint;
+    }
+    unsigned long long renderedFrames = 0;
+    bool written = true;
+    for(;;)
+    {
+        int frames = ReadBlock(reader, left, right, settings.blockFrames, tailFrames);
+        if(frames == 0)
+        {
+            break;
+        }
+
+        // Block is split at the changes and the checkpoints, so that they
+        // take place at their exact frames.
+        int processedFrames = 0;
+        while(processedFrames < frames)
+        {
+            bool changed = false;
+            while(nextChange < changes.size() && changes[nextChange].frame <= frame)
+            {
+                params = changes[nextChange++].params;
+                changed = true;
+            }
+            while(nextPoint < pointFrames.size() && pointFrames[nextPoint] <= frame)
+            {
+                *AutomatedParam(params, settings.automation[nextPoint].param) = settings.automation[nextPoint].value;
+                ++nextPoint;
+                changed = true;
+            }
+            if(changed)
+            {
+                ApplyParams(unit, timeInfo, params);
+                checkpointing = checkpointing && cache.AppendChange(frame, params);
+            }
+            if(checkpointing && frame == nextCheckpoint)
+            {
+                // Incomplete state is not saved, a later render resumes
+                // from an earlier checkpoint.
+                if(unit.CanSaveState())
+                {
+                    unit.SaveState(leftState, rightState);
+                    checkpointing = cache.AppendCheckpoint(frame, params, leftState, rightState, unit.GetStateFrames());
+                }
+                nextCheckpoint += checkpointFrames;
+            }
+
+            unsigned long long pieceEnd = frame + (frames - processedFrames);
+            if(checkpointing)
+            {
+                pieceEnd = std::min(pieceEnd, nextCheckpoint);
+            }
+            if(nextChange < changes.size())
+            {
+                pieceEnd = std::min(pieceEnd, changes[nextChange].frame);
+            }
+            if(nextPoint < pointFrames.size())
+            {
+                pieceEnd = std::min(pieceEnd, pointFrames[nextPoint]);
+            }
+            int pieceFrames = (int)(pieceEnd - frame);
+            ProcessFrames(unit, channelWorker, left + processedFrames, right + processedFrames, pieceFrames);
+            processedFrames += pieceFrames;
+            frame += pieceFrames;
+        }
+
+        if(!(written = writer.Write(channels, frames)))
+        {
+            break;
+        }
+        renderedFrames += frames;
+    }
+    delete channelWorker;
+    delete[] left;
+    delete[] right;
+    delete[] leftState;
+    delete[] rightState;
+    renderedSeconds = (double)renderedFrames / format.sampleRate;
+
+    // Output is complete even if the cache is not, the next render only
+    // resumes from an earlier checkpoint.
+    if(settings.cachePath && (!cache.Close() || !checkpointing))
+    {
+        fprintf(stderr, "%s: %s\n", settings.cachePath, cache.GetError());
+    }
+    written = writer.Close() && written;
+    if(!written)
+    {
+        fprintf(stderr, "%s: %s\n", outputPath, writer.GetError());
+    }
+    return written;
+}
+
+/**
+ * Reads paths of input files listed one per line.
+ * @param listPath a path of the list.
+ * @param inputPaths where to append the paths to.
+ * @return true on success, false if the list cannot be read.
+ */
+bool ReadInputList(const char* listPath, std::vector<std::string>& inputPaths)
+{
+    FILE* list = fopen(listPath, "r");
+    if(!list)
+    {
+        return false;
+    }
+
+    char line[4096];
+    while(fgets(line, sizeof(line), list))
+    {
+        size_t length = strcspn(line, "\r\n");
+        if(length > 0)
+        {
+            inputPaths.push_back(std::string(line, length));
+        }
+    }
+    fclose(list);
+    return true;
+}
+
+/**
+ * Reads variants of a sweep, each line holds the delay, feedback, panorama,
+ * wet and synchronization parameters, the other parameters are the ones
+ * of the settings. Empty lines and lines starting with # are skipped.
+ * @param sweepPath a path of the sweep file.
+ * @param settings settings of the render, the variants override their
+ *      parameters.
+ * @param variants where to append the settings of the variants to.
+ * @param lineNumbers where to append the line numbers of the variants to.
+ * @return true on success, false if the file cannot be read or a line is
+ *      not valid, the error is printed to the standard error.
+ */
+bool ReadSweep(const char* sweepPath, const RenderSettings& settings, std::vector<RenderSettings>& variants,
+               std::vector<int>& lineNumbers)
+{
+    FILE* sweep = fopen(sweepPath, "r");
+    if(!sweep)
+    {
+        fprintf(stderr, "%s: cannot read the sweep\n", sweepPath);
+        return false;
+    }
+
+    char line[4096];
+    int lineNumber = 0;
+    bool valid = true;
+    while(valid && fgets(line, sizeof(line), sweep))
+    {
+        ++lineNumber;
+        char* token = strtok(line, " \t\r\n");
+        if(!token || token[0] == '#')
+        {
+            continue;
+        }
+
+        RenderSettings variant = settings;
+        float* params[] = {&variant.delayParam, &variant.feedbackParam, &variant.panoramaParam,
+                           &variant.wetParam, &variant.syncParam};
+        int paramCount = (int)(sizeof(params) / sizeof(params[0]));
+        for(int i = 0; i < paramCount && valid; ++i)
+        {
+            valid = token && ParseParam(token, *params[i]);
+            token = strtok(NULL, " \t\r\n");
+        }
+        if(!valid || token)
+        {
+            fprintf(stderr, "%s:%d: expected %d parameters between [0, 1]\n", sweepPath, lineNumber, paramCount);
+            valid = false;
+            break;
+        }
+        variants.push_back(variant);
+        lineNumbers.push_back(lineNumber);
+    }
+    fclose(sweep);
+    if(valid && variants.empty())
+    {
+        fprintf(stderr, "%s: no variants\n", sweepPath);
+        valid = false;
+    }
+    return valid;
+}
+
+/**
+ * Renders one file through all the variants of a sweep, decoding it only
+ * once. Each block is rendered by the units of all the variants, which are
+ * split among the worker threads, before the next one is decoded.
+ * @param variants settings of the variants, they differ only in the unit
+ *      parameters.
+ * @param lineNumbers line numbers of the variants, naming their outputs.
+ * @param inputPath a path of the input file.
+ * @param outputDirectory a directory to render the variants into.
+ * @param workerCount number of worker threads.
+ * @param renderedSeconds where to store the length of the audio rendered
+ *      by all the variants in seconds.
+ * @return number of variants, which failed to render.
+ */
+int RenderSweep(const std::vector<RenderSettings>& variants, const std::vector<int>& lineNumbers,
+                const char* inputPath, const char* outputDirectory, int workerCount, double& renderedSeconds)
+{
+    renderedSeconds = 0.0;
+    const RenderSettings& settings = variants[0];
+    int variantCount = (int)variants.size();
+    PingPongDelayWavReader reader;
+    if(!reader.Open(inputPath, settings.blockFrames, 0))
+    {
+        fprintf(stderr, "%s: %s\n", inputPath, reader.GetError());
+        return variantCount;
+    }
+    const PingPongDelayWavFormat& format = reader.GetFormat();
+    if(format.channelCount > 2)
+    {
+        fprintf(stderr, "%s: only mono and stereo files are supported\n", inputPath);
+        return variantCount;
+    }
+
+    // Outputs are named after the input, the line number of the variant
+    // is inserted before the extension.
+    std::string inputName(inputPath);
+    size_t slash = inputName.find_last_of('/');
+    inputName = inputName.substr((slash == std::string::npos) ? 0 : slash + 1);
+    size_t dot = inputName.find_last_of('.');
+    std::string stem = inputName.substr(0, dot);
+    std::string extension = (dot == std::string::npos) ? std::string(".wav") : inputName.substr(dot);
+
+    // Units of all the variants share the time info, which they only read.
+    VstTimeInfo timeInfo;
+    memset(&timeInfo, 0, sizeof(timeInfo));
+    timeInfo.sampleRate = format.sampleRate;
+    timeInfo.tempo = settings.tempo;
+    timeInfo.flags = kVstTempoValid;
+    int bufferSize = PingPongDelayUnit::RequiredBufferSize((float)format.sampleRate, settings.tempo);
+    PingPongDelaySampleFormat sampleFormat = settings.keepSampleFormat ? format.sampleFormat : settings.sampleFormat;
+
+    int failedCount = 0;
+    std::vector<SweepVariant*> sweep;
+    for(int v = 0; v < variantCount; ++v)
+    {
+        SweepVariant* variant = new SweepVariant();
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), ".%03d", lineNumbers[v]);
+        variant->outputPath = std::string(outputDirectory) + "/" + stem + suffix + extension;
+        variant->unit = new PingPongDelayUnit(bufferSize, &timeInfo, variants[v].delayParam, variants[v].feedbackParam,
+                                              variants[v].panoramaParam, variants[v].wetParam, variants[v].syncParam);
+        ApplyParams(*variant->unit, timeInfo, StartParams(variants[v]));
+        variant->unit->AllocateBuffers();
+        variant->left = new float[settings.blockFrames];
+        variant->right = new float[settings.blockFrames];
+        variant->failed = !variant->writer.Open(variant->outputPath.c_str(), 2, format.sampleRate, sampleFormat,
+                                                settings.blockFrames);
+        sweep.push_back(variant);
+    }
+
+    float* left = new float[settings.blockFrames];
+    float* right = new float[settings.blockFrames];
+    unsigned long long tailFrames = (unsigned long long)(settings.tailSeconds * format.sampleRate);
+    unsigned long long renderedFrames = 0;
+    workerCount = std::min(workerCount, variantCount);
+    for(;;)
+    {
+        int frames = ReadBlock(reader, left, right, settings.blockFrames, tailFrames);
+        if(frames == 0)
+        {
+            break;
+        }
+
+        // The decoded block is shared by all the variants, only read by
+        // the workers. Blocks are long enough for the start of the threads
+        // to be negligible.
+        std::vector<std::thread> workers;
+        for(int worker = 0; worker < workerCount; ++worker)
+        {
+            workers.push_back(std::thread([&, worker, frames]
+            {
+                for(int v = worker; v < variantCount; v += workerCount)
+                {
+                    SweepVariant& variant = *sweep[v];
+                    if(variant.failed)
+                    {
+                        continue;
+                    }
+                    variant.unit->ProcessBlock(left, right, variant.left, variant.right, frames);
+                    const float* channels[2] = {variant.left, variant.right};
+                    variant.failed = !variant.writer.Write(channels, frames);
+                }
+            }));
+        }
+        for(int worker = 0; worker < workerCount; ++worker)
+        {
+            workers[worker].join();
+        }
+        renderedFrames += frames;
+    }
+    delete[] left;
+    delete[] right;
+
+    for(int v = 0; v < variantCount; ++v)
+    {
+        SweepVariant* variant = sweep[v];
+        bool written = !variant->failed;
+        written = variant->writer.Close() && written;
+        if(written)
+        {
+            renderedSeconds += (double)renderedFrames / format.sampleRate;
+        }
+        else
+        {
+            fprintf(stderr, "%s: %s\n", variant->outputPath.c_str(), variant->writer.GetError());
+            ++failedCount;
+        }
+        delete variant->unit;
+        delete[] variant->left;
+        delete[] variant->right;
+        delete variant;
+    }
+    return failedCount;
+}
+
+/**
+ * Renders many files at once, each worker thread by its own unit.
+ * @param settings settings of the renders.
+ * @param inputPaths paths of the input files.
+ * @param outputDirectory a directory to render the files into.
+ * @param workerCount number of worker threads.
+ * @return number of files, which failed to render.
+ */
+int RenderBatch(const RenderSettings& settings, const std::vector<std::string>& inputPaths,
+                const char* outputDirectory, int workerCount)
+{
+    char directoryPath[PATH_MAX];
+    if(!realpath(outputDirectory, directoryPath))
+    {
+        fprintf(stderr, "%s: cannot open the directory\n", outputDirectory);
+        return (int)inputPaths.size();
+    }
+
+    std::vector<PingPongDelayRenderJob> jobs;
+    int failedCount = 0;
+    for(size_t i = 0; i < inputPaths.size(); ++i)
+    {
+        struct stat status;
+        if(stat(inputPaths[i].c_str(), &status) != 0)
+        {
+            fprintf(stderr, "%s: cannot open the file\n", inputPaths[i].c_str());
+            ++failedCount;
+            continue;
+        }
+
+        PingPongDelayRenderJob job;
+        size_t slash = inputPaths[i].find_last_of('/');
+        job.inputPath = inputPaths[i];
+        job.outputPath = std::string(outputDirectory) + "/" +
+            inputPaths[i].substr((slash == std::string::npos) ? 0 : slash + 1);
+        job.bytes = (unsigned long long)status.st_size;
+
+        // Rendering into the directory of the input would overwrite it.
+        char inputPath[PATH_MAX];
+        if(realpath(job.inputPath.c_str(), inputPath) &&
+           std::string(inputPath) == std::string(directoryPath) + job.outputPath.substr(job.outputPath.find_last_of('/')))
+        {
+            fprintf(stderr, "%s: the output would overwrite the input\n", job.inputPath.c_str());
+            ++failedCount;
+            continue;
+        }
+        jobs.push_back(job);
+    }
+
+    PingPongDelayRenderQueue queue(jobs, workerCount);
+    std::vector<double> workerSeconds(workerCount, 0.0);
+    std::atomic<int> workerFailedCount(0);
+    double start = Now();
+
+    // The reader and the writer of each worker run on their own threads,
+    // so the file I/O overlaps the processing of the worker.
+    std::vector<std::thread> workers;
+    for(int worker = 0; worker < workerCount; ++worker)
+    {
+        workers.push_back(std::thread([&, worker]
+        {
+            PingPongDelayRenderJob job;
+            while(queue.Pop(worker, job))
+            {
+                double jobStart = Now();
+                double renderedSeconds;
+                if(!RenderFile(settings, job.inputPath.c_str(), job.outputPath.c_str(), renderedSeconds))
+                {
+                    workerFailedCount.fetch_add(1);
+                    continue;
+                }
+                double elapsed = Now() - jobStart;
+                workerSeconds[worker] += renderedSeconds;
+                fprintf(stderr, "%s: %.1f s of audio in %.2f s, %.1fx realtime\n", job.outputPath.c_str(),
+                        renderedSeconds, elapsed, (elapsed > 0.0) ? (renderedSeconds / elapsed) : 0.0);
+            }
+        }));
+    }
+    for(int worker = 0; worker < workerCount; ++worker)
+    {
+        workers[worker].join();
+    }
+
+    double elapsed = Now() - start;
+    double renderedSeconds = 0.0;
+    for(int worker = 0; worker < workerCount; ++worker)
+    {
+        renderedSeconds += workerSeconds[worker];
+    }
+    failedCount += workerFailedCount.load();
+    fprintf(stderr, "%d files (%d failed) by %d workers: %.1f s of audio in %.2f s, %.1fx realtime\n",
+            (int)inputPaths.size(), failedCount, workerCount, renderedSeconds, elapsed,
+            (elapsed > 0.0) ? (renderedSeconds / elapsed) : 0.0);
+    return failedCount;
+}
+
+/**
+ * Prints the usage of the tool.
+ * @param name a name of the tool.
+ */
+void PrintUsage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-d delay] [-f feedback] [-p panorama] [-w wet] [-s sync] [-t tempo]\n"
+            "       [-T taps] [-P tap,time,gain,panorama ...] [-i interpolation]\n"
+            "       [-z freeze] [-e economy]\n"
+            "       [-l seconds] [-F pcm16|pcm24|pcm32|float32|float64] [-b frames] [-c]\n"
+            "       [-A automation] [-C cache [-I seconds] [-R seconds]] input.wav output.wav\n"
+            "       %s [options] -o directory [-j workers] [-L list] input.wav ...\n"
+            "       %s [options] -S sweep -o directory [-j workers] [-L list] input.wav ...\n", name, name, name);
+}
+
+/**
+ * Entry point of the renderer.
+ * @param argc number of arguments.
+ * @param argv arguments.
+ * @return zero on success.
+ */
+int main(int argc, char* argv[])
+{
+    // Defaults are the ones of the effect.
+    RenderSettings settings;
+    settings.delayParam = 0.8f;
+    settings.feedbackParam = 0.25f;
+    settings.panoramaParam = 0.0f;
+    settings.wetParam = 0.25f;
+    settings.syncParam = 0.0f;
+    settings.tempo = 120.0f;
+    settings.tapCountParam = 0.0f;
+    for(int tap = 0; tap < maxTapCount; ++tap)
+    {
+        settings.tapTimeParams[tap] = (float)(tap + 1) / maxTapCount;
+        settings.tapGainParams[tap] = 0.5f;
+        settings.tapPanoramaParams[tap] = 0.5f;
+    }
+    settings.interpolationParam = 0.0f;
+    settings.freezeParam = 0.0f;
+    settings.economyParam = 0.0f;
+    settings.tailSeconds = 0.0;
+    settings.blockFrames = 65536;
+    settings.keepSampleFormat = true;
+    settings.sampleFormat = Float32Format;
+    settings.channelParallel = false;
+    settings.cachePath = NULL;
+    settings.checkpointSeconds = 60.0;
+    settings.resumeSeconds = -1.0;
+    const char* outputDirectory = NULL;
+    const char* sweepPath = NULL;
+    int workerCount = (int)std::thread::hardware_concurrency();
+    std::vector<std::string> inputPaths;
+
+    int option;
+    bool valid = true;
+    while((option = getopt(argc, argv, "d:f:p:w:s:t:T:P:i:z:e:l:F:b:o:j:L:cS:C:I:R:A:")) != -1)
+    {
+        switch(option)
+        {
+            case 'd':
+                valid = ParseParam(optarg, settings.delayParam) && valid;
+                break;
+
+            case 'f':
+                valid = ParseParam(optarg, settings.feedbackParam) && valid;
+                break;
+
+            case 'p':
+                valid = ParseParam(optarg, settings.panoramaParam) && valid;
+                break;
+
+            case 'w':
+                valid = ParseParam(optarg, settings.wetParam) && valid;
+                break;
+
+            case 's':
+                valid = ParseParam(optarg, settings.syncParam) && valid;
+                break;
+
+            case 't':
+                settings.tempo = (float)atof(optarg);
+                valid = (settings.tempo > 0.0f) && valid;
+                break;
+
+            case 'T':
+                valid = ParseParam(optarg, settings.tapCountParam) && valid;
+                break;
+
+            case 'P':
+                valid = ParseTap(optarg, settings) && valid;
+                break;
+
+            case 'i':
+                valid = ParseParam(optarg, settings.interpolationParam) && valid;
+                break;
+
+            case 'z':
+                valid = ParseParam(optarg, settings.freezeParam) && valid;
+                break;
+
+            case 'e':
+                valid = ParseParam(optarg, settings.economyParam) && valid;
+                break;
+
+            case 'l':
+                settings.tailSeconds = atof(optarg);
+                valid = (settings.tailSeconds >= 0.0) && valid;
+                break;
+
+            case 'F':
+                settings.keepSampleFormat = false;
+                valid = ParseSampleFormat(optarg, settings.sampleFormat) && valid;
+                break;
+
+            case 'b':
+                settings.blockFrames = atoi(optarg);
+                valid = (settings.blockFrames > 0) && valid;
+                break;
+
+            case 'o':
+                outputDirectory = optarg;
+                break;
+
+            case 'j':
+                workerCount = atoi(optarg);
+                valid = (workerCount > 0) && valid;
+                break;
+
+            case 'L':
+                if(!ReadInputList(optarg, inputPaths))
+                {
+                    fprintf(stderr, "%s: cannot read the list\n", optarg);
+                    return 1;
+                }
+                break;
+
+            case 'c':
+                settings.channelParallel = true;
+                break;
+
+            case 'S':
+                sweepPath = optarg;
+                break;
+
+            case 'C':
+                settings.cachePath = optarg;
+                break;
+
+            case 'I':
+                settings.checkpointSeconds = atof(optarg);
+                valid = (settings.checkpointSeconds > 0.0) && valid;
+                break;
+
+            case 'R':
+                settings.resumeSeconds = atof(optarg);
+                valid = (settings.resumeSeconds >= 0.0) && valid;
+                break;
+
+            case 'A':
+                if(!ReadAutomation(optarg, settings.automation))
+                {
+                    return 1;
+                }
+                break;
+
+            default:
+                valid = false;
+                break;
+        }
+    }
+    // Checkpoints are kept only for a single file render.
+    bool checkpointed = settings.cachePath || settings.resumeSeconds >= 0.0;
+    valid = valid && (!checkpointed || (!outputDirectory && !sweepPath)) &&
+        (settings.resumeSeconds < 0.0 || settings.cachePath) && (settings.automation.empty() || !sweepPath);
+    if(valid && outputDirectory && sweepPath && (!inputPaths.empty() || optind < argc))
+    {
+        inputPaths.insert(inputPaths.end(), argv + optind, argv + argc);
+        std::vector<RenderSettings> variants;
+        std::vector<int> lineNumbers;
+        if(!ReadSweep(sweepPath, settings, variants, lineNumbers))
+        {
+            return 1;
+        }
+
+        int failedCount = 0;
+        for(size_t i = 0; i < inputPaths.size(); ++i)
+        {
+            double start = Now();
+            double renderedSeconds;
+            failedCount += RenderSweep(variants, lineNumbers, inputPaths[i].c_str(), outputDirectory,
+                                       std::max(workerCount, 1), renderedSeconds);
+            double elapsed = Now() - start;
+            fprintf(stderr, "%s: %d variants, %.1f s of audio in %.2f s, %.1fx realtime\n", inputPaths[i].c_str(),
+                    (int)variants.size(), renderedSeconds, elapsed, (elapsed > 0.0) ? (renderedSeconds / elapsed) : 0.0);
+        }
+        return (failedCount == 0) ? 0 : 1;
+    }
+    if(valid && outputDirectory && !sweepPath)
+    {
+        inputPaths.insert(inputPaths.end(), argv + optind, argv + argc);
+        if(!inputPaths.empty())
+        {
+            return (RenderBatch(settings, inputPaths, outputDirectory, std::max(workerCount, 1)) == 0) ? 0 : 1;
+        }
+    }
+    if(!valid || outputDirectory || sweepPath || argc - optind != 2)
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    double start = Now();
+    double renderedSeconds;
+    if(!RenderFile(settings, argv[optind], argv[optind + 1], renderedSeconds))
+    {
+        return 1;
+    }
+    double elapsed = Now() - start;
+    fprintf(stderr, "%s: %.1f s of audio in %.2f s, %.1fx realtime\n", argv[optind + 1],
+            renderedSeconds, elapsed, (elapsed > 0.0) ? (renderedSeconds / elapsed) : 0.0);
+    return 0;
+}
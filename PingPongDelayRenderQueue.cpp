@@ -0,0 +1,117 @@
+/**
+ * PingPongDelayRenderQueue.cpp:
+ *
+ * Implementation of PingPongDelayRenderQueue class scheduling render jobs
+ * to worker threads by work stealing, the largest jobs first.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayRenderQueue
+ */
+
+
+#include <algorithm>
+
+#ifndef PINGPONGDELAYRENDERQUEUE_H
+#include "PingPongDelayRenderQueue.h"
+#endif
+
+
+namespace PingPongDelay
+{
+    /**
+     * A constructor. Deals the jobs from the largest one to the deques
+     * of the workers in turn.
+     * @param jobs jobs to be rendered.
+     * @param workerCount number of worker threads.
+     */
+    PingPongDelayRenderQueue::PingPongDelayRenderQueue(std::vector<PingPongDelayRenderJob> jobs, int workerCount) :
+        workerJobs_(new WorkerJobs[workerCount]),
+        workerCount_(workerCount)
+    {
+        std::stable_sort(jobs.begin(), jobs.end(),
+                         [](const PingPongDelayRenderJob& first, const PingPongDelayRenderJob& second)
+                         {
+                             return first.bytes > second.bytes;
+                         });
+
+        // Dealing in turn keeps each deque ordered from the largest job.
+        for(size_t i = 0; i < jobs.size(); ++i)
+        {
+            workerJobs_[i % workerCount].jobs.push_back(jobs[i]);
+        }
+    }
+
+    /**
+     * A destructor.
+     */
+    PingPongDelayRenderQueue::~PingPongDelayRenderQueue()
+    {
+        delete[] workerJobs_;
+    }
+
+    /**
+     * Takes the next job of a worker, stealing it from the other
+     * workers if its own deque is empty.
+     * @param worker an index of the worker.
+     * @param job where to store the job.
+     * @return true if a job was taken, false if all jobs are taken.
+     */
+    bool PingPongDelayRenderQueue::Pop(int worker, PingPongDelayRenderJob& job)
+    {
+        {
+            WorkerJobs& own = workerJobs_[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if(!own.jobs.empty())
+            {
+                job = own.jobs.front();
+                own.jobs.pop_front();
+                return true;
+            }
+        }
+        return Steal(worker, job);
+    }
+
+    /**
+     * Steals the largest job waiting in the deques of the other workers.
+     * @param worker an index of the stealing worker.
+     * @param job where to store the job.
+     * @return true if a job was stolen, false if all jobs are taken.
+     */
+    bool PingPongDelayRenderQueue::Steal(int worker, PingPongDelayRenderJob& job)
+    {
+        for(;;)
+        {
+            // Finding the victim, whose largest waiting job is the largest.
+            int victim = -1;
+            unsigned long long victimBytes = 0;
+            for(int i = 1; i < workerCount_; ++i)
+            {
+                int candidate = (worker + i) % workerCount_;
+                WorkerJobs& candidateJobs = workerJobs_[candidate];
+                std::lock_guard<std::mutex> lock(candidateJobs.mutex);
+                if(!candidateJobs.jobs.empty() && (victim < 0 || candidateJobs.jobs.front().bytes > victimBytes))
+                {
+                    victim = candidate;
+                    victimBytes = candidateJobs.jobs.front().bytes;
+                }
+            }
+            if(victim < 0)
+            {
+                return false;
+            }
+
+            // The victim may have taken the job meanwhile, looking again then.
+            WorkerJobs& victimJobs = workerJobs_[victim];
+            std::lock_guard<std::mutex> lock(victimJobs.mutex);
+            if(!victimJobs.jobs.empty())
+            {
+                job = victimJobs.jobs.front();
+                victimJobs.jobs.pop_front();
+                return true;
+            }
+        }
+    }
+}
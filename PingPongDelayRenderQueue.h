@@ -0,0 +1,123 @@
+/**
+ * PingPongDelayRenderQueue.h:
+ *
+ * Declaration of PingPongDelayRenderJob structure describing one file
+ * to be rendered.
+ *
+ * Declaration of PingPongDelayRenderQueue class scheduling render jobs
+ * to worker threads by work stealing, the largest jobs first.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayRenderQueue
+ */
+
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef PINGPONGDELAYRENDERQUEUE_H
+#define PINGPONGDELAYRENDERQUEUE_H
+
+
+namespace PingPongDelay
+{
+    /**
+     * One file to be rendered.
+     */
+    struct PingPongDelayRenderJob
+    {
+        /**
+         * Path of the input file.
+         */
+        std::string inputPath;
+
+        /**
+         * Path of the output file.
+         */
+        std::string outputPath;
+
+        /**
+         * Size of the input file in bytes, estimating the cost of the job.
+         */
+        unsigned long long bytes;
+    };
+
+
+    /**
+     * Queue of render jobs shared by worker threads. Each worker owns
+     * a deque of jobs ordered from the largest one, which it takes jobs from.
+     * Once it runs dry, it steals the largest job waiting in the deques of
+     * the other workers. Starting the large jobs first keeps a single huge
+     * file from being left for the end, where it would prolong the batch
+     * while the other workers idle.
+     */
+    class PingPongDelayRenderQueue
+    {
+    public:
+        /**
+         * A constructor. Deals the jobs from the largest one to the deques
+         * of the workers in turn.
+         * @param jobs jobs to be rendered.
+         * @param workerCount number of worker threads.
+         */
+        PingPongDelayRenderQueue(std::vector<PingPongDelayRenderJob> jobs, int workerCount);
+
+        /**
+         * A destructor.
+         */
+        ~PingPongDelayRenderQueue();
+
+        /**
+         * Takes the next job of a worker, stealing it from the other
+         * workers if its own deque is empty.
+         * @param worker an index of the worker.
+         * @param job where to store the job.
+         * @return true if a job was taken, false if all jobs are taken.
+         */
+        bool Pop(int worker, PingPongDelayRenderJob& job);
+
+    private:
+        /**
+         * Deque of jobs owned by one worker.
+         */
+        struct WorkerJobs
+        {
+            /**
+             * Waiting jobs ordered from the largest one.
+             */
+            std::deque<PingPongDelayRenderJob> jobs;
+
+            /**
+             * Guards the jobs against the thieves.
+             */
+            std::mutex mutex;
+        };
+
+        /**
+         * Steals the largest job waiting in the deques of the other workers.
+         * @param worker an index of the stealing worker.
+         * @param job where to store the job.
+         * @return true if a job was stolen, false if all jobs are taken.
+         */
+        bool Steal(int worker, PingPongDelayRenderJob& job);
+
+
+        /**
+         * Deques of the workers.
+         */
+        WorkerJobs* workerJobs_;
+
+        /**
+         * Number of the workers.
+         */
+        int workerCount_;
+    };
+}
+
+
+#endif
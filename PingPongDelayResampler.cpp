@@ -0,0 +1,324 @@
+/**
+ * PingPongDelayResampler.cpp:
+ *
+ * Implementation of PingPongDelayResampler class decimating a stereo sample
+ * stream to an integer fraction of its rate and interpolating it back.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayResampler
+ */
+
+
+#include <string.h>
+
+#ifndef PINGPONGDELAYRESAMPLER_H
+#include "PingPongDelayResampler.h"
+#endif
+
+
+namespace PingPongDelay
+{
+    /**
+     * Side coefficients of the half-band filter, the first one
+     * of the pair nearest to the center, whose coefficient is one half.
+     * Designed by the Kaiser window of beta 5.
+     */
+    const float PingPongDelayResampler::halfBandCoefficients_[halfBandPairCount] =
+    {
+        0.307637496f, -0.076783210f, 0.024320545f, -0.005174831f
+    };
+
+    /**
+     * A constructor. The rate is not reduced until SetFactor is called.
+     */
+    PingPongDelayResampler::PingPongDelayResampler()
+    {
+        SetFactor(1);
+    }
+
+    /**
+     * Sets the factor by which the rate is reduced and resets
+     * the resampler. Neither allocates nor locks.
+     * @param factor a factor of 1, 2 or maxResamplingFactor.
+     */
+    void PingPongDelayResampler::SetFactor(int factor)
+    {
+        factor_ = factor;
+        stageCount_ = 0;
+        for(int stageFactor = 1; stageFactor < factor; stageFactor *= 2)
+        {
+            ++stageCount_;
+        }
+        Reset();
+    }
+
+    /**
+     * Gets the factor by which the rate is reduced.
+     * @return factor of the rate.
+     */
+    int PingPongDelayResampler::GetFactor()
+    {
+        return factor_;
+    }
+
+    /**
+     * Gets the number of full rate frames the round trip through
+     * the reduced rate lags by.
+     * @return lag of the round trip in frames.
+     */
+    int PingPongDelayResampler::GetLatency()
+    {
+        // Each stage lags by its filter twice, the held back frames
+        // add factor - 1.
+        int latency = factor_ - 1;
+        for(int stage = 0, stageFactor = 1; stage < stageCount_; ++stage, stageFactor *= 2)
+        {
+            latency += stageFactor * (4 * halfBandPairCount - 3);
+        }
+        return latency;
+    }
+
+    /**
+     * Clears the filters as if both streams were silent.
+     */
+    void PingPongDelayResampler::Reset()
+    {
+        memset(decimatorPending_, 0, sizeof(decimatorPending_));
+        memset(decimatorHeld_, 0, sizeof(decimatorHeld_));
+        memset(decimatorEarly_, 0, sizeof(decimatorEarly_));
+        memset(decimatorLate_, 0, sizeof(decimatorLate_));
+        memset(interpolatorInputs_, 0, sizeof(interpolatorInputs_));
+        memset(interpolated_, 0, sizeof(interpolated_));
+
+        // Silence is held back, so that the first block gets all its
+        // frames before any reduced frame is decimated.
+        heldFrames_ = factor_ - 1;
+    }
+
+    /**
+     * Decimates the next block of the full rate stream.
+     * @param leftInput an array of left channel samples.
+     * @param rightInput an array of right channel samples.
+     * @param leftReduced where to store the reduced left channel samples.
+     * @param rightReduced where to store the reduced right channel samples.
+     * @param sampleFrames number of samples of each channel, at most
+     *      maxResampledFrames times the factor.
+     * @return number of the reduced samples of each channel.
+     */
+    int PingPongDelayResampler::Decimate(const float* leftInput, const float* rightInput, float* leftReduced,
+                                         float* rightReduced, int sampleFrames)
+    {
+        const float* inputs[2] = {leftInput, rightInput};
+        float* reduced[2] = {leftReduced, rightReduced};
+        int pending[maxResamplingStages];
+        memcpy(pending, decimatorPending_, sizeof(pending));
+        int reducedFrames = sampleFrames;
+        for(int channel = 0; channel < 2; ++channel)
+        {
+            // Both channels start from the same pending samples.
+            memcpy(decimatorPending_, pending, sizeof(pending));
+            switch(stageCount_)
+            {
+                case 0:
+                    memcpy(reduced[channel], inputs[channel], sampleFrames * sizeof(float));
+                    reducedFrames = sampleFrames;
+                    break;
+
+                case 1:
+                    reducedFrames = DecimateStage(0, channel, inputs[channel], sampleFrames, reduced[channel]);
+                    break;
+
+                default:
+                    reducedFrames = DecimateStage(0, channel, inputs[channel], sampleFrames, stageSamples_[channel]);
+                    reducedFrames = DecimateStage(1, channel, stageSamples_[channel], reducedFrames, reduced[channel]);
+                    break;
+            }
+        }
+        return reducedFrames;
+    }
+
+    /**
+     * Interpolates the next block of the reduced stream back to the full
+     * rate. Must follow Decimate of the block with the same number
+     * of frames.
+     * @param leftReduced an array of reduced left channel samples.
+     * @param rightReduced an array of reduced right channel samples.
+     * @param reducedFrames number of the reduced samples returned
+     *      by Decimate.
+     * @param leftOutput where to store the left channel samples.
+     * @param rightOutput where to store the right channel samples.
+     * @param sampleFrames number of samples of each channel given
+     *      to Decimate.
+     */
+    void PingPongDelayResampler::Interpolate(const float* leftReduced, const float* rightReduced, int reducedFrames,
+                                             float* leftOutput, float* rightOutput, int sampleFrames)
+    {
+        const float* reduced[2] = {leftReduced, rightReduced};
+        float* outputs[2] = {leftOutput, rightOutput};
+        if(stageCount_ == 0)
+        {
+            for(int channel = 0; channel < 2; ++channel)
+            {
+                memcpy(outputs[channel], reduced[channel], sampleFrames * sizeof(float));
+            }
+            return;
+        }
+
+        // Interpolated frames follow the ones held back, the block gets
+        // the first of them and the rest is held back for the next one.
+        int interpolatedFrames = heldFrames_ + reducedFrames * factor_;
+        for(int channel = 0; channel < 2; ++channel)
+        {
+            float* interpolated = interpolated_[channel];
+            if(stageCount_ == 1)
+            {
+                InterpolateStage(0, channel, reduced[channel], reducedFrames, interpolated + heldFrames_);
+            }
+            else
+            {
+                InterpolateStage(1, channel, reduced[channel], reducedFrames, stageSamples_[channel]);
+                InterpolateStage(0, channel, stageSamples_[channel], 2 * reducedFrames, interpolated + heldFrames_);
+            }
+            memcpy(outputs[channel], interpolated, sampleFrames * sizeof(float));
+            memmove(interpolated, interpolated + sampleFrames, (interpolatedFrames - sampleFrames) * sizeof(float));
+        }
+        heldFrames_ = interpolatedFrames - sampleFrames;
+    }
+
+    /**
+     * Halves the rate of one channel by a stage of the half-band filter.
+     * @param stage an index of the stage, 0 for the one at the full rate.
+     * @param channel an index of the channel.
+     * @param input an array of the samples at the higher rate.
+     * @param inputFrames number of the samples.
+     * @param output where to store the samples at the halved rate.
+     * @return number of the stored samples.
+     */
+    int PingPongDelayResampler::DecimateStage(int stage, int channel, const float* input, int inputFrames,
+                                              float* output)
+    {
+        // Pairs of the samples are split into the early and the late ones
+        // following their history, each output sample is centered on an early
+        // one, while only the late ones get the side coefficients.
+        float* early = decimatorEarly_[stage][channel];
+        float* late = decimatorLate_[stage][channel];
+        int pending = decimatorPending_[stage];
+        int outputFrames = (pending + inputFrames) / 2;
+        const float* pairs = input - pending;
+        int frame = 0;
+        if(pending > 0 && outputFrames > 0)
+        {
+            early[earlyHistory_] = decimatorHeld_[stage][channel];
+            late[lateHistory_] = input[0];
+            frame = 1;
+        }
+        for(; frame < outputFrames; ++frame)
+        {
+            early[earlyHistory_ + frame] = pairs[2 * frame];
+            late[lateHistory_ + frame] = pairs[2 * frame + 1];
+        }
+        if((pending + inputFrames) % 2 > 0)
+        {
+            decimatorHeld_[stage][channel] = input[inputFrames - 1];
+        }
+
+        // Frames are filtered in independent lanes, which lets the compiler
+        // keep them in vector registers through the loop.
+        int groupedFrames = outputFrames - (outputFrames % laneCount_);
+        for(frame = 0; frame < groupedFrames; frame += laneCount_)
+        {
+            float sums[laneCount_];
+            for(int lane = 0; lane < laneCount_; ++lane)
+            {
+                sums[lane] = 0.5f * early[frame + lane];
+            }
+            for(int pair = 0; pair < halfBandPairCount; ++pair)
+            {
+                const float* newer = late + halfBandPairCount + pair + frame;
+                const float* older = late + halfBandPairCount - 1 - pair + frame;
+                for(int lane = 0; lane < laneCount_; ++lane)
+                {
+                    sums[lane] += halfBandCoefficients_[pair] * (newer[lane] + older[lane]);
+                }
+            }
+            for(int lane = 0; lane < laneCount_; ++lane)
+            {
+                output[frame + lane] = sums[lane];
+            }
+        }
+        for(; frame < outputFrames; ++frame)
+        {
+            float sum = 0.5f * early[frame];
+            for(int pair = 0; pair < halfBandPairCount; ++pair)
+            {
+                sum += halfBandCoefficients_[pair] * (late[halfBandPairCount + pair + frame] +
+                                                      late[halfBandPairCount - 1 - pair + frame]);
+            }
+            output[frame] = sum;
+        }
+        memmove(early, early + outputFrames, earlyHistory_ * sizeof(float));
+        memmove(late, late + outputFrames, lateHistory_ * sizeof(float));
+        decimatorPending_[stage] = (pending + inputFrames) % 2;
+        return outputFrames;
+    }
+
+    /**
+     * Doubles the rate of one channel by a stage of the half-band filter,
+     * storing two samples for each given one.
+     * @param stage an index of the stage, 0 for the one at the full rate.
+     * @param channel an index of the channel.
+     * @param input an array of the samples at the lower rate.
+     * @param inputFrames number of the samples.
+     * @param output where to store the samples at the doubled rate.
+     */
+    void PingPongDelayResampler::InterpolateStage(int stage, int channel, const float* input, int inputFrames,
+                                                  float* output)
+    {
+        // Samples follow the history, of the two output samples of each one
+        // the first is halfway between the two in the middle of the filter
+        // and the second is the later one of them. Frames are filtered
+        // in independent lanes, which lets the compiler keep them in vector
+        // registers through the loop.
+        float* samples = interpolatorInputs_[stage][channel];
+        memcpy(samples + interpolatorHistory_, input, inputFrames * sizeof(float));
+        const float* center = samples + halfBandPairCount;
+        int groupedFrames = inputFrames - (inputFrames % laneCount_);
+        int frame = 0;
+        for(; frame < groupedFrames; frame += laneCount_)
+        {
+            float sums[laneCount_];
+            for(int lane = 0; lane < laneCount_; ++lane)
+            {
+                sums[lane] = 0.0f;
+            }
+            for(int pair = 0; pair < halfBandPairCount; ++pair)
+            {
+                const float* newer = center + pair + frame;
+                const float* older = center - 1 - pair + frame;
+                for(int lane = 0; lane < laneCount_; ++lane)
+                {
+                    sums[lane] += halfBandCoefficients_[pair] * (newer[lane] + older[lane]);
+                }
+            }
+            for(int lane = 0; lane < laneCount_; ++lane)
+            {
+                output[2 * (frame + lane)] = 2.0f * sums[lane];
+                output[2 * (frame + lane) + 1] = center[frame + lane];
+            }
+        }
+        for(; frame < inputFrames; ++frame)
+        {
+            float sum = 0.0f;
+            for(int pair = 0; pair < halfBandPairCount; ++pair)
+            {
+                sum += halfBandCoefficients_[pair] * (center[pair + frame] + center[-1 - pair + frame]);
+            }
+            output[2 * frame] = 2.0f * sum;
+            output[2 * frame + 1] = center[frame];
+        }
+        memmove(samples, samples + inputFrames, interpolatorHistory_ * sizeof(float));
+    }
+}
@@ -0,0 +1,245 @@
+/**
+ * PingPongDelayResampler.h:
+ *
+ * Declaration of PingPongDelayResampler class decimating a stereo sample
+ * stream to an integer fraction of its rate and interpolating it back.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayResampler
+ */
+
+
+#ifndef PINGPONGDELAYRESAMPLER_H
+#define PINGPONGDELAYRESAMPLER_H
+
+
+namespace PingPongDelay
+{
+    /**
+     * Maximal factor, by which PingPongDelayResampler reduces the rate.
+     *
+     * @see PingPongDelayResampler
+     */
+    const int maxResamplingFactor = 4;
+
+    /**
+     * Maximal number of reduced frames PingPongDelayResampler decimates
+     * or interpolates at once.
+     *
+     * @see PingPongDelayResampler
+     */
+    const int maxResampledFrames = 256;
+
+    /**
+     * Maximal number of the half-band stages of PingPongDelayResampler,
+     * each of them halving the rate.
+     *
+     * @see PingPongDelayResampler
+     */
+    const int maxResamplingStages = 2;
+
+    /**
+     * Number of the pairs of nonzero side coefficients of the half-band
+     * filter of PingPongDelayResampler.
+     *
+     * @see PingPongDelayResampler
+     */
+    const int halfBandPairCount = 4;
+
+
+    /**
+     * Resampler decimating a stereo sample stream to the rate reduced
+     * by a factor of 2 or 4 and interpolating the reduced stream back
+     * to the full rate. Each factor of 2 is a stage of a short half-band
+     * FIR filter of 15 taps, only the center one and 4 symmetric pairs
+     * of which are not zero. The stages are polyphase, the decimator
+     * computes only the kept frames and the interpolator only its nonzero
+     * products, so that a stage costs about 2.5 multiplications per frame
+     * of its higher rate in each direction. The filter passes up to 0.15
+     * of the higher rate within 0.02 dB and stops the band folding back
+     * onto it by 53 dB.
+     *
+     * Reduced frames are produced once all the full rate frames they
+     * are decimated from are given, so the blocks need not be multiples
+     * of the factor. The interpolated stream is held back by factor - 1
+     * frames, so that each block gets all its full rate frames.
+     */
+    class PingPongDelayResampler
+    {
+    public:
+        /**
+         * A constructor. The rate is not reduced until SetFactor is called.
+         */
+        PingPongDelayResampler();
+
+        /**
+         * Sets the factor by which the rate is reduced and resets
+         * the resampler. Neither allocates nor locks.
+         * @param factor a factor of 1, 2 or maxResamplingFactor.
+         */
+        void SetFactor(int factor);
+
+        /**
+         * Gets the factor by which the rate is reduced.
+         * @return factor of the rate.
+         */
+        int GetFactor();
+
+        /**
+         * Gets the number of full rate frames the round trip through
+         * the reduced rate lags by.
+         * @return lag of the round trip in frames.
+         */
+        int GetLatency();
+
+        /**
+         * Clears the filters as if both streams were silent.
+         */
+        void Reset();
+
+        /**
+         * Decimates the next block of the full rate stream.
+         * @param leftInput an array of left channel samples.
+         * @param rightInput an array of right channel samples.
+         * @param leftReduced where to store the reduced left channel samples.
+         * @param rightReduced where to store the reduced right channel samples.
+         * @param sampleFrames number of samples of each channel, at most
+         *      maxResampledFrames times the factor.
+         * @return number of the reduced samples of each channel.
+         */
+        int Decimate(const float* leftInput, const float* rightInput, float* leftReduced, float* rightReduced,
+                     int sampleFrames);
+
+        /**
+         * Interpolates the next block of the reduced stream back to the full
+         * rate. Must follow Decimate of the block with the same number
+         * of frames.
+         * @param leftReduced an array of reduced left channel samples.
+         * @param rightReduced an array of reduced right channel samples.
+         * @param reducedFrames number of the reduced samples returned
+         *      by Decimate.
+         * @param leftOutput where to store the left channel samples.
+         * @param rightOutput where to store the right channel samples.
+         * @param sampleFrames number of samples of each channel given
+         *      to Decimate.
+         */
+        void Interpolate(const float* leftReduced, const float* rightReduced, int reducedFrames, float* leftOutput,
+                         float* rightOutput, int sampleFrames);
+
+    private:
+        /**
+         * Halves the rate of one channel by a stage of the half-band filter.
+         * @param stage an index of the stage, 0 for the one at the full rate.
+         * @param channel an index of the channel.
+         * @param input an array of the samples at the higher rate.
+         * @param inputFrames number of the samples.
+         * @param output where to store the samples at the halved rate.
+         * @return number of the stored samples.
+         */
+        int DecimateStage(int stage, int channel, const float* input, int inputFrames, float* output);
+
+        /**
+         * Doubles the rate of one channel by a stage of the half-band filter,
+         * storing two samples for each given one.
+         * @param stage an index of the stage, 0 for the one at the full rate.
+         * @param channel an index of the channel.
+         * @param input an array of the samples at the lower rate.
+         * @param inputFrames number of the samples.
+         * @param output where to store the samples at the doubled rate.
+         */
+        void InterpolateStage(int stage, int channel, const float* input, int inputFrames, float* output);
+
+
+        /**
+         * Number of the late samples of the pairs the decimating stage
+         * keeps from the previous blocks.
+         */
+        static const int lateHistory_ = 2 * halfBandPairCount - 1;
+
+        /**
+         * Number of the early samples of the pairs the decimating stage
+         * keeps from the previous blocks.
+         */
+        static const int earlyHistory_ = halfBandPairCount - 1;
+
+        /**
+         * Number of lanes the frames are filtered in, so that the filters
+         * vectorize.
+         */
+        static const int laneCount_ = 4;
+
+        /**
+         * Number of the samples at the lower rate the interpolating stage
+         * keeps from the previous blocks.
+         */
+        static const int interpolatorHistory_ = 2 * halfBandPairCount - 1;
+
+        /**
+         * Side coefficients of the half-band filter, the first one
+         * of the pair nearest to the center, whose coefficient is one half.
+         */
+        static const float halfBandCoefficients_[halfBandPairCount];
+
+        /**
+         * Factor by which the rate is reduced.
+         */
+        int factor_;
+
+        /**
+         * Number of the half-band stages, one for each factor of 2.
+         */
+        int stageCount_;
+
+        /**
+         * Number of samples each decimating stage was given since its last
+         * output sample, 0 or 1.
+         */
+        int decimatorPending_[maxResamplingStages];
+
+        /**
+         * Sample each decimating stage and channel was given since its last
+         * output sample, if any.
+         */
+        float decimatorHeld_[maxResamplingStages][2];
+
+        /**
+         * Early samples of the pairs of each decimating stage and channel,
+         * the history of the previous blocks followed by the current ones.
+         */
+        float decimatorEarly_[maxResamplingStages][2][earlyHistory_ + maxResamplingFactor / 2 * maxResampledFrames];
+
+        /**
+         * Late samples of the pairs of each decimating stage and channel,
+         * the history of the previous blocks followed by the current ones.
+         */
+        float decimatorLate_[maxResamplingStages][2][lateHistory_ + maxResamplingFactor / 2 * maxResampledFrames];
+
+        /**
+         * Samples of each interpolating stage and channel, the history
+         * of the previous blocks followed by the current ones.
+         */
+        float interpolatorInputs_[maxResamplingStages][2][interpolatorHistory_ + maxResamplingFactor / 2 * maxResampledFrames];
+
+        /**
+         * Samples of each channel at the rate between the stages.
+         */
+        float stageSamples_[2][maxResamplingFactor / 2 * maxResampledFrames];
+
+        /**
+         * Interpolated samples of each channel held back for the next
+         * block followed by the ones of the current block.
+         */
+        float interpolated_[2][maxResamplingFactor - 1 + maxResamplingFactor * maxResampledFrames];
+
+        /**
+         * Number of the interpolated samples held back for the next block.
+         */
+        int heldFrames_;
+    };
+}
+
+
+#endif
@@ -0,0 +1,324 @@
+/**
+ * PingPongDelayStats.cpp:
+ *
+ * Implementation of PingPongDelayStatsPublisher class publishing counters
+ * of one effect instance into the POSIX shared memory segment of its
+ * process and of functions reading the segment.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayStatsPublisher
+ */
+
+
+#if defined(PINGPONGDELAY_STATS) && defined(__unix__)
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#ifndef PINGPONGDELAYSTATS_H
+#include "PingPongDelayStats.h"
+#endif
+
+
+namespace PingPongDelay
+{
+    /**
+     * Prefix of the shared memory segment names. Each process hosting
+     * PingPongDelayEffect instances creates segment named by the prefix
+     * followed by its pid.
+     */
+    const char* statsSegmentPrefix = "/PingPongDelayStats.";
+
+    /**
+     * Ratio of real time duration of the block, processing
+     * over which is considered risking the xrun.
+     */
+    const double PingPongDelayStatsPublisher::budgetRatio_ = 0.5;
+
+    /**
+     * Mapped segment of the process, NULL if there is no publisher.
+     */
+    PingPongDelayStatsSegment* PingPongDelayStatsPublisher::segment_ = NULL;
+
+    /**
+     * Number of publishers attached to the segment of the process.
+     */
+    int PingPongDelayStatsPublisher::publisherCount_ = 0;
+
+    /**
+     * Guards the segment_ and publisherCount_ and claiming the slots.
+     */
+    std::mutex PingPongDelayStatsPublisher::segmentMutex_;
+
+
+    /**
+     * Reads the consistent copy of the counters of a slot. Never blocks
+     * the writer, it retries while the slot is being written.
+     * @param slot a slot to read.
+     * @param record where to store the copy.
+     * @return true if the slot is in use, false otherwise.
+     */
+    bool ReadStatsSlot(const PingPongDelayStatsSlot& slot, PingPongDelayStatsRecord& record)
+    {
+        if(!slot.inUse.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        unsigned int sequence;
+        do
+        {
+            // Odd sequence means the writer is in the middle of writing.
+            sequence = slot.sequence.load(std::memory_order_acquire);
+            if(sequence & 1)
+            {
+                continue;
+            }
+            record.blocks = slot.blocks.load(std::memory_order_relaxed);
+            record.frames = slot.frames.load(std::memory_order_relaxed);
+            record.processNs = slot.processNs.load(std::memory_order_relaxed);
+            record.overBudgetBlocks = slot.overBudgetBlocks.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        while((sequence & 1) || sequence != slot.sequence.load(std::memory_order_relaxed));
+
+        record.bufferBytes = slot.bufferBytes.load(std::memory_order_relaxed);
+        record.createdNs = slot.createdNs.load(std::memory_order_relaxed);
+        record.suspendedNs = slot.suspendedNs.load(std::memory_order_relaxed);
+        record.suspendedSinceNs = slot.suspendedSinceNs.load(std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Reads the monotonic clock used by the statistics.
+     * @return monotonic time in nanoseconds.
+     */
+    unsigned long long StatsNow()
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+    }
+
+
+    /**
+     * A constructor. Claims a slot, must not be called from
+     * the audio thread.
+     */
+    PingPongDelayStatsPublisher::PingPongDelayStatsPublisher() :
+        slot_(NULL),
+        blockStart_(0),
+        blocks_(0),
+        frames_(0),
+        processNs_(0),
+        overBudgetBlocks_(0)
+    {
+        std::lock_guard<std::mutex> lock(segmentMutex_);
+        if(!AttachSegment())
+        {
+            return;
+        }
+
+        for(int i = 0; i < statsSlotCount; ++i)
+        {
+            PingPongDelayStatsSlot& slot = segment_->slots[i];
+            if(!slot.inUse.load(std::memory_order_relaxed))
+            {
+                // Clearing the counters left by the previous owner before
+                // readers can see the slot in use.
+                slot.sequence.store(0, std::memory_order_relaxed);
+                slot.blocks.store(0, std::memory_order_relaxed);
+                slot.frames.store(0, std::memory_order_relaxed);
+                slot.processNs.store(0, std::memory_order_relaxed);
+                slot.overBudgetBlocks.store(0, std::memory_order_relaxed);
+                slot.bufferBytes.store(0, std::memory_order_relaxed);
+                slot.createdNs.store(StatsNow(), std::memory_order_relaxed);
+                slot.suspendedNs.store(0, std::memory_order_relaxed);
+                slot.suspendedSinceNs.store(0, std::memory_order_relaxed);
+                slot.inUse.store(1, std::memory_order_release);
+                slot_ = &slot;
+                return;
+            }
+        }
+
+        // No free slot, publishing nothing.
+        DetachSegment();
+    }
+
+    /**
+     * A destructor. Releases the slot, must not be called from
+     * the audio thread.
+     */
+    PingPongDelayStatsPublisher::~PingPongDelayStatsPublisher()
+    {
+        if(!slot_)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(segmentMutex_);
+        slot_->inUse.store(0, std::memory_order_release);
+        slot_ = NULL;
+        DetachSegment();
+    }
+
+    /**
+     * Marks the beginning of a processed block. Must be called
+     * from the audio thread only.
+     */
+    void PingPongDelayStatsPublisher::BeginBlock()
+    {
+        if(slot_)
+        {
+            blockStart_ = StatsNow();
+        }
+    }
+
+    /**
+     * Marks the end of a processed block and publishes the block
+     * counters. Must be called from the audio thread only.
+     * @param sampleFrames number of frames processed in the block.
+     * @param sampleRate a sample rate the block is processed at.
+     */
+    void PingPongDelayStatsPublisher::EndBlock(int sampleFrames, float sampleRate)
+    {
+        if(!slot_)
+        {
+            return;
+        }
+
+        unsigned long long blockNs = StatsNow() - blockStart_;
+        ++blocks_;
+        frames_ += sampleFrames;
+        processNs_ += blockNs;
+        if(sampleRate > 0 && blockNs > budgetRatio_ * 1e9 * sampleFrames / sampleRate)
+        {
+            ++overBudgetBlocks_;
+        }
+
+        // Seqlock writing, the odd sequence makes readers retry.
+        unsigned int sequence = slot_->sequence.load(std::memory_order_relaxed);
+        slot_->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot_->blocks.store(blocks_, std::memory_order_relaxed);
+        slot_->frames.store(frames_, std::memory_order_relaxed);
+        slot_->processNs.store(processNs_, std::memory_order_relaxed);
+        slot_->overBudgetBlocks.store(overBudgetBlocks_, std::memory_order_relaxed);
+        slot_->sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * Publishes the suspension state of the instance. Must be called
+     * from the host thread only.
+     * @param suspended true when the instance is being suspended, false
+     *      when it is being resumed.
+     */
+    void PingPongDelayStatsPublisher::SetSuspended(bool suspended)
+    {
+        if(!slot_)
+        {
+            return;
+        }
+
+        unsigned long long since = slot_->suspendedSinceNs.load(std::memory_order_relaxed);
+        if(suspended && since == 0)
+        {
+            slot_->suspendedSinceNs.store(StatsNow(), std::memory_order_relaxed);
+        }
+        else if(!suspended && since != 0)
+        {
+            unsigned long long suspendedNs = slot_->suspendedNs.load(std::memory_order_relaxed);
+            slot_->suspendedNs.store(suspendedNs + (StatsNow() - since), std::memory_order_relaxed);
+            slot_->suspendedSinceNs.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Publishes the memory of the delay buffers.
+     * @param bytes memory of the delay buffers in bytes.
+     */
+    void PingPongDelayStatsPublisher::SetBufferBytes(unsigned long long bytes)
+    {
+        if(slot_)
+        {
+            slot_->bufferBytes.store(bytes, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Maps the segment of the process, creating it if this is the first
+     * publisher. Must be called with segmentMutex_ locked.
+     * @return true if the segment is mapped, false otherwise.
+     */
+    bool PingPongDelayStatsPublisher::AttachSegment()
+    {
+        if(segment_)
+        {
+            ++publisherCount_;
+            return true;
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "%s%d", statsSegmentPrefix, (int)getpid());
+        // Segment of a crashed process of the same pid may be left behind,
+        // it is removed so that the created one is always fresh.
+        shm_unlink(name);
+        int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+        if(fd < 0)
+        {
+            return false;
+        }
+        if(ftruncate(fd, sizeof(PingPongDelayStatsSegment)) != 0)
+        {
+            close(fd);
+            shm_unlink(name);
+            return false;
+        }
+        void* memory = mmap(NULL, sizeof(PingPongDelayStatsSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if(memory == MAP_FAILED)
+        {
+            shm_unlink(name);
+            return false;
+        }
+
+        // Fresh segment is zero filled, so all the slots are free. Magic
+        // is written last, readers ignore the segment until then.
+        segment_ = (PingPongDelayStatsSegment*)memory;
+        segment_->version = statsSegmentVersion;
+        segment_->pid = (int)getpid();
+        segment_->slotCount = statsSlotCount;
+        std::atomic_thread_fence(std::memory_order_release);
+        segment_->magic = statsSegmentMagic;
+        publisherCount_ = 1;
+        return true;
+    }
+
+    /**
+     * Unmaps the segment of the process, removing it if this is the last
+     * publisher. Must be called with segmentMutex_ locked.
+     */
+    void PingPongDelayStatsPublisher::DetachSegment()
+    {
+        if(--publisherCount_ > 0)
+        {
+            return;
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "%s%d", statsSegmentPrefix, (int)getpid());
+        shm_unlink(name);
+        munmap(segment_, sizeof(PingPongDelayStatsSegment));
+        segment_ = NULL;
+    }
+}
+
+
+#endif
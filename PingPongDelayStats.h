@@ -0,0 +1,314 @@
+/**
+ * PingPongDelayStats.h:
+ *
+ * Declaration of PingPongDelayStatsSlot and PingPongDelayStatsSegment
+ * structures describing the layout of POSIX shared memory segment
+ * through which running PingPongDelayEffect instances publish their
+ * counters.
+ *
+ * Declaration of PingPongDelayStatsRecord structure holding a consistent
+ * copy of one slot.
+ *
+ * Declaration of PingPongDelayStatsPublisher class publishing counters
+ * of one effect instance into the segment of its process.
+ *
+ * Whole statistics are compiled only when PINGPONGDELAY_STATS is
+ * defined on a POSIX system, otherwise this header declares nothing.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayStatsPublisher
+ * @see PingPongDelayStatsSegment
+ */
+
+
+#if defined(PINGPONGDELAY_STATS) && defined(__unix__)
+
+#include <atomic>
+#include <mutex>
+
+#ifndef PINGPONGDELAYSTATS_H
+#define PINGPONGDELAYSTATS_H
+
+
+namespace PingPongDelay
+{
+    /**
+     * Prefix of the shared memory segment names. Each process hosting
+     * PingPongDelayEffect instances creates segment named by the prefix
+     * followed by its pid.
+     */
+    extern const char* statsSegmentPrefix;
+
+    /**
+     * Magic number identifying the shared memory segment ("PPDS").
+     */
+    const unsigned int statsSegmentMagic = 0x50504453;
+
+    /**
+     * Version of the layout of the shared memory segment.
+     */
+    const unsigned int statsSegmentVersion = 1;
+
+    /**
+     * Number of instance slots in the segment of one process.
+     */
+    const int statsSlotCount = 256;
+
+
+    /**
+     * One instance slot of the shared memory segment. Block counters are
+     * written only by the audio thread of the instance and guarded by the
+     * sequence number working as a seqlock, so that readers never block
+     * the writer. Suspension counters are written only by the host thread
+     * and are read as individual values.
+     */
+    struct PingPongDelayStatsSlot
+    {
+        /**
+         * Non zero while the slot is owned by an instance.
+         */
+        std::atomic<unsigned int> inUse;
+
+        /**
+         * Seqlock sequence number, odd while the block counters are
+         * being written.
+         */
+        std::atomic<unsigned int> sequence;
+
+        /**
+         * Number of processed blocks.
+         */
+        std::atomic<unsigned long long> blocks;
+
+        /**
+         * Number of processed frames.
+         */
+        std::atomic<unsigned long long> frames;
+
+        /**
+         * Time spent processing the blocks in nanoseconds.
+         */
+        std::atomic<unsigned long long> processNs;
+
+        /**
+         * Number of blocks whose processing took longer than
+         * statsBudgetRatio of their real time duration.
+         */
+        std::atomic<unsigned long long> overBudgetBlocks;
+
+        /**
+         * Memory of the delay buffers in bytes.
+         */
+        std::atomic<unsigned long long> bufferBytes;
+
+        /**
+         * Monotonic time of the instance creation in nanoseconds.
+         */
+        std::atomic<unsigned long long> createdNs;
+
+        /**
+         * Time spent suspended by the host (sleeping) in nanoseconds,
+         * not including the current suspension.
+         */
+        std::atomic<unsigned long long> suspendedNs;
+
+        /**
+         * Monotonic time of the beginning of the current suspension in
+         * nanoseconds, zero while the instance is resumed.
+         */
+        std::atomic<unsigned long long> suspendedSinceNs;
+    };
+
+
+    /**
+     * Layout of the shared memory segment of one process.
+     */
+    struct PingPongDelayStatsSegment
+    {
+        /**
+         * Magic number, equal to statsSegmentMagic.
+         */
+        unsigned int magic;
+
+        /**
+         * Version of the layout, equal to statsSegmentVersion.
+         */
+        unsigned int version;
+
+        /**
+         * Pid of the process owning the segment.
+         */
+        int pid;
+
+        /**
+         * Number of slots, equal to statsSlotCount.
+         */
+        int slotCount;
+
+        /**
+         * Instance slots.
+         */
+        PingPongDelayStatsSlot slots[statsSlotCount];
+    };
+
+
+    /**
+     * Consistent copy of the counters of one slot.
+     *
+     * @see PingPongDelayStatsSlot
+     */
+    struct PingPongDelayStatsRecord
+    {
+        unsigned long long blocks;
+        unsigned long long frames;
+        unsigned long long processNs;
+        unsigned long long overBudgetBlocks;
+        unsigned long long bufferBytes;
+        unsigned long long createdNs;
+        unsigned long long suspendedNs;
+        unsigned long long suspendedSinceNs;
+    };
+
+
+    /**
+     * Reads the consistent copy of the counters of a slot. Never blocks
+     * the writer, it retries while the slot is being written.
+     * @param slot a slot to read.
+     * @param record where to store the copy.
+     * @return true if the slot is in use, false otherwise.
+     */
+    bool ReadStatsSlot(const PingPongDelayStatsSlot& slot, PingPongDelayStatsRecord& record);
+
+    /**
+     * Reads the monotonic clock used by the statistics.
+     * @return monotonic time in nanoseconds.
+     */
+    unsigned long long StatsNow();
+
+
+    /**
+     * Publisher of counters of one effect instance. It owns one slot
+     * of the shared memory segment of the process, the segment is created
+     * with the first and removed with the last publisher of the process.
+     * If there is no free slot or the segment cannot be created,
+     * the publisher silently publishes nothing.
+     */
+    class PingPongDelayStatsPublisher
+    {
+    public:
+        /**
+         * A constructor. Claims a slot, must not be called from
+         * the audio thread.
+         */
+        PingPongDelayStatsPublisher();
+
+        /**
+         * A destructor. Releases the slot, must not be called from
+         * the audio thread.
+         */
+        ~PingPongDelayStatsPublisher();
+
+        /**
+         * Marks the beginning of a processed block. Must be called
+         * from the audio thread only.
+         */
+        void BeginBlock();
+
+        /**
+         * Marks the end of a processed block and publishes the block
+         * counters. Must be called from the audio thread only.
+         * @param sampleFrames number of frames processed in the block.
+         * @param sampleRate a sample rate the block is processed at.
+         */
+        void EndBlock(int sampleFrames, float sampleRate);
+
+        /**
+         * Publishes the suspension state of the instance. Must be called
+         * from the host thread only.
+         * @param suspended true when the instance is being suspended, false
+         *      when it is being resumed.
+         */
+        void SetSuspended(bool suspended);
+
+        /**
+         * Publishes the memory of the delay buffers.
+         * @param bytes memory of the delay buffers in bytes.
+         */
+        void SetBufferBytes(unsigned long long bytes);
+
+    private:
+        /**
+         * Maps the segment of the process, creating it if this is the first
+         * publisher. Must be called with segmentMutex_ locked.
+         * @return true if the segment is mapped, false otherwise.
+         */
+        static bool AttachSegment();
+
+        /**
+         * Unmaps the segment of the process, removing it if this is the last
+         * publisher. Must be called with segmentMutex_ locked.
+         */
+        static void DetachSegment();
+
+
+        /**
+         * Owned slot of the segment, NULL if none.
+         */
+        PingPongDelayStatsSlot* slot_;
+
+        /**
+         * Monotonic time of the beginning of currently processed block.
+         */
+        unsigned long long blockStart_;
+
+        // Block counters, mirrored to the slot after each block.
+        /**
+         * Number of processed blocks.
+         */
+        unsigned long long blocks_;
+
+        /**
+         * Number of processed frames.
+         */
+        unsigned long long frames_;
+
+        /**
+         * Time spent processing in nanoseconds.
+         */
+        unsigned long long processNs_;
+
+        /**
+         * Number of blocks over budget.
+         */
+        unsigned long long overBudgetBlocks_;
+
+
+        /**
+         * Ratio of real time duration of the block, processing
+         * over which is considered risking the xrun.
+         */
+        static const double budgetRatio_;
+
+        /**
+         * Mapped segment of the process, NULL if there is no publisher.
+         */
+        static PingPongDelayStatsSegment* segment_;
+
+        /**
+         * Number of publishers attached to the segment of the process.
+         */
+        static int publisherCount_;
+
+        /**
+         * Guards the segment_ and publisherCount_ and claiming the slots.
+         */
+        static std::mutex segmentMutex_;
+    };
+}
+
+
+#endif
+#endif
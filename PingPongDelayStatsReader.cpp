@@ -0,0 +1,274 @@
+/**
+ * PingPongDelayStatsReader.cpp:
+ *
+ * Command line tool aggregating counters published by running
+ * PingPongDelayEffect instances into POSIX shared memory segments.
+ *
+ * Usage: PingPongDelayStatsReader [-i seconds] [-n count]
+ *      -i seconds an interval between reports, 1 by default.
+ *      -n count a number of reports, 0 (endless) by default.
+ *
+ * Reader maps the segments read only, so it never touches the audio
+ * threads of the instances.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayStatsPublisher
+ */
+
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <map>
+
+// Reader is useful only with the statistics compiled in.
+#ifndef PINGPONGDELAY_STATS
+#define PINGPONGDELAY_STATS
+#endif
+#include "PingPongDelayStats.h"
+
+
+using namespace PingPongDelay;
+
+
+/**
+ * Aggregated counters of all instances of one process.
+ */
+struct ProcessTotals
+{
+    int instances;
+    unsigned long long blocks;
+    unsigned long long frames;
+    unsigned long long processNs;
+    unsigned long long overBudgetBlocks;
+    unsigned long long bufferBytes;
+    unsigned long long lifetimeNs;
+    unsigned long long suspendedNs;
+};
+
+
+/**
+ * Aggregates the counters of all instances of one process segment.
+ * @param segment a mapped segment.
+ * @param now the current monotonic time in nanoseconds.
+ * @param totals where to store the aggregated counters.
+ */
+void AggregateSegment(const PingPongDelayStatsSegment* segment, unsigned long long now, ProcessTotals& totals)
+{
+    memset(&totals, 0, sizeof(totals));
+    for(int i = 0; i < segment->slotCount && i < statsSlotCount; ++i)
+    {
+        PingPongDelayStatsRecord record;
+        if(!ReadStatsSlot(segment->slots[i], record))
+        {
+            continue;
+        }
+
+        ++totals.instances;
+        totals.blocks += record.blocks;
+        totals.frames += record.frames;
+        totals.processNs += record.processNs;
+        totals.overBudgetBlocks += record.overBudgetBlocks;
+        totals.bufferBytes += record.bufferBytes;
+        totals.lifetimeNs += now - record.createdNs;
+        totals.suspendedNs += record.suspendedNs;
+        if(record.suspendedSinceNs != 0)
+        {
+            totals.suspendedNs += now - record.suspendedSinceNs;
+        }
+    }
+}
+
+/**
+ * Maps the segment read only.
+ * @param name a name of the segment without the leading slash.
+ * @return mapped segment or NULL if it is not a valid segment of
+ *      a running process.
+ */
+const PingPongDelayStatsSegment* MapSegment(const char* name)
+{
+    char path[NAME_MAX + 2];
+    snprintf(path, sizeof(path), "/%s", name);
+    int fd = shm_open(path, O_RDONLY, 0);
+    if(fd < 0)
+    {
+        return NULL;
+    }
+
+    // Segment being created may not be truncated to its size yet,
+    // touching it would raise SIGBUS.
+    struct stat status;
+    if(fstat(fd, &status) != 0 || status.st_size < (off_t)sizeof(PingPongDelayStatsSegment))
+    {
+        close(fd);
+        return NULL;
+    }
+    void* memory = mmap(NULL, sizeof(PingPongDelayStatsSegment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(memory == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    // Segments of crashed processes are left behind, skipping them.
+    const PingPongDelayStatsSegment* segment = (const PingPongDelayStatsSegment*)memory;
+    if(segment->magic != statsSegmentMagic || segment->version != statsSegmentVersion ||
+       (kill(segment->pid, 0) != 0 && errno != EPERM))
+    {
+        munmap(memory, sizeof(PingPongDelayStatsSegment));
+        return NULL;
+    }
+    return segment;
+}
+
+/**
+ * Prints one row of the report.
+ * @param label a label of the row.
+ * @param totals counters of the row.
+ * @param previous counters of the row in the previous report, NULL if none.
+ * @param intervalNs time elapsed from the previous report in nanoseconds.
+ */
+void PrintRow(const char* label, const ProcessTotals& totals, const ProcessTotals* previous, unsigned long long intervalNs)
+{
+    // Load is the ratio of the processing time to the wall time.
+    double load = 0.0;
+    double blockRate = 0.0;
+    if(previous && intervalNs > 0)
+    {
+        load = 100.0 * (double)(totals.processNs - previous->processNs) / intervalNs;
+        blockRate = 1e9 * (double)(totals.blocks - previous->blocks) / intervalNs;
+    }
+    double sleeping = (totals.lifetimeNs > 0) ? (100.0 * totals.suspendedNs / totals.lifetimeNs) : 0.0;
+    double overBudget = (totals.blocks > 0) ? (100.0 * totals.overBudgetBlocks / totals.blocks) : 0.0;
+
+    printf("%-10s %9d %14llu %10.1f %8.2f%% %12llu %7.3f%% %8.1f%% %10.1f\n",
+           label, totals.instances, totals.blocks, blockRate, load,
+           totals.overBudgetBlocks, overBudget, sleeping, totals.bufferBytes / (1024.0 * 1024.0));
+}
+
+/**
+ * Entry point of the reader.
+ * @param argc number of arguments.
+ * @param argv arguments.
+ * @return zero on success.
+ */
+int main(int argc, char* argv[])
+{
+    double interval = 1.0;
+    long count = 0;
+    int option;
+    while((option = getopt(argc, argv, "i:n:")) != -1)
+    {
+        switch(option)
+        {
+            case 'i':
+                interval = atof(optarg);
+                break;
+
+            case 'n':
+                count = atol(optarg);
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-i seconds] [-n count]\n", argv[0]);
+                return 1;
+        }
+    }
+    if(interval <= 0.0)
+    {
+        interval = 1.0;
+    }
+
+    // Segment prefix without the leading slash as listed in /dev/shm.
+    const char* prefix = statsSegmentPrefix + 1;
+    std::map<int, ProcessTotals> previousTotals;
+    unsigned long long previousNow = 0;
+
+    for(long report = 0; count == 0 || report < count; ++report)
+    {
+        if(report > 0)
+        {
+            usleep((useconds_t)(interval * 1e6));
+        }
+
+        DIR* directory = opendir("/dev/shm");
+        if(!directory)
+        {
+            perror("/dev/shm");
+            return 1;
+        }
+
+        unsigned long long now = StatsNow();
+        unsigned long long intervalNs = previousNow ? (now - previousNow) : 0;
+        std::map<int, ProcessTotals> currentTotals;
+        ProcessTotals total;
+        ProcessTotals previousTotal;
+        memset(&total, 0, sizeof(total));
+        memset(&previousTotal, 0, sizeof(previousTotal));
+
+        printf("%-10s %9s %14s %10s %9s %12s %8s %9s %10s\n", "pid", "instances", "blocks",
+               "blocks/s", "load", "over budget", "ratio", "sleeping", "buffer MB");
+
+        struct dirent* entry;
+        while((entry = readdir(directory)) != NULL)
+        {
+            if(strncmp(entry->d_name, prefix, strlen(prefix)) != 0)
+            {
+                continue;
+            }
+            const PingPongDelayStatsSegment* segment = MapSegment(entry->d_name);
+            if(!segment)
+            {
+                continue;
+            }
+
+            ProcessTotals& totals = currentTotals[segment->pid];
+            AggregateSegment(segment, now, totals);
+            std::map<int, ProcessTotals>::const_iterator previous = previousTotals.find(segment->pid);
+            char label[16];
+            snprintf(label, sizeof(label), "%d", segment->pid);
+            PrintRow(label, totals, (previous != previousTotals.end()) ? &previous->second : NULL, intervalNs);
+            munmap((void*)segment, sizeof(PingPongDelayStatsSegment));
+
+            total.instances += totals.instances;
+            total.blocks += totals.blocks;
+            total.frames += totals.frames;
+            total.processNs += totals.processNs;
+            total.overBudgetBlocks += totals.overBudgetBlocks;
+            total.bufferBytes += totals.bufferBytes;
+            total.lifetimeNs += totals.lifetimeNs;
+            total.suspendedNs += totals.suspendedNs;
+            if(previous != previousTotals.end())
+            {
+                previousTotal.blocks += previous->second.blocks;
+                previousTotal.processNs += previous->second.processNs;
+            }
+            else
+            {
+                // Processes appeared since the last report do not count
+                // into the rates of the total.
+                previousTotal.blocks += totals.blocks;
+                previousTotal.processNs += totals.processNs;
+            }
+        }
+        closedir(directory);
+
+        PrintRow("total", total, previousNow ? &previousTotal : NULL, intervalNs);
+        printf("\n");
+        fflush(stdout);
+
+        previousTotals.swap(currentTotals);
+        previousNow = now;
+    }
+    return 0;
+}
@@ -0,0 +1,374 @@
+/**
+ * PingPongDelaySurround.cpp:
+ *
+ * Implementation of PingPongDelaySurroundUnit class template providing
+ * ping pong delay processing of a ring of any number of channels, and
+ * its instances for the common speaker layouts.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelaySurroundUnit
+ */
+
+
+#include <string.h>
+#include <algorithm>
+#include "public.sdk/source/vst2.x/audioeffectx.h"
+
+#ifndef PINGPONGDELAYSURROUND_H
+#include "PingPongDelaySurround.h"
+#endif
+
+
+namespace PingPongDelay
+{
+    /**
+     * Number of frames computed at once, all of them read before
+     * any is written, so that the loops vectorize.
+     */
+    template<int channelCount>
+    const int PingPongDelaySurroundUnit<channelCount>::surroundLaneCount_;
+
+
+    /**
+     * A constructor.
+     * All the parameters are between [0, 1]. The buffer is not allocated
+     * until AllocateBuffers is called.
+     * @param bufferSize a size of the buffer of the delay line, must not
+     *      be lower than RequiredBufferSize of the lowest tempo, so that
+     *      the delayed samples are never the written ones.
+     * @param timeInfo a timeInfo with valid tempo information.
+     * @param delayParam a default delay parameter between [0, 1].
+     * @param feedbackParam a default feedback parameter between [0, 1].
+     * @param panoramaParam a default panorama parameter between [0, 1].
+     * @param wetParam a default wet parameter between [0, 1].
+     * @param syncParam a default synchronization parameter between [0, 1].
+     */
+    template<int channelCount>
+    PingPongDelaySurroundUnit<channelCount>::PingPongDelaySurroundUnit(int bufferSize, VstTimeInfo* timeInfo,
+                                                                       float delayParam, float feedbackParam,
+                                                                       float panoramaParam, float wetParam,
+                                                                       float syncParam) :
+        bufferSize_(bufferSize),
+        settings_(bufferSize, timeInfo, delayParam, feedbackParam, panoramaParam, wetParam, syncParam),
+        bufferCursor_(0),
+        buffer_(NULL)
+    {
+    }
+
+    /**
+     * A destructor.
+     */
+    template<int channelCount>
+    PingPongDelaySurroundUnit<channelCount>::~PingPongDelaySurroundUnit()
+    {
+        if(buffer_)
+        {
+            delete[] buffer_;
+        }
+    }
+
+    /**
+     * Gets the unit holding the settings. Its settings may be changed
+     * between the blocks, or published to it from any thread, processing
+     * it on its own gives no sound, as it has no buffers.
+     * @return unit holding the settings.
+     */
+    template<int channelCount>
+    PingPongDelayUnit& PingPongDelaySurroundUnit<channelCount>::GetUnit()
+    {
+        return settings_;
+    }
+
+    /**
+     * PingPongDelaySurroundUnit block processing method. Output arrays
+     * may be the same as the input ones.
+     * @param inputs arrays of samples for each channel of the ring.
+     * @param outputs where to store the effected samples of each channel.
+     * @param sampleFrames number of samples of each channel.
+     */
+    template<int channelCount>
+    void PingPongDelaySurroundUnit<channelCount>::ProcessBlock(const float* const* inputs, float* const* outputs,
+                                                               int sampleFrames)
+    {
+        // Settings published to the unit take effect from the block
+        // at once, without any crossfade.
+        settings_.TakePublishedSettings();
+
+        // Without buffer the delay line is silent.
+        if(!buffer_)
+        {
+            for(int channel = 0; channel < channelCount; ++channel)
+            {
+                for(int frame = 0; frame < sampleFrames; ++frame)
+                {
+                    outputs[channel][frame] = settings_.wetParamC_ * inputs[channel][frame];
+                }
+            }
+            return;
+        }
+
+        // The delay is constant within the block. Speaker k reads the line
+        // at the k-th distance behind the buffer cursor, the last one
+        // is fed back.
+        int delaySamples = settings_.DelaySamples();
+        int distances[channelCount];
+        for(int speaker = 0; speaker < channelCount; ++speaker)
+        {
+            distances[speaker] = BufferModulo(delaySamples * (speaker + 1));
+        }
+
+        int frame = 0;
+        while(frame < sampleFrames)
+        {
+            // Segment ends before any of the cursors wraps. It is not longer
+            // than the distances either, so that the samples it writes,
+            // at the cursor and where the inputs are added, never overlap
+            // the ones it reads in other frames.
+            int delayedCursors[channelCount];
+            int segmentFrames = std::min(sampleFrames - frame, bufferSize_ - bufferCursor_);
+            for(int speaker = 0; speaker < channelCount; ++speaker)
+            {
+                delayedCursors[speaker] = BufferModulo(bufferCursor_ - distances[speaker]);
+                segmentFrames = std::min(segmentFrames, bufferSize_ - delayedCursors[speaker]);
+                if(distances[speaker] > 0)
+                {
+                    segmentFrames = std::min(segmentFrames, distances[speaker]);
+                }
+            }
+
+            const float* segmentInputs[channelCount];
+            float* segmentOutputs[channelCount];
+            for(int channel = 0; channel < channelCount; ++channel)
+            {
+                segmentInputs[channel] = inputs[channel] + frame;
+                segmentOutputs[channel] = outputs[channel] + frame;
+            }
+            ProcessSegment(segmentInputs, segmentOutputs, segmentFrames, delayedCursors);
+
+            // Moving buffer cursor behind the segment.
+            bufferCursor_ += segmentFrames;
+            if(bufferCursor_ == bufferSize_)
+            {
+                bufferCursor_ = 0;
+            }
+            frame += segmentFrames;
+        }
+    }
+
+    /**
+     * Allocates the buffer, if it is not allocated yet.
+     * @return true if the buffer was allocated, false if it
+     *      already had been.
+     */
+    template<int channelCount>
+    bool PingPongDelaySurroundUnit<channelCount>::AllocateBuffers()
+    {
+        if(buffer_)
+        {
+            return false;
+        }
+
+        buffer_ = new float[bufferSize_];
+        ResetBuffers();
+        return true;
+    }
+
+    /**
+     * Clears the buffer.
+     */
+    template<int channelCount>
+    void PingPongDelaySurroundUnit<channelCount>::ResetBuffers()
+    {
+        // Buffer is cleared whole instead of keeping the watermark
+        // of PingPongDelayUnit, which keeps the check out of the lanes.
+        memset(buffer_, 0, bufferSize_ * sizeof(float));
+        bufferCursor_ = 0;
+    }
+
+    /**
+     * Tells whether the buffer is allocated.
+     * @return true if the buffer is allocated, false otherwise.
+     */
+    template<int channelCount>
+    bool PingPongDelaySurroundUnit<channelCount>::HasBuffers()
+    {
+        return buffer_ != NULL;
+    }
+
+    /**
+     * Gets the memory of the buffer.
+     * @return memory of the buffer in bytes, zero if not allocated.
+     */
+    template<int channelCount>
+    long long PingPongDelaySurroundUnit<channelCount>::GetBufferMemory()
+    {
+        return buffer_ ? ((long long)bufferSize_ * sizeof(float)) : 0;
+    }
+
+    /**
+     * Calculates the smallest buffer size, with which every delay
+     * setting is delayed correctly.
+     * @param sampleRate a sample rate of the processing.
+     * @param tempo the lowest tempo the unit is synchronized to.
+     * @return size of the buffer of the delay line in samples.
+     */
+    template<int channelCount>
+    int PingPongDelaySurroundUnit<channelCount>::RequiredBufferSize(float sampleRate, float tempo)
+    {
+        // Echo fed back after the whole round must stay behind the buffer cursor.
+        return std::max(channelCount * PingPongDelayUnit::MaxDelaySamples(sampleRate, tempo) + 1, 4);
+    }
+
+    /**
+     * Processes a segment of a block, within which none of the buffer
+     * cursors wraps and which reads no samples it writes in an earlier
+     * frame.
+     * @param inputs arrays of samples for each channel of the segment.
+     * @param outputs where to store the effected samples of the segment.
+     * @param sampleFrames number of samples of each channel.
+     * @param delayedCursors buffer indexes delayed once up to channelCount
+     *      times behind the cursor, read by the speakers of the ring.
+     */
+    template<int channelCount>
+    void PingPongDelaySurroundUnit<channelCount>::ProcessSegment(const float* const* inputs, float* const* outputs,
+                                                                 int sampleFrames, const int* delayedCursors)
+    {
+        // Settings are copied, so that the compiler does not have to
+        // reload them after each write to the buffer. Secondary part
+        // of the echoes is spread evenly over the whole ring, keeping
+        // the gain of the echoes present in all the speakers.
+        float feedback = settings_.feedback_;
+        float wet = settings_.wetParam_;
+        float dry = settings_.wetParamC_;
+        float panorama = settings_.panoramaParam_;
+        float panoramaC = settings_.panoramaParamC_;
+        float primary = 1 - 2 * settings_.secondaryPanningQuotient_;
+        float secondary = 2 * settings_.secondaryPanningQuotient_ / channelCount;
+
+        // Speaker k reads the line at delayedCursors[k], where the input
+        // of the speaker k + 1 is added once it is read. The last speaker
+        // reads the samples fed back into the cursor.
+        float* written = buffer_ + bufferCursor_;
+        float* delayed[channelCount];
+        for(int speaker = 0; speaker < channelCount; ++speaker)
+        {
+            delayed[speaker] = buffer_ + delayedCursors[speaker];
+        }
+
+        // Frames are processed in groups of lanes, all the samples of
+        // a group are read before any is written.
+        int frame = 0;
+        int groupedFrames = sampleFrames - (sampleFrames % surroundLaneCount_);
+        for(; frame < groupedFrames; frame += surroundLaneCount_)
+        {
+            // Lanes are the innermost loops, the loops over the speakers
+            // are unrolled around them.
+            float heard[channelCount][surroundLaneCount_];
+            float inputSamples[channelCount][surroundLaneCount_];
+            float sums[surroundLaneCount_];
+            float writtenSamples[surroundLaneCount_];
+            memset(sums, 0, sizeof(sums));
+            for(int speaker = 0; speaker < channelCount; ++speaker)
+            {
+                for(int lane = 0; lane < surroundLaneCount_; ++lane)
+                {
+                    heard[speaker][lane] = delayed[speaker][frame + lane];
+                    inputSamples[speaker][lane] = inputs[speaker][frame + lane];
+                    sums[lane] += heard[speaker][lane];
+                }
+            }
+            for(int lane = 0; lane < surroundLaneCount_; ++lane)
+            {
+                writtenSamples[lane] = (inputSamples[0][lane] + heard[channelCount - 1][lane]) * feedback;
+            }
+
+            // Speaker gets the echo it reads and the one passed to it
+            // by the previous speaker of the ring.
+            float echoes[channelCount][surroundLaneCount_];
+            for(int speaker = 0; speaker < channelCount; ++speaker)
+            {
+                for(int lane = 0; lane < surroundLaneCount_; ++lane)
+                {
+                    echoes[speaker][lane] = primary * heard[speaker][lane] + secondary * sums[lane];
+                }
+            }
+            for(int speaker = 0; speaker < channelCount; ++speaker)
+            {
+                const float* passed = echoes[(speaker + channelCount - 1) % channelCount];
+                for(int lane = 0; lane < surroundLaneCount_; ++lane)
+                {
+                    outputs[speaker][frame + lane] = (dry * inputSamples[speaker][lane]) +
+                        (wet * ((panoramaC * echoes[speaker][lane]) + (panorama * passed[lane])));
+                }
+            }
+
+            for(int lane = 0; lane < surroundLaneCount_; ++lane)
+            {
+                written[frame + lane] = writtenSamples[lane];
+            }
+            for(int speaker = 1; speaker < channelCount; ++speaker)
+            {
+                for(int lane = 0; lane < surroundLaneCount_; ++lane)
+                {
+                    delayed[speaker - 1][frame + lane] = heard[speaker - 1][lane] + inputSamples[speaker][lane] * feedback;
+                }
+            }
+        }
+
+        // Remaining frames are processed one by one.
+        for(; frame < sampleFrames; ++frame)
+        {
+            float heard[channelCount];
+            float inputSamples[channelCount];
+            float sum = 0;
+            for(int speaker = 0; speaker < channelCount; ++speaker)
+            {
+                heard[speaker] = delayed[speaker][frame];
+                inputSamples[speaker] = inputs[speaker][frame];
+                sum += heard[speaker];
+            }
+            float writtenSample = (inputSamples[0] + heard[channelCount - 1]) * feedback;
+
+            float echoes[channelCount];
+            for(int speaker = 0; speaker < channelCount; ++speaker)
+            {
+                echoes[speaker] = primary * heard[speaker] + secondary * sum;
+            }
+            for(int speaker = 0; speaker < channelCount; ++speaker)
+            {
+                float passed = echoes[(speaker + channelCount - 1) % channelCount];
+                outputs[speaker][frame] = (dry * inputSamples[speaker]) + (wet * ((panoramaC * echoes[speaker]) + (panorama * passed)));
+            }
+
+            written[frame] = writtenSample;
+            for(int speaker = 1; speaker < channelCount; ++speaker)
+            {
+                delayed[speaker - 1][frame] = heard[speaker - 1] + inputSamples[speaker] * feedback;
+            }
+        }
+    }
+
+    /**
+     * Proper math modulo arithmetic function for the cursor not
+     * to exceed bounds of the buffer arrays.
+     * @param cursorIndex a buffer index, does not matter if exceeded
+     *   outside from buffer arrays.
+     * @return (cursorIndex) mod (buffer size).
+     */
+    template<int channelCount>
+    int PingPongDelaySurroundUnit<channelCount>::BufferModulo(int cursorIndex)
+    {
+        return (cursorIndex % bufferSize_ + bufferSize_) % bufferSize_;
+    }
+
+
+    // Instances for the rings of the quad, 5.1, 7.1 and 7.1.4 layouts
+    // without the LFE channel.
+    template class PingPongDelaySurroundUnit<4>;
+    template class PingPongDelaySurroundUnit<5>;
+    template class PingPongDelaySurroundUnit<7>;
+    template class PingPongDelaySurroundUnit<11>;
+}
@@ -0,0 +1,182 @@
+/**
+ * PingPongDelaySurround.h:
+ *
+ * Declaration of PingPongDelaySurroundUnit class template providing
+ * ping pong delay processing of a ring of any number of channels.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelaySurroundUnit
+ * @see PingPongDelayUnit
+ */
+
+
+#include "public.sdk/source/vst2.x/audioeffectx.h"
+#include "PingPongDelayUnit.h"
+
+#ifndef PINGPONGDELAYSURROUND_H
+#define PINGPONGDELAYSURROUND_H
+
+
+namespace PingPongDelay
+{
+    /**
+     * Unit providing ping pong delay processing of channels placed in
+     * a ring of speakers, generalizing the ping pong of PingPongDelayUnit
+     * from two channels. All the channels share one delay line holding
+     * a single round of the ring, channelCount delays. Each speaker reads
+     * the line at its own distance, the speaker k at k + 1 delays behind
+     * the cursor, so that each echo passes to the next speaker after every
+     * delay and is fed back into the cursor after the whole round. Input
+     * of the speaker k is added to the line where the speaker k - 1 has just
+     * read it, so that it is first echoed by its own speaker one delay
+     * later. The panorama places each echo between its speaker and
+     * the previous one, the further it is from the center the more of each
+     * echo is spread over the whole ring.
+     *
+     * The number of channels is a template parameter, so that the loops
+     * over the channels are unrolled. The class is instantiated in
+     * PingPongDelaySurround.cpp for 4, 5, 7 and 11 channels, the rings of
+     * the quad, 5.1, 7.1 and 7.1.4 layouts without the LFE channel.
+     *
+     * The unit keeps its settings in PingPongDelayUnit, which never allocates
+     * its buffers. It ignores the taps, the interpolation, the freeze and
+     * the economy of the unit, meters no levels and does not trim its buffer.
+     *
+     * ALERT: Whole class requires correct usage as written
+     * in documentation. It does not make any argument checks
+     * nor it throws any own error,
+     */
+    template<int channelCount>
+    class PingPongDelaySurroundUnit
+    {
+    public:
+        /**
+         * A constructor.
+         * All the parameters are between [0, 1]. The buffer is not allocated
+         * until AllocateBuffers is called.
+         * @param bufferSize a size of the buffer of the delay line, must not
+         *      be lower than RequiredBufferSize of the lowest tempo, so that
+         *      the delayed samples are never the written ones.
+         * @param timeInfo a timeInfo with valid tempo information.
+         * @param delayParam a default delay parameter between [0, 1].
+         * @param feedbackParam a default feedback parameter between [0, 1].
+         * @param panoramaParam a default panorama parameter between [0, 1].
+         * @param wetParam a default wet parameter between [0, 1].
+         * @param syncParam a default synchronization parameter between [0, 1].
+         */
+        PingPongDelaySurroundUnit(int bufferSize, VstTimeInfo* timeInfo, float delayParam, float feedbackParam,
+                                  float panoramaParam, float wetParam, float syncParam);
+
+        /**
+         * A destructor.
+         */
+        ~PingPongDelaySurroundUnit();
+
+        /**
+         * Gets the unit holding the settings. Its settings may be changed
+         * between the blocks, or published to it from any thread, processing
+         * it on its own gives no sound, as it has no buffers.
+         * @return unit holding the settings.
+         */
+        PingPongDelayUnit& GetUnit();
+
+        /**
+         * PingPongDelaySurroundUnit block processing method. Output arrays
+         * may be the same as the input ones.
+         * @param inputs arrays of samples for each channel of the ring.
+         * @param outputs where to store the effected samples of each channel.
+         * @param sampleFrames number of samples of each channel.
+         */
+        void ProcessBlock(const float* const* inputs, float* const* outputs, int sampleFrames);
+
+        /**
+         * Allocates the buffer, if it is not allocated yet.
+         * @return true if the buffer was allocated, false if it
+         *      already had been.
+         */
+        bool AllocateBuffers();
+
+        /**
+         * Clears the buffer.
+         */
+        void ResetBuffers();
+
+        /**
+         * Tells whether the buffer is allocated.
+         * @return true if the buffer is allocated, false otherwise.
+         */
+        bool HasBuffers();
+
+        /**
+         * Gets the memory of the buffer.
+         * @return memory of the buffer in bytes, zero if not allocated.
+         */
+        long long GetBufferMemory();
+
+        /**
+         * Calculates the smallest buffer size, with which every delay
+         * setting is delayed correctly.
+         * @param sampleRate a sample rate of the processing.
+         * @param tempo the lowest tempo the unit is synchronized to.
+         * @return size of the buffer of the delay line in samples.
+         */
+        static int RequiredBufferSize(float sampleRate, float tempo);
+
+    private:
+        /**
+         * Processes a segment of a block, within which none of the buffer
+         * cursors wraps and which reads no samples it writes in an earlier
+         * frame.
+         * @param inputs arrays of samples for each channel of the segment.
+         * @param outputs where to store the effected samples of the segment.
+         * @param sampleFrames number of samples of each channel.
+         * @param delayedCursors buffer indexes delayed once up to channelCount
+         *      times behind the cursor, read by the speakers of the ring.
+         */
+        void ProcessSegment(const float* const* inputs, float* const* outputs, int sampleFrames,
+                            const int* delayedCursors);
+
+        /**
+         * Proper math modulo arithmetic function for the cursor not
+         * to exceed bounds of the buffer arrays.
+         * @param cursorIndex a buffer index, does not matter if exceeded
+         *   outside from buffer arrays.
+         * @return (cursorIndex) mod (buffer size).
+         */
+        int BufferModulo(int cursorIndex);
+
+
+        /**
+         * Size of the buffer of the delay line.
+         */
+        int bufferSize_;
+
+        /**
+         * Unit holding the settings, without buffers.
+         */
+        PingPongDelayUnit settings_;
+
+        /**
+         * Cursor pointing to the sample of the buffer to be written next.
+         */
+        int bufferCursor_;
+
+        /**
+         * Buffer of the delay line shared by all the channels.
+         */
+        float* buffer_;
+
+
+        /**
+         * Number of frames computed at once, all of them read before
+         * any is written, so that the loops vectorize.
+         */
+        static const int surroundLaneCount_ = 8;
+    };
+}
+
+
+#endif
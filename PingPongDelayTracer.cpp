@@ -0,0 +1,346 @@
+/**
+ * PingPongDelayTracer.cpp:
+ *
+ * Implementation of PingPongDelayTracer class recording processing timeline
+ * of one PingPongDelayEffect instance into a lock-free ring, which is drained
+ * by a background thread into Chrome trace JSON file.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayTracer
+ */
+
+
+#ifdef PINGPONGDELAY_TRACING
+
+#include <stdlib.h>
+#include <chrono>
+#include <algorithm>
+#include <string>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#ifndef PINGPONGDELAYTRACER_H
+#include "PingPongDelayTracer.h"
+#endif
+
+
+namespace PingPongDelay
+{
+    /**
+     * Number of cells of the ring, must be a power of two.
+     */
+    const int PingPongDelayTracer::capacity_ = 8192;
+
+    /**
+     * Period of draining in milliseconds.
+     */
+    const int PingPongDelayTracer::drainPeriodMs_ = 50;
+
+    /**
+     * Registered tracers.
+     */
+    std::vector<PingPongDelayTracer*> PingPongDelayTracer::tracers_;
+
+    /**
+     * Guards tracers_, traceFile_ and draining.
+     */
+    std::mutex PingPongDelayTracer::registryMutex_;
+
+    /**
+     * Background thread draining the tracers.
+     */
+    std::thread PingPongDelayTracer::drainThread_;
+
+    /**
+     * Tells the background thread to keep draining.
+     */
+    std::atomic<bool> PingPongDelayTracer::draining_(false);
+
+    /**
+     * Trace file being written, NULL if none.
+     */
+    FILE* PingPongDelayTracer::traceFile_ = NULL;
+
+    /**
+     * Monotonic time the trace timestamps are relative to.
+     */
+    unsigned long long PingPongDelayTracer::traceStartNs_ = 0;
+
+    /**
+     * Identifier of the next created instance.
+     */
+    int PingPongDelayTracer::nextInstanceId_ = 1;
+
+    /**
+     * Number of the next trace file of the process.
+     */
+    int PingPongDelayTracer::nextSessionId_ = 1;
+
+
+    /**
+     * A constructor. Registers the tracer to the background thread,
+     * starting it if this is the first tracer of the process.
+     * Must not be called from the audio thread.
+     */
+    PingPongDelayTracer::PingPongDelayTracer() :
+        cells_(NULL),
+        pushPosition_(0),
+        drainPosition_(0),
+        droppedCount_(0),
+        reportedDroppedCount_(0),
+        instanceId_(0)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex_);
+        if(!traceFile_)
+        {
+            // Tracing is opt-in through the environment.
+            const char* path = getenv("PINGPONGDELAY_TRACE");
+            if(!path || !*path)
+            {
+                return;
+            }
+
+            // Pid and the session number go before the extension, so that
+            // a plugin reloaded by the host does not overwrite its trace.
+            std::string name(path);
+            std::string::size_type baseName = (name.find_last_of("/\\") == std::string::npos) ? 0 :
+                (name.find_last_of("/\\") + 1);
+            std::string::size_type extension = name.find_last_of('.');
+            if(extension == std::string::npos || extension <= baseName)
+            {
+                extension = name.size();
+            }
+            char suffix[32];
+            snprintf(suffix, sizeof(suffix), ".%d.%d", (int)getpid(), nextSessionId_);
+            name.insert(extension, suffix);
+            if(!(traceFile_ = fopen(name.c_str(), "w")))
+            {
+                return;
+            }
+            ++nextSessionId_;
+
+            // Array format of the trace, the closing bracket is optional
+            // so that the trace stays readable even if the host crashes.
+            fputs("[\n", traceFile_);
+            traceStartNs_ = Now();
+            draining_.store(true);
+            drainThread_ = std::thread(DrainLoop);
+        }
+
+        cells_ = new Cell[capacity_];
+        for(int i = 0; i < capacity_; ++i)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        instanceId_ = nextInstanceId_++;
+        fprintf(traceFile_, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+                "\"args\":{\"name\":\"PingPongDelay #%d\"}},\n", (int)getpid(), instanceId_, instanceId_);
+        tracers_.push_back(this);
+    }
+
+    /**
+     * A destructor. Drains and unregisters the tracer, stopping
+     * the background thread and finishing the trace file if this is the last
+     * tracer of the process. Must not be called from the audio thread.
+     */
+    PingPongDelayTracer::~PingPongDelayTracer()
+    {
+        if(!cells_)
+        {
+            return;
+        }
+
+        std::thread stoppedThread;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex_);
+            Drain();
+            tracers_.erase(std::remove(tracers_.begin(), tracers_.end(), this), tracers_.end());
+            if(tracers_.empty())
+            {
+                draining_.store(false);
+                stoppedThread.swap(drainThread_);
+            }
+        }
+
+        // Joining outside of the lock, the thread may be waiting for it.
+        if(stoppedThread.joinable())
+        {
+            stoppedThread.join();
+            std::lock_guard<std::mutex> lock(registryMutex_);
+            if(!tracers_.empty())
+            {
+                // Another tracer was registered meanwhile, keep draining.
+                draining_.store(true);
+                drainThread_ = std::thread(DrainLoop);
+            }
+            else if(traceFile_)
+            {
+                // Instant event with no comma after it closes the array.
+                fprintf(traceFile_, "{\"name\":\"traceEnd\",\"ph\":\"i\",\"s\":\"p\",\"ts\":%.3f,\"pid\":%d,\"tid\":0}\n]\n",
+                        (Now() - traceStartNs_) / 1000.0, (int)getpid());
+                fclose(traceFile_);
+                traceFile_ = NULL;
+            }
+        }
+
+        delete[] cells_;
+        cells_ = NULL;
+    }
+
+    /**
+     * Pushes an event into the ring.
+     * @param type a type of the event.
+     * @param index an event specific index.
+     * @param value an event specific value.
+     */
+    void PingPongDelayTracer::Push(PingPongDelayTraceEventType type, int index, float value)
+    {
+        // Bounded multiple producer ring: the cell is free for writing when
+        // its sequence equals to the position, then the position is claimed.
+        unsigned long long position = pushPosition_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for(;;)
+        {
+            cell = &cells_[position & (capacity_ - 1)];
+            unsigned long long sequence = cell->sequence.load(std::memory_order_acquire);
+            long long difference = (long long)(sequence - position);
+            if(difference == 0)
+            {
+                if(pushPosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if(difference < 0)
+            {
+                // Ring is full, the event is dropped.
+                droppedCount_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            else
+            {
+                position = pushPosition_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->event.timeNs = Now();
+        cell->event.type = type;
+        cell->event.index = index;
+        cell->event.value = value;
+        cell->sequence.store(position + 1, std::memory_order_release);
+    }
+
+    /**
+     * Drains the recorded events into the trace file. Must be called
+     * by one thread at a time, with registryMutex_ locked.
+     */
+    void PingPongDelayTracer::Drain()
+    {
+        for(;;)
+        {
+            Cell& cell = cells_[drainPosition_ & (capacity_ - 1)];
+            if(cell.sequence.load(std::memory_order_acquire) != drainPosition_ + 1)
+            {
+                break;
+            }
+            WriteEvent(cell.event);
+            cell.sequence.store(drainPosition_ + capacity_, std::memory_order_release);
+            ++drainPosition_;
+        }
+
+        unsigned long long droppedCount = droppedCount_.load(std::memory_order_relaxed);
+        if(droppedCount != reportedDroppedCount_)
+        {
+            fprintf(traceFile_, "{\"name\":\"droppedEvents\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,"
+                    "\"args\":{\"count\":%llu}},\n", (Now() - traceStartNs_) / 1000.0, (int)getpid(), instanceId_,
+                    droppedCount - reportedDroppedCount_);
+            reportedDroppedCount_ = droppedCount;
+        }
+    }
+
+    /**
+     * Writes one event into the trace file.
+     * @param event an event to write.
+     */
+    void PingPongDelayTracer::WriteEvent(const PingPongDelayTraceEvent& event)
+    {
+        // Chrome trace timestamps are in microseconds.
+        double timeUs = (event.timeNs - traceStartNs_) / 1000.0;
+        int pid = (int)getpid();
+        switch(event.type)
+        {
+            case ProcessBeginEvent:
+                fprintf(traceFile_, "{\"name\":\"processReplacing\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,"
+                        "\"args\":{\"frames\":%d}},\n", timeUs, pid, instanceId_, event.index);
+                break;
+
+            case ProcessEndEvent:
+                fprintf(traceFile_, "{\"name\":\"processReplacing\",\"ph\":\"E\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d},\n",
+                        timeUs, pid, instanceId_);
+                break;
+
+            case ParameterEvent:
+                fprintf(traceFile_, "{\"name\":\"setParameter\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,"
+                        "\"args\":{\"index\":%d,\"value\":%g}},\n", timeUs, pid, instanceId_, event.index, event.value);
+                break;
+
+            case BufferAllocationEvent:
+                fprintf(traceFile_, "{\"name\":\"bufferAllocation\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,"
+                        "\"args\":{\"bytes\":%.0f}},\n", timeUs, pid, instanceId_, event.value);
+                break;
+
+            case ModeSwitchEvent:
+                fprintf(traceFile_, "{\"name\":\"modeSwitch\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,"
+                        "\"args\":{\"mode\":%d,\"state\":%g}},\n", timeUs, pid, instanceId_, event.index, event.value);
+                break;
+
+            case SuspendEvent:
+                fprintf(traceFile_, "{\"name\":\"suspend\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d},\n",
+                        timeUs, pid, instanceId_);
+                break;
+
+            case ResumeEvent:
+                fprintf(traceFile_, "{\"name\":\"resume\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d},\n",
+                        timeUs, pid, instanceId_);
+                break;
+        }
+    }
+
+    /**
+     * Body of the background thread draining all the tracers.
+     */
+    void PingPongDelayTracer::DrainLoop()
+    {
+        while(draining_.load())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(drainPeriodMs_));
+            std::lock_guard<std::mutex> lock(registryMutex_);
+            for(size_t i = 0; i < tracers_.size(); ++i)
+            {
+                tracers_[i]->Drain();
+            }
+            fflush(traceFile_);
+        }
+    }
+
+    /**
+     * Reads the monotonic clock used by the tracer.
+     * @return monotonic time in nanoseconds.
+     */
+    unsigned long long PingPongDelayTracer::Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+
+#endif
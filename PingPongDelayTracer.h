@@ -0,0 +1,246 @@
+/**
+ * PingPongDelayTracer.h:
+ *
+ * Declaration of PingPongDelayTraceEventType enum and PingPongDelayTraceEvent
+ * structure describing recorded events.
+ *
+ * Declaration of PingPongDelayTracer class recording processing timeline
+ * of one PingPongDelayEffect instance into a lock-free ring, which is drained
+ * by a background thread into Chrome trace JSON file.
+ *
+ * Whole tracer is compiled only when PINGPONGDELAY_TRACING is
+ * defined, otherwise this header declares nothing. Even then tracing is
+ * opt-in, events are recorded only if the environment variable
+ * PINGPONGDELAY_TRACE holds the path of the trace file.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayTracer
+ */
+
+
+#ifdef PINGPONGDELAY_TRACING
+
+#include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef PINGPONGDELAYTRACER_H
+#define PINGPONGDELAYTRACER_H
+
+
+namespace PingPongDelay
+{
+    /**
+     * An enum for types of recorded events.
+     */
+    enum PingPongDelayTraceEventType
+    {
+        ProcessBeginEvent,
+        ProcessEndEvent,
+        ParameterEvent,
+        BufferAllocationEvent,
+        ModeSwitchEvent,
+        SuspendEvent,
+        ResumeEvent,
+    };
+
+
+    /**
+     * One recorded event.
+     */
+    struct PingPongDelayTraceEvent
+    {
+        /**
+         * Monotonic time of the event in nanoseconds.
+         */
+        unsigned long long timeNs;
+
+        /**
+         * Type of the event.
+         */
+        PingPongDelayTraceEventType type;
+
+        /**
+         * Event specific index. Index of the parameter for parameter events,
+         * number of frames for process events.
+         */
+        int index;
+
+        /**
+         * Event specific value. Value of the parameter for parameter events,
+         * bytes for buffer allocation events, new state for mode switches.
+         */
+        float value;
+    };
+
+
+    /**
+     * Tracer of one effect instance. Events may be recorded from any thread,
+     * recording never locks nor allocates. Events not drained in time are
+     * dropped and counted.
+     */
+    class PingPongDelayTracer
+    {
+    public:
+        /**
+         * A constructor. Registers the tracer to the background thread,
+         * starting it if this is the first tracer of the process.
+         * Must not be called from the audio thread.
+         */
+        PingPongDelayTracer();
+
+        /**
+         * A destructor. Drains and unregisters the tracer, stopping
+         * the background thread and finishing the trace file if this is the last
+         * tracer of the process. Must not be called from the audio thread.
+         */
+        ~PingPongDelayTracer();
+
+        /**
+         * Records an event, if tracing is enabled.
+         * @param type a type of the event.
+         * @param index an event specific index.
+         * @param value an event specific value.
+         */
+        inline void Record(PingPongDelayTraceEventType type, int index = 0, float value = 0.0f)
+        {
+            if(cells_)
+            {
+                Push(type, index, value);
+            }
+        }
+
+    private:
+        /**
+         * One cell of the ring. Its sequence tells whether the cell is
+         * free to be written or holds an event to be drained.
+         */
+        struct Cell
+        {
+            std::atomic<unsigned long long> sequence;
+            PingPongDelayTraceEvent event;
+        };
+
+        /**
+         * Pushes an event into the ring.
+         * @param type a type of the event.
+         * @param index an event specific index.
+         * @param value an event specific value.
+         */
+        void Push(PingPongDelayTraceEventType type, int index, float value);
+
+        /**
+         * Drains the recorded events into the trace file. Must be called
+         * by one thread at a time, with registryMutex_ locked.
+         */
+        void Drain();
+
+        /**
+         * Writes one event into the trace file.
+         * @param event an event to write.
+         */
+        void WriteEvent(const PingPongDelayTraceEvent& event);
+
+        /**
+         * Body of the background thread draining all the tracers.
+         */
+        static void DrainLoop();
+
+        /**
+         * Reads the monotonic clock used by the tracer.
+         * @return monotonic time in nanoseconds.
+         */
+        static unsigned long long Now();
+
+
+        /**
+         * Ring of the recorded events, NULL if tracing is disabled.
+         */
+        Cell* cells_;
+
+        /**
+         * Position of the next written event.
+         */
+        std::atomic<unsigned long long> pushPosition_;
+
+        /**
+         * Position of the next drained event.
+         */
+        unsigned long long drainPosition_;
+
+        /**
+         * Number of events dropped because the ring was full.
+         */
+        std::atomic<unsigned long long> droppedCount_;
+
+        /**
+         * Number of dropped events already reported into the trace file.
+         */
+        unsigned long long reportedDroppedCount_;
+
+        /**
+         * Identifier of the instance, used as the thread id of the trace.
+         */
+        int instanceId_;
+
+
+        /**
+         * Number of cells of the ring, must be a power of two.
+         */
+        static const int capacity_;
+
+        /**
+         * Period of draining in milliseconds.
+         */
+        static const int drainPeriodMs_;
+
+        /**
+         * Registered tracers.
+         */
+        static std::vector<PingPongDelayTracer*> tracers_;
+
+        /**
+         * Guards tracers_, traceFile_ and draining.
+         */
+        static std::mutex registryMutex_;
+
+        /**
+         * Background thread draining the tracers.
+         */
+        static std::thread drainThread_;
+
+        /**
+         * Tells the background thread to keep draining.
+         */
+        static std::atomic<bool> draining_;
+
+        /**
+         * Trace file being written, NULL if none.
+         */
+        static FILE* traceFile_;
+
+        /**
+         * Monotonic time the trace timestamps are relative to.
+         */
+        static unsigned long long traceStartNs_;
+
+        /**
+         * Identifier of the next created instance.
+         */
+        static int nextInstanceId_;
+
+        /**
+         * Number of the next trace file of the process.
+         */
+        static int nextSessionId_;
+    };
+}
+
+
+#endif
+#endif
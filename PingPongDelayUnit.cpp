@@ -13,12 +13,18 @@
 
 
 #include <math.h>
+#include <string.h>
+#include <algorithm>
 #include "public.sdk/source/vst2.x/audioeffectx.h"
 
 #ifndef PINGPONGDELAY_H
 #include "PingPongDelayUnit.h"
 #endif
 
+#ifdef PINGPONGDELAY_TRIMMING
+#include "PingPongDelayBufferPool.h"
+#endif
+
 
 namespace PingPongDelay
 {
@@ -57,6 +63,28 @@ namespace PingPongDelay
      */
     const char* PingPongDelayUnit::syncDelayRatioStrings_[syncDelayRatioCount_] = {"1/4", "1/3", "1/2", "2/3", "1", "3/2", "2"};
 
+    /**
+     * Stores the strings of the interpolations in the order
+     * of PingPongDelayInterpolation.
+     */
+    const char* PingPongDelayUnit::interpolationStrings_[InterpolationCount] = {"Off", "Linear", "Hermite", "Allpass"};
+
+    /**
+     * Number of possible economies.
+     */
+    const int PingPongDelayUnit::economyCount_ = 3;
+
+    /**
+     * Stores the strings of the economies, the rates of the delay line
+     * relative to the sample rate.
+     */
+    const char* PingPongDelayUnit::economyStrings_[economyCount_] = {"Off", "1/2", "1/4"};
+
+    /**
+     * Stores the factors of the economies in the order of economyStrings_.
+     */
+    const int PingPongDelayUnit::economyFactors_[economyCount_] = {1, 2, maxResamplingFactor};
+
     // Field representing the bounds of feedback ratio.
     // These constrictions are made due to the protection from
     // output signal clipping.
@@ -70,6 +98,19 @@ namespace PingPongDelay
      */
     const float PingPongDelayUnit::maxFeedback_ = 0.8f;
 
+    // Fields representing the bounds of tap time ratio.
+    /**
+     * Lower bound of possible tap time ratio settings.
+     */
+    const float PingPongDelayUnit::minTapTimeRatio_ = 0.0f;
+
+    /**
+     * Upper bound of possible tap time ratio settings. Taps read
+     * at most as far as the echoes fed back, so that the buffers
+     * are long enough for them.
+     */
+    const float PingPongDelayUnit::maxTapTimeRatio_ = 2.0f;
+
     // Fields representing ratios of time convertions.
     /**
      * Stores how many seconds are in minute.
@@ -81,11 +122,51 @@ namespace PingPongDelay
      */
     const int PingPongDelayUnit::msInS_ = 1000;
 
+    /**
+     * Distance in quarter notes between the expected and the actual
+     * musical position of a block, beyond which the playback is
+     * considered relocated and the delay does not ramp.
+     */
+    const double PingPongDelayUnit::rampPpqTolerance_ = 1.0 / 16.0;
+
+    /**
+     * Length of the crossfade to the published settings, into and out
+     * of the frozen loop and of the seam of the loop in milliseconds.
+     */
+    const int PingPongDelayUnit::fadeMs_ = 20;
+
+    // Fields representing the metering settings.
+    /**
+     * Length of the metering window in milliseconds.
+     */
+    const int PingPongDelayUnit::meterWindowMs_ = 50;
+
+    /**
+     * Number of lanes the levels are accumulated in, so that
+     * the metering vectorizes together with the processing.
+     */
+    const int PingPongDelayUnit::meterLaneCount_;
+
+    /**
+     * Number of frames of a channel computed at once by ProcessChannel
+     * and MixChannels, all of them read before any is written, so that
+     * the loops vectorize.
+     */
+    const int PingPongDelayUnit::channelLaneCount_;
+
+#ifdef PINGPONGDELAY_TRIMMING
+    /**
+     * Level below which samples are considered silent.
+     */
+    const float PingPongDelayUnit::silenceLevel_ = 1e-5f;
+#endif
+
 
     /**
      * A constructor.
      * All the parameters are between [0, 1]. The unit will be set accordingly
      * to the behavior of methods setting the parameters.
+     * The buffers are not allocated until AllocateBuffers is called.
      * @param bufferSize a size of the buffers, must be greater than 3.
      *      It determinates the lower bound of time info tempo of correct
      *      synchronization functionality. The greater bufferSize means
@@ -107,15 +188,54 @@ namespace PingPongDelay
     PingPongDelayUnit::PingPongDelayUnit(int bufferSize, VstTimeInfo* timeInfo, float delayParam, float feedbackParam,
                                          float panoramaParam, float wetParam, float syncParam) :
         bufferSize_(bufferSize),
+        fullBufferSize_(bufferSize),
         timeInfo_(timeInfo),
-        bufferCursor_(0)
+        interpolationParam_(0.0f),
+        interpolation_(NoInterpolation),
+        freezeParam_(0.0f),
+        isFrozen_(false),
+        freezeLength_(0),
+        freezeCursor_(0),
+        freezeOffset_(0),
+        thawLength_(0),
+        thawFrames_(0),
+        economyParam_(0.0f),
+        economy_(0),
+        economyFactor_(1),
+        isReducing_(false),
+        economyDryGain_(0.0f),
+        rampTempo_(0.0),
+        rampPpqPos_(0.0),
+        rampPpqPosValid_(false),
+        publishedSequence_(0),
+        takenSequence_(0),
+        fadeLength_(0),
+        fadeFrames_(0),
+        bufferCursor_(0),
+        leftBuffer_(NULL),
+        rightBuffer_(NULL),
+        writtenFrames_(0),
+        meterFrames_(0)
     {
-        // Allocating buffers.
-        leftBuffer_ = new float[bufferSize];
-        rightBuffer_ = new float[bufferSize];
-        // Inicialize buffers by erasing.
-        memset (leftBuffer_, 0, bufferSize * sizeof (float));
-        memset (rightBuffer_, 0, bufferSize * sizeof (float));
+        // Buffers are allocated later by AllocateBuffers, so that
+        // constructing the unit costs nothing.
+        memset(leftAllpassStates_, 0, sizeof(leftAllpassStates_));
+        memset(rightAllpassStates_, 0, sizeof(rightAllpassStates_));
+        memset(fadingLeftAllpassStates_, 0, sizeof(fadingLeftAllpassStates_));
+        memset(fadingRightAllpassStates_, 0, sizeof(fadingRightAllpassStates_));
+        memset(frozenLeftAllpassStates_, 0, sizeof(frozenLeftAllpassStates_));
+        memset(frozenRightAllpassStates_, 0, sizeof(frozenRightAllpassStates_));
+
+        // Starting the first metering window.
+        memset(meterPeaks_, 0, sizeof(meterPeaks_));
+        memset(meterSums_, 0, sizeof(meterSums_));
+
+#ifdef PINGPONGDELAY_TRIMMING
+        // Trimming is disabled until SetIdleTrimMs is called.
+        bufferState_.store(ActiveBuffers);
+        idleTrimMs_ = 0;
+        silentFrames_ = 0;
+#endif
 
         // Setting the inicial unit settings.
         SetDelayParam(delayParam);
@@ -123,6 +243,19 @@ namespace PingPongDelay
         SetPanoramaParam(panoramaParam);
         SetWetParam(wetParam);
         SetSyncParam(syncParam);
+
+        // Taps are disabled, once enabled they are spread evenly
+        // up to the echo fed back. Gains of a tap are calculated from
+        // both its settings, so these are cleared first.
+        memset(tapGainParams_, 0, sizeof(tapGainParams_));
+        memset(tapPanoramaParams_, 0, sizeof(tapPanoramaParams_));
+        SetTapCountParam(0.0f);
+        for(int tap = 0; tap < maxTapCount; ++tap)
+        {
+            SetTapTimeParam(tap, (float)(tap + 1) / maxTapCount);
+            SetTapGainParam(tap, 0.5f);
+            SetTapPanoramaParam(tap, 0.5f);
+        }
     }
 
     /**
@@ -141,53 +274,562 @@ namespace PingPongDelay
         }
     }
 
+    /**
+     * Sets the time info of the blocks processed from now on, the host
+     * refreshes it before each block. Must be called from the audio
+     * thread or while the unit does not process.
+     * @param timeInfo a timeInfo with valid tempo information, which
+     *      must stay valid until the next call.
+     */
+    void PingPongDelayUnit::SetTimeInfo(VstTimeInfo* timeInfo)
+    {
+        timeInfo_ = timeInfo;
+    }
+
     /**
      * PingPongDelayUnit sample stream processing method.
+     * The frozen delay line is looped and thawed the same way
+     * as by ProcessBlock.
      * @param input a next sample in stream of stereo samples to be processed by unit.
      * @return effected input stereo sample.
      */
     StereoSample PingPongDelayUnit::GetSample(StereoSample input)
     {
-        // Calculating a number of samples for delay.
-        int delaySamples;
-        if(IsAsync())
+#ifdef PINGPONGDELAY_TRIMMING
+        // While the buffers are trimmed the delay line is silent.
+        if(!ProvideBuffers(&input.first, &input.second, 1))
         {
-            // Setting the asynchronous pre-calculated delay as the delay
-            // in case that unit is asynchronous.
-            float msSamples = (timeInfo_->sampleRate / msInS_);
-            delaySamples = (int)(asyncDelayMs_ * msSamples);
+            return StereoSample(wetParamC_ * input.first, wetParamC_ * input.second);
         }
-        else
+#endif
+
+        // Without buffers the delay line is silent.
+        if(!leftBuffer_)
+        {
+            return StereoSample(wetParamC_ * input.first, wetParamC_ * input.second);
+        }
+
+        // Frozen delay line loops until it is thawed, the same way as
+        // in ProcessBlock. The frames reading the loop are metered there,
+        // so they are accounted into the metering window as well.
+        if(isFrozen_ && freezeLength_ == 0 && fadeFrames_ == 0)
+        {
+            StartFreeze();
+        }
+        if(freezeLength_ > 0 && thawFrames_ == 0 && !isFrozen_)
+        {
+            StartThaw();
+        }
+        if(freezeLength_ > 0)
         {
-            // Calculating delay as number of samples in case that unit is
-            // synchronized to the tempo setting.
-            float beatsPerSec = timeInfo_->tempo / sInMin_;
-            float samplesPerBeat = timeInfo_->sampleRate / beatsPerSec;
-            delaySamples = (int)(samplesPerBeat * syncDelayRatios_[syncDelayRatioIndex_]);
+            StereoSample output;
+            if(thawFrames_ > 0)
+            {
+                ProcessThawingFrames(&input.first, &input.second, &output.first, &output.second, 1);
+            }
+            else
+            {
+                ProcessFrozenBlock(&input.first, &input.second, &output.first, &output.second, 1);
+            }
+            AccountMeterFrames(1);
+            return output;
         }
 
+        // Interpolated read heads read the delay line between its samples.
+        int interpolation = interpolation_;
+        if(interpolation != NoInterpolation)
+        {
+            PingPongDelayReadHead heads[2];
+            PlaceReadHeads(heads, interpolation);
+            int delaySamples = DelaySamples();
+            int tapCount = tapCount_;
+            int tapDistances[maxTapCount];
+            for(int tap = 0; tap < tapCount; ++tap)
+            {
+                tapDistances[tap] = TapDistance(tap, delaySamples);
+            }
+
+            StereoSample output;
+            ProcessInterpolatedFrame(input.first, input.second, output.first, output.second,
+                                     heads, interpolation, tapCount, tapDistances);
+            return output;
+        }
+
+        // Calculating a number of samples for delay.
+        int delaySamples = DelaySamples();
+
         // Getting semi and full delayed cursors through BufferModulo method.
         int semiDelayedCursor = BufferModulo(bufferCursor_ - delaySamples);
         int fullDelayedCursor = BufferModulo(bufferCursor_ - (delaySamples * 2));
 
+        // Getting the cursors of the taps.
+        int tapCount = tapCount_;
+        int tapCursors[maxTapCount];
+        for(int tap = 0; tap < tapCount; ++tap)
+        {
+            int tapDistance = TapDistance(tap, delaySamples);
+            tapCursors[tap] = BufferModulo(bufferCursor_ - tapDistance);
+            ClearUnwritten(tapCursors[tap], tapDistance, 1);
+        }
+
+        // Clearing the read samples not written since the last reset.
+        ClearUnwritten(semiDelayedCursor, BufferModulo(delaySamples), 1);
+        ClearUnwritten(fullDelayedCursor, BufferModulo(delaySamples * 2), 1);
+
         // Writing actual samples to buffer.
         leftBuffer_[bufferCursor_] = (input.first + leftBuffer_[fullDelayedCursor]) * feedback_;
         rightBuffer_[bufferCursor_] =  (input.second + rightBuffer_[fullDelayedCursor]) * feedback_;
 
+        // Construction of the echoes of both channels from the semi and full delayed samples.
+        float semiDelayed = primaryPanningQuotient_ * leftBuffer_[semiDelayedCursor] + secondaryPanningQuotient_ * rightBuffer_[semiDelayedCursor];
+        float fullDelayed = secondaryPanningQuotient_ * leftBuffer_[fullDelayedCursor] + primaryPanningQuotient_ * rightBuffer_[fullDelayedCursor];
+        float leftEcho = (panoramaParamC_ * semiDelayed) + (panoramaParam_ * fullDelayed);
+        float rightEcho = (panoramaParam_ * semiDelayed) + (panoramaParamC_ * fullDelayed);
+
+        // Taps are added to the echoes.
+        for(int tap = 0; tap < tapCount; ++tap)
+        {
+            float tapped = leftBuffer_[tapCursors[tap]] + rightBuffer_[tapCursors[tap]];
+            leftEcho += tapLeftGains_[tap] * tapped;
+            rightEcho += tapRightGains_[tap] * tapped;
+        }
+
         // Construction of the current output samples includes combining the dry and wet samples.
-        float left = (wetParamC_ * input.first) +
-            (wetParam_ * ((panoramaParamC_ * (primaryPanningQuotient_ * leftBuffer_[semiDelayedCursor] + secondaryPanningQuotient_ * rightBuffer_[semiDelayedCursor])) +
-                     (panoramaParam_ * (secondaryPanningQuotient_ * leftBuffer_[fullDelayedCursor] + primaryPanningQuotient_ * rightBuffer_[fullDelayedCursor]))));
-        // Constructing the actual right output sample.
-        float right = (wetParamC_ * input.second) +
-            (wetParam_ * ((panoramaParam_ * (primaryPanningQuotient_ * leftBuffer_[semiDelayedCursor] + secondaryPanningQuotient_ * rightBuffer_[semiDelayedCursor])) +
-                     (panoramaParamC_ * (secondaryPanningQuotient_ * leftBuffer_[fullDelayedCursor] + primaryPanningQuotient_ * rightBuffer_[fullDelayedCursor]))));
+        float left = (wetParamC_ * input.first) + (wetParam_ * leftEcho);
+        float right = (wetParamC_ * input.second) + (wetParam_ * rightEcho);
 
         // Move buffer cursor to new position.
         IncrementBufferCursor();
+        AdvanceWatermark(1);
         return StereoSample(left, right);
     }
 
+    /**
+     * PingPongDelayUnit block processing method. Gives the same output
+     * as calling GetSample for each frame of the block, while it also
+     * meters the levels of the input, the delay line and the output.
+     * Takes over the published settings, crossfading to them through
+     * the first frames. In the economy the echoes come from the delay
+     * line running at the reduced rate instead. Output arrays may be
+     * the same as the input ones.
+     * @param leftInput an array of left channel samples to be processed.
+     * @param rightInput an array of right channel samples to be processed.
+     * @param leftOutput where to store the effected left channel samples.
+     * @param rightOutput where to store the effected right channel samples.
+     * @param sampleFrames number of samples of each channel.
+     */
+    void PingPongDelayUnit::ProcessBlock(const float* leftInput, const float* rightInput, float* leftOutput,
+                                         float* rightOutput, int sampleFrames)
+    {
+        TakePublishedSettings();
+
+        // Without buffers the delay line is silent, as well as while
+        // they are trimmed.
+#ifdef PINGPONGDELAY_TRIMMING
+        if(!ProvideBuffers(leftInput, rightInput, sampleFrames) || !leftBuffer_)
+#else
+        if(!leftBuffer_)
+#endif
+        {
+            for(int frame = 0; frame < sampleFrames; ++frame)
+            {
+                leftOutput[frame] = wetParamC_ * leftInput[frame];
+                rightOutput[frame] = wetParamC_ * rightInput[frame];
+            }
+            fadeFrames_ = 0;
+            freezeLength_ = 0;
+            thawFrames_ = 0;
+            economyDryGain_ = wetParamC_;
+            AdvanceRamp(sampleFrames);
+            return;
+        }
+
+        if(economyFactor_ > 1)
+        {
+            ProcessEconomyBlock(leftInput, rightInput, leftOutput, rightOutput, sampleFrames);
+        }
+        else
+        {
+            ProcessDelayBlock(leftInput, rightInput, leftOutput, rightOutput, sampleFrames);
+            AccountMeterFrames(sampleFrames);
+        }
+        AdvanceRamp(sampleFrames);
+    }
+
+    /**
+     * Processes a block through the delay line, frozen, crossfading
+     * or as usual, without accounting it into the metering window
+     * and the tempo ramps.
+     * @param leftInput an array of left channel samples to be processed.
+     * @param rightInput an array of right channel samples to be processed.
+     * @param leftOutput where to store the effected left channel samples.
+     * @param rightOutput where to store the effected right channel samples.
+     * @param sampleFrames number of samples of each channel.
+     */
+    void PingPongDelayUnit::ProcessDelayBlock(const float* leftInput, const float* rightInput, float* leftOutput,
+                                              float* rightOutput, int sampleFrames)
+    {
+        // Frozen delay line loops until it is thawed. The freeze waits
+        // for the crossfade between the settings to end.
+        if(isFrozen_ && freezeLength_ == 0 && fadeFrames_ == 0)
+        {
+            StartFreeze();
+        }
+        if(freezeLength_ > 0 && thawFrames_ == 0)
+        {
+            if(isFrozen_)
+            {
+                ProcessFrozenBlock(leftInput, rightInput, leftOutput, rightOutput, sampleFrames);
+                return;
+            }
+            StartThaw();
+        }
+
+        // Frames crossfading between the settings or from the frozen loop
+        // are processed first, the rest of the block as usual.
+        int fadedFrames = std::min(fadeFrames_ + thawFrames_, sampleFrames);
+        if(fadeFrames_ > 0)
+        {
+            ProcessFadingFrames(leftInput, rightInput, leftOutput, rightOutput, fadedFrames);
+        }
+        else if(thawFrames_ > 0)
+        {
+            ProcessThawingFrames(leftInput, rightInput, leftOutput, rightOutput, fadedFrames);
+        }
+
+        if(interpolation_ != NoInterpolation)
+        {
+            ProcessInterpolatedBlock(leftInput + fadedFrames, rightInput + fadedFrames, leftOutput + fadedFrames,
+                                     rightOutput + fadedFrames, sampleFrames - fadedFrames);
+            return;
+        }
+
+        // The delay is constant within the block, so it is calculated once.
+        int delaySamples = DelaySamples();
+        // Distances of the delayed cursors behind the buffer cursor.
+        int semiDistance = BufferModulo(delaySamples);
+        int fullDistance = BufferModulo(delaySamples * 2);
+        int tapCount = tapCount_;
+        int tapDistances[maxTapCount];
+        for(int tap = 0; tap < tapCount; ++tap)
+        {
+            tapDistances[tap] = TapDistance(tap, delaySamples);
+        }
+
+        int frame = fadedFrames;
+        while(frame < sampleFrames)
+        {
+            int semiDelayedCursor = BufferModulo(bufferCursor_ - delaySamples);
+            int fullDelayedCursor = BufferModulo(bufferCursor_ - (delaySamples * 2));
+            int tapCursors[maxTapCount];
+
+            // Segment ends before any of the cursors wraps. It is not longer
+            // than the distances either, so that the samples it writes never
+            // overlap the ones it reads and the compiler can vectorize it.
+            int segmentFrames = sampleFrames - frame;
+            segmentFrames = std::min(segmentFrames, bufferSize_ - bufferCursor_);
+            segmentFrames = std::min(segmentFrames, bufferSize_ - semiDelayedCursor);
+            segmentFrames = std::min(segmentFrames, bufferSize_ - fullDelayedCursor);
+            if(semiDistance > 0)
+            {
+                segmentFrames = std::min(segmentFrames, semiDistance);
+            }
+            if(fullDistance > 0)
+            {
+                segmentFrames = std::min(segmentFrames, fullDistance);
+            }
+            for(int tap = 0; tap < tapCount; ++tap)
+            {
+                tapCursors[tap] = BufferModulo(bufferCursor_ - tapDistances[tap]);
+                segmentFrames = std::min(segmentFrames, bufferSize_ - tapCursors[tap]);
+                if(tapDistances[tap] > 0)
+                {
+                    segmentFrames = std::min(segmentFrames, tapDistances[tap]);
+                }
+            }
+
+            // Samples the segment reads, which were not written since
+            // the last reset, are cleared just before it reads them.
+            ClearUnwritten(semiDelayedCursor, semiDistance, segmentFrames);
+            ClearUnwritten(fullDelayedCursor, fullDistance, segmentFrames);
+            for(int tap = 0; tap < tapCount; ++tap)
+            {
+                ClearUnwritten(tapCursors[tap], tapDistances[tap], segmentFrames);
+            }
+
+            ProcessSegment(leftInput + frame, rightInput + frame, leftOutput + frame, rightOutput + frame,
+                           segmentFrames, semiDelayedCursor, fullDelayedCursor, tapCount, tapCursors);
+            AdvanceWatermark(segmentFrames);
+
+            // Moving buffer cursor behind the segment.
+            bufferCursor_ += segmentFrames;
+            if(bufferCursor_ == bufferSize_)
+            {
+                bufferCursor_ = 0;
+            }
+            frame += segmentFrames;
+        }
+    }
+
+    /**
+     * Runs the feedback loop of one channel over a block, writing its
+     * delay line without producing any output. The feedback loops of
+     * the channels are independent, so the two channels of a block may
+     * be run on two threads at once. Once both are run, the block must
+     * be finished by MixChannels. The block must not be longer than
+     * GetChannelBlockLimit.
+     * @param channel zero for the left, one for the right channel.
+     * @param input an array of samples of the channel to be processed.
+     * @param sampleFrames number of samples of the channel.
+     */
+    void PingPongDelayUnit::ProcessChannel(int channel, const float* input, int sampleFrames)
+    {
+        // Without buffers the delay line is silent, there is nothing to write.
+        if(!leftBuffer_)
+        {
+            return;
+        }
+
+        // Each channel touches only its own buffer, the cursor and
+        // the watermark are moved by MixChannels.
+        float* buffer = (channel == 0) ? leftBuffer_ : rightBuffer_;
+        int delaySamples = DelaySamples();
+        int semiDistance = BufferModulo(delaySamples);
+        int fullDistance = BufferModulo(delaySamples * 2);
+
+        // Samples read by the whole block, including the ones MixChannels
+        // reads, are cleared at once. They lie behind the samples the block
+        // writes, so the clearing never erases them.
+        ClearUnwrittenBlock(buffer, semiDistance, sampleFrames);
+        ClearUnwrittenBlock(buffer, fullDistance, sampleFrames);
+        for(int tap = 0; tap < tapCount_; ++tap)
+        {
+            ClearUnwrittenBlock(buffer, TapDistance(tap, delaySamples), sampleFrames);
+        }
+
+        float feedback = feedback_;
+        int frame = 0;
+        while(frame < sampleFrames)
+        {
+            int writtenCursor = BufferModulo(bufferCursor_ + frame);
+            int fullDelayedCursor = BufferModulo(writtenCursor - fullDistance);
+
+            // Segment ends before any of the cursors wraps and does not read
+            // samples it writes, the same way as in ProcessBlock.
+            int segmentFrames = sampleFrames - frame;
+            segmentFrames = std::min(segmentFrames, bufferSize_ - writtenCursor);
+            segmentFrames = std::min(segmentFrames, bufferSize_ - fullDelayedCursor);
+            if(fullDistance > 0)
+            {
+                segmentFrames = std::min(segmentFrames, fullDistance);
+            }
+
+            float* written = buffer + writtenCursor;
+            const float* fullDelayed = buffer + fullDelayedCursor;
+            const float* segmentInput = input + frame;
+
+            // Grouped frames are read before written, which is correct even
+            // when the fully delayed cursor equals the buffer cursor, as each
+            // frame then reads and writes the same sample.
+            int groupedFrames = segmentFrames - (segmentFrames % channelLaneCount_);
+            int i = 0;
+            for(; i < groupedFrames; i += channelLaneCount_)
+            {
+                float writtenSamples[channelLaneCount_];
+                for(int lane = 0; lane < channelLaneCount_; ++lane)
+                {
+                    writtenSamples[lane] = (segmentInput[i + lane] + fullDelayed[i + lane]) * feedback;
+                }
+                for(int lane = 0; lane < channelLaneCount_; ++lane)
+                {
+                    written[i + lane] = writtenSamples[lane];
+                }
+            }
+            for(; i < segmentFrames; ++i)
+            {
+                written[i] = (segmentInput[i] + fullDelayed[i]) * feedback;
+            }
+
+            frame += segmentFrames;
+        }
+    }
+
+    /**
+     * Finishes a block, whose channels were run by ProcessChannel,
+     * mixing the dry input with the delay line and moving the buffer
+     * cursor behind the block. Together they give the same output as
+     * ProcessBlock without interpolation, except that the levels are
+     * not metered. Output arrays may be the same as the input ones.
+     * @param leftInput an array of left channel samples to be processed.
+     * @param rightInput an array of right channel samples to be processed.
+     * @param leftOutput where to store the effected left channel samples.
+     * @param rightOutput where to store the effected right channel samples.
+     * @param sampleFrames number of samples of each channel.
+     */
+    void PingPongDelayUnit::MixChannels(const float* leftInput, const float* rightInput, float* leftOutput,
+                                        float* rightOutput, int sampleFrames)
+    {
+        if(!leftBuffer_)
+        {
+            for(int frame = 0; frame < sampleFrames; ++frame)
+            {
+                leftOutput[frame] = wetParamC_ * leftInput[frame];
+                rightOutput[frame] = wetParamC_ * rightInput[frame];
+            }
+            return;
+        }
+
+        int delaySamples = DelaySamples();
+        int semiDistance = BufferModulo(delaySamples);
+        int fullDistance = BufferModulo(delaySamples * 2);
+
+        float wet = wetParam_;
+        float dry = wetParamC_;
+        float panorama = panoramaParam_;
+        float panoramaC = panoramaParamC_;
+        float primary = primaryPanningQuotient_;
+        float secondary = secondaryPanningQuotient_;
+        int tapCount = tapCount_;
+        int tapDistances[maxTapCount];
+        float tapLeftGains[maxTapCount];
+        float tapRightGains[maxTapCount];
+        for(int tap = 0; tap < tapCount; ++tap)
+        {
+            tapDistances[tap] = TapDistance(tap, delaySamples);
+            tapLeftGains[tap] = tapLeftGains_[tap];
+            tapRightGains[tap] = tapRightGains_[tap];
+        }
+
+        // The whole block is already written, so each delayed sample holds
+        // the value GetSample would read at its frame and the mix only
+        // reads the buffers.
+        int frame = 0;
+        while(frame < sampleFrames)
+        {
+            int semiDelayedCursor = BufferModulo(bufferCursor_ + frame - semiDistance);
+            int fullDelayedCursor = BufferModulo(bufferCursor_ + frame - fullDistance);
+            int segmentFrames = sampleFrames - frame;
+            segmentFrames = std::min(segmentFrames, bufferSize_ - semiDelayedCursor);
+            segmentFrames = std::min(segmentFrames, bufferSize_ - fullDelayedCursor);
+            const float* leftTapped[maxTapCount];
+            const float* rightTapped[maxTapCount];
+            for(int tap = 0; tap < tapCount; ++tap)
+            {
+                int tapCursor = BufferModulo(bufferCursor_ + frame - tapDistances[tap]);
+                segmentFrames = std::min(segmentFrames, bufferSize_ - tapCursor);
+                leftTapped[tap] = leftBuffer_ + tapCursor;
+                rightTapped[tap] = rightBuffer_ + tapCursor;
+            }
+
+            const float* leftSemiDelayed = leftBuffer_ + semiDelayedCursor;
+            const float* rightSemiDelayed = rightBuffer_ + semiDelayedCursor;
+            const float* leftFullDelayed = leftBuffer_ + fullDelayedCursor;
+            const float* rightFullDelayed = rightBuffer_ + fullDelayedCursor;
+            const float* leftSegmentInput = leftInput + frame;
+            const float* rightSegmentInput = rightInput + frame;
+            float* leftSegmentOutput = leftOutput + frame;
+            float* rightSegmentOutput = rightOutput + frame;
+
+            // Outputs may be the inputs, so the grouped frames are read
+            // before written.
+            int groupedFrames = segmentFrames - (segmentFrames % channelLaneCount_);
+            int i = 0;
+            for(; i < groupedFrames; i += channelLaneCount_)
+            {
+                float leftEchoes[channelLaneCount_];
+                float rightEchoes[channelLaneCount_];
+                for(int lane = 0; lane < channelLaneCount_; ++lane)
+                {
+                    int j = i + lane;
+                    float semiDelayed = primary * leftSemiDelayed[j] + secondary * rightSemiDelayed[j];
+                    float fullDelayed = secondary * leftFullDelayed[j] + primary * rightFullDelayed[j];
+                    leftEchoes[lane] = (panoramaC * semiDelayed) + (panorama * fullDelayed);
+                    rightEchoes[lane] = (panorama * semiDelayed) + (panoramaC * fullDelayed);
+                }
+                for(int tap = 0; tap < tapCount; ++tap)
+                {
+                    for(int lane = 0; lane < channelLaneCount_; ++lane)
+                    {
+                        float tapped = leftTapped[tap][i + lane] + rightTapped[tap][i + lane];
+                        leftEchoes[lane] += tapLeftGains[tap] * tapped;
+                        rightEchoes[lane] += tapRightGains[tap] * tapped;
+                    }
+                }
+
+                float leftOutputSamples[channelLaneCount_];
+                float rightOutputSamples[channelLaneCount_];
+                for(int lane = 0; lane < channelLaneCount_; ++lane)
+                {
+                    leftOutputSamples[lane] = (dry * leftSegmentInput[i + lane]) + (wet * leftEchoes[lane]);
+                    rightOutputSamples[lane] = (dry * rightSegmentInput[i + lane]) + (wet * rightEchoes[lane]);
+                }
+                for(int lane = 0; lane < channelLaneCount_; ++lane)
+                {
+                    leftSegmentOutput[i + lane] = leftOutputSamples[lane];
+                    rightSegmentOutput[i + lane] = rightOutputSamples[lane];
+                }
+            }
+            for(; i < segmentFrames; ++i)
+            {
+                float semiDelayed = primary * leftSemiDelayed[i] + secondary * rightSemiDelayed[i];
+                float fullDelayed = secondary * leftFullDelayed[i] + primary * rightFullDelayed[i];
+                float leftEcho = (panoramaC * semiDelayed) + (panorama * fullDelayed);
+                float rightEcho = (panorama * semiDelayed) + (panoramaC * fullDelayed);
+                for(int tap = 0; tap < tapCount; ++tap)
+                {
+                    float tapped = leftTapped[tap][i] + rightTapped[tap][i];
+                    leftEcho += tapLeftGains[tap] * tapped;
+                    rightEcho += tapRightGains[tap] * tapped;
+                }
+                float leftInputSample = leftSegmentInput[i];
+                float rightInputSample = rightSegmentInput[i];
+                leftSegmentOutput[i] = (dry * leftInputSample) + (wet * leftEcho);
+                rightSegmentOutput[i] = (dry * rightInputSample) + (wet * rightEcho);
+            }
+
+            frame += segmentFrames;
+        }
+
+        AdvanceWatermark(sampleFrames);
+        bufferCursor_ = BufferModulo(bufferCursor_ + sampleFrames);
+    }
+
+    /**
+     * Gets the longest block, which may be processed by ProcessChannel
+     * and MixChannels with the current delay. The delay line must hold
+     * the delayed samples of the whole block at once.
+     * @return number of frames.
+     */
+    int PingPongDelayUnit::GetChannelBlockLimit()
+    {
+        int delaySamples = DelaySamples();
+        return bufferSize_ - std::max(BufferModulo(delaySamples), BufferModulo(delaySamples * 2));
+    }
+
+    /**
+     * Tells whether ProcessChannel and MixChannels give the same output
+     * as ProcessBlock with the current settings. They read the delay line
+     * only at whole samples and always write it at the full rate, so they
+     * do not with interpolation, nor while the delay line is frozen
+     * or thawing, nor in the economy.
+     * @return true if the channels may be processed separately, false
+     *      otherwise.
+     */
+    bool PingPongDelayUnit::CanProcessChannels()
+    {
+        return interpolation_ == NoInterpolation && !isFrozen_ && freezeLength_ == 0 && economyFactor_ == 1;
+    }
+
+    /**
+     * Gets the latest levels metered by ProcessBlock. May be called
+     * from any thread, it never blocks the processing.
+     * @param levels where to store the levels.
+     */
+    void PingPongDelayUnit::GetLevels(PingPongDelayLevels& levels)
+    {
+        levels_.Read(levels);
+    }
+
     /**
      * Gets the delay parameter setting of unit.
      * @return delay parameter between [0, 1].
@@ -208,9 +850,9 @@ namespace PingPongDelay
     {
         delayParam_ = delayParam;
         // Calculating the corresponding time of asynchronous delay in ms.
-        asyncDelayMs_ = Corresponding(delayParam, minAsyncDelayMs_, maxAsyncDelayMs_);
+        asyncDelayMs_ = AsyncDelayMs(delayParam);
         // Calculating the corresponding index of sync ratio of synchronized delay.
-        syncDelayRatioIndex_ = Corresponding(delayParam, 0, syncDelayRatioCount_ - 1);
+        syncDelayRatioIndex_ = SyncDelayRatioIndex(delayParam);
     }
 
     /**
@@ -258,7 +900,7 @@ namespace PingPongDelay
     void PingPongDelayUnit::SetFeedbackParam(float feedbackParam)
     {
         feedbackParam_ = feedbackParam;
-        feedback_ = Corresponding(feedbackParam, minFeedback_, maxFeedback_);
+        feedback_ = Feedback(feedbackParam);
     }
 
     /**
@@ -302,16 +944,7 @@ namespace PingPongDelay
         panoramaParam_ = panoramaParam;
         // Calculating the complementary ratio to panorama.
         panoramaParamC_ = (1 - panoramaParam);
-        // The reason of calculating these quotients is that when the panorama
-        // of the delay unit is set to 0 or 1 (while signal delays in one channel
-        // there is none delayed in the other) the delayed signal added to the
-        // corresponding channel should be mono so that both original channels would
-        // be heard. On the other side if the panorama is set to 0.5 (Each delay is
-        // equally intensive in both channels) there should be heard the stereo
-        // panning from the original sample.
-        secondaryPanningQuotient_ = fabs(0.5f - primaryPanningQuotient_);
-        // Calculating the complementary ratio to secondary panning quotient.
-        primaryPanningQuotient_ = 1 - secondaryPanningQuotient_;
+        PanningQuotients(panoramaParam, primaryPanningQuotient_, secondaryPanningQuotient_);
     }
 
     /**
@@ -374,6 +1007,2858 @@ namespace PingPongDelay
         return isAsync_;
     }
 
+    /**
+     * Gets the tap count parameter setting of unit.
+     * @return tap count parameter between [0, 1].
+     */
+    float PingPongDelayUnit::GetTapCountParam()
+    {
+        return tapCountParam_;
+    }
+
+    /**
+     * Sets the tap count parameter setting of unit.
+     * @param tapCountParam a new tap count parameter of the unit. Must be
+     *      a value from [0, 1]. Setting it to zero disables the taps,
+     *      setting it to one enables all maxTapCount of them. Any other
+     *      settings in between these act evenly corresponding to the value.
+     */
+    void PingPongDelayUnit::SetTapCountParam(float tapCountParam)
+    {
+        tapCountParam_ = tapCountParam;
+        tapCount_ = TapCount(tapCountParam);
+    }
+
+    /**
+     * Gets the number of enabled taps, the first ones are enabled.
+     * @return number of taps between [0, maxTapCount].
+     */
+    int PingPongDelayUnit::GetTapCount()
+    {
+        return tapCount_;
+    }
+
+    /**
+     * Gets the time parameter setting of a tap.
+     * @param tap an index of the tap.
+     * @return time parameter between [0, 1].
+     */
+    float PingPongDelayUnit::GetTapTimeParam(int tap)
+    {
+        return tapTimeParams_[tap];
+    }
+
+    /**
+     * Sets the time parameter setting of a tap.
+     * @param tap an index of the tap.
+     * @param tapTimeParam a new time parameter of the tap. Must be a value
+     *      from [0, 1]. The tap reads the delay line at the corresponding
+     *      ratio of the delay from [min tap time ratio, max tap time ratio],
+     *      one half reads it once delayed.
+     */
+    void PingPongDelayUnit::SetTapTimeParam(int tap, float tapTimeParam)
+    {
+        tapTimeParams_[tap] = tapTimeParam;
+        tapTimeRatios_[tap] = TapTimeRatio(tapTimeParam);
+    }
+
+    /**
+     * Gets the time ratio of a tap.
+     * @param tap an index of the tap.
+     * @return ratio of the delay the tap reads the delay line at.
+     */
+    float PingPongDelayUnit::GetTapTimeRatio(int tap)
+    {
+        return tapTimeRatios_[tap];
+    }
+
+    /**
+     * Gets the gain parameter setting of a tap.
+     * @param tap an index of the tap.
+     * @return gain parameter between [0, 1].
+     */
+    float PingPongDelayUnit::GetTapGainParam(int tap)
+    {
+        return tapGainParams_[tap];
+    }
+
+    /**
+     * Sets the gain parameter setting of a tap.
+     * @param tap an index of the tap.
+     * @param tapGainParam a new gain parameter of the tap. Must be a value
+     *      from [0, 1], the ratio of the tap in the wet signal.
+     */
+    void PingPongDelayUnit::SetTapGainParam(int tap, float tapGainParam)
+    {
+        tapGainParams_[tap] = tapGainParam;
+        UpdateTapGains(tap);
+    }
+
+    /**
+     * Gets the panorama parameter setting of a tap.
+     * @param tap an index of the tap.
+     * @return panorama parameter between [0, 1].
+     */
+    float PingPongDelayUnit::GetTapPanoramaParam(int tap)
+    {
+        return tapPanoramaParams_[tap];
+    }
+
+    /**
+     * Sets the panorama parameter setting of a tap.
+     * @param tap an index of the tap.
+     * @param tapPanoramaParam a new panorama parameter of the tap. Must be
+     *      a value from [0, 1]. Setting it to zero places the tap to
+     *      the left, to one half to the center and to one to the right
+     *      channel.
+     */
+    void PingPongDelayUnit::SetTapPanoramaParam(int tap, float tapPanoramaParam)
+    {
+        tapPanoramaParams_[tap] = tapPanoramaParam;
+        UpdateTapGains(tap);
+    }
+
+    /**
+     * Gets the interpolation parameter setting of unit.
+     * @return interpolation parameter between [0, 1].
+     */
+    float PingPongDelayUnit::GetInterpolationParam()
+    {
+        return interpolationParam_;
+    }
+
+    /**
+     * Sets the interpolation parameter setting of unit.
+     * @param interpolationParam a new interpolation parameter of the unit.
+     *      Must be a value from [0, 1]. Each of PingPongDelayInterpolation
+     *      in its order corresponds to an evenly big part of the interval.
+     */
+    void PingPongDelayUnit::SetInterpolationParam(float interpolationParam)
+    {
+        interpolationParam_ = interpolationParam;
+        int interpolation = Interpolation(interpolationParam);
+        if(interpolation != interpolation_)
+        {
+            // Allpass heads start from silence, not from samples
+            // of another interpolation.
+            memset(leftAllpassStates_, 0, sizeof(leftAllpassStates_));
+            memset(rightAllpassStates_, 0, sizeof(rightAllpassStates_));
+            interpolation_ = interpolation;
+        }
+    }
+
+    /**
+     * Gets the interpolation of the delay line reads.
+     * @return one of PingPongDelayInterpolation.
+     */
+    int PingPongDelayUnit::GetInterpolation()
+    {
+        return interpolation_;
+    }
+
+    /**
+     * Gets the string of currently set interpolation.
+     * @return string of the interpolation.
+     */
+    const char* PingPongDelayUnit::GetInterpolationName()
+    {
+        return interpolationStrings_[interpolation_];
+    }
+
+    /**
+     * Gets the freeze parameter setting of unit.
+     * @return freeze parameter between [0, 1].
+     */
+    float PingPongDelayUnit::GetFreezeParam()
+    {
+        return freezeParam_;
+    }
+
+    /**
+     * Sets the freeze parameter setting of unit. While it is at least
+     * one half, nothing is written to the delay line and the read heads
+     * keep looping over the last two delays held in it. Only ProcessBlock
+     * freezes the delay line, the freeze is not a part of the settings.
+     * @param freezeParam a new freeze parameter of the unit. Must be
+     *      a value from [0, 1].
+     */
+    void PingPongDelayUnit::SetFreezeParam(float freezeParam)
+    {
+        freezeParam_ = freezeParam;
+        isFrozen_ = (freezeParam >= 0.5f);
+    }
+
+    /**
+     * Tells whether the delay line of unit is to be frozen.
+     * @return true if the delay line is to be frozen, false otherwise.
+     */
+    bool PingPongDelayUnit::IsFrozen()
+    {
+        return isFrozen_;
+    }
+
+    /**
+     * Gets the economy parameter setting of unit.
+     * @return economy parameter between [0, 1].
+     */
+    float PingPongDelayUnit::GetEconomyParam()
+    {
+        return economyParam_;
+    }
+
+    /**
+     * Sets the economy parameter setting of unit. Each of the rates
+     * of economyStrings_ in its order corresponds to an evenly big part
+     * of the interval. Only ProcessBlock runs the delay line at
+     * the reduced rate, the economy is not a part of the settings.
+     * The rate is switched once AllocateBuffers replaces the buffers
+     * by the ones sized for it, until then the unit keeps its rate.
+     * @param economyParam a new economy parameter of the unit. Must be
+     *      a value from [0, 1].
+     */
+    void PingPongDelayUnit::SetEconomyParam(float economyParam)
+    {
+        economyParam_ = economyParam;
+        economy_ = Corresponding(economyParam, 0, economyCount_ - 1);
+    }
+
+    /**
+     * Gets the factor by which the sample rate of the delay line
+     * is to be reduced.
+     * @return factor of the rate, 1 if the economy is off.
+     */
+    int PingPongDelayUnit::GetEconomyFactor()
+    {
+        return economyFactors_[economy_];
+    }
+
+    /**
+     * Gets the string of currently set economy.
+     * @return string of the economy.
+     */
+    const char* PingPongDelayUnit::GetEconomyName()
+    {
+        return economyStrings_[economy_];
+    }
+
+    /**
+     * Gets all the settings of unit, the parameters together with
+     * the values derived from them.
+     * @param settings where to store the settings.
+     */
+    void PingPongDelayUnit::GetSettings(PingPongDelaySettings& settings)
+    {
+        settings.delayParam = delayParam_;
+        settings.feedbackParam = feedbackParam_;
+        settings.panoramaParam = panoramaParam_;
+        settings.wetParam = wetParam_;
+        settings.syncParam = syncParam_;
+        settings.interpolationParam = interpolationParam_;
+        settings.tapCountParam = tapCountParam_;
+        memcpy(settings.tapTimeParams, tapTimeParams_, sizeof(tapTimeParams_));
+        memcpy(settings.tapGainParams, tapGainParams_, sizeof(tapGainParams_));
+        memcpy(settings.tapPanoramaParams, tapPanoramaParams_, sizeof(tapPanoramaParams_));
+
+        settings.asyncDelayMs = asyncDelayMs_;
+        settings.syncDelayRatioIndex = syncDelayRatioIndex_;
+        settings.feedback = feedback_;
+        settings.panoramaParamC = panoramaParamC_;
+        settings.primaryPanningQuotient = primaryPanningQuotient_;
+        settings.secondaryPanningQuotient = secondaryPanningQuotient_;
+        settings.wetParamC = wetParamC_;
+        settings.isAsync = isAsync_;
+        settings.tapCount = tapCount_;
+        memcpy(settings.tapTimeRatios, tapTimeRatios_, sizeof(tapTimeRatios_));
+        memcpy(settings.tapLeftGains, tapLeftGains_, sizeof(tapLeftGains_));
+        memcpy(settings.tapRightGains, tapRightGains_, sizeof(tapRightGains_));
+        settings.interpolation = interpolation_;
+    }
+
+    /**
+     * Sets all the settings of unit at once. The derived values are
+     * copied instead of being derived again, so they must correspond
+     * to the parameters, as got by GetSettings of a unit.
+     * @param settings the settings to set.
+     * @return true if the settings were set, false if some of the derived
+     *      values are out of their range and nothing was set.
+     */
+    bool PingPongDelayUnit::SetSettings(const PingPongDelaySettings& settings)
+    {
+        if(!IsValidSettings(settings))
+        {
+            return false;
+        }
+
+        delayParam_ = settings.delayParam;
+        feedbackParam_ = settings.feedbackParam;
+        panoramaParam_ = settings.panoramaParam;
+        wetParam_ = settings.wetParam;
+        syncParam_ = settings.syncParam;
+        interpolationParam_ = settings.interpolationParam;
+        tapCountParam_ = settings.tapCountParam;
+        memcpy(tapTimeParams_, settings.tapTimeParams, sizeof(tapTimeParams_));
+        memcpy(tapGainParams_, settings.tapGainParams, sizeof(tapGainParams_));
+        memcpy(tapPanoramaParams_, settings.tapPanoramaParams, sizeof(tapPanoramaParams_));
+
+        asyncDelayMs_ = settings.asyncDelayMs;
+        syncDelayRatioIndex_ = settings.syncDelayRatioIndex;
+        feedback_ = settings.feedback;
+        panoramaParamC_ = settings.panoramaParamC;
+        primaryPanningQuotient_ = settings.primaryPanningQuotient;
+        secondaryPanningQuotient_ = settings.secondaryPanningQuotient;
+        wetParamC_ = settings.wetParamC;
+        isAsync_ = settings.isAsync;
+        tapCount_ = settings.tapCount;
+        memcpy(tapTimeRatios_, settings.tapTimeRatios, sizeof(tapTimeRatios_));
+        memcpy(tapLeftGains_, settings.tapLeftGains, sizeof(tapLeftGains_));
+        memcpy(tapRightGains_, settings.tapRightGains, sizeof(tapRightGains_));
+        if(settings.interpolation != interpolation_)
+        {
+            // Allpass heads start from silence, not from samples
+            // of another interpolation.
+            memset(leftAllpassStates_, 0, sizeof(leftAllpassStates_));
+            memset(rightAllpassStates_, 0, sizeof(rightAllpassStates_));
+            interpolation_ = settings.interpolation;
+        }
+        return true;
+    }
+
+    /**
+     * Tells whether the derived values of settings are within their
+     * ranges, so that the settings may be set by SetSettings.
+     * @param settings the settings to check.
+     * @return true if the settings are valid, false otherwise.
+     */
+    bool PingPongDelayUnit::IsValidSettings(const PingPongDelaySettings& settings)
+    {
+        // Values deciding the indexes and the distances are checked,
+        // so that the settings from outside never read beyond the tables
+        // or the buffers, nor make the feedback loop unstable.
+        if(settings.asyncDelayMs < minAsyncDelayMs_ || settings.asyncDelayMs > maxAsyncDelayMs_ ||
+           settings.syncDelayRatioIndex < 0 || settings.syncDelayRatioIndex >= syncDelayRatioCount_ ||
+           !(settings.feedback >= minFeedback_ && settings.feedback <= maxFeedback_) ||
+           settings.tapCount < 0 || settings.tapCount > maxTapCount ||
+           settings.interpolation < 0 || settings.interpolation >= InterpolationCount)
+        {
+            return false;
+        }
+        for(int tap = 0; tap < maxTapCount; ++tap)
+        {
+            if(!(settings.tapTimeRatios[tap] >= minTapTimeRatio_ && settings.tapTimeRatios[tap] <= maxTapTimeRatio_))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Derives the values of settings from their parameters, the same
+     * way as the setters of a unit do. Neither a unit nor its time
+     * info are needed, so it is cheap to call from any thread.
+     * @param settings the settings whose values are to be derived.
+     */
+    void PingPongDelayUnit::DeriveSettings(PingPongDelaySettings& settings)
+    {
+        settings.asyncDelayMs = AsyncDelayMs(settings.delayParam);
+        settings.syncDelayRatioIndex = SyncDelayRatioIndex(settings.delayParam);
+        settings.feedback = Feedback(settings.feedbackParam);
+        settings.panoramaParamC = 1 - settings.panoramaParam;
+        PanningQuotients(settings.panoramaParam, settings.primaryPanningQuotient, settings.secondaryPanningQuotient);
+        settings.wetParamC = 1 - settings.wetParam;
+        settings.isAsync = (settings.syncParam == 0.0f);
+        settings.tapCount = TapCount(settings.tapCountParam);
+        for(int tap = 0; tap < maxTapCount; ++tap)
+        {
+            settings.tapTimeRatios[tap] = TapTimeRatio(settings.tapTimeParams[tap]);
+            TapGains(settings.tapGainParams[tap], settings.tapPanoramaParams[tap], settings.tapLeftGains[tap],
+                     settings.tapRightGains[tap]);
+        }
+        settings.interpolation = Interpolation(settings.interpolationParam);
+    }
+
+    /**
+     * Derives the asynchronous delay from the delay parameter.
+     * @param delayParam a delay parameter from [0, 1].
+     * @return delay time from [min delay time, max delay time] in ms.
+     */
+    int PingPongDelayUnit::AsyncDelayMs(float delayParam)
+    {
+        return Corresponding(delayParam, minAsyncDelayMs_, maxAsyncDelayMs_);
+    }
+
+    /**
+     * Derives the index of the synchronized delay ratio from the delay
+     * parameter.
+     * @param delayParam a delay parameter from [0, 1].
+     * @return index of the ratio of syncDelayRatios_.
+     */
+    int PingPongDelayUnit::SyncDelayRatioIndex(float delayParam)
+    {
+        return Corresponding(delayParam, 0, syncDelayRatioCount_ - 1);
+    }
+
+    /**
+     * Derives the feedback from the feedback parameter.
+     * @param feedbackParam a feedback parameter from [0, 1].
+     * @return feedback from [min feedback, max feedback].
+     */
+    float PingPongDelayUnit::Feedback(float feedbackParam)
+    {
+        return Corresponding(feedbackParam, minFeedback_, maxFeedback_);
+    }
+
+    /**
+     * Derives the panning quotients from the panorama parameter.
+     * @param panoramaParam a panorama parameter from [0, 1].
+     * @param primaryPanningQuotient where to store the quotient
+     *      of the stereo panning of the delayed signal.
+     * @param secondaryPanningQuotient where to store the quotient
+     *      of the mono delayed signal.
+     */
+    void PingPongDelayUnit::PanningQuotients(float panoramaParam, float& primaryPanningQuotient,
+                                             float& secondaryPanningQuotient)
+    {
+        // The reason of calculating these quotients is that when the panorama
+        // of the delay unit is set to 0 or 1 (while signal delays in one channel
+        // there is none delayed in the other) the delayed signal added to the
+        // corresponding channel should be mono so that both original channels would
+        // be heard. On the other side if the panorama is set to 0.5 (Each delay is
+        // equally intensive in both channels) there should be heard the stereo
+        // panning from the original sample.
+        secondaryPanningQuotient = fabs(0.5f - panoramaParam);
+        // Calculating the complementary ratio to secondary panning quotient.
+        primaryPanningQuotient = 1 - secondaryPanningQuotient;
+    }
+
+    /**
+     * Derives the interpolation from the interpolation parameter.
+     * @param interpolationParam an interpolation parameter from [0, 1].
+     * @return one of PingPongDelayInterpolation.
+     */
+    int PingPongDelayUnit::Interpolation(float interpolationParam)
+    {
+        return Corresponding(interpolationParam, 0, InterpolationCount - 1);
+    }
+
+    /**
+     * Derives the number of enabled taps from the tap count parameter.
+     * @param tapCountParam a tap count parameter from [0, 1].
+     * @return number of taps between [0, maxTapCount].
+     */
+    int PingPongDelayUnit::TapCount(float tapCountParam)
+    {
+        return Corresponding(tapCountParam, 0, maxTapCount);
+    }
+
+    /**
+     * Derives the time ratio of a tap from its time parameter.
+     * @param tapTimeParam a time parameter of the tap from [0, 1].
+     * @return ratio of the delay the tap reads the delay line at.
+     */
+    float PingPongDelayUnit::TapTimeRatio(float tapTimeParam)
+    {
+        return Corresponding(tapTimeParam, minTapTimeRatio_, maxTapTimeRatio_);
+    }
+
+    /**
+     * Derives the gains of a tap in both channels from its gain
+     * and panorama parameters.
+     * @param tapGainParam a gain parameter of the tap from [0, 1].
+     * @param tapPanoramaParam a panorama parameter of the tap from [0, 1].
+     * @param leftGain where to store the gain of the left channel.
+     * @param rightGain where to store the gain of the right channel.
+     */
+    void PingPongDelayUnit::TapGains(float tapGainParam, float tapPanoramaParam, float& leftGain, float& rightGain)
+    {
+        // Tap reads the sum of both channels, so the gains are halved.
+        // Panorama attenuates the opposite channel only, keeping the center
+        // as loud as the sides.
+        float gain = 0.5f * tapGainParam;
+        leftGain = gain * std::min(1.0f, 2 * (1 - tapPanoramaParam));
+        rightGain = gain * std::min(1.0f, 2 * tapPanoramaParam);
+    }
+
+    /**
+     * Publishes settings to the audio thread. The next block processed
+     * by ProcessBlock takes them over and crossfades from the current
+     * settings to them, without deriving any value. Settings reading
+     * the delay line at the same places are set at once instead. Never
+     * blocks the processing and allocates nothing, but must not be
+     * called from two threads at once. Settings published again before
+     * the previous ones were taken over replace them, the ones published
+     * while crossfading are taken over once the crossfade ends.
+     * @param settings the settings, as got by GetSettings of a unit.
+     */
+    void PingPongDelayUnit::PublishSettings(const PingPongDelaySettings& settings)
+    {
+        // Seqlock writing, the odd sequence makes the audio thread
+        // leave the settings for the next block.
+        unsigned int sequence = publishedSequence_.load(std::memory_order_relaxed);
+        publishedSequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        publishedSettings_ = settings;
+        publishedSequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * Tells whether there are published settings not yet taken over
+     * by the audio thread. Until then the unit keeps its previous
+     * settings.
+     * @return true if the published settings are pending, false otherwise.
+     */
+    bool PingPongDelayUnit::HasPublishedSettings()
+    {
+        return publishedSequence_.load(std::memory_order_acquire) != takenSequence_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Allocates and clears the buffers, unless they are already allocated
+     * for the rate of the economy. Buffers of another rate are replaced,
+     * their size is the size given to the constructor divided by
+     * the economy factor. Until then the unit processes as if the delay
+     * line was silent. Must not be called from the audio thread.
+     * @return true if the buffers were allocated by this call, false if
+     *      they had already been allocated.
+     */
+    bool PingPongDelayUnit::AllocateBuffers()
+    {
+#ifdef PINGPONGDELAY_TRIMMING
+        // Buffers offered to be trimmed count as allocated, they are
+        // provided again from the pool once they are needed.
+        if(bufferState_.load(std::memory_order_acquire) != ActiveBuffers)
+        {
+            return false;
+        }
+#endif
+        int economyFactor = GetEconomyFactor();
+        if(leftBuffer_ && economyFactor == economyFactor_)
+        {
+            return false;
+        }
+        delete[] leftBuffer_;
+        delete[] rightBuffer_;
+
+        // Delays truncated at the reduced rate are at most the full rate
+        // ones divided by the factor, the three frames RequiredBufferSize
+        // adds beyond them are kept whole.
+        economyFactor_ = economyFactor;
+        bufferSize_ = (economyFactor > 1) ? (fullBufferSize_ + economyFactor - 1) / economyFactor + 3 : fullBufferSize_;
+        bufferCursor_ = 0;
+
+        // Allocating buffers. They are not erased, the watermark makes
+        // them read as silent.
+        rightBuffer_ = new float[bufferSize_];
+        leftBuffer_ = new float[bufferSize_];
+        ResetBuffers();
+        return true;
+    }
+
+    /**
+     * Makes the delay line silent in constant time. Samples are not erased,
+     * the ones not written since the reset are cleared lazily just before
+     * they are read. Must not be called while the unit is processing.
+     */
+    void PingPongDelayUnit::ResetBuffers()
+    {
+        writtenFrames_ = 0;
+        memset(leftAllpassStates_, 0, sizeof(leftAllpassStates_));
+        memset(rightAllpassStates_, 0, sizeof(rightAllpassStates_));
+        rampTempo_ = 0.0;
+        fadeFrames_ = 0;
+        freezeLength_ = 0;
+        thawFrames_ = 0;
+        resampler_.SetFactor(economyFactor_);
+        economyDryGain_ = wetParamC_;
+    }
+
+    /**
+     * Tells whether the buffers of the unit are allocated.
+     * @return true if the buffers are allocated, false otherwise.
+     */
+    bool PingPongDelayUnit::HasBuffers()
+    {
+        return leftBuffer_ != NULL;
+    }
+
+    /**
+     * Gets the memory allocated by the unit for its buffers.
+     * @return size of the buffers in bytes, zero if they are not allocated.
+     */
+    long long PingPongDelayUnit::GetBufferMemory()
+    {
+        return leftBuffer_ ? (2LL * bufferSize_ * sizeof(float)) : 0;
+    }
+
+    /**
+     * Gets the size of the buffers of the unit.
+     * @return size of each of the buffers in samples.
+     */
+    int PingPongDelayUnit::GetBufferSize()
+    {
+        return bufferSize_;
+    }
+
+    /**
+     * Gets the number of frames of the state of the delay line, which
+     * are the frames written since the last reset, at most the buffer
+     * size.
+     * @return number of frames, zero if the buffers are not allocated.
+     */
+    int PingPongDelayUnit::GetStateFrames()
+    {
+        return leftBuffer_ ? writtenFrames_ : 0;
+    }
+
+    /**
+     * Tells whether SaveState copies everything the following output
+     * depends on besides the parameters. It does not with the allpass
+     * interpolation, whose filters keep their own state, nor while
+     * the delay is to ramp from the previous tempo, while the delay line
+     * is frozen or thawing, nor in the economy, whose resampler keeps
+     * its own state.
+     * @return true if the state is complete, false otherwise.
+     */
+    bool PingPongDelayUnit::CanSaveState()
+    {
+        // LoadState clears the filters, the tempo to ramp from, the loop
+        // and the resampler.
+        float rampDelay;
+        return interpolation_ != AllpassInterpolation && !GetRampDelay(rampDelay) && !isFrozen_ &&
+            freezeLength_ == 0 && economyFactor_ == 1;
+    }
+
+    /**
+     * Copies the state of the delay line, the samples written since
+     * the last reset from the oldest one. Together with the parameters
+     * it is everything the following output depends on, as long as
+     * CanSaveState tells so.
+     * @param leftState where to store GetStateFrames left channel samples.
+     * @param rightState where to store GetStateFrames right channel samples.
+     */
+    void PingPongDelayUnit::SaveState(float* leftState, float* rightState)
+    {
+        // State may wrap around the end of the buffers.
+        int stateFrames = GetStateFrames();
+        int stateCursor = BufferModulo(bufferCursor_ - stateFrames);
+        int headFrames = std::min(stateFrames, bufferSize_ - stateCursor);
+        memcpy(leftState, leftBuffer_ + stateCursor, headFrames * sizeof(float));
+        memcpy(rightState, rightBuffer_ + stateCursor, headFrames * sizeof(float));
+        memcpy(leftState + headFrames, leftBuffer_, (stateFrames - headFrames) * sizeof(float));
+        memcpy(rightState + headFrames, rightBuffer_, (stateFrames - headFrames) * sizeof(float));
+    }
+
+    /**
+     * Restores the state of the delay line copied by SaveState, possibly
+     * of another unit. The buffers must be allocated. If the state is
+     * longer than the buffers, only its newest samples are restored.
+     * @param leftState left channel samples of the state.
+     * @param rightState right channel samples of the state.
+     * @param stateFrames number of samples of each channel.
+     */
+    void PingPongDelayUnit::LoadState(const float* leftState, const float* rightState, int stateFrames)
+    {
+        // Output depends only on the distances behind the buffer cursor,
+        // so the state is restored from the start of the buffers.
+        int skippedFrames = std::max(stateFrames - bufferSize_, 0);
+        stateFrames -= skippedFrames;
+        memcpy(leftBuffer_, leftState + skippedFrames, stateFrames * sizeof(float));
+        memcpy(rightBuffer_, rightState + skippedFrames, stateFrames * sizeof(float));
+        bufferCursor_ = BufferModulo(stateFrames);
+        writtenFrames_ = stateFrames;
+        memset(leftAllpassStates_, 0, sizeof(leftAllpassStates_));
+        memset(rightAllpassStates_, 0, sizeof(rightAllpassStates_));
+        rampTempo_ = 0.0;
+        fadeFrames_ = 0;
+        freezeLength_ = 0;
+        thawFrames_ = 0;
+        resampler_.Reset();
+        economyDryGain_ = wetParamC_;
+    }
+
+    /**
+     * Calculates the smallest buffer size, with which every delay
+     * setting is delayed correctly.
+     * @param sampleRate a sample rate of the processing.
+     * @param tempo the lowest tempo the unit is synchronized to.
+     * @return size of the buffers in samples.
+     */
+    int PingPongDelayUnit::RequiredBufferSize(float sampleRate, float tempo)
+    {
+        // Fully delayed cursor must stay behind the buffer cursor, even
+        // with the two samples read beyond it by the Hermite interpolation.
+        return std::max(2 * MaxDelaySamples(sampleRate, tempo) + 3, 4);
+    }
+
+    /**
+     * Calculates the longest delay of any delay setting.
+     * @param sampleRate a sample rate of the processing.
+     * @param tempo the lowest tempo the unit is synchronized to.
+     * @return delay in samples.
+     */
+    int PingPongDelayUnit::MaxDelaySamples(float sampleRate, float tempo)
+    {
+        // Longest delays calculated the same way as by DelaySamples,
+        // the ratios are ascending.
+        float msSamples = (sampleRate / msInS_);
+        int maxAsyncDelay = (int)(maxAsyncDelayMs_ * msSamples);
+        float beatsPerSec = tempo / sInMin_;
+        float samplesPerBeat = sampleRate / beatsPerSec;
+        int maxSyncDelay = (int)(samplesPerBeat * syncDelayRatios_[syncDelayRatioCount_ - 1]);
+        return std::max(maxAsyncDelay, maxSyncDelay);
+    }
+
+#ifdef PINGPONGDELAY_TRIMMING
+    /**
+     * Sets the time of silence after which the unit offers its buffers
+     * to be trimmed. Must not be called while the unit is processing.
+     * @param idleTrimMs time of silence in milliseconds, zero disables
+     *      the trimming.
+     */
+    void PingPongDelayUnit::SetIdleTrimMs(int idleTrimMs)
+    {
+        idleTrimMs_ = idleTrimMs;
+        silentFrames_ = 0;
+    }
+
+    /**
+     * Releases the buffers, if the unit offered them to be trimmed and
+     * has not taken the offer back. Must not be called from the audio
+     * thread.
+     * @return released memory in bytes.
+     */
+    long long PingPongDelayUnit::TrimBuffers()
+    {
+        // Claiming the buffers, the audio thread does not touch them
+        // until they are trimmed.
+        int state = TrimRequestedBuffers;
+        if(!bufferState_.compare_exchange_strong(state, TrimmingBuffers, std::memory_order_acquire))
+        {
+            return 0;
+        }
+
+        long long memory = GetBufferMemory();
+        delete[] leftBuffer_;
+        delete[] rightBuffer_;
+        leftBuffer_ = NULL;
+        rightBuffer_ = NULL;
+        bufferState_.store(TrimmedBuffers, std::memory_order_release);
+        return memory;
+    }
+
+    /**
+     * Tells whether the buffers of the unit are trimmed, waiting to be
+     * provided from the pool of spare buffers.
+     * @return true if the buffers are trimmed, false otherwise.
+     */
+    bool PingPongDelayUnit::IsTrimmed()
+    {
+        return bufferState_.load(std::memory_order_acquire) == TrimmedBuffers;
+    }
+#endif
+
+    /**
+     * Calculates the current delay as a number of samples, considering
+     * whether the unit is synchronized with its time info tempo or not.
+     * @return delay in samples.
+     */
+    int PingPongDelayUnit::DelaySamples()
+    {
+        if(IsAsync())
+        {
+            // Setting the asynchronous pre-calculated delay as the delay
+            // in case that unit is asynchronous.
+            float msSamples = (LineRate() / msInS_);
+            return (int)(asyncDelayMs_ * msSamples);
+        }
+
+        // Calculating delay as number of samples in case that unit is
+        // synchronized to the tempo setting.
+        float beatsPerSec = timeInfo_->tempo / sInMin_;
+        float samplesPerBeat = LineRate() / beatsPerSec;
+        return (int)(samplesPerBeat * syncDelayRatios_[syncDelayRatioIndex_]);
+    }
+
+    /**
+     * Calculates the current delay as a fractional number of samples,
+     * the same way as DelaySamples does before the truncation.
+     * @return delay in samples.
+     */
+    float PingPongDelayUnit::ExactDelaySamples()
+    {
+        if(IsAsync())
+        {
+            float msSamples = (LineRate() / msInS_);
+            return asyncDelayMs_ * msSamples;
+        }
+
+        float beatsPerSec = timeInfo_->tempo / sInMin_;
+        float samplesPerBeat = LineRate() / beatsPerSec;
+        return samplesPerBeat * syncDelayRatios_[syncDelayRatioIndex_];
+    }
+
+    /**
+     * Calculates the delay of settings as a fractional number of samples,
+     * the same way as ExactDelaySamples does for the settings of unit.
+     * @param settings the settings.
+     * @return delay in samples.
+     */
+    float PingPongDelayUnit::ExactDelaySamples(const PingPongDelaySettings& settings)
+    {
+        if(settings.isAsync)
+        {
+            float msSamples = (LineRate() / msInS_);
+            return settings.asyncDelayMs * msSamples;
+        }
+
+        float beatsPerSec = timeInfo_->tempo / sInMin_;
+        float samplesPerBeat = LineRate() / beatsPerSec;
+        return samplesPerBeat * syncDelayRatios_[settings.syncDelayRatioIndex];
+    }
+
+    /**
+     * Takes over the published settings, if there are any, and starts
+     * crossfading to them, unless they read the delay line at the same
+     * places as the current ones. Called by the audio thread
+     * at the beginning of each block.
+     */
+    void PingPongDelayUnit::TakePublishedSettings()
+    {
+        unsigned int sequence = publishedSequence_.load(std::memory_order_acquire);
+        if((sequence & 1) || sequence == takenSequence_.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        // Settings being written meanwhile are left for the next block,
+        // so that the audio thread never waits for the publisher.
+        PingPongDelaySettings settings = publishedSettings_;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(publishedSequence_.load(std::memory_order_relaxed) != sequence)
+        {
+            return;
+        }
+
+        // Settings reading the delay line at the same places, such as
+        // an automated wet or feedback, are set at once, as by the setters.
+        PingPongDelaySettings current;
+        GetSettings(current);
+        if(ReadsSamePlaces(current, settings))
+        {
+            SetSettings(settings);
+            takenSequence_.store(sequence, std::memory_order_release);
+            return;
+        }
+
+        // Other settings published while crossfading wait for its end,
+        // so that the settings being faded out never jump, as well as
+        // the ones published while the delay line is frozen or thawing.
+        if(fadeFrames_ > 0 || freezeLength_ > 0)
+        {
+            return;
+        }
+
+        // The current settings are faded out by heads of their own.
+        fadingSettings_ = current;
+        memcpy(fadingLeftAllpassStates_, leftAllpassStates_, sizeof(leftAllpassStates_));
+        memcpy(fadingRightAllpassStates_, rightAllpassStates_, sizeof(rightAllpassStates_));
+        if(SetSettings(settings) && leftBuffer_)
+        {
+            fadeLength_ = FadeLength();
+            fadeFrames_ = fadeLength_;
+        }
+        takenSequence_.store(sequence, std::memory_order_release);
+    }
+
+    /**
+     * Tells whether two settings read the delay line at the same places
+     * the same way, so that switching between them needs no crossfade.
+     * @param first the first settings.
+     * @param second the second settings.
+     * @return true if the settings read the same places, false otherwise.
+     */
+    bool PingPongDelayUnit::ReadsSamePlaces(const PingPongDelaySettings& first, const PingPongDelaySettings& second)
+    {
+        if(first.isAsync != second.isAsync || first.interpolation != second.interpolation ||
+           first.tapCount != second.tapCount)
+        {
+            return false;
+        }
+        if(first.isAsync ? (first.asyncDelayMs != second.asyncDelayMs) :
+                           (first.syncDelayRatioIndex != second.syncDelayRatioIndex))
+        {
+            return false;
+        }
+        for(int tap = 0; tap < first.tapCount; ++tap)
+        {
+            if(first.tapTimeRatios[tap] != second.tapTimeRatios[tap])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Calculates the length of the crossfades in frames.
+     * @return length of the crossfades, at least one frame.
+     */
+    int PingPongDelayUnit::FadeLength()
+    {
+        return std::max(1, (int)(LineRate() * fadeMs_ / msInS_));
+    }
+
+    /**
+     * Processes frames crossfading from fadingSettings_ to the settings
+     * of unit. Both settings read the delay line by their own read heads,
+     * the output and the samples written to the delay line are blended
+     * frame by frame. Must not be called for more than fadeFrames_.
+     * @param leftInput an array of left channel samples to be processed.
+     * @param rightInput an array of right channel samples to be processed.
+     * @param leftOutput where to store the effected left channel samples.
+     * @param rightOutput where to store the effected right channel samples.
+     * @param sampleFrames number of samples of each channel.
+     */
+    void PingPongDelayUnit::ProcessFadingFrames(const float* leftInput, const float* rightInput, float* leftOutput,
+                                                float* rightOutput, int sampleFrames)
+    {
+        // The delay is constant within the block, so the heads of both
+        // settings are placed once.
+        PingPongDelaySettings settings;
+        GetSettings(settings);
+        PingPongDelayReadHead heads[2];
+        PingPongDelayReadHead fadingHeads[2];
+        int tapDistances[maxTapCount];
+        int fadingTapDistances[maxTapCount];
+        PlaceSettingsHeads(settings, heads, tapDistances);
+        PlaceSettingsHeads(fadingSettings_, fadingHeads, fadingTapDistances);
+
+        for(int frame = 0; frame < sampleFrames; ++frame)
+        {
+            float leftInputSample = leftInput[frame];
+            float rightInputSample = rightInput[frame];
+            float leftSample;
+            float rightSample;
+            float leftWritten;
+            float rightWritten;
+            ReadSettingsFrame(settings, heads, tapDistances, false, leftInputSample, rightInputSample, leftSample,
+                              rightSample, leftWritten, rightWritten, leftAllpassStates_, rightAllpassStates_);
+            float fadingLeftSample;
+            float fadingRightSample;
+            float fadingLeftWritten;
+            float fadingRightWritten;
+            ReadSettingsFrame(fadingSettings_, fadingHeads, fadingTapDistances, false, leftInputSample, rightInputSample,
+                              fadingLeftSample, fadingRightSample, fadingLeftWritten, fadingRightWritten,
+                              fadingLeftAllpassStates_, fadingRightAllpassStates_);
+
+            // Gain of the settings faded in rises linearly, reaching one
+            // at the last frame of the crossfade.
+            --fadeFrames_;
+            float gain = (float)(fadeLength_ - fadeFrames_) / fadeLength_;
+            leftWritten = fadingLeftWritten + gain * (leftWritten - fadingLeftWritten);
+            rightWritten = fadingRightWritten + gain * (rightWritten - fadingRightWritten);
+            leftOutput[frame] = fadingLeftSample + gain * (leftSample - fadingLeftSample);
+            rightOutput[frame] = fadingRightSample + gain * (rightSample - fadingRightSample);
+
+            leftBuffer_[bufferCursor_] = leftWritten;
+            rightBuffer_[bufferCursor_] = rightWritten;
+            MeterFrame(leftInputSample, rightInputSample, leftWritten, rightWritten, leftOutput[frame], rightOutput[frame]);
+            IncrementBufferCursor();
+            AdvanceWatermark(1);
+        }
+    }
+
+    /**
+     * Places the semi and the full delayed read heads and calculates
+     * the tap distances of settings.
+     * @param settings the settings.
+     * @param heads where to store the two heads.
+     * @param tapDistances where to store the distances of the taps.
+     */
+    void PingPongDelayUnit::PlaceSettingsHeads(const PingPongDelaySettings& settings, PingPongDelayReadHead* heads, int* tapDistances)
+    {
+        // Heads without interpolation read whole multiples of the truncated
+        // delay, as ProcessBlock does.
+        float delay = ExactDelaySamples(settings);
+        int delaySamples = (int)delay;
+        for(int head = 0; head < 2; ++head)
+        {
+            if(settings.interpolation == NoInterpolation)
+            {
+                heads[head].distance = delaySamples * (head + 1);
+                heads[head].coefficients[0] = 1.0f;
+            }
+            else
+            {
+                float fraction;
+                heads[head].distance = SplitDistance(settings.interpolation, (head + 1) * delay, fraction);
+                Coefficients(settings.interpolation, fraction, heads[head].coefficients);
+            }
+        }
+        for(int tap = 0; tap < settings.tapCount; ++tap)
+        {
+            tapDistances[tap] = BufferModulo((int)(settings.tapTimeRatios[tap] * delaySamples));
+        }
+    }
+
+    /**
+     * Reads a single frame of the delay line as settings do, without
+     * writing it. The read samples may wrap around the end of the buffers.
+     * @param settings the settings.
+     * @param heads the read heads of the settings.
+     * @param tapDistances the tap distances of the settings.
+     * @param frozen whether to read the frozen loop instead of the samples
+     *      behind the buffer cursor. The samples to be written are then
+     *      the ones held by the loop.
+     * @param leftInput a left channel sample to be processed.
+     * @param rightInput a right channel sample to be processed.
+     * @param leftOutput where to store the effected left channel sample.
+     * @param rightOutput where to store the effected right channel sample.
+     * @param leftWritten where to store the left channel sample to be written.
+     * @param rightWritten where to store the right channel sample to be written.
+     * @param leftStates the left channel allpass states of the heads.
+     * @param rightStates the right channel allpass states of the heads.
+     */
+    void PingPongDelayUnit::ReadSettingsFrame(const PingPongDelaySettings& settings, const PingPongDelayReadHead* heads,
+                                              const int* tapDistances, bool frozen, float leftInput, float rightInput, float& leftOutput,
+                                              float& rightOutput, float& leftWritten, float& rightWritten, float* leftStates,
+                                              float* rightStates)
+    {
+        int pointCount = InterpolationPoints(settings.interpolation);
+        float leftDelayed[2];
+        float rightDelayed[2];
+        for(int head = 0; head < 2; ++head)
+        {
+            float leftPoints[maxInterpolationPoints];
+            float rightPoints[maxInterpolationPoints];
+            for(int point = 0; point < pointCount; ++point)
+            {
+                int distance = BufferModulo(heads[head].distance + point);
+                int cursor = frozen ? FrozenCursor(heads[head].distance + point) : BufferModulo(bufferCursor_ - distance);
+                ClearUnwritten(cursor, distance, 1);
+                leftPoints[pointCount - 1 - point] = leftBuffer_[cursor];
+                rightPoints[pointCount - 1 - point] = rightBuffer_[cursor];
+            }
+            if(settings.interpolation == NoInterpolation)
+            {
+                leftDelayed[head] = leftPoints[0];
+                rightDelayed[head] = rightPoints[0];
+            }
+            else
+            {
+                leftDelayed[head] = Interpolate(settings.interpolation, leftPoints + pointCount - 1, heads[head].coefficients, leftStates[head]);
+                rightDelayed[head] = Interpolate(settings.interpolation, rightPoints + pointCount - 1, heads[head].coefficients, rightStates[head]);
+            }
+        }
+
+        // Frozen loop holds the samples it reads, nothing is fed back.
+        if(frozen)
+        {
+            leftWritten = leftDelayed[1];
+            rightWritten = rightDelayed[1];
+        }
+        else
+        {
+            leftWritten = (leftInput + leftDelayed[1]) * settings.feedback;
+            rightWritten = (rightInput + rightDelayed[1]) * settings.feedback;
+        }
+
+        float primary = settings.primaryPanningQuotient;
+        float secondary = settings.secondaryPanningQuotient;
+        float semiDelayed = primary * leftDelayed[0] + secondary * rightDelayed[0];
+        float fullDelayed = secondary * leftDelayed[1] + primary * rightDelayed[1];
+        float leftEcho = (settings.panoramaParamC * semiDelayed) + (settings.panoramaParam * fullDelayed);
+        float rightEcho = (settings.panoramaParam * semiDelayed) + (settings.panoramaParamC * fullDelayed);
+        for(int tap = 0; tap < settings.tapCount; ++tap)
+        {
+            // Taps at no distance read the samples just being written,
+            // unless the loop is frozen.
+            float tapped = leftWritten + rightWritten;
+            if(frozen || tapDistances[tap] > 0)
+            {
+                int cursor = frozen ? FrozenCursor(tapDistances[tap]) : BufferModulo(bufferCursor_ - tapDistances[tap]);
+                ClearUnwritten(cursor, tapDistances[tap], 1);
+                tapped = leftBuffer_[cursor] + rightBuffer_[cursor];
+            }
+            leftEcho += settings.tapLeftGains[tap] * tapped;
+            rightEcho += settings.tapRightGains[tap] * tapped;
+        }
+        float dry = DryGain(settings.wetParamC);
+        leftOutput = (dry * leftInput) + (settings.wetParam * leftEcho);
+        rightOutput = (dry * rightInput) + (settings.wetParam * rightEcho);
+    }
+
+    /**
+     * Freezes the delay line at the buffer cursor. The loop spans the last
+     * two delays, so that both heads keep reading what they read before.
+     * Its end is blended into the samples preceding its beginning, so that
+     * it wraps around without a click.
+     */
+    void PingPongDelayUnit::StartFreeze()
+    {
+        int loopLength = 2 * DelaySamples();
+        if(loopLength < 1 || loopLength > bufferSize_)
+        {
+            return;
+        }
+
+        // The loop may read any sample as long as it lasts, so the ones
+        // not written since the last reset are cleared at once.
+        ClearUnwrittenBlock(leftBuffer_, bufferSize_, bufferSize_);
+        ClearUnwrittenBlock(rightBuffer_, bufferSize_, bufferSize_);
+        AdvanceWatermark(bufferSize_);
+
+        // The samples preceding the beginning of the loop continue into it
+        // the same way as the blended end of the loop does.
+        int seamFrames = std::min(std::min(FadeLength(), loopLength / 2), bufferSize_ - loopLength - maxInterpolationPoints);
+        for(int frame = 0; frame < seamFrames; ++frame)
+        {
+            float gain = (float)(frame + 1) / seamFrames;
+            int cursor = BufferModulo(bufferCursor_ - seamFrames + frame);
+            int precedingCursor = BufferModulo(cursor - loopLength);
+            leftBuffer_[cursor] += gain * (leftBuffer_[precedingCursor] - leftBuffer_[cursor]);
+            rightBuffer_[cursor] += gain * (rightBuffer_[precedingCursor] - rightBuffer_[cursor]);
+        }
+
+        freezeLength_ = loopLength;
+        freezeCursor_ = bufferCursor_;
+        freezeOffset_ = 0;
+    }
+
+    /**
+     * Starts crossfading from the frozen loop to the delay line being
+     * written again, or ends the freeze at once, if the written samples
+     * would reach the loop before the crossfade ends.
+     */
+    void PingPongDelayUnit::StartThaw()
+    {
+        // Samples written while thawing must not reach the oldest ones
+        // the loop reads, including the points interpolated around them.
+        int readFrames = std::max(freezeLength_, 2 * DelaySamples()) + 2 * maxInterpolationPoints;
+        thawLength_ = std::min(FadeLength(), bufferSize_ - readFrames);
+        if(thawLength_ < 1)
+        {
+            freezeLength_ = 0;
+            return;
+        }
+
+        // The loop is faded out by heads of its own.
+        thawFrames_ = thawLength_;
+        memcpy(frozenLeftAllpassStates_, leftAllpassStates_, sizeof(leftAllpassStates_));
+        memcpy(frozenRightAllpassStates_, rightAllpassStates_, sizeof(rightAllpassStates_));
+    }
+
+    /**
+     * Calculates the buffer index, at which a read head of the frozen loop
+     * reads. Heads reading behind the beginning of the loop are wrapped
+     * back by its length.
+     * @param distance a distance of the head behind the virtual cursor
+     *      of the loop.
+     * @return buffer index of the read sample.
+     */
+    int PingPongDelayUnit::FrozenCursor(int distance)
+    {
+        // Virtual cursor is freezeOffset_ frames past the end of the loop.
+        int behindEnd = freezeOffset_ - distance;
+        if(behindEnd >= 0)
+        {
+            behindEnd = behindEnd % freezeLength_ - freezeLength_;
+        }
+        return BufferModulo(freezeCursor_ + behindEnd);
+    }
+
+    /**
+     * Processes a block while the delay line is frozen. Nothing is written,
+     * the heads and the taps read the loop by contiguous segments.
+     * @param leftInput an array of left channel samples to be processed.
+     * @param rightInput an array of right channel samples to be processed.
+     * @param leftOutput where to store the effected left channel samples.
+     * @param rightOutput where to store the effected right channel samples.
+     * @param sampleFrames number of samples of each channel.
+     */
+    void PingPongDelayUnit::ProcessFrozenBlock(const float* leftInput, const float* rightInput, float* leftOutput,
+                                               float* rightOutput, int sampleFrames)
+    {
+        // The delay is constant within the block, so the heads are placed once.
+        PingPongDelaySettings settings;
+        GetSettings(settings);
+        PingPongDelayReadHead heads[2];
+        int tapDistances[maxTapCount];
+        PlaceSettingsHeads(settings, heads, tapDistances);
+        int interpolation = settings.interpolation;
+        int pointCount = InterpolationPoints(interpolation);
+        int tapCount = settings.tapCount;
+
+        int frame = 0;
+        while(frame < sampleFrames)
+        {
+            int headCursors[2];
+            int tapCursors[maxTapCount];
+
+            // Segment ends before any of the cursors wraps around the end
+            // of the buffers or reaches the end of the loop, from which
+            // it jumps back to the beginning of the loop.
+            int segmentFrames = sampleFrames - frame;
+            bool straddling = false;
+            for(int head = 0; head < 2; ++head)
+            {
+                headCursors[head] = FrozenCursor(heads[head].distance);
+                straddling = straddling || (headCursors[head] < pointCount - 1);
+                segmentFrames = std::min(segmentFrames, bufferSize_ - headCursors[head]);
+                segmentFrames = std::min(segmentFrames, BufferModulo(freezeCursor_ - headCursors[head]));
+            }
+            for(int tap = 0; tap < tapCount; ++tap)
+            {
+                tapCursors[tap] = FrozenCursor(tapDistances[tap]);
+                segmentFrames = std::min(segmentFrames, bufferSize_ - tapCursors[tap]);
+                segmentFrames = std::min(segmentFrames, BufferModulo(freezeCursor_ - tapCursors[tap]));
+            }
+
+            // Frames whose heads read across the end of the buffers are
+            // processed one by one with wrapping indexes.
+            if(straddling)
+            {
+                float leftInputSample = leftInput[frame];
+                float rightInputSample = rightInput[frame];
+                float leftHeld;
+                float rightHeld;
+                ReadSettingsFrame(settings, heads, tapDistances, true, leftInputSample, rightInputSample, leftOutput[frame],
+                                  rightOutput[frame], leftHeld, rightHeld, leftAllpassStates_, rightAllpassStates_);
+                MeterFrame(leftInputSample, rightInputSample, leftHeld, rightHeld, leftOutput[frame], rightOutput[frame]);
+                freezeOffset_ = (freezeOffset_ + 1) % freezeLength_;
+                ++frame;
+                continue;
+            }
+
+            switch(interpolation)
+            {
+                case NoInterpolation:
+                    ProcessFrozenSegment<NoInterpolation>(leftInput + frame, rightInput + frame, leftOutput + frame,
+                                                          rightOutput + frame, segmentFrames, heads, headCursors,
+                                                          tapCount, tapCursors);
+                    break;
+
+                case LinearInterpolation:
+                    ProcessFrozenSegment<LinearInterpolation>(leftInput + frame, rightInput + frame, leftOutput + frame,
+                                                              rightOutput + frame, segmentFrames, heads, headCursors,
+                                                              tapCount, tapCursors);
+                    break;
+
+                case HermiteInterpolation:
+                    ProcessFrozenSegment<HermiteInterpolation>(leftInput + frame, rightInput + frame, leftOutput + frame,
+                                                               rightOutput + frame, segmentFrames, heads, headCursors,
+                                                               tapCount, tapCursors);
+                    break;
+
+                case AllpassInterpolation:
+                    ProcessFrozenSegment<AllpassInterpolation>(leftInput + frame, rightInput + frame, leftOutput + frame,
+                                                               rightOutput + frame, segmentFrames, heads, headCursors,
+                                                               tapCount, tapCursors);
+                    break;
+            }
+            freezeOffset_ = (freezeOffset_ + segmentFrames) % freezeLength_;
+            frame += segmentFrames;
+        }
+    }
+
+    /**
+     * Processes a segment of a frozen block, within which none of the read
+     * cursors wraps around the end of the buffers nor jumps back to
+     * the beginning of the loop, and no head reads across the end of
+     * the buffers. Accumulates the metered levels, the held samples
+     * are metered as the delay line.
+     * @param leftInput an array of left channel samples to be processed.
+     * @param rightInput an array of right channel samples to be processed.
+     * @param leftOutput where to store the effected left channel samples.
+     * @param rightOutput where to store the effected right channel samples.
+     * @param sampleFrames number of samples of each channel.
+     * @param heads the semi and the full delayed read heads.
+     * @param headCursors buffer indexes of the newest samples read by the heads.
+     * @param tapCount number of taps read by the segment.
+     * @param tapCursors buffer indexes of the taps.
+     */
+    template<int interpolation>
+    void PingPongDelayUnit::ProcessFrozenSegment(const float* leftInput, const float* rightInput, float* leftOutput,
+                                                 float* rightOutput, int sampleFrames, const PingPongDelayReadHead* heads,
+                                                 const int* headCursors, int tapCount, const int* tapCursors)
+    {
+        // Nothing is written, so there is neither the feedback to calculate
+        // nor the buffers to store to. The heads are held by plain locals
+        // the same way as ProcessSegment does.
+        const float* leftSemiDelayed = leftBuffer_ + headCursors[0];
+        const float* rightSemiDelayed = rightBuffer_ + headCursors[0];
+        const float* leftFullDelayed = leftBuffer_ + headCursors[1];
+        const float* rightFullDelayed = rightBuffer_ + headCursors[1];
+        float semiCoefficients[maxInterpolationPoints];
+        float fullCoefficients[maxInterpolationPoints];
+        memcpy(semiCoefficients, heads[0].coefficients, sizeof(semiCoefficients));
+        memcpy(fullCoefficients, heads[1].coefficients, sizeof(fullCoefficients));
+        float leftSemiState = leftAllpassStates_[0];
+        float rightSemiState = rightAllpassStates_[0];
+        float leftFullState = leftAllpassStates_[1];
+        float rightFullState = rightAllpassStates_[1];
+
+        float wet = wetParam_;
+        float dry = DryGain(wetParamC_);
+        float panorama = panoramaParam_;
+        float panoramaC = panoramaParamC_;
+        float primary = primaryPanningQuotient_;
+        float secondary = secondaryPanningQuotient_;
+
+        const float* leftTapped[maxTapCount];
+        const float* rightTapped[maxTapCount];
+        float tapLeftGains[maxTapCount];
+        float tapRightGains[maxTapCount];
+        for(int tap = 0; tap < tapCount; ++tap)
+        {
+            leftTapped[tap] = leftBuffer_ + tapCursors[tap];
+            rightTapped[tap] = rightBuffer_ + tapCursors[tap];
+            tapLeftGains[tap] = tapLeftGains_[tap];
+            tapRightGains[tap] = tapRightGains_[tap];
+        }
+
+        float peaks[meterPointCount][meterChannelCount][meterLaneCount_];
+        float sums[meterPointCount][meterChannelCount][meterLaneCount_];
+        memset(peaks, 0, sizeof(peaks));
+        memset(sums, 0, sizeof(sums));
+
+        // Frames are processed in groups of lanes the same way as
+        // ProcessSegment does.
+        int groupedFrames = sampleFrames - (sampleFrames % meterLaneCount_);
+
+        int frame = 0;
+        for(; frame < groupedFrames; frame += meterLaneCount_)
+        {
+            float leftInputSamples[meterLaneCount_];
+            float rightInputSamples[meterLaneCount_];
+            float leftHeldSamples[meterLaneCount_];
+            float rightHeldSamples[meterLaneCount_];
+            float leftEchoes[meterLaneCount_];
+            float rightEchoes[meterLaneCount_];
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                int i = frame + lane;
+                float leftSemi = leftSemiDelayed[i];
+                float rightSemi = rightSemiDelayed[i];
+                float leftFull = leftFullDelayed[i];
+                float rightFull = rightFullDelayed[i];
+                if(interpolation != NoInterpolation)
+                {
+                    leftSemi = Interpolate(interpolation, leftSemiDelayed + i, semiCoefficients, leftSemiState);
+                    rightSemi = Interpolate(interpolation, rightSemiDelayed + i, semiCoefficients, rightSemiState);
+                    leftFull = Interpolate(interpolation, leftFullDelayed + i, fullCoefficients, leftFullState);
+                    rightFull = Interpolate(interpolation, rightFullDelayed + i, fullCoefficients, rightFullState);
+                }
+                leftInputSamples[lane] = leftInput[i];
+                rightInputSamples[lane] = rightInput[i];
+                leftHeldSamples[lane] = leftFull;
+                rightHeldSamples[lane] = rightFull;
+
+                float semiDelayed = primary * leftSemi + secondary * rightSemi;
+                float fullDelayed = secondary * leftFull + primary * rightFull;
+                leftEchoes[lane] = (panoramaC * semiDelayed) + (panorama * fullDelayed);
+                rightEchoes[lane] = (panorama * semiDelayed) + (panoramaC * fullDelayed);
+            }
+
+            for(int tap = 0; tap < tapCount; ++tap)
+            {
+                for(int lane = 0; lane < meterLaneCount_; ++lane)
+                {
+                    float tapped = leftTapped[tap][frame + lane] + rightTapped[tap][frame + lane];
+                    leftEchoes[lane] += tapLeftGains[tap] * tapped;
+                    rightEchoes[lane] += tapRightGains[tap] * tapped;
+                }
+            }
+
+            float leftOutputSamples[meterLaneCount_];
+            float rightOutputSamples[meterLaneCount_];
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                leftOutputSamples[lane] = (dry * leftInputSamples[lane]) + (wet * leftEchoes[lane]);
+                rightOutputSamples[lane] = (dry * rightInputSamples[lane]) + (wet * rightEchoes[lane]);
+            }
+
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                leftOutput[frame + lane] = leftOutputSamples[lane];
+                rightOutput[frame + lane] = rightOutputSamples[lane];
+            }
+
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                AccumulateLevel(leftInputSamples[lane], peaks[InputMeter][0][lane], sums[InputMeter][0][lane]);
+                AccumulateLevel(rightInputSamples[lane], peaks[InputMeter][1][lane], sums[InputMeter][1][lane]);
+                AccumulateLevel(leftHeldSamples[lane], peaks[DelayMeter][0][lane], sums[DelayMeter][0][lane]);
+                AccumulateLevel(rightHeldSamples[lane], peaks[DelayMeter][1][lane], sums[DelayMeter][1][lane]);
+                AccumulateLevel(leftOutputSamples[lane], peaks[OutputMeter][0][lane], sums[OutputMeter][0][lane]);
+                AccumulateLevel(rightOutputSamples[lane], peaks[OutputMeter][1][lane], sums[OutputMeter][1][lane]);
+            }
+        }
+
+        for(; frame < sampleFrames; ++frame)
+        {
+            float leftSemi = leftSemiDelayed[frame];
+            float rightSemi = rightSemiDelayed[frame];
+            float leftFull = leftFullDelayed[frame];
+            float rightFull = rightFullDelayed[frame];
+            if(interpolation != NoInterpolation)
+            {
+                leftSemi = Interpolate(interpolation, leftSemiDelayed + frame, semiCoefficients, leftSemiState);
+                rightSemi = Interpolate(interpolation, rightSemiDelayed + frame, semiCoefficients, rightSemiState);
+                leftFull = Interpolate(interpolation, leftFullDelayed + frame, fullCoefficients, leftFullState);
+                rightFull = Interpolate(interpolation, rightFullDelayed + frame, fullCoefficients, rightFullState);
+            }
+
+            float leftInputSample = leftInput[frame];
+            float rightInputSample = rightInput[frame];
+            float semiDelayed = primary * leftSemi + secondary * rightSemi;
+            float fullDelayed = secondary * leftFull + primary * rightFull;
+            float leftEcho = (panoramaC * semiDelayed) + (panorama * fullDelayed);
+            float rightEcho = (panorama * semiDelayed) + (panoramaC * fullDelayed);
+            for(int tap = 0; tap < tapCount; ++tap)
+            {
+                float tapped = leftTapped[tap][frame] + rightTapped[tap][frame];
+                leftEcho += tapLeftGains[tap] * tapped;
+                rightEcho += tapRightGains[tap] * tapped;
+            }
+            leftOutput[frame] = (dry * leftInputSample) + (wet * leftEcho);
+            rightOutput[frame] = (dry * rightInputSample) + (wet * rightEcho);
+
+            AccumulateLevel(leftInputSample, peaks[InputMeter][0][0], sums[InputMeter][0][0]);
+            AccumulateLevel(rightInputSample, peaks[InputMeter][1][0], sums[InputMeter][1][0]);
+            AccumulateLevel(leftFull, peaks[DelayMeter][0][0], sums[DelayMeter][0][0]);
+            AccumulateLevel(rightFull, peaks[DelayMeter][1][0], sums[DelayMeter][1][0]);
+            AccumulateLevel(leftOutput[frame], peaks[OutputMeter][0][0], sums[OutputMeter][0][0]);
+            AccumulateLevel(rightOutput[frame], peaks[OutputMeter][1][0], sums[OutputMeter][1][0]);
+        }
+
+        leftAllpassStates_[0] = leftSemiState;
+        rightAllpassStates_[0] = rightSemiState;
+        leftAllpassStates_[1] = leftFullState;
+        rightAllpassStates_[1] = rightFullState;
+
+        // Folding the lanes into the metering window.
+        for(int point = 0; point < meterPointCount; ++point)
+        {
+            for(int channel = 0; channel < meterChannelCount; ++channel)
+            {
+                for(int lane = 0; lane < meterLaneCount_; ++lane)
+                {
+                    meterPeaks_[point][channel] = std::max(meterPeaks_[point][channel], peaks[point][channel][lane]);
+                    meterSums_[point][channel] += sums[point][channel][lane];
+                }
+            }
+        }
+    }
+
+    /**
+     * Processes frames crossfading from the frozen loop to the delay line
+     * being written again. The output and the samples written to the delay
+     * line are blended frame by frame. Must not be called for more than
+     * thawFrames_.
+     * @param leftInput an array of left channel samples to be processed.
+     * @param rightInput an array of right channel samples to be processed.
+     * @param leftOutput where to store the effected left channel samples.
+     * @param rightOutput where to store the effected right channel samples.
+     * @param sampleFrames number of samples of each channel.
+     */
+    void PingPongDelayUnit::ProcessThawingFrames(const float* leftInput, const float* rightInput, float* leftOutput,
+                                                 float* rightOutput, int sampleFrames)
+    {
+        // The delay is constant within the block, so the heads are placed
+        // once, both the loop and the delay line read by the same ones.
+        PingPongDelaySettings settings;
+        GetSettings(settings);
+        PingPongDelayReadHead heads[2];
+        int tapDistances[maxTapCount];
+        PlaceSettingsHeads(settings, heads, tapDistances);
+
+        for(int frame = 0; frame < sampleFrames; ++frame)
+        {
+            float leftInputSample = leftInput[frame];
+            float rightInputSample = rightInput[frame];
+            float leftSample;
+            float rightSample;
+            float leftWritten;
+            float rightWritten;
+            ReadSettingsFrame(settings, heads, tapDistances, false, leftInputSample, rightInputSample, leftSample,
+                              rightSample, leftWritten, rightWritten, leftAllpassStates_, rightAllpassStates_);
+            float frozenLeftSample;
+            float frozenRightSample;
+            float leftHeld;
+            float rightHeld;
+            ReadSettingsFrame(settings, heads, tapDistances, true, leftInputSample, rightInputSample, frozenLeftSample,
+                              frozenRightSample, leftHeld, rightHeld, frozenLeftAllpassStates_, frozenRightAllpassStates_);
+
+            // Gain of the delay line faded in rises linearly, reaching one
+            // at the last frame of the crossfade.
+            --thawFrames_;
+            float gain = (float)(thawLength_ - thawFrames_) / thawLength_;
+            leftWritten = leftHeld + gain * (leftWritten - leftHeld);
+            rightWritten = rightHeld + gain * (rightWritten - rightHeld);
+            leftOutput[frame] = frozenLeftSample + gain * (leftSample - frozenLeftSample);
+            rightOutput[frame] = frozenRightSample + gain * (rightSample - frozenRightSample);
+
+            leftBuffer_[bufferCursor_] = leftWritten;
+            rightBuffer_[bufferCursor_] = rightWritten;
+            MeterFrame(leftInputSample, rightInputSample, leftWritten, rightWritten, leftOutput[frame], rightOutput[frame]);
+            IncrementBufferCursor();
+            AdvanceWatermark(1);
+            freezeOffset_ = (freezeOffset_ + 1) % freezeLength_;
+        }
+
+        if(thawFrames_ == 0)
+        {
+            freezeLength_ = 0;
+        }
+    }
+
+    /**
+     * Tells whether the delay of the current block ramps from
+     * the previous tempo and calculates the delay it ramps from.
+     * The delay ramps only while the unit is synchronized with
+     * interpolation, the tempo changed since the previous block
+     * and the playback was not relocated.
+     * @param rampDelay where to store the delay in samples at
+     *      the previous tempo.
+     * @return true if the delay ramps, false otherwise.
+     */
+    bool PingPongDelayUnit::GetRampDelay(float& rampDelay)
+    {
+        if(IsAsync() || interpolation_ == NoInterpolation || rampTempo_ <= 0.0 || rampTempo_ == timeInfo_->tempo)
+        {
+            return false;
+        }
+
+        // Jumps of the playback position are followed by jumps of the tempo,
+        // which must not be smeared over the block.
+        if(timeInfo_->flags & kVstTransportChanged)
+        {
+            return false;
+        }
+        if(rampPpqPosValid_ && (timeInfo_->flags & kVstPpqPosValid) &&
+           fabs(timeInfo_->ppqPos - rampPpqPos_) > rampPpqTolerance_)
+        {
+            return false;
+        }
+
+        float beatsPerSec = rampTempo_ / sInMin_;
+        float samplesPerBeat = LineRate() / beatsPerSec;
+        rampDelay = samplesPerBeat * syncDelayRatios_[syncDelayRatioIndex_];
+        return true;
+    }
+
+    /**
+     * Remembers the tempo and the expected musical position of the next
+     * block, once the current block is processed.
+     * @param sampleFrames number of frames of the processed block.
+     */
+    void PingPongDelayUnit::AdvanceRamp(int sampleFrames)
+    {
+        rampTempo_ = timeInfo_->tempo;
+        rampPpqPosValid_ = (timeInfo_->flags & kVstPpqPosValid) && timeInfo_->sampleRate > 0.0;
+        if(rampPpqPosValid_)
+        {
+            rampPpqPos_ = timeInfo_->ppqPos + sampleFrames * timeInfo_->tempo / (sInMin_ * timeInfo_->sampleRate);
+        }
+    }
+
+    /**
+     * Places the semi and the full delayed read heads at the current
+     * delay and twice the delay behind the buffer cursor.
+     * @param heads where to store the two heads.
+     * @param interpolation an interpolation of the heads, other than
+     *      NoInterpolation.
+     */
+    void PingPongDelayUnit::PlaceReadHeads(PingPongDelayReadHead* heads, int interpolation)
+    {
+        float delay = ExactDelaySamples();
+        for(int head = 0; head < 2; ++head)
+        {
+            // The coefficients are calculated once per placement from
+            // the fraction of the distance, it is the same for all
+            // the frames read by the head.
+            float fraction;
+            heads[head].distance = SplitDistance(interpolation, (head + 1) * delay, fraction);
+            Coefficients(interpolation, fraction, heads[head].coefficients);
+        }
+    }
+
+    /**
+     * Splits a fractional distance behind the buffer cursor into
+     * the distance of the newest sample read by a read head and
+     * the fraction interpolated by the head.
+     * @param interpolation an interpolation of the head, other than
+     *      NoInterpolation.
+     * @param distance a distance behind the buffer cursor in samples.
+     * @param fraction where to store the interpolated fraction.
+     * @return distance of the newest read sample.
+     */
+    inline int PingPongDelayUnit::SplitDistance(int interpolation, float distance, float& fraction)
+    {
+        int whole = (int)distance;
+        fraction = distance - whole;
+        if(interpolation == HermiteInterpolation)
+        {
+            // Hermite reads one more sample on each side of the distance.
+            return whole - 1;
+        }
+        if(interpolation == AllpassInterpolation && fraction < 0.5f)
+        {
+            // The first order allpass delays between [0.5, 1.5) samples,
+            // where its phase delay is the flattest, the rest of
+            // the distance is read whole.
+            fraction += 1.0f;
+            return whole - 1;
+        }
+        return whole;
+    }
+
+    /**
+     * Calculates the coefficients of the samples read by a read head,
+     * from the newest one. Coefficients of the samples the head does not
+     * read are zero.
+     * @param interpolation an interpolation of the head, other than
+     *      NoInterpolation.
+     * @param fraction the fraction interpolated by the head, as split
+     *      by SplitDistance.
+     * @param coefficients where to store maxInterpolationPoints coefficients.
+     */
+    inline void PingPongDelayUnit::Coefficients(int interpolation, float fraction, float* coefficients)
+    {
+        // Calculated rather than looked up in tables of the fractions.
+        // The heads are placed once per block unless the delay ramps,
+        // and even the ramping heads, placed for each frame, gained
+        // only about 6 % with the Hermite table of 1024 fractions
+        // and lost about 5 % with the allpass one, while the tables
+        // would quantize the fraction.
+        memset(coefficients, 0, maxInterpolationPoints * sizeof(float));
+        switch(interpolation)
+        {
+            case LinearInterpolation:
+                coefficients[0] = 1.0f - fraction;
+                coefficients[1] = fraction;
+                break;
+
+            case HermiteInterpolation:
+                // Catmull-Rom spline through the two samples around
+                // the distance and their two neighbours.
+                coefficients[0] = ((-0.5f * fraction + 1.0f) * fraction - 0.5f) * fraction;
+                coefficients[1] = (1.5f * fraction - 2.5f) * fraction * fraction + 1.0f;
+                coefficients[2] = ((-1.5f * fraction + 2.0f) * fraction + 0.5f) * fraction;
+                coefficients[3] = (0.5f * fraction - 0.5f) * fraction * fraction;
+                break;
+
+            case AllpassInterpolation:
+                coefficients[0] = (1.0f - fraction) / (1.0f + fraction);
+                break;
+        }
+    }
+
+    /**
+     * Gets the number of samples read at once by a read head.
+     * @param interpolation an interpolation of the head.
+     * @return number of samples up to maxInterpolationPoints.
+     */
+    int PingPongDelayUnit::InterpolationPoints(int interpolation)
+    {
+        switch(interpolation)
+        {
+            case LinearInterpolation:
+            case AllpassInterpolation:
+                return 2;
+
+            case HermiteInterpolation:
+                return 4;
+        }
+        return 1;
+    }
+
+    /**
+     * Interpolates the sample read by a read head.
+     * @param interpolation an interpolation of the head, other than
+     *      NoInterpolation.
+     * @param newest a pointer to the newest read sample, the older ones
+     *      precede it.
+     * @param coefficients coefficients of the head.
+     * @param state the previous sample of the head, updated by allpass
+     *      interpolation.
+     * @return interpolated sample.
+     */
+    float PingPongDelayUnit::Interpolate(int interpolation, const float* newest, const float* coefficients, float& state)
+    {
+        if(interpolation == AllpassInterpolation)
+        {
+            state = coefficients[0] * (newest[0] - state) + newest[-1];
+            return state;
+        }
+
+        float sample = coefficients[0] * newest[0] + coefficients[1] * newest[-1];
+        if(interpolation == HermiteInterpolation)
+        {
+            sample += coefficients[2] * newest[-2];
+            sample += coefficients[3] * newest[-3];
+        }
+        return sample;
+    }
+
+    /**
+     * Calculates the distance of a tap behind the buffer cursor.
+     * @param tap an index of the tap.
+     * @param delaySamples the current delay in samples.
+     * @return distance in samples.
+     */
+    int PingPongDelayUnit::TapDistance(int tap, int delaySamples)
+    {
+        return BufferModulo((int)(tapTimeRatios_[tap] * delaySamples));
+    }
+
+    /**
+     * Precalculates the gains of a tap in the channels from its gain
+     * and panorama.
+     * @param tap an index of the tap.
+     */
+    void PingPongDelayUnit::UpdateTapGains(int tap)
+    {
+        TapGains(tapGainParams_[tap], tapPanoramaParams_[tap], tapLeftGains_[tap], tapRightGains_[tap]);
+    }
+
+    /**
+     * Processes a segment of a block, within which none of the buffer
+     * cursors wraps and which reads no samples it writes, except when
+     * the delayed cursors equal the buffer cursor, so that it runs over
+     * contiguous arrays. Accumulates the metered levels.
+     * @param leftInput an array of left channel samples to be processed.
+     * @param rightInput an array of right channel samples to be processed.
+     * @param leftOutput where to store the effected left channel samples.
+     * @param rightOutput where to store the effected right channel samples.
+     * @param sampleFrames number of samples of each channel.
+     * @param semiDelayedCursor buffer index delayed once behind the cursor.
+     * @param fullDelayedCursor buffer index delayed twice behind the cursor.
+     * @param tapCount number of taps read by the segment.
+     * @param tapCursors buffer indexes of the taps.
+     */
+    void PingPongDelayUnit::ProcessSegment(const float* leftInput, const float* rightInput, float* leftOutput,
+                                           float* rightOutput, int sampleFrames, int semiDelayedCursor, int fullDelayedCursor,
+                                           int tapCount, const int* tapCursors)
+    {
+        float* leftWritten = leftBuffer_ + bufferCursor_;
+        float* rightWritten = rightBuffer_ + bufferCursor_;
+        const float* leftSemiDelayed = leftBuffer_ + semiDelayedCursor;
+        const float* rightSemiDelayed = rightBuffer_ + semiDelayedCursor;
+        const float* leftFullDelayed = leftBuffer_ + fullDelayedCursor;
+        const float* rightFullDelayed = rightBuffer_ + fullDelayedCursor;
+
+        // Settings are copied, so that the compiler does not have to
+        // reload them after each write to the buffers.
+        float feedback = feedback_;
+        float wet = wetParam_;
+        float dry = DryGain(wetParamC_);
+        float panorama = panoramaParam_;
+        float panoramaC = panoramaParamC_;
+        float primary = primaryPanningQuotient_;
+        float secondary = secondaryPanningQuotient_;
+
+        const float* leftTapped[maxTapCount];
+        const float* rightTapped[maxTapCount];
+        float tapLeftGains[maxTapCount];
+        float tapRightGains[maxTapCount];
+        bool overlapping = (semiDelayedCursor == bufferCursor_) || (fullDelayedCursor == bufferCursor_);
+        for(int tap = 0; tap < tapCount; ++tap)
+        {
+            leftTapped[tap] = leftBuffer_ + tapCursors[tap];
+            rightTapped[tap] = rightBuffer_ + tapCursors[tap];
+            tapLeftGains[tap] = tapLeftGains_[tap];
+            tapRightGains[tap] = tapRightGains_[tap];
+            overlapping = overlapping || (tapCursors[tap] == bufferCursor_);
+        }
+
+        // Levels are accumulated in independent lanes, which lets the
+        // compiler keep them in vector registers through the loop.
+        float peaks[meterPointCount][meterChannelCount][meterLaneCount_];
+        float sums[meterPointCount][meterChannelCount][meterLaneCount_];
+        memset(peaks, 0, sizeof(peaks));
+        memset(sums, 0, sizeof(sums));
+
+        // Frames are processed in groups of lanes. All the samples of
+        // a group are read before any is written, which is correct unless
+        // the delay is a multiple of the buffer size and so a delayed
+        // cursor equals the buffer cursor. Such segments are processed
+        // frame by frame.
+        int groupedFrames = overlapping ? 0 : (sampleFrames - (sampleFrames % meterLaneCount_));
+
+        int frame = 0;
+        for(; frame < groupedFrames; frame += meterLaneCount_)
+        {
+            float leftInputSamples[meterLaneCount_];
+            float rightInputSamples[meterLaneCount_];
+            float leftWrittenSamples[meterLaneCount_];
+            float rightWrittenSamples[meterLaneCount_];
+            float leftEchoes[meterLaneCount_];
+            float rightEchoes[meterLaneCount_];
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                int i = frame + lane;
+                leftInputSamples[lane] = leftInput[i];
+                rightInputSamples[lane] = rightInput[i];
+                leftWrittenSamples[lane] = (leftInput[i] + leftFullDelayed[i]) * feedback;
+                rightWrittenSamples[lane] = (rightInput[i] + rightFullDelayed[i]) * feedback;
+
+                float semiDelayed = primary * leftSemiDelayed[i] + secondary * rightSemiDelayed[i];
+                float fullDelayed = secondary * leftFullDelayed[i] + primary * rightFullDelayed[i];
+                leftEchoes[lane] = (panoramaC * semiDelayed) + (panorama * fullDelayed);
+                rightEchoes[lane] = (panorama * semiDelayed) + (panoramaC * fullDelayed);
+            }
+
+            // Taps are added to the echoes, each of them over all the lanes.
+            for(int tap = 0; tap < tapCount; ++tap)
+            {
+                for(int lane = 0; lane < meterLaneCount_; ++lane)
+                {
+                    float tapped = leftTapped[tap][frame + lane] + rightTapped[tap][frame + lane];
+                    leftEchoes[lane] += tapLeftGains[tap] * tapped;
+                    rightEchoes[lane] += tapRightGains[tap] * tapped;
+                }
+            }
+
+            float leftOutputSamples[meterLaneCount_];
+            float rightOutputSamples[meterLaneCount_];
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                leftOutputSamples[lane] = (dry * leftInputSamples[lane]) + (wet * leftEchoes[lane]);
+                rightOutputSamples[lane] = (dry * rightInputSamples[lane]) + (wet * rightEchoes[lane]);
+            }
+
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                leftWritten[frame + lane] = leftWrittenSamples[lane];
+                rightWritten[frame + lane] = rightWrittenSamples[lane];
+                leftOutput[frame + lane] = leftOutputSamples[lane];
+                rightOutput[frame + lane] = rightOutputSamples[lane];
+            }
+
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                AccumulateLevel(leftInputSamples[lane], peaks[InputMeter][0][lane], sums[InputMeter][0][lane]);
+                AccumulateLevel(rightInputSamples[lane], peaks[InputMeter][1][lane], sums[InputMeter][1][lane]);
+                AccumulateLevel(leftWrittenSamples[lane], peaks[DelayMeter][0][lane], sums[DelayMeter][0][lane]);
+                AccumulateLevel(rightWrittenSamples[lane], peaks[DelayMeter][1][lane], sums[DelayMeter][1][lane]);
+                AccumulateLevel(leftOutputSamples[lane], peaks[OutputMeter][0][lane], sums[OutputMeter][0][lane]);
+                AccumulateLevel(rightOutputSamples[lane], peaks[OutputMeter][1][lane], sums[OutputMeter][1][lane]);
+            }
+        }
+
+        // Remaining frames are processed the same way as GetSample does,
+        // the delay line samples are read after the write just like there.
+        for(; frame < sampleFrames; ++frame)
+        {
+            float leftInputSample = leftInput[frame];
+            float rightInputSample = rightInput[frame];
+            leftWritten[frame] = (leftInputSample + leftFullDelayed[frame]) * feedback;
+            rightWritten[frame] = (rightInputSample + rightFullDelayed[frame]) * feedback;
+
+            float semiDelayed = primary * leftSemiDelayed[frame] + secondary * rightSemiDelayed[frame];
+            float fullDelayed = secondary * leftFullDelayed[frame] + primary * rightFullDelayed[frame];
+            float leftEcho = (panoramaC * semiDelayed) + (panorama * fullDelayed);
+            float rightEcho = (panorama * semiDelayed) + (panoramaC * fullDelayed);
+            for(int tap = 0; tap < tapCount; ++tap)
+            {
+                float tapped = leftTapped[tap][frame] + rightTapped[tap][frame];
+                leftEcho += tapLeftGains[tap] * tapped;
+                rightEcho += tapRightGains[tap] * tapped;
+            }
+            leftOutput[frame] = (dry * leftInputSample) + (wet * leftEcho);
+            rightOutput[frame] = (dry * rightInputSample) + (wet * rightEcho);
+
+            AccumulateLevel(leftInputSample, peaks[InputMeter][0][0], sums[InputMeter][0][0]);
+            AccumulateLevel(rightInputSample, peaks[InputMeter][1][0], sums[InputMeter][1][0]);
+            AccumulateLevel(leftWritten[frame], peaks[DelayMeter][0][0], sums[DelayMeter][0][0]);
+            AccumulateLevel(rightWritten[frame], peaks[DelayMeter][1][0], sums[DelayMeter][1][0]);
+            AccumulateLevel(leftOutput[frame], peaks[OutputMeter][0][0], sums[OutputMeter][0][0]);
+            AccumulateLevel(rightOutput[frame], peaks[OutputMeter][1][0], sums[OutputMeter][1][0]);
+        }
+
+        // Folding the lanes into the metering window.
+        for(int point = 0; point < meterPointCount; ++point)
+        {
+            for(int channel = 0; channel < meterChannelCount; ++channel)
+            {
+                for(int lane = 0; lane < meterLaneCount_; ++lane)
+                {
+                    meterPeaks_[point][channel] = std::max(meterPeaks_[point][channel], peaks[point][channel][lane]);
+                    meterSums_[point][channel] += sums[point][channel][lane];
+                }
+            }
+        }
+    }
+
+    /**
+     * Processes a block the same way as ProcessBlock does, reading
+     * the echoes by interpolated read heads.
+     * @param leftInput an array of left channel samples to be processed.
+     * @param rightInput an array of right channel samples to be processed.
+     * @param leftOutput where to store the effected left channel samples.
+     * @param rightOutput where to store the effected right channel samples.
+     * @param sampleFrames number of samples of each channel.
+     */
+    void PingPongDelayUnit::ProcessInterpolatedBlock(const float* leftInput, const float* rightInput, float* leftOutput,
+                                                     float* rightOutput, int sampleFrames)
+    {
+        float rampDelay;
+        if(sampleFrames > 0 && GetRampDelay(rampDelay) &&
+           ProcessRampedBlock(leftInput, rightInput, leftOutput, rightOutput, sampleFrames, rampDelay, ExactDelaySamples()))
+        {
+            return;
+        }
+
+        // The delay is constant within the block, so the heads are placed once.
+        int interpolation = interpolation_;
+        int pointCount = InterpolationPoints(interpolation);
+        PingPongDelayReadHead heads[2];
+        PlaceReadHeads(heads, interpolation);
+        int delaySamples = DelaySamples();
+        int tapCount = tapCount_;
+        int tapDistances[maxTapCount];
+        for(int tap = 0; tap < tapCount; ++tap)
+        {
+            tapDistances[tap] = TapDistance(tap, delaySamples);
+        }
+
+        // Heads reading the samples being written or beyond the buffers,
+        // as happens for tempos lower than the buffers are sized for, and
+        // taps reading the samples being written are processed frame
+        // by frame.
+        bool framewise = false;
+        for(int head = 0; head < 2; ++head)
+        {
+            framewise = framewise || (heads[head].distance < 1) || (heads[head].distance + pointCount > bufferSize_);
+        }
+        for(int tap = 0; tap < tapCount; ++tap)
+        {
+            framewise = framewise || (tapDistances[tap] == 0);
+        }
+
+        int frame = 0;
+        while(frame < sampleFrames)
+        {
+            int headCursors[2];
+            int tapCursors[maxTapCount];
+
+            // Segment ends before any of the cursors wraps. It is not longer
+            // than the distances either, so that the samples it writes never
+            // overlap the ones it reads and the compiler can vectorize it.
+            int segmentFrames = sampleFrames - frame;
+            segmentFrames = std::min(segmentFrames, bufferSize_ - bufferCursor_);
+            bool straddling = framewise;
+            for(int head = 0; head < 2; ++head)
+            {
+                headCursors[head] = BufferModulo(bufferCursor_ - heads[head].distance);
+                straddling = straddling || (headCursors[head] < pointCount - 1);
+                segmentFrames = std::min(segmentFrames, bufferSize_ - headCursors[head]);
+                segmentFrames = std::min(segmentFrames, heads[head].distance);
+            }
+            for(int tap = 0; tap < tapCount; ++tap)
+            {
+                tapCursors[tap] = BufferModulo(bufferCursor_ - tapDistances[tap]);
+                segmentFrames = std::min(segmentFrames, bufferSize_ - tapCursors[tap]);
+                if(tapDistances[tap] > 0)
+                {
+                    segmentFrames = std::min(segmentFrames, tapDistances[tap]);
+                }
+            }
+
+            // Frames whose heads read across the end of the buffers are
+            // processed one by one with wrapping indexes.
+            if(straddling)
+            {
+                float leftInputSample = leftInput[frame];
+                float rightInputSample = rightInput[frame];
+                int writtenCursor = bufferCursor_;
+                ProcessInterpolatedFrame(leftInputSample, rightInputSample, leftOutput[frame], rightOutput[frame],
+                                         heads, interpolation, tapCount, tapDistances);
+                MeterFrame(leftInputSample, rightInputSample, leftBuffer_[writtenCursor], rightBuffer_[writtenCursor],
+                           leftOutput[frame], rightOutput[frame]);
+                ++frame;
+                continue;
+            }
+
+            // Samples the segment reads, which were not written since
+            // the last reset, are cleared just before it reads them.
+            for(int head = 0; head < 2; ++head)
+            {
+                ClearUnwritten(headCursors[head] - (pointCount - 1), heads[head].distance + (pointCount - 1),
+                               segmentFrames + (pointCount - 1));
+            }
+            for(int tap = 0; tap < tapCount; ++tap)
+            {
+                ClearUnwritten(tapCursors[tap], tapDistances[tap], segmentFrames);
+            }
+
+            switch(interpolation)
+            {
+                case LinearInterpolation:
+                    ProcessInterpolatedSegment<LinearInterpolation, false>(leftInput + frame, rightInput + frame, leftOutput + frame,
+                                                                           rightOutput + frame, segmentFrames, heads, headCursors,
+                                                                           0.0f, 0.0f, tapCount, tapCursors);
+                    break;
+
+                case HermiteInterpolation:
+                    ProcessInterpolatedSegment<HermiteInterpolation, false>(leftInput + frame, rightInput + frame, leftOutput + frame,
+                                                                            rightOutput + frame, segmentFrames, heads, headCursors,
+                                                                            0.0f, 0.0f, tapCount, tapCursors);
+                    break;
+
+                case AllpassInterpolation:
+                    ProcessInterpolatedSegment<AllpassInterpolation, false>(leftInput + frame, rightInput + frame, leftOutput + frame,
+                                                                            rightOutput + frame, segmentFrames, heads, headCursors,
+                                                                            0.0f, 0.0f, tapCount, tapCursors);
+                    break;
+            }
+            AdvanceWatermark(segmentFrames);
+
+            // Moving buffer cursor behind the segment.
+            bufferCursor_ += segmentFrames;
+            if(bufferCursor_ == bufferSize_)
+            {
+                bufferCursor_ = 0;
+            }
+            frame += segmentFrames;
+        }
+    }
+
+    /**
+     * Processes a block by interpolated read heads moving with the delay
+     * ramping from one length to another across the block. The delay
+     * reaches the end length at the last frame.
+     * @param leftInput an array of left channel samples to be processed.
+     * @param rightInput an array of right channel samples to be processed.
+     * @param leftOutput where to store the effected left channel samples.
+     * @param rightOutput where to store the effected right channel samples.
+     * @param sampleFrames number of samples of each channel.
+     * @param startDelay the delay in samples before the block.
+     * @param endDelay the delay in samples at the last frame of the block.
+     * @return true if the block was processed, false if the ramp does not
+     *      fit the buffers and the block must be processed at a constant
+     *      delay.
+     */
+    bool PingPongDelayUnit::ProcessRampedBlock(const float* leftInput, const float* rightInput, float* leftOutput,
+                                               float* rightOutput, int sampleFrames, float startDelay, float endDelay)
+    {
+        int interpolation = interpolation_;
+        int pointCount = InterpolationPoints(interpolation);
+        float delayStep = (endDelay - startDelay) / sampleFrames;
+        float firstDelay = startDelay + delayStep;
+
+        // Heads are read by whole groups of lanes before any of them is
+        // written, so they must stay a group behind the buffer cursor.
+        // They must not read beyond the buffers either.
+        int nearestDistance = (int)std::min(firstDelay, endDelay) - 1;
+        int farthestDistance = (int)(2.0f * std::max(firstDelay, endDelay)) + pointCount;
+        if(nearestDistance < meterLaneCount_ || farthestDistance >= bufferSize_)
+        {
+            return false;
+        }
+        int delaySamples = DelaySamples();
+        int tapCount = tapCount_;
+        int tapDistances[maxTapCount];
+        for(int tap = 0; tap < tapCount; ++tap)
+        {
+            tapDistances[tap] = TapDistance(tap, delaySamples);
+            if(tapDistances[tap] == 0)
+            {
+                return false;
+            }
+        }
+
+        // Samples the heads read, which were not written since the last
+        // reset, are cleared before the block at once.
+        ClearUnwrittenBlock(leftBuffer_, farthestDistance, sampleFrames + farthestDistance - nearestDistance);
+        ClearUnwrittenBlock(rightBuffer_, farthestDistance, sampleFrames + farthestDistance - nearestDistance);
+
+        int frame = 0;
+        while(frame < sampleFrames)
+        {
+            int tapCursors[maxTapCount];
+
+            // Segment ends before any of the cursors wraps. The heads
+            // wrap their indexes themselves, the taps do not ramp.
+            int segmentFrames = sampleFrames - frame;
+            segmentFrames = std::min(segmentFrames, bufferSize_ - bufferCursor_);
+            for(int tap = 0; tap < tapCount; ++tap)
+            {
+                tapCursors[tap] = BufferModulo(bufferCursor_ - tapDistances[tap]);
+                segmentFrames = std::min(segmentFrames, bufferSize_ - tapCursors[tap]);
+                segmentFrames = std::min(segmentFrames, tapDistances[tap]);
+            }
+            for(int tap = 0; tap < tapCount; ++tap)
+            {
+                ClearUnwritten(tapCursors[tap], tapDistances[tap], segmentFrames);
+            }
+
+            float segmentDelay = firstDelay + delayStep * frame;
+            switch(interpolation)
+            {
+                case LinearInterpolation:
+                    ProcessInterpolatedSegment<LinearInterpolation, true>(leftInput + frame, rightInput + frame, leftOutput + frame,
+                                                                          rightOutput + frame, segmentFrames, NULL, NULL,
+                                                                          segmentDelay, delayStep, tapCount, tapCursors);
+                    break;
+
+                case HermiteInterpolation:
+                    ProcessInterpolatedSegment<HermiteInterpolation, true>(leftInput + frame, rightInput + frame, leftOutput + frame,
+                                                                           rightOutput + frame, segmentFrames, NULL, NULL,
+                                                                           segmentDelay, delayStep, tapCount, tapCursors);
+                    break;
+
+                case AllpassInterpolation:
+                    ProcessInterpolatedSegment<AllpassInterpolation, true>(leftInput + frame, rightInput + frame, leftOutput + frame,
+                                                                           rightOutput + frame, segmentFrames, NULL, NULL,
+                                                                           segmentDelay, delayStep, tapCount, tapCursors);
+                    break;
+            }
+            AdvanceWatermark(segmentFrames);
+
+            // Moving buffer cursor behind the segment.
+            bufferCursor_ += segmentFrames;
+            if(bufferCursor_ == bufferSize_)
+            {
+                bufferCursor_ = 0;
+            }
+            frame += segmentFrames;
+        }
+        return true;
+    }
+
+    /**
+     * Processes a segment of a block by interpolated read heads, within
+     * which none of the buffer cursors wraps and which reads no samples
+     * it writes. Unless the heads are ramped, no head reads across the end
+     * of the buffers. Ramped heads move with the delay from frame to frame,
+     * they gather the read samples by wrapping indexes. Accumulates
+     * the metered levels.
+     * @param leftInput an array of left channel samples to be processed.
+     * @param rightInput an array of right channel samples to be processed.
+     * @param leftOutput where to store the effected left channel samples.
+     * @param rightOutput where to store the effected right channel samples.
+     * @param sampleFrames number of samples of each channel.
+     * @param heads the semi and the full delayed read heads, unless ramped.
+     * @param headCursors buffer indexes of the newest samples read by the heads,
+     *      unless ramped.
+     * @param firstDelay the delay at the first frame of the segment, if ramped.
+     * @param delayStep change of the delay from frame to frame, if ramped.
+     * @param tapCount number of taps read by the segment.
+     * @param tapCursors buffer indexes of the taps.
+     */
+    template<int interpolation, bool ramped>
+    void PingPongDelayUnit::ProcessInterpolatedSegment(const float* leftInput, const float* rightInput, float* leftOutput,
+                                                       float* rightOutput, int sampleFrames, const PingPongDelayReadHead* heads,
+                                                       const int* headCursors, float firstDelay, float delayStep,
+                                                       int tapCount, const int* tapCursors)
+    {
+        float* leftWritten = leftBuffer_ + bufferCursor_;
+        float* rightWritten = rightBuffer_ + bufferCursor_;
+        int bufferCursor = bufferCursor_;
+
+        // Heads and their allpass states are copied as well as the settings,
+        // so that the compiler does not have to reload them after each write
+        // to the buffers. Ramped heads are placed at each frame instead.
+        const float* leftRead[2] = {NULL, NULL};
+        const float* rightRead[2] = {NULL, NULL};
+        float coefficients[2][maxInterpolationPoints];
+        float leftStates[2];
+        float rightStates[2];
+        for(int head = 0; head < 2; ++head)
+        {
+            if(!ramped)
+            {
+                leftRead[head] = leftBuffer_ + headCursors[head];
+                rightRead[head] = rightBuffer_ + headCursors[head];
+                memcpy(coefficients[head], heads[head].coefficients, sizeof(coefficients[head]));
+            }
+            leftStates[head] = leftAllpassStates_[head];
+            rightStates[head] = rightAllpassStates_[head];
+        }
+
+        float feedback = feedback_;
+        float wet = wetParam_;
+        float dry = DryGain(wetParamC_);
+        float panorama = panoramaParam_;
+        float panoramaC = panoramaParamC_;
+        float primary = primaryPanningQuotient_;
+        float secondary = secondaryPanningQuotient_;
+
+        const float* leftTapped[maxTapCount];
+        const float* rightTapped[maxTapCount];
+        float tapLeftGains[maxTapCount];
+        float tapRightGains[maxTapCount];
+        for(int tap = 0; tap < tapCount; ++tap)
+        {
+            leftTapped[tap] = leftBuffer_ + tapCursors[tap];
+            rightTapped[tap] = rightBuffer_ + tapCursors[tap];
+            tapLeftGains[tap] = tapLeftGains_[tap];
+            tapRightGains[tap] = tapRightGains_[tap];
+        }
+
+        float peaks[meterPointCount][meterChannelCount][meterLaneCount_];
+        float sums[meterPointCount][meterChannelCount][meterLaneCount_];
+        memset(peaks, 0, sizeof(peaks));
+        memset(sums, 0, sizeof(sums));
+
+        // Frames are processed in groups of lanes the same way as
+        // ProcessSegment does, the heads are interpolated first.
+        int groupedFrames = sampleFrames - (sampleFrames % meterLaneCount_);
+
+        int frame = 0;
+        for(; frame < groupedFrames; frame += meterLaneCount_)
+        {
+            float leftDelayed[2][meterLaneCount_];
+            float rightDelayed[2][meterLaneCount_];
+            for(int head = 0; head < 2; ++head)
+            {
+                if(ramped)
+                {
+                    // All the lanes place their heads at once, then each
+                    // of them gathers the samples around its head.
+                    int cursors[meterLaneCount_];
+                    float laneCoefficients[meterLaneCount_][maxInterpolationPoints];
+                    for(int lane = 0; lane < meterLaneCount_; ++lane)
+                    {
+                        float fraction;
+                        float distance = (head + 1) * (firstDelay + delayStep * (frame + lane));
+                        cursors[lane] = bufferCursor + frame + lane - SplitDistance(interpolation, distance, fraction);
+                        Coefficients(interpolation, fraction, laneCoefficients[lane]);
+                    }
+                    for(int lane = 0; lane < meterLaneCount_; ++lane)
+                    {
+                        ReadMovingHead<interpolation>(cursors[lane], laneCoefficients[lane], leftDelayed[head][lane],
+                                                      rightDelayed[head][lane], leftStates[head], rightStates[head]);
+                    }
+                }
+                else
+                {
+                    for(int lane = 0; lane < meterLaneCount_; ++lane)
+                    {
+                        leftDelayed[head][lane] = Interpolate(interpolation, leftRead[head] + frame + lane, coefficients[head], leftStates[head]);
+                        rightDelayed[head][lane] = Interpolate(interpolation, rightRead[head] + frame + lane, coefficients[head], rightStates[head]);
+                    }
+                }
+            }
+
+            float leftInputSamples[meterLaneCount_];
+            float rightInputSamples[meterLaneCount_];
+            float leftWrittenSamples[meterLaneCount_];
+            float rightWrittenSamples[meterLaneCount_];
+            float leftEchoes[meterLaneCount_];
+            float rightEchoes[meterLaneCount_];
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                int i = frame + lane;
+                leftInputSamples[lane] = leftInput[i];
+                rightInputSamples[lane] = rightInput[i];
+                leftWrittenSamples[lane] = (leftInput[i] + leftDelayed[1][lane]) * feedback;
+                rightWrittenSamples[lane] = (rightInput[i] + rightDelayed[1][lane]) * feedback;
+
+                float semiDelayed = primary * leftDelayed[0][lane] + secondary * rightDelayed[0][lane];
+                float fullDelayed = secondary * leftDelayed[1][lane] + primary * rightDelayed[1][lane];
+                leftEchoes[lane] = (panoramaC * semiDelayed) + (panorama * fullDelayed);
+                rightEchoes[lane] = (panorama * semiDelayed) + (panoramaC * fullDelayed);
+            }
+
+            for(int tap = 0; tap < tapCount; ++tap)
+            {
+                for(int lane = 0; lane < meterLaneCount_; ++lane)
+                {
+                    float tapped = leftTapped[tap][frame + lane] + rightTapped[tap][frame + lane];
+                    leftEchoes[lane] += tapLeftGains[tap] * tapped;
+                    rightEchoes[lane] += tapRightGains[tap] * tapped;
+                }
+            }
+
+            float leftOutputSamples[meterLaneCount_];
+            float rightOutputSamples[meterLaneCount_];
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                leftOutputSamples[lane] = (dry * leftInputSamples[lane]) + (wet * leftEchoes[lane]);
+                rightOutputSamples[lane] = (dry * rightInputSamples[lane]) + (wet * rightEchoes[lane]);
+            }
+
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                leftWritten[frame + lane] = leftWrittenSamples[lane];
+                rightWritten[frame + lane] = rightWrittenSamples[lane];
+                leftOutput[frame + lane] = leftOutputSamples[lane];
+                rightOutput[frame + lane] = rightOutputSamples[lane];
+            }
+
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                AccumulateLevel(leftInputSamples[lane], peaks[InputMeter][0][lane], sums[InputMeter][0][lane]);
+                AccumulateLevel(rightInputSamples[lane], peaks[InputMeter][1][lane], sums[InputMeter][1][lane]);
+                AccumulateLevel(leftWrittenSamples[lane], peaks[DelayMeter][0][lane], sums[DelayMeter][0][lane]);
+                AccumulateLevel(rightWrittenSamples[lane], peaks[DelayMeter][1][lane], sums[DelayMeter][1][lane]);
+                AccumulateLevel(leftOutputSamples[lane], peaks[OutputMeter][0][lane], sums[OutputMeter][0][lane]);
+                AccumulateLevel(rightOutputSamples[lane], peaks[OutputMeter][1][lane], sums[OutputMeter][1][lane]);
+            }
+        }
+
+        for(; frame < sampleFrames; ++frame)
+        {
+            float leftDelayed[2];
+            float rightDelayed[2];
+            for(int head = 0; head < 2; ++head)
+            {
+                if(ramped)
+                {
+                    float fraction;
+                    float headCoefficients[maxInterpolationPoints];
+                    float distance = (head + 1) * (firstDelay + delayStep * frame);
+                    int cursor = bufferCursor + frame - SplitDistance(interpolation, distance, fraction);
+                    Coefficients(interpolation, fraction, headCoefficients);
+                    ReadMovingHead<interpolation>(cursor, headCoefficients, leftDelayed[head], rightDelayed[head],
+                                                  leftStates[head], rightStates[head]);
+                }
+                else
+                {
+                    leftDelayed[head] = Interpolate(interpolation, leftRead[head] + frame, coefficients[head], leftStates[head]);
+                    rightDelayed[head] = Interpolate(interpolation, rightRead[head] + frame, coefficients[head], rightStates[head]);
+                }
+            }
+
+            float leftInputSample = leftInput[frame];
+            float rightInputSample = rightInput[frame];
+            leftWritten[frame] = (leftInputSample + leftDelayed[1]) * feedback;
+            rightWritten[frame] = (rightInputSample + rightDelayed[1]) * feedback;
+
+            float semiDelayed = primary * leftDelayed[0] + secondary * rightDelayed[0];
+            float fullDelayed = secondary * leftDelayed[1] + primary * rightDelayed[1];
+            float leftEcho = (panoramaC * semiDelayed) + (panorama * fullDelayed);
+            float rightEcho = (panorama * semiDelayed) + (panoramaC * fullDelayed);
+            for(int tap = 0; tap < tapCount; ++tap)
+            {
+                float tapped = leftTapped[tap][frame] + rightTapped[tap][frame];
+                leftEcho += tapLeftGains[tap] * tapped;
+                rightEcho += tapRightGains[tap] * tapped;
+            }
+            leftOutput[frame] = (dry * leftInputSample) + (wet * leftEcho);
+            rightOutput[frame] = (dry * rightInputSample) + (wet * rightEcho);
+
+            AccumulateLevel(leftInputSample, peaks[InputMeter][0][0], sums[InputMeter][0][0]);
+            AccumulateLevel(rightInputSample, peaks[InputMeter][1][0], sums[InputMeter][1][0]);
+            AccumulateLevel(leftWritten[frame], peaks[DelayMeter][0][0], sums[DelayMeter][0][0]);
+            AccumulateLevel(rightWritten[frame], peaks[DelayMeter][1][0], sums[DelayMeter][1][0]);
+            AccumulateLevel(leftOutput[frame], peaks[OutputMeter][0][0], sums[OutputMeter][0][0]);
+            AccumulateLevel(rightOutput[frame], peaks[OutputMeter][1][0], sums[OutputMeter][1][0]);
+        }
+
+        for(int head = 0; head < 2; ++head)
+        {
+            leftAllpassStates_[head] = leftStates[head];
+            rightAllpassStates_[head] = rightStates[head];
+        }
+
+        // Folding the lanes into the metering window.
+        for(int point = 0; point < meterPointCount; ++point)
+        {
+            for(int channel = 0; channel < meterChannelCount; ++channel)
+            {
+                for(int lane = 0; lane < meterLaneCount_; ++lane)
+                {
+                    meterPeaks_[point][channel] = std::max(meterPeaks_[point][channel], peaks[point][channel][lane]);
+                    meterSums_[point][channel] += sums[point][channel][lane];
+                }
+            }
+        }
+    }
+
+    /**
+     * Reads both channels by a read head moving from frame to frame.
+     * The read samples may wrap around the end of the buffers.
+     * @param newestCursor buffer index of the newest read sample, it may
+     *      be negative down to minus the buffer size.
+     * @param coefficients coefficients of the head at the frame.
+     * @param leftSample where to store the interpolated left channel sample.
+     * @param rightSample where to store the interpolated right channel sample.
+     * @param leftState the previous left channel sample of the head.
+     * @param rightState the previous right channel sample of the head.
+     */
+    template<int interpolation>
+    inline void PingPongDelayUnit::ReadMovingHead(int newestCursor, const float* coefficients, float& leftSample, float& rightSample,
+                                           float& leftState, float& rightState)
+    {
+        int pointCount = InterpolationPoints(interpolation);
+        float leftPoints[maxInterpolationPoints];
+        float rightPoints[maxInterpolationPoints];
+        for(int point = 0; point < pointCount; ++point)
+        {
+            int cursor = newestCursor - point;
+            cursor += (cursor < 0) ? bufferSize_ : 0;
+            leftPoints[pointCount - 1 - point] = leftBuffer_[cursor];
+            rightPoints[pointCount - 1 - point] = rightBuffer_[cursor];
+        }
+        leftSample = Interpolate(interpolation, leftPoints + pointCount - 1, coefficients, leftState);
+        rightSample = Interpolate(interpolation, rightPoints + pointCount - 1, coefficients, rightState);
+    }
+
+    /**
+     * Processes a single frame by interpolated read heads, the same way
+     * as GetSample does. The read samples may wrap around the end of
+     * the buffers.
+     * @param leftInput a left channel sample to be processed.
+     * @param rightInput a right channel sample to be processed.
+     * @param leftOutput where to store the effected left channel sample.
+     * @param rightOutput where to store the effected right channel sample.
+     * @param heads the semi and the full delayed read heads.
+     * @param interpolation an interpolation of the heads.
+     * @param tapCount number of taps read by the frame.
+     * @param tapDistances distances of the taps behind the buffer cursor.
+     */
+    void PingPongDelayUnit::ProcessInterpolatedFrame(float leftInput, float rightInput, float& leftOutput, float& rightOutput,
+                                                     const PingPongDelayReadHead* heads, int interpolation, int tapCount,
+                                                     const int* tapDistances)
+    {
+        // Samples read by each head are gathered from the oldest one,
+        // so that they are interpolated the same way as in a segment.
+        int pointCount = InterpolationPoints(interpolation);
+        float leftDelayed[2];
+        float rightDelayed[2];
+        for(int head = 0; head < 2; ++head)
+        {
+            float leftPoints[maxInterpolationPoints];
+            float rightPoints[maxInterpolationPoints];
+            for(int point = 0; point < pointCount; ++point)
+            {
+                int distance = BufferModulo(heads[head].distance + point);
+                int cursor = BufferModulo(bufferCursor_ - distance);
+                ClearUnwritten(cursor, distance, 1);
+                leftPoints[pointCount - 1 - point] = leftBuffer_[cursor];
+                rightPoints[pointCount - 1 - point] = rightBuffer_[cursor];
+            }
+            leftDelayed[head] = Interpolate(interpolation, leftPoints + pointCount - 1, heads[head].coefficients, leftAllpassStates_[head]);
+            rightDelayed[head] = Interpolate(interpolation, rightPoints + pointCount - 1, heads[head].coefficients, rightAllpassStates_[head]);
+        }
+
+        int tapCursors[maxTapCount];
+        for(int tap = 0; tap < tapCount; ++tap)
+        {
+            tapCursors[tap] = BufferModulo(bufferCursor_ - tapDistances[tap]);
+            ClearUnwritten(tapCursors[tap], tapDistances[tap], 1);
+        }
+
+        leftBuffer_[bufferCursor_] = (leftInput + leftDelayed[1]) * feedback_;
+        rightBuffer_[bufferCursor_] = (rightInput + rightDelayed[1]) * feedback_;
+
+        float semiDelayed = primaryPanningQuotient_ * leftDelayed[0] + secondaryPanningQuotient_ * rightDelayed[0];
+        float fullDelayed = secondaryPanningQuotient_ * leftDelayed[1] + primaryPanningQuotient_ * rightDelayed[1];
+        float leftEcho = (panoramaParamC_ * semiDelayed) + (panoramaParam_ * fullDelayed);
+        float rightEcho = (panoramaParam_ * semiDelayed) + (panoramaParamC_ * fullDelayed);
+        for(int tap = 0; tap < tapCount; ++tap)
+        {
+            float tapped = leftBuffer_[tapCursors[tap]] + rightBuffer_[tapCursors[tap]];
+            leftEcho += tapLeftGains_[tap] * tapped;
+            rightEcho += tapRightGains_[tap] * tapped;
+        }
+        float dry = DryGain(wetParamC_);
+        leftOutput = (dry * leftInput) + (wetParam_ * leftEcho);
+        rightOutput = (dry * rightInput) + (wetParam_ * rightEcho);
+
+        IncrementBufferCursor();
+        AdvanceWatermark(1);
+    }
+
+    /**
+     * Accumulates the levels of a single frame into the metering window.
+     * @param leftInput a left channel input sample.
+     * @param rightInput a right channel input sample.
+     * @param leftWritten a left channel sample written to the delay line.
+     * @param rightWritten a right channel sample written to the delay line.
+     * @param leftOutput a left channel output sample.
+     * @param rightOutput a right channel output sample.
+     */
+    void PingPongDelayUnit::MeterFrame(float leftInput, float rightInput, float leftWritten, float rightWritten,
+                                       float leftOutput, float rightOutput)
+    {
+        float samples[meterPointCount][meterChannelCount];
+        samples[InputMeter][0] = leftInput;
+        samples[InputMeter][1] = rightInput;
+        samples[DelayMeter][0] = leftWritten;
+        samples[DelayMeter][1] = rightWritten;
+        samples[OutputMeter][0] = leftOutput;
+        samples[OutputMeter][1] = rightOutput;
+        for(int point = 0; point < meterPointCount; ++point)
+        {
+            for(int channel = 0; channel < meterChannelCount; ++channel)
+            {
+                float sum = 0.0f;
+                AccumulateLevel(samples[point][channel], meterPeaks_[point][channel], sum);
+                meterSums_[point][channel] += sum;
+            }
+        }
+    }
+
+    /**
+     * Accumulates a sample into the level of a metering lane.
+     * @param sample a metered sample.
+     * @param peak a peak level of the lane to update.
+     * @param sum a sum of squared samples of the lane to update.
+     */
+    void PingPongDelayUnit::AccumulateLevel(float sample, float& peak, float& sum)
+    {
+        // Written as a comparison rather than std::max, so that it maps
+        // to a single vector max instruction.
+        float magnitude = fabsf(sample);
+        peak = (magnitude > peak) ? magnitude : peak;
+        sum += sample * sample;
+    }
+
+    /**
+     * Accounts processed frames into the metering window and publishes
+     * the levels once the window is complete.
+     * @param sampleFrames number of processed frames.
+     */
+    void PingPongDelayUnit::AccountMeterFrames(int sampleFrames)
+    {
+        meterFrames_ += sampleFrames;
+        int meterWindowFrames = (int)(LineRate() * meterWindowMs_ / msInS_);
+        if(meterFrames_ <= 0 || meterFrames_ < meterWindowFrames)
+        {
+            return;
+        }
+
+        PingPongDelayLevels levels;
+        for(int point = 0; point < meterPointCount; ++point)
+        {
+            for(int channel = 0; channel < meterChannelCount; ++channel)
+            {
+                levels.peak[point][channel] = meterPeaks_[point][channel];
+                levels.rms[point][channel] = (float)sqrt(meterSums_[point][channel] / meterFrames_);
+            }
+        }
+        levels_.Publish(levels);
+
+#ifdef PINGPONGDELAY_TRIMMING
+        // Counting the silence of the input and of the samples written
+        // to the delay line.
+        if(idleTrimMs_ > 0)
+        {
+            bool silent = true;
+            for(int channel = 0; channel < meterChannelCount; ++channel)
+            {
+                silent = silent && meterPeaks_[InputMeter][channel] < silenceLevel_ &&
+                    meterPeaks_[DelayMeter][channel] < silenceLevel_;
+            }
+            silentFrames_ = silent ? (silentFrames_ + meterFrames_) : 0;
+        }
+#endif
+
+        // Starting the next metering window.
+        memset(meterPeaks_, 0, sizeof(meterPeaks_));
+        memset(meterSums_, 0, sizeof(meterSums_));
+        meterFrames_ = 0;
+    }
+
+    /**
+     * Gets the sample rate the delay line runs at.
+     * @return time info sample rate divided by the economy factor.
+     */
+    float PingPongDelayUnit::LineRate()
+    {
+        return (float)(timeInfo_->sampleRate / economyFactor_);
+    }
+
+    /**
+     * Gets the gain of the dry input of the output of the delay line,
+     * which is left out while the delay line runs at the reduced rate.
+     * @param wetParamC a complement of the wet parameter.
+     * @return gain of the dry input.
+     */
+    inline float PingPongDelayUnit::DryGain(float wetParamC)
+    {
+        return isReducing_ ? 0.0f : wetParamC;
+    }
+
+    /**
+     * Processes a block running the delay line at the reduced rate.
+     * The block is decimated and processed by ProcessDelayBlock without
+     * the dry input in chunks, the echoes are interpolated back and
+     * mixed with the dry input by MixEchoes.
+     * @param leftInput an array of left channel samples to be processed.
+     * @param rightInput an array of right channel samples to be processed.
+     * @param leftOutput where to store the effected left channel samples.
+     * @param rightOutput where to store the effected right channel samples.
+     * @param sampleFrames number of samples of each channel.
+     */
+    void PingPongDelayUnit::ProcessEconomyBlock(const float* leftInput, const float* rightInput, float* leftOutput,
+                                                float* rightOutput, int sampleFrames)
+    {
+        // Dry input ramps across the block to the current wet parameter,
+        // the crossfades of the delay line do not reach it.
+        float dryGain = economyDryGain_;
+        float dryStep = (wetParamC_ - dryGain) / sampleFrames;
+        int chunkLimit = maxResampledFrames * economyFactor_;
+
+        int frame = 0;
+        while(frame < sampleFrames)
+        {
+            int chunkFrames = std::min(sampleFrames - frame, chunkLimit);
+            int reducedFrames = resampler_.Decimate(leftInput + frame, rightInput + frame, leftReduced_, rightReduced_,
+                                                    chunkFrames);
+
+            // Delay line meters only the samples written to it, the input
+            // and the output are metered at the full rate by MixEchoes.
+            float peaks[meterPointCount][meterChannelCount];
+            double sums[meterPointCount][meterChannelCount];
+            memcpy(peaks, meterPeaks_, sizeof(peaks));
+            memcpy(sums, meterSums_, sizeof(sums));
+            if(reducedFrames > 0)
+            {
+                isReducing_ = true;
+                ProcessDelayBlock(leftReduced_, rightReduced_, leftReduced_, rightReduced_, reducedFrames);
+                isReducing_ = false;
+            }
+            for(int channel = 0; channel < meterChannelCount; ++channel)
+            {
+                meterPeaks_[InputMeter][channel] = peaks[InputMeter][channel];
+                meterSums_[InputMeter][channel] = sums[InputMeter][channel];
+                meterPeaks_[OutputMeter][channel] = peaks[OutputMeter][channel];
+                meterSums_[OutputMeter][channel] = sums[OutputMeter][channel];
+            }
+
+            // Tempo ramps only within the first chunk.
+            rampTempo_ = timeInfo_->tempo;
+
+            resampler_.Interpolate(leftReduced_, rightReduced_, reducedFrames, leftEchoes_, rightEchoes_, chunkFrames);
+            MixEchoes(leftInput + frame, rightInput + frame, leftOutput + frame, rightOutput + frame, chunkFrames,
+                      dryGain + dryStep * frame, dryStep, (float)reducedFrames / chunkFrames);
+            AccountMeterFrames(reducedFrames);
+            frame += chunkFrames;
+        }
+        economyDryGain_ = wetParamC_;
+    }
+
+    /**
+     * Mixes the dry input of a chunk with the echoes interpolated
+     * to leftEchoes_ and rightEchoes_, metering the input and the output
+     * at the full rate. Output arrays may be the same as the input ones.
+     * @param leftInput an array of left channel samples to be processed.
+     * @param rightInput an array of right channel samples to be processed.
+     * @param leftOutput where to store the effected left channel samples.
+     * @param rightOutput where to store the effected right channel samples.
+     * @param sampleFrames number of samples of each channel.
+     * @param dryGain a gain of the dry input before the first frame.
+     * @param dryStep a change of the gain of the dry input per frame.
+     * @param sumScale a ratio the sums of squared samples are scaled by,
+     *      so that they are accounted as the frames of the delay line.
+     */
+    void PingPongDelayUnit::MixEchoes(const float* leftInput, const float* rightInput, float* leftOutput,
+                                      float* rightOutput, int sampleFrames, float dryGain, float dryStep, float sumScale)
+    {
+        // Levels are accumulated in independent lanes, which lets the
+        // compiler keep them in vector registers through the loop.
+        float inputPeaks[meterChannelCount][meterLaneCount_];
+        float inputSums[meterChannelCount][meterLaneCount_];
+        float outputPeaks[meterChannelCount][meterLaneCount_];
+        float outputSums[meterChannelCount][meterLaneCount_];
+        memset(inputPeaks, 0, sizeof(inputPeaks));
+        memset(inputSums, 0, sizeof(inputSums));
+        memset(outputPeaks, 0, sizeof(outputPeaks));
+        memset(outputSums, 0, sizeof(outputSums));
+
+        // Outputs may be the inputs, so the grouped frames are read
+        // before written.
+        int groupedFrames = sampleFrames - (sampleFrames % meterLaneCount_);
+        int frame = 0;
+        for(; frame < groupedFrames; frame += meterLaneCount_)
+        {
+            float leftInputSamples[meterLaneCount_];
+            float rightInputSamples[meterLaneCount_];
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                leftInputSamples[lane] = leftInput[frame + lane];
+                rightInputSamples[lane] = rightInput[frame + lane];
+            }
+
+            float leftOutputSamples[meterLaneCount_];
+            float rightOutputSamples[meterLaneCount_];
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                float dry = dryGain + dryStep * (frame + lane + 1);
+                leftOutputSamples[lane] = (dry * leftInputSamples[lane]) + leftEchoes_[frame + lane];
+                rightOutputSamples[lane] = (dry * rightInputSamples[lane]) + rightEchoes_[frame + lane];
+            }
+
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                AccumulateLevel(leftInputSamples[lane], inputPeaks[0][lane], inputSums[0][lane]);
+                AccumulateLevel(rightInputSamples[lane], inputPeaks[1][lane], inputSums[1][lane]);
+                AccumulateLevel(leftOutputSamples[lane], outputPeaks[0][lane], outputSums[0][lane]);
+                AccumulateLevel(rightOutputSamples[lane], outputPeaks[1][lane], outputSums[1][lane]);
+            }
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                leftOutput[frame + lane] = leftOutputSamples[lane];
+                rightOutput[frame + lane] = rightOutputSamples[lane];
+            }
+        }
+        for(; frame < sampleFrames; ++frame)
+        {
+            float leftInputSample = leftInput[frame];
+            float rightInputSample = rightInput[frame];
+            float dry = dryGain + dryStep * (frame + 1);
+            leftOutput[frame] = (dry * leftInputSample) + leftEchoes_[frame];
+            rightOutput[frame] = (dry * rightInputSample) + rightEchoes_[frame];
+            AccumulateLevel(leftInputSample, inputPeaks[0][0], inputSums[0][0]);
+            AccumulateLevel(rightInputSample, inputPeaks[1][0], inputSums[1][0]);
+            AccumulateLevel(leftOutput[frame], outputPeaks[0][0], outputSums[0][0]);
+            AccumulateLevel(rightOutput[frame], outputPeaks[1][0], outputSums[1][0]);
+        }
+
+        // Folding the lanes into the metering window.
+        for(int channel = 0; channel < meterChannelCount; ++channel)
+        {
+            for(int lane = 0; lane < meterLaneCount_; ++lane)
+            {
+                meterPeaks_[InputMeter][channel] = std::max(meterPeaks_[InputMeter][channel], inputPeaks[channel][lane]);
+                meterSums_[InputMeter][channel] += sumScale * inputSums[channel][lane];
+                meterPeaks_[OutputMeter][channel] = std::max(meterPeaks_[OutputMeter][channel], outputPeaks[channel][lane]);
+                meterSums_[OutputMeter][channel] += sumScale * outputSums[channel][lane];
+            }
+        }
+    }
+
+#ifdef PINGPONGDELAY_TRIMMING
+    /**
+     * Decides whether the buffers may be used to process a block. Offers
+     * them to be trimmed after long silence and provides them again,
+     * once the input is not silent. Must be called from the audio thread
+     * only.
+     * @param leftInput an array of left channel samples to be processed.
+     * @param rightInput an array of right channel samples to be processed.
+     * @param sampleFrames number of samples of each channel.
+     * @return true if the buffers may be used, false if the block is
+     *      to be processed as if the delay line was silent.
+     */
+    bool PingPongDelayUnit::ProvideBuffers(const float* leftInput, const float* rightInput, int sampleFrames)
+    {
+        int state = bufferState_.load(std::memory_order_acquire);
+        if(state == ActiveBuffers)
+        {
+            if(idleTrimMs_ <= 0 || !leftBuffer_)
+            {
+                return true;
+            }
+
+            // Once all the samples in the buffers were written in silence,
+            // they hold nothing worth keeping.
+            int idleTrimFrames = (int)(LineRate() * idleTrimMs_ / msInS_);
+            if(silentFrames_ < std::max(idleTrimFrames, bufferSize_) || !IsSilent(leftInput, rightInput, sampleFrames))
+            {
+                return true;
+            }
+            silentFrames_ = 0;
+            bufferState_.store(TrimRequestedBuffers, std::memory_order_release);
+            return false;
+        }
+
+        if(IsSilent(leftInput, rightInput, sampleFrames))
+        {
+            return false;
+        }
+
+        // Taking the offer back, unless the buffers are already being
+        // trimmed.
+        if(state == TrimRequestedBuffers &&
+           bufferState_.compare_exchange_strong(state, ActiveBuffers, std::memory_order_acquire))
+        {
+            return true;
+        }
+
+        // Trimmed buffers are replaced by the prefaulted spare ones, which
+        // hold stale samples until the watermark clears them.
+        if(state == TrimmedBuffers && PingPongDelayBufferPool::Take(bufferSize_, leftBuffer_, rightBuffer_))
+        {
+            ResetBuffers();
+            bufferState_.store(ActiveBuffers, std::memory_order_relaxed);
+            return true;
+        }
+
+        // No spare buffers yet, the delay line stays silent until
+        // the pool is refilled.
+        return false;
+    }
+
+    /**
+     * Tells whether all samples of a block are below the silence level.
+     * @param leftInput an array of left channel samples.
+     * @param rightInput an array of right channel samples.
+     * @param sampleFrames number of samples of each channel.
+     * @return true if the block is silent, false otherwise.
+     */
+    bool PingPongDelayUnit::IsSilent(const float* leftInput, const float* rightInput, int sampleFrames)
+    {
+        float peak = 0.0f;
+        for(int frame = 0; frame < sampleFrames; ++frame)
+        {
+            float leftMagnitude = fabsf(leftInput[frame]);
+            float rightMagnitude = fabsf(rightInput[frame]);
+            peak = (leftMagnitude > peak) ? leftMagnitude : peak;
+            peak = (rightMagnitude > peak) ? rightMagnitude : peak;
+        }
+        return peak < silenceLevel_;
+    }
+#endif
+
+    /**
+     * Clears samples about to be read by a delayed cursor, which were not
+     * written since the last reset. They lie at the beginning of the read
+     * range, because the further is the sample behind the buffer cursor,
+     * the earlier it was written.
+     * @param delayedCursor a buffer index of the first sample to be read.
+     * @param distance a distance of the delayed cursor behind the buffer cursor.
+     * @param sampleFrames number of samples to be read, the range must not wrap.
+     */
+    void PingPongDelayUnit::ClearUnwritten(int delayedCursor, int distance, int sampleFrames)
+    {
+        if(distance <= writtenFrames_)
+        {
+            return;
+        }
+
+        int unwrittenFrames = std::min(distance - writtenFrames_, sampleFrames);
+        memset(leftBuffer_ + delayedCursor, 0, unwrittenFrames * sizeof(float));
+        memset(rightBuffer_ + delayedCursor, 0, unwrittenFrames * sizeof(float));
+    }
+
+    /**
+     * Clears samples of one buffer about to be read by a delayed cursor
+     * during a block, which were not written since the last reset.
+     * @param buffer a buffer to clear.
+     * @param distance a distance of the delayed cursor behind the buffer cursor.
+     * @param sampleFrames number of frames of the block, the read range may wrap.
+     */
+    void PingPongDelayUnit::ClearUnwrittenBlock(float* buffer, int distance, int sampleFrames)
+    {
+        if(distance <= writtenFrames_)
+        {
+            return;
+        }
+
+        int unwrittenFrames = std::min(distance - writtenFrames_, sampleFrames);
+        int delayedCursor = BufferModulo(bufferCursor_ - distance);
+        int headFrames = std::min(unwrittenFrames, bufferSize_ - delayedCursor);
+        memset(buffer + delayedCursor, 0, headFrames * sizeof(float));
+        memset(buffer, 0, (unwrittenFrames - headFrames) * sizeof(float));
+    }
+
+    /**
+     * Advances the watermark by written frames.
+     * @param sampleFrames number of frames written behind the buffer cursor.
+     */
+    void PingPongDelayUnit::AdvanceWatermark(int sampleFrames)
+    {
+        // Once the whole buffers are written, the watermark stays at their size.
+        writtenFrames_ = std::min(writtenFrames_ + sampleFrames, bufferSize_);
+    }
+
     /**
      * Increments the inner buffer cursors.
      */
@@ -14,6 +14,12 @@
 
 #include <utility>
 #include "public.sdk/source/vst2.x/audioeffectx.h"
+#include "PingPongDelayLevels.h"
+#include "PingPongDelayResampler.h"
+
+#ifdef PINGPONGDELAY_TRIMMING
+#include <atomic>
+#endif
 
 #ifndef PINGPONGDELAYUNIT_H
 #define PINGPONGDELAYUNIT_H
@@ -34,11 +40,132 @@ namespace PingPongDelay
      */
     typedef pair<float, float> StereoSample;
 
+    /**
+     * Maximal number of taps of PingPongDelayUnit.
+     *
+     * @see PingPongDelayUnit
+     */
+    const int maxTapCount = 8;
+
+    /**
+     * Maximal number of samples read at once by an interpolated read
+     * head of PingPongDelayUnit.
+     *
+     * @see PingPongDelayUnit
+     */
+    const int maxInterpolationPoints = 4;
+
+
+    /**
+     * An enum for interpolations of the delay line reads between its
+     * samples.
+     */
+    enum PingPongDelayInterpolation
+    {
+        NoInterpolation,
+        LinearInterpolation,
+        HermiteInterpolation,
+        AllpassInterpolation,
+        InterpolationCount,
+    };
+
+
+    /**
+     * Read head of PingPongDelayUnit reading the delay line at a fractional
+     * distance behind the buffer cursor.
+     *
+     * @see PingPongDelayUnit
+     */
+    struct PingPongDelayReadHead
+    {
+        /**
+         * Distance of the newest read sample behind the buffer cursor,
+         * the other ones are read one sample further each.
+         */
+        int distance;
+
+        /**
+         * Coefficients of the read samples from the newest one on.
+         * The allpass interpolation keeps its only coefficient first.
+         */
+        float coefficients[maxInterpolationPoints];
+    };
+
+
+    /**
+     * All the settings of PingPongDelayUnit, its parameters together with
+     * the values derived from them, so that the settings may be stored
+     * and restored without deriving them again.
+     *
+     * @see PingPongDelayUnit
+     */
+    struct PingPongDelaySettings
+    {
+        // Parameters of the unit, all of them between [0, 1].
+        float delayParam;
+        float feedbackParam;
+        float panoramaParam;
+        float wetParam;
+        float syncParam;
+        float interpolationParam;
+        float tapCountParam;
+        float tapTimeParams[maxTapCount];
+        float tapGainParams[maxTapCount];
+        float tapPanoramaParams[maxTapCount];
+
+        // Values derived from the parameters.
+        int asyncDelayMs;
+        int syncDelayRatioIndex;
+        float feedback;
+        float panoramaParamC;
+        float primaryPanningQuotient;
+        float secondaryPanningQuotient;
+        float wetParamC;
+        bool isAsync;
+        int tapCount;
+        float tapTimeRatios[maxTapCount];
+        float tapLeftGains[maxTapCount];
+        float tapRightGains[maxTapCount];
+        int interpolation;
+    };
+
+
+#ifdef PINGPONGDELAY_TRIMMING
+    /**
+     * An enum for states of the buffers of the unit with respect
+     * to idle memory trimming.
+     */
+    enum PingPongDelayBufferState
+    {
+        ActiveBuffers,
+        TrimRequestedBuffers,
+        TrimmingBuffers,
+        TrimmedBuffers,
+    };
+#endif
+
 
     /**
      * Unit providing ping pong delay processing of streo sample
      * stream.
      *
+     * Besides the ping pong echoes the unit may read up to maxTapCount
+     * taps from the same delay line. Each tap reads both channels at its
+     * ratio of the delay, mixed to mono and placed by its panorama. Taps
+     * only read the delay line, they do not feed back, so the memory and
+     * the writes of the unit do not depend on their number.
+     *
+     * Without interpolation the delay is truncated to whole samples, so
+     * the synchronized delay follows the tempo in one sample steps.
+     * Interpolated read heads read the echoes at the exact fractional
+     * delay, the taps still read whole samples.
+     *
+     * In the economy the delay line of ProcessBlock runs at one half
+     * or one quarter of the sample rate in buffers as much smaller.
+     * The input is decimated into it and its echoes are interpolated back
+     * by the half-band filters of PingPongDelayResampler, while the dry
+     * input is mixed at the full rate.
+     *
      * ALERT: Whole class requires correct usage as written
      * in documentation. It does not make any argument checks
      * nor it throws any own error,
@@ -50,6 +177,7 @@ namespace PingPongDelay
          * A constructor.
          * All the parameters are between [0, 1]. The unit will be set accordingly
          * to the behavior of methods setting the parameters.
+         * The buffers are not allocated until AllocateBuffers is called.
          * @param bufferSize a size of the buffers, must be greater than 3.
          *      It determinates the lower bound of time info tempo of correct
          *      synchronization functionality. The greater bufferSize means
@@ -76,13 +204,98 @@ namespace PingPongDelay
          */
         ~PingPongDelayUnit();
 
+        /**
+         * Sets the time info of the blocks processed from now on, the host
+         * refreshes it before each block. Must be called from the audio
+         * thread or while the unit does not process.
+         * @param timeInfo a timeInfo with valid tempo information, which
+         *      must stay valid until the next call.
+         */
+        void SetTimeInfo(VstTimeInfo* timeInfo);
+
         /**
          * PingPongDelayUnit sample stream processing method.
+         * The frozen delay line is looped and thawed the same way
+         * as by ProcessBlock.
          * @param input a next sample in stream of stereo samples to be processed by unit.
          * @return effected input stereo sample.
          */
         StereoSample GetSample(StereoSample input);
 
+        /**
+         * PingPongDelayUnit block processing method. Gives the same output
+         * as calling GetSample for each frame of the block, while it also
+         * meters the levels of the input, the delay line and the output.
+         * The only exception is the synchronized unit with interpolation,
+         * whose time info tempo changed since the previous block without
+         * relocating the playback. Its delay ramps across the block from
+         * the previous tempo to the current one instead of jumping.
+         * In the economy the echoes come from the delay line running
+         * at the reduced rate instead.
+         * Output arrays may be the same as the input ones.
+         * @param leftInput an array of left channel samples to be processed.
+         * @param rightInput an array of right channel samples to be processed.
+         * @param leftOutput where to store the effected left channel samples.
+         * @param rightOutput where to store the effected right channel samples.
+         * @param sampleFrames number of samples of each channel.
+         */
+        void ProcessBlock(const float* leftInput, const float* rightInput, float* leftOutput,
+                          float* rightOutput, int sampleFrames);
+
+        /**
+         * Runs the feedback loop of one channel over a block, writing its
+         * delay line without producing any output. The feedback loops of
+         * the channels are independent, so the two channels of a block may
+         * be run on two threads at once. Once both are run, the block must
+         * be finished by MixChannels. The block must not be longer than
+         * GetChannelBlockLimit.
+         * @param channel zero for the left, one for the right channel.
+         * @param input an array of samples of the channel to be processed.
+         * @param sampleFrames number of samples of the channel.
+         */
+        void ProcessChannel(int channel, const float* input, int sampleFrames);
+
+        /**
+         * Finishes a block, whose channels were run by ProcessChannel,
+         * mixing the dry input with the delay line and moving the buffer
+         * cursor behind the block. Together they give the same output as
+         * ProcessBlock without interpolation, except that the levels are
+         * not metered. Output arrays may be the same as the input ones.
+         * @param leftInput an array of left channel samples to be processed.
+         * @param rightInput an array of right channel samples to be processed.
+         * @param leftOutput where to store the effected left channel samples.
+         * @param rightOutput where to store the effected right channel samples.
+         * @param sampleFrames number of samples of each channel.
+         */
+        void MixChannels(const float* leftInput, const float* rightInput, float* leftOutput,
+                         float* rightOutput, int sampleFrames);
+
+        /**
+         * Gets the longest block, which may be processed by ProcessChannel
+         * and MixChannels with the current delay. The delay line must hold
+         * the delayed samples of the whole block at once.
+         * @return number of frames.
+         */
+        int GetChannelBlockLimit();
+
+        /**
+         * Tells whether ProcessChannel and MixChannels give the same output
+         * as ProcessBlock with the current settings. They read the delay line
+         * only at whole samples and always write it at the full rate, so they
+         * do not with interpolation, nor while the delay line is frozen
+         * or thawing, nor in the economy.
+         * @return true if the channels may be processed separately, false
+         *      otherwise.
+         */
+        bool CanProcessChannels();
+
+        /**
+         * Gets the latest levels metered by ProcessBlock. May be called
+         * from any thread, it never blocks the processing.
+         * @param levels where to store the levels.
+         */
+        void GetLevels(PingPongDelayLevels& levels);
+
         /**
          * Gets the delay parameter setting of unit.
          * @return delay parameter between [0, 1].
@@ -206,246 +419,1516 @@ namespace PingPongDelay
         */
         bool IsAsync();
 
-    private:
         /**
-         * Increments the inner buffer cursors.
+         * Gets the tap count parameter setting of unit.
+         * @return tap count parameter between [0, 1].
          */
-        void IncrementBufferCursor();
+        float GetTapCountParam();
 
         /**
-         * Proper math modulo arithmetic function for the cursor not
-         * to exceed bounds of the buffer arrays while calculating
-         * delayed index.
-         * @param cursorIndex a buffer index, does not matter if exceeded
-         *   outside from buffer arrays.
-         * @return (cursorIndex) mod (buffer size).
+         * Sets the tap count parameter setting of unit.
+         * @param tapCountParam a new tap count parameter of the unit. Must be
+         *      a value from [0, 1]. Setting it to zero disables the taps,
+         *      setting it to one enables all maxTapCount of them. Any other
+         *      settings in between these act evenly corresponding to the value.
          */
-        int BufferModulo(int cursorIndex);
+        void SetTapCountParam(float tapCountParam);
 
         /**
-         * Calculates evenly corresponding integer value from interval
-         * [min, max] to value from interval [0, 1].
-         * @param param a parameter value from interval [0, 1].
-         * @param min a lower bound of closed output interval.
-         * @param max an upper bound of closed output interval.
-         * @return corresponding int value from [min, max].
+         * Gets the number of enabled taps, the first ones are enabled.
+         * @return number of taps between [0, maxTapCount].
          */
-        int Corresponding(float param, int min, int max);
+        int GetTapCount();
 
         /**
-         * Calculates evenly corresponding float value from interval
-         * [min, max] to value from interval [0, 1].
-         * @param param a parameter value from interval [0, 1].
-         * @param min a lower bound of closed output interval.
-         * @param max an upper bound of closed output interval.
-         * @return corresponding float value from [min, max].
+         * Gets the time parameter setting of a tap.
+         * @param tap an index of the tap.
+         * @return time parameter between [0, 1].
          */
-        float Corresponding(float param, float min, float max);
+        float GetTapTimeParam(int tap);
 
+        /**
+         * Sets the time parameter setting of a tap.
+         * @param tap an index of the tap.
+         * @param tapTimeParam a new time parameter of the tap. Must be a value
+         *      from [0, 1]. The tap reads the delay line at the corresponding
+         *      ratio of the delay from [min tap time ratio, max tap time ratio],
+         *      one half reads it once delayed.
+         */
+        void SetTapTimeParam(int tap, float tapTimeParam);
 
         /**
-         * Size of the stereo buffer.
-         *
-         * @see leftBuffer_
-         * @see rightBuffer_
+         * Gets the time ratio of a tap.
+         * @param tap an index of the tap.
+         * @return ratio of the delay the tap reads the delay line at.
          */
-        int bufferSize_;
+        float GetTapTimeRatio(int tap);
 
         /**
-         * Inner time info containing valid tempo information.
+         * Gets the gain parameter setting of a tap.
+         * @param tap an index of the tap.
+         * @return gain parameter between [0, 1].
          */
-        VstTimeInfo* timeInfo_;
+        float GetTapGainParam(int tap);
 
+        /**
+         * Sets the gain parameter setting of a tap.
+         * @param tap an index of the tap.
+         * @param tapGainParam a new gain parameter of the tap. Must be a value
+         *      from [0, 1], the ratio of the tap in the wet signal.
+         */
+        void SetTapGainParam(int tap, float tapGainParam);
 
-        // Fields for parameters of unit settings.
         /**
-         * Stores the value of delay parameter.
+         * Gets the panorama parameter setting of a tap.
+         * @param tap an index of the tap.
+         * @return panorama parameter between [0, 1].
          */
-        float delayParam_;
+        float GetTapPanoramaParam(int tap);
 
         /**
-         * Stores the value of feedback parameter.
+         * Sets the panorama parameter setting of a tap.
+         * @param tap an index of the tap.
+         * @param tapPanoramaParam a new panorama parameter of the tap. Must be
+         *      a value from [0, 1]. Setting it to zero places the tap to
+         *      the left, to one half to the center and to one to the right
+         *      channel.
          */
-        float feedbackParam_;
+        void SetTapPanoramaParam(int tap, float tapPanoramaParam);
 
         /**
-         * Stores the value of panorama parameter.
+         * Gets the interpolation parameter setting of unit.
+         * @return interpolation parameter between [0, 1].
          */
-        float panoramaParam_;
+        float GetInterpolationParam();
 
         /**
-         * Stores the value of wet parameter.
+         * Sets the interpolation parameter setting of unit.
+         * @param interpolationParam a new interpolation parameter of the unit.
+         *      Must be a value from [0, 1]. Each of PingPongDelayInterpolation
+         *      in its order corresponds to an evenly big part of the interval.
          */
-        float wetParam_;
+        void SetInterpolationParam(float interpolationParam);
 
         /**
-         * Stores the value of synchronization parameter.
+         * Gets the interpolation of the delay line reads.
+         * @return one of PingPongDelayInterpolation.
          */
-        float syncParam_;
+        int GetInterpolation();
 
+        /**
+         * Gets the string of currently set interpolation.
+         * @return string of the interpolation.
+         */
+        const char* GetInterpolationName();
 
-        // Auxiliary fields for unit settings.
         /**
-         * Field containing corresponding delay time in milliseconds set by
-         * delay parameter value while unit is usynchronized with its time info
-         * inner tempo.
-         *
-         * @see timeInfo_
+         * Gets the freeze parameter setting of unit.
+         * @return freeze parameter between [0, 1].
          */
-        int asyncDelayMs_;
+        float GetFreezeParam();
 
         /**
-         * This index points to the syncRatios_ index of which ratio is
-         * currently set by delay parameter value while unit is synchronized
-         * with its time info inner tempo.
-         *
-         * @see syncRatios_
-         * @see timeInfo_
+         * Sets the freeze parameter setting of unit. While it is at least
+         * one half, nothing is written to the delay line and the read heads
+         * keep looping over the last two delays held in it. Only ProcessBlock
+         * freezes the delay line, the freeze is not a part of the settings.
+         * @param freezeParam a new freeze parameter of the unit. Must be
+         *      a value from [0, 1].
          */
-        int syncDelayRatioIndex_;
+        void SetFreezeParam(float freezeParam);
 
         /**
-         * Field representing the precalculated correspondening feedback value
-         * to the interval [minFeedback_, maxFeedback_]set by feedbackParam_.
-         *
-         * @see minFeedback_
-         * @see maxFeedback_
-         * @see feedbackParam_
+         * Tells whether the delay line of unit is to be frozen.
+         * @return true if the delay line is to be frozen, false otherwise.
          */
-        float feedback_;
+        bool IsFrozen();
 
         /**
-         * This field together with panoramaParam_ are used to provide ping
-         * pong delaying. They represent the ratio of delaying signal in one
-         * channel in comparison to the other. They are always complementary
-         * so their sum must be equal to 1.
-         *
-         * @see panoramaParam_
+         * Gets the economy parameter setting of unit.
+         * @return economy parameter between [0, 1].
          */
-        float panoramaParamC_;
+        float GetEconomyParam();
 
         /**
-         * primaryPanningQuotient_ & secondaryPanningQuotient_ are used to provide
-         * stereo delaying. They represent the ratio of respectively left and
-         * right channel input sample to be delayed in left channel and the
-         * ratio of respectively right and left channel input sample to be
-         * delayed in right channel. They are always complementary. Their
-         * sum must be equal to 1.
-         *
-         * @see secondaryPanningQuotient_
+         * Sets the economy parameter setting of unit. Each of the rates
+         * of economyStrings_ in its order corresponds to an evenly big part
+         * of the interval. Only ProcessBlock runs the delay line at
+         * the reduced rate, the economy is not a part of the settings.
+         * The rate is switched once AllocateBuffers replaces the buffers
+         * by the ones sized for it, until then the unit keeps its rate.
+         * @param economyParam a new economy parameter of the unit. Must be
+         *      a value from [0, 1].
          */
-        float primaryPanningQuotient_;
+        void SetEconomyParam(float economyParam);
 
         /**
-         * primaryPanningQuotient_ & secondaryPanningQuotient_ are used to provide
-         * stereo delaying. They represent the ratio of respectively left and
-         * right channel input sample to be delayed in left channel and the
-         * ratio of respectively right and left channel input sample to be
-         * delayed in right channel. They are always complementary. Their
-         * sum must be equal to 1.
-         *
-         * @see primaryPanningQuotient_
+         * Gets the factor by which the sample rate of the delay line
+         * is to be reduced.
+         * @return factor of the rate, 1 if the economy is off.
          */
-        float secondaryPanningQuotient_;
+        int GetEconomyFactor();
 
         /**
-         * This field together with wetParam_ are complementary so that
-         * their sum must be equal to 1. In This ratio is also called a "dry"
-         * ratio in audio effect terminology. Wet represents the ratio of
-         * effected while dry represents the ratio of original signal in output.
-         *
-         * @see wetParam_
+         * Gets the string of currently set economy.
+         * @return string of the economy.
          */
-        float wetParamC_;
+        const char* GetEconomyName();
 
         /**
-         * This field stores the precalculated value representing weather the
-         * unit is synchronized ("true") with its time info or not ("false").
+         * Gets all the settings of unit, the parameters together with
+         * the values derived from them.
+         * @param settings where to store the settings.
          */
-        bool isAsync_;
+        void GetSettings(PingPongDelaySettings& settings);
 
+        /**
+         * Sets all the settings of unit at once. The derived values are
+         * copied instead of being derived again, so they must correspond
+         * to the parameters, as got by GetSettings of a unit.
+         * @param settings the settings to set.
+         * @return true if the settings were set, false if some of the derived
+         *      values are out of their range and nothing was set.
+         */
+        bool SetSettings(const PingPongDelaySettings& settings);
 
         /**
-         * Buffer cursor pointing to the index where should be current sample
-         * being played written.
+         * Tells whether the derived values of settings are within their
+         * ranges, so that the settings may be set by SetSettings.
+         * @param settings the settings to check.
+         * @return true if the settings are valid, false otherwise.
          */
-        int bufferCursor_;
+        static bool IsValidSettings(const PingPongDelaySettings& settings);
 
         /**
-         * An array of samples representing left channel circular buffer.
-         * Purpose of this buffers is to track down the dry signal combined with
-         * feedbacked delayed signal on left channel.
+         * Derives the values of settings from their parameters, the same
+         * way as the setters of a unit do. Neither a unit nor its time
+         * info are needed, so it is cheap to call from any thread.
+         * @param settings the settings whose values are to be derived.
          */
-        float* leftBuffer_;
+        static void DeriveSettings(PingPongDelaySettings& settings);
 
         /**
-         * An array of samples representing right channel circular buffer.
-         * Purpose of this buffers is to track down the dry signal combined with
-         * feedbacked delayed signal on right channel.
+         * Derives the asynchronous delay from the delay parameter.
+         * @param delayParam a delay parameter from [0, 1].
+         * @return delay time from [min delay time, max delay time] in ms.
          */
-        float* rightBuffer_;
+        static int AsyncDelayMs(float delayParam);
 
+        /**
+         * Derives the index of the synchronized delay ratio from the delay
+         * parameter.
+         * @param delayParam a delay parameter from [0, 1].
+         * @return index of the ratio of syncDelayRatios_.
+         */
+        static int SyncDelayRatioIndex(float delayParam);
 
-        // Fields representing the possible settings of
-        // delaying time of unit while it is asynchronous.
         /**
-         * Lower bound of possible asynchronous delay settings in ms.
+         * Derives the feedback from the feedback parameter.
+         * @param feedbackParam a feedback parameter from [0, 1].
+         * @return feedback from [min feedback, max feedback].
          */
-        static const int minAsyncDelayMs_;
+        static float Feedback(float feedbackParam);
 
         /**
-         * Upper bound of possible asynchronous delay settings in ms.
+         * Derives the panning quotients from the panorama parameter.
+         * @param panoramaParam a panorama parameter from [0, 1].
+         * @param primaryPanningQuotient where to store the quotient
+         *      of the stereo panning of the delayed signal.
+         * @param secondaryPanningQuotient where to store the quotient
+         *      of the mono delayed signal.
          */
-        static const int maxAsyncDelayMs_;
+        static void PanningQuotients(float panoramaParam, float& primaryPanningQuotient,
+                                     float& secondaryPanningQuotient);
 
+        /**
+         * Derives the interpolation from the interpolation parameter.
+         * @param interpolationParam an interpolation parameter from [0, 1].
+         * @return one of PingPongDelayInterpolation.
+         */
+        static int Interpolation(float interpolationParam);
 
-        // Fields representing the possible settings of
-        // delaying time of unit while it is synchronized.
         /**
-         * Stores the number of possible synchronized delay ratio settings.
-         * It is the size of syncDelayRatios_ array.
-         *
-         * @see syncDelayRatios_
+         * Derives the number of enabled taps from the tap count parameter.
+         * @param tapCountParam a tap count parameter from [0, 1].
+         * @return number of taps between [0, maxTapCount].
          */
-        static const int syncDelayRatioCount_;
+        static int TapCount(float tapCountParam);
 
         /**
-         * Stores the possible synchronized delay ratios.
+         * Derives the time ratio of a tap from its time parameter.
+         * @param tapTimeParam a time parameter of the tap from [0, 1].
+         * @return ratio of the delay the tap reads the delay line at.
          */
-        static const float syncDelayRatios_[];
+        static float TapTimeRatio(float tapTimeParam);
 
         /**
-         * Stores the strings of possible synchronized delay ratios,
-         * from syncDelayRatios_.
-         *
-         * @see syncDelayRatios_.
+         * Derives the gains of a tap in both channels from its gain
+         * and panorama parameters.
+         * @param tapGainParam a gain parameter of the tap from [0, 1].
+         * @param tapPanoramaParam a panorama parameter of the tap from [0, 1].
+         * @param leftGain where to store the gain of the left channel.
+         * @param rightGain where to store the gain of the right channel.
          */
-        static const char* syncDelayRatioStrings_[];
+        static void TapGains(float tapGainParam, float tapPanoramaParam, float& leftGain, float& rightGain);
 
+        /**
+         * Publishes settings to the audio thread. The next block processed
+         * by ProcessBlock takes them over and crossfades from the current
+         * settings to them, without deriving any value. Settings reading
+         * the delay line at the same places are set at once instead. Never
+         * blocks the processing and allocates nothing, but must not be
+         * called from two threads at once. Settings published again before
+         * the previous ones were taken over replace them, the ones published
+         * while crossfading are taken over once the crossfade ends.
+         * @param settings the settings, as got by GetSettings of a unit.
+         */
+        void PublishSettings(const PingPongDelaySettings& settings);
 
-        // Field representing the bounds of feedback ratio.
-        // These constrictions are made due to the protection from
-        // output signal clipping.
         /**
-         * Lower bound of possible feedback ratio settings.
+         * Tells whether there are published settings not yet taken over
+         * by the audio thread. Until then the unit keeps its previous
+         * settings.
+         * @return true if the published settings are pending, false otherwise.
          */
-        static const float minFeedback_;
+        bool HasPublishedSettings();
+
         /**
-         * Upper bound of possible feedback ratio settings.
+         * Allocates and clears the buffers, unless they are already allocated
+         * for the rate of the economy. Buffers of another rate are replaced,
+         * their size is the size given to the constructor divided by
+         * the economy factor. Until then the unit processes as if the delay
+         * line was silent. Must not be called from the audio thread.
+         * @return true if the buffers were allocated by this call, false if
+         *      they had already been allocated.
          */
-        static const float maxFeedback_;
+        bool AllocateBuffers();
 
+        /**
+         * Makes the delay line silent in constant time. Samples are not erased,
+         * the ones not written since the reset are cleared lazily just before
+         * they are read. Must not be called while the unit is processing.
+         */
+        void ResetBuffers();
 
-        // Fields representing ratios of time convertions.
         /**
-         * Stores how many seconds are in minute.
+         * Tells whether the buffers of the unit are allocated.
+         * @return true if the buffers are allocated, false otherwise.
          */
-        static const int sInMin_;
+        bool HasBuffers();
 
         /**
-         * Stores how many milliseconds are in second.
+         * Gets the memory allocated by the unit for its buffers.
+         * @return size of the buffers in bytes, zero if they are not allocated.
          */
-        static const int msInS_;
+        long long GetBufferMemory();
+
+        /**
+         * Gets the size of the buffers of the unit.
+         * @return size of each of the buffers in samples.
+         */
+        int GetBufferSize();
+
+        /**
+         * Gets the number of frames of the state of the delay line, which
+         * are the frames written since the last reset, at most the buffer
+         * size.
+         * @return number of frames, zero if the buffers are not allocated.
+         */
+        int GetStateFrames();
+
+        /**
+         * Tells whether SaveState copies everything the following output
+         * depends on besides the parameters. It does not with the allpass
+         * interpolation, whose filters keep their own state, nor while
+         * the delay is to ramp from the previous tempo, while the delay line
+         * is frozen or thawing, nor in the economy, whose resampler keeps
+         * its own state.
+         * @return true if the state is complete, false otherwise.
+         */
+        bool CanSaveState();
+
+        /**
+         * Copies the state of the delay line, the samples written since
+         * the last reset from the oldest one. Together with the parameters
+         * it is everything the following output depends on, as long as
+         * CanSaveState tells so.
+         * @param leftState where to store GetStateFrames left channel samples.
+         * @param rightState where to store GetStateFrames right channel samples.
+         */
+        void SaveState(float* leftState, float* rightState);
+
+        /**
+         * Restores the state of the delay line copied by SaveState, possibly
+         * of another unit. The buffers must be allocated. If the state is
+         * longer than the buffers, only its newest samples are restored.
+         * @param leftState left channel samples of the state.
+         * @param rightState right channel samples of the state.
+         * @param stateFrames number of samples of each channel.
+         */
+        void LoadState(const float* leftState, const float* rightState, int stateFrames);
+
+        /**
+         * Calculates the smallest buffer size, with which every delay
+         * setting is delayed correctly.
+         * @param sampleRate a sample rate of the processing.
+         * @param tempo the lowest tempo the unit is synchronized to.
+         * @return size of the buffers in samples.
+         */
+        static int RequiredBufferSize(float sampleRate, float tempo);
+
+        /**
+         * Calculates the longest delay of any delay setting.
+         * @param sampleRate a sample rate of the processing.
+         * @param tempo the lowest tempo the unit is synchronized to.
+         * @return delay in samples.
+         */
+        static int MaxDelaySamples(float sampleRate, float tempo);
+
+#ifdef PINGPONGDELAY_TRIMMING
+        /**
+         * Sets the time of silence after which the unit offers its buffers
+         * to be trimmed. Must not be called while the unit is processing.
+         * @param idleTrimMs time of silence in milliseconds, zero disables
+         *      the trimming.
+         */
+        void SetIdleTrimMs(int idleTrimMs);
+
+        /**
+         * Releases the buffers, if the unit offered them to be trimmed and
+         * has not taken the offer back. Must not be called from the audio
+         * thread.
+         * @return released memory in bytes.
+         */
+        long long TrimBuffers();
+
+        /**
+         * Tells whether the buffers of the unit are trimmed, waiting to be
+         * provided from the pool of spare buffers.
+         * @return true if the buffers are trimmed, false otherwise.
+         */
+        bool IsTrimmed();
+#endif
+
+    private:
+        /**
+         * Bank processing many units at once reads the settings of its
+         * units directly.
+         */
+        friend class PingPongDelayBank;
+
+        /**
+         * Surround units read the settings of their units directly.
+         */
+        template<int channelCount> friend class PingPongDelaySurroundUnit;
+
+        /**
+         * Calculates the current delay as a number of samples, considering
+         * whether the unit is synchronized with its time info tempo or not.
+         * @return delay in samples.
+         */
+        int DelaySamples();
+
+        /**
+         * Calculates the current delay as a fractional number of samples,
+         * the same way as DelaySamples does before the truncation.
+         * @return delay in samples.
+         */
+        float ExactDelaySamples();
+
+        /**
+         * Calculates the delay of settings as a fractional number of samples,
+         * the same way as ExactDelaySamples does for the settings of unit.
+         * @param settings the settings.
+         * @return delay in samples.
+         */
+        float ExactDelaySamples(const PingPongDelaySettings& settings);
+
+        /**
+         * Takes over the published settings, if there are any, and starts
+         * crossfading to them, unless they read the delay line at the same
+         * places as the current ones. Called by the audio thread
+         * at the beginning of each block.
+         */
+        void TakePublishedSettings();
+
+        /**
+         * Tells whether two settings read the delay line at the same places
+         * the same way, so that switching between them needs no crossfade.
+         * @param first the first settings.
+         * @param second the second settings.
+         * @return true if the settings read the same places, false otherwise.
+         */
+        static bool ReadsSamePlaces(const PingPongDelaySettings& first, const PingPongDelaySettings& second);
+
+        /**
+         * Calculates the length of the crossfades in frames.
+         * @return length of the crossfades, at least one frame.
+         */
+        int FadeLength();
+
+        /**
+         * Processes frames crossfading from fadingSettings_ to the settings
+         * of unit. Both settings read the delay line by their own read heads,
+         * the output and the samples written to the delay line are blended
+         * frame by frame. Must not be called for more than fadeFrames_.
+         * @param leftInput an array of left channel samples to be processed.
+         * @param rightInput an array of right channel samples to be processed.
+         * @param leftOutput where to store the effected left channel samples.
+         * @param rightOutput where to store the effected right channel samples.
+         * @param sampleFrames number of samples of each channel.
+         */
+        void ProcessFadingFrames(const float* leftInput, const float* rightInput, float* leftOutput,
+                                 float* rightOutput, int sampleFrames);
+
+        /**
+         * Places the semi and the full delayed read heads and calculates
+         * the tap distances of settings.
+         * @param settings the settings.
+         * @param heads where to store the two heads.
+         * @param tapDistances where to store the distances of the taps.
+         */
+        void PlaceSettingsHeads(const PingPongDelaySettings& settings, PingPongDelayReadHead* heads, int* tapDistances);
+
+        /**
+         * Reads a single frame of the delay line as settings do, without
+         * writing it. The read samples may wrap around the end of the buffers.
+         * @param settings the settings.
+         * @param heads the read heads of the settings.
+         * @param tapDistances the tap distances of the settings.
+         * @param frozen whether to read the frozen loop instead of the samples
+         *      behind the buffer cursor. The samples to be written are then
+         *      the ones held by the loop.
+         * @param leftInput a left channel sample to be processed.
+         * @param rightInput a right channel sample to be processed.
+         * @param leftOutput where to store the effected left channel sample.
+         * @param rightOutput where to store the effected right channel sample.
+         * @param leftWritten where to store the left channel sample to be written.
+         * @param rightWritten where to store the right channel sample to be written.
+         * @param leftStates the left channel allpass states of the heads.
+         * @param rightStates the right channel allpass states of the heads.
+         */
+        void ReadSettingsFrame(const PingPongDelaySettings& settings, const PingPongDelayReadHead* heads,
+                               const int* tapDistances, bool frozen, float leftInput, float rightInput, float& leftOutput,
+                               float& rightOutput, float& leftWritten, float& rightWritten, float* leftStates,
+                               float* rightStates);
+
+        /**
+         * Freezes the delay line at the buffer cursor. The loop spans the last
+         * two delays, so that both heads keep reading what they read before.
+         * Its end is blended into the samples preceding its beginning, so that
+         * it wraps around without a click.
+         */
+        void StartFreeze();
+
+        /**
+         * Starts crossfading from the frozen loop to the delay line being
+         * written again, or ends the freeze at once, if the written samples
+         * would reach the loop before the crossfade ends.
+         */
+        void StartThaw();
+
+        /**
+         * Calculates the buffer index, at which a read head of the frozen loop
+         * reads. Heads reading behind the beginning of the loop are wrapped
+         * back by its length.
+         * @param distance a distance of the head behind the virtual cursor
+         *      of the loop.
+         * @return buffer index of the read sample.
+         */
+        int FrozenCursor(int distance);
+
+        /**
+         * Processes a block while the delay line is frozen. Nothing is written,
+         * the heads and the taps read the loop by contiguous segments.
+         * @param leftInput an array of left channel samples to be processed.
+         * @param rightInput an array of right channel samples to be processed.
+         * @param leftOutput where to store the effected left channel samples.
+         * @param rightOutput where to store the effected right channel samples.
+         * @param sampleFrames number of samples of each channel.
+         */
+        void ProcessFrozenBlock(const float* leftInput, const float* rightInput, float* leftOutput,
+                                float* rightOutput, int sampleFrames);
+
+        /**
+         * Processes a segment of a frozen block, within which none of the read
+         * cursors wraps around the end of the buffers nor jumps back to
+         * the beginning of the loop, and no head reads across the end of
+         * the buffers. Accumulates the metered levels, the held samples
+         * are metered as the delay line.
+         * @param leftInput an array of left channel samples to be processed.
+         * @param rightInput an array of right channel samples to be processed.
+         * @param leftOutput where to store the effected left channel samples.
+         * @param rightOutput where to store the effected right channel samples.
+         * @param sampleFrames number of samples of each channel.
+         * @param heads the semi and the full delayed read heads.
+         * @param headCursors buffer indexes of the newest samples read by the heads.
+         * @param tapCount number of taps read by the segment.
+         * @param tapCursors buffer indexes of the taps.
+         */
+        template<int interpolation>
+        void ProcessFrozenSegment(const float* leftInput, const float* rightInput, float* leftOutput,
+                                  float* rightOutput, int sampleFrames, const PingPongDelayReadHead* heads,
+                                  const int* headCursors, int tapCount, const int* tapCursors);
+
+        /**
+         * Processes frames crossfading from the frozen loop to the delay line
+         * being written again. The output and the samples written to the delay
+         * line are blended frame by frame. Must not be called for more than
+         * thawFrames_.
+         * @param leftInput an array of left channel samples to be processed.
+         * @param rightInput an array of right channel samples to be processed.
+         * @param leftOutput where to store the effected left channel samples.
+         * @param rightOutput where to store the effected right channel samples.
+         * @param sampleFrames number of samples of each channel.
+         */
+        void ProcessThawingFrames(const float* leftInput, const float* rightInput, float* leftOutput,
+                                  float* rightOutput, int sampleFrames);
+
+        /**
+         * Tells whether the delay of the current block ramps from
+         * the previous tempo and calculates the delay it ramps from.
+         * The delay ramps only while the unit is synchronized with
+         * interpolation, the tempo changed since the previous block
+         * and the playback was not relocated.
+         * @param rampDelay where to store the delay in samples at
+         *      the previous tempo.
+         * @return true if the delay ramps, false otherwise.
+         */
+        bool GetRampDelay(float& rampDelay);
+
+        /**
+         * Remembers the tempo and the expected musical position of the next
+         * block, once the current block is processed.
+         * @param sampleFrames number of frames of the processed block.
+         */
+        void AdvanceRamp(int sampleFrames);
+
+        /**
+         * Places the semi and the full delayed read heads at the current
+         * delay and twice the delay behind the buffer cursor.
+         * @param heads where to store the two heads.
+         * @param interpolation an interpolation of the heads, other than
+         *      NoInterpolation.
+         */
+        void PlaceReadHeads(PingPongDelayReadHead* heads, int interpolation);
+
+        /**
+         * Gets the number of samples read at once by a read head.
+         * @param interpolation an interpolation of the head.
+         * @return number of samples up to maxInterpolationPoints.
+         */
+        static int InterpolationPoints(int interpolation);
+
+        /**
+         * Splits a fractional distance behind the buffer cursor into
+         * the distance of the newest sample read by a read head and
+         * the fraction interpolated by the head.
+         * @param interpolation an interpolation of the head, other than
+         *      NoInterpolation.
+         * @param distance a distance behind the buffer cursor in samples.
+         * @param fraction where to store the interpolated fraction.
+         * @return distance of the newest read sample.
+         */
+        static int SplitDistance(int interpolation, float distance, float& fraction);
+
+        /**
+         * Calculates the coefficients of the samples read by a read head,
+         * from the newest one. Coefficients of the samples the head does not
+         * read are zero.
+         * @param interpolation an interpolation of the head, other than
+         *      NoInterpolation.
+         * @param fraction the fraction interpolated by the head, as split
+         *      by SplitDistance.
+         * @param coefficients where to store maxInterpolationPoints coefficients.
+         */
+        static void Coefficients(int interpolation, float fraction, float* coefficients);
+
+        /**
+         * Interpolates the sample read by a read head.
+         * @param interpolation an interpolation of the head, other than
+         *      NoInterpolation.
+         * @param newest a pointer to the newest read sample, the older ones
+         *      precede it.
+         * @param coefficients coefficients of the head.
+         * @param state the previous sample of the head, updated by allpass
+         *      interpolation.
+         * @return interpolated sample.
+         */
+        static float Interpolate(int interpolation, const float* newest, const float* coefficients, float& state);
+
+        /**
+         * Calculates the distance of a tap behind the buffer cursor.
+         * @param tap an index of the tap.
+         * @param delaySamples the current delay in samples.
+         * @return distance in samples.
+         */
+        int TapDistance(int tap, int delaySamples);
+
+        /**
+         * Precalculates the gains of a tap in the channels from its gain
+         * and panorama.
+         * @param tap an index of the tap.
+         */
+        void UpdateTapGains(int tap);
+
+        /**
+         * Processes a segment of a block, within which none of the buffer
+         * cursors wraps and which reads no samples it writes, except when
+         * the delayed cursors equal the buffer cursor, so that it runs over
+         * contiguous arrays. Accumulates the metered levels.
+         * @param leftInput an array of left channel samples to be processed.
+         * @param rightInput an array of right channel samples to be processed.
+         * @param leftOutput where to store the effected left channel samples.
+         * @param rightOutput where to store the effected right channel samples.
+         * @param sampleFrames number of samples of each channel.
+         * @param semiDelayedCursor buffer index delayed once behind the cursor.
+         * @param fullDelayedCursor buffer index delayed twice behind the cursor.
+         * @param tapCount number of taps read by the segment.
+         * @param tapCursors buffer indexes of the taps.
+         */
+        void ProcessSegment(const float* leftInput, const float* rightInput, float* leftOutput,
+                            float* rightOutput, int sampleFrames, int semiDelayedCursor, int fullDelayedCursor,
+                            int tapCount, const int* tapCursors);
+
+        /**
+         * Processes a block the same way as ProcessBlock does, reading
+         * the echoes by interpolated read heads.
+         * @param leftInput an array of left channel samples to be processed.
+         * @param rightInput an array of right channel samples to be processed.
+         * @param leftOutput where to store the effected left channel samples.
+         * @param rightOutput where to store the effected right channel samples.
+         * @param sampleFrames number of samples of each channel.
+         */
+        void ProcessInterpolatedBlock(const float* leftInput, const float* rightInput, float* leftOutput,
+                                      float* rightOutput, int sampleFrames);
+
+        /**
+         * Processes a block by interpolated read heads moving with the delay
+         * ramping from one length to another across the block. The delay
+         * reaches the end length at the last frame.
+         * @param leftInput an array of left channel samples to be processed.
+         * @param rightInput an array of right channel samples to be processed.
+         * @param leftOutput where to store the effected left channel samples.
+         * @param rightOutput where to store the effected right channel samples.
+         * @param sampleFrames number of samples of each channel.
+         * @param startDelay the delay in samples before the block.
+         * @param endDelay the delay in samples at the last frame of the block.
+         * @return true if the block was processed, false if the ramp does not
+         *      fit the buffers and the block must be processed at a constant
+         *      delay.
+         */
+        bool ProcessRampedBlock(const float* leftInput, const float* rightInput, float* leftOutput,
+                                float* rightOutput, int sampleFrames, float startDelay, float endDelay);
+
+        /**
+         * Processes a segment of a block by interpolated read heads, within
+         * which none of the buffer cursors wraps and which reads no samples
+         * it writes. Unless the heads are ramped, no head reads across the end
+         * of the buffers. Ramped heads move with the delay from frame to frame,
+         * they gather the read samples by wrapping indexes. Accumulates
+         * the metered levels.
+         * @param leftInput an array of left channel samples to be processed.
+         * @param rightInput an array of right channel samples to be processed.
+         * @param leftOutput where to store the effected left channel samples.
+         * @param rightOutput where to store the effected right channel samples.
+         * @param sampleFrames number of samples of each channel.
+         * @param heads the semi and the full delayed read heads, unless ramped.
+         * @param headCursors buffer indexes of the newest samples read by the heads,
+         *      unless ramped.
+         * @param firstDelay the delay at the first frame of the segment, if ramped.
+         * @param delayStep change of the delay from frame to frame, if ramped.
+         * @param tapCount number of taps read by the segment.
+         * @param tapCursors buffer indexes of the taps.
+         */
+        template<int interpolation, bool ramped>
+        void ProcessInterpolatedSegment(const float* leftInput, const float* rightInput, float* leftOutput,
+                                        float* rightOutput, int sampleFrames, const PingPongDelayReadHead* heads,
+                                        const int* headCursors, float firstDelay, float delayStep,
+                                        int tapCount, const int* tapCursors);
+
+        /**
+         * Reads both channels by a read head moving from frame to frame.
+         * The read samples may wrap around the end of the buffers.
+         * @param newestCursor buffer index of the newest read sample, it may
+         *      be negative down to minus the buffer size.
+         * @param coefficients coefficients of the head at the frame.
+         * @param leftSample where to store the interpolated left channel sample.
+         * @param rightSample where to store the interpolated right channel sample.
+         * @param leftState the previous left channel sample of the head.
+         * @param rightState the previous right channel sample of the head.
+         */
+        template<int interpolation>
+        void ReadMovingHead(int newestCursor, const float* coefficients, float& leftSample, float& rightSample,
+                            float& leftState, float& rightState);
+
+        /**
+         * Processes a single frame by interpolated read heads, the same way
+         * as GetSample does. The read samples may wrap around the end of
+         * the buffers.
+         * @param leftInput a left channel sample to be processed.
+         * @param rightInput a right channel sample to be processed.
+         * @param leftOutput where to store the effected left channel sample.
+         * @param rightOutput where to store the effected right channel sample.
+         * @param heads the semi and the full delayed read heads.
+         * @param interpolation an interpolation of the heads.
+         * @param tapCount number of taps read by the frame.
+         * @param tapDistances distances of the taps behind the buffer cursor.
+         */
+        void ProcessInterpolatedFrame(float leftInput, float rightInput, float& leftOutput, float& rightOutput,
+                                      const PingPongDelayReadHead* heads, int interpolation, int tapCount,
+                                      const int* tapDistances);
+
+        /**
+         * Accumulates the levels of a single frame into the metering window.
+         * @param leftInput a left channel input sample.
+         * @param rightInput a right channel input sample.
+         * @param leftWritten a left channel sample written to the delay line.
+         * @param rightWritten a right channel sample written to the delay line.
+         * @param leftOutput a left channel output sample.
+         * @param rightOutput a right channel output sample.
+         */
+        void MeterFrame(float leftInput, float rightInput, float leftWritten, float rightWritten,
+                        float leftOutput, float rightOutput);
+
+        /**
+         * Accumulates a sample into the level of a metering lane.
+         * @param sample a metered sample.
+         * @param peak a peak level of the lane to update.
+         * @param sum a sum of squared samples of the lane to update.
+         */
+        static void AccumulateLevel(float sample, float& peak, float& sum);
+
+        /**
+         * Accounts processed frames into the metering window and publishes
+         * the levels once the window is complete.
+         * @param sampleFrames number of processed frames.
+         */
+        void AccountMeterFrames(int sampleFrames);
+
+        /**
+         * Gets the sample rate the delay line runs at.
+         * @return time info sample rate divided by the economy factor.
+         */
+        float LineRate();
+
+        /**
+         * Gets the gain of the dry input of the output of the delay line,
+         * which is left out while the delay line runs at the reduced rate.
+         * @param wetParamC a complement of the wet parameter.
+         * @return gain of the dry input.
+         */
+        float DryGain(float wetParamC);
+
+        /**
+         * Processes a block through the delay line, frozen, crossfading
+         * or as usual, without accounting it into the metering window
+         * and the tempo ramps.
+         * @param leftInput an array of left channel samples to be processed.
+         * @param rightInput an array of right channel samples to be processed.
+         * @param leftOutput where to store the effected left channel samples.
+         * @param rightOutput where to store the effected right channel samples.
+         * @param sampleFrames number of samples of each channel.
+         */
+        void ProcessDelayBlock(const float* leftInput, const float* rightInput, float* leftOutput,
+                               float* rightOutput, int sampleFrames);
+
+        /**
+         * Processes a block running the delay line at the reduced rate.
+         * The block is decimated and processed by ProcessDelayBlock without
+         * the dry input in chunks, the echoes are interpolated back and
+         * mixed with the dry input by MixEchoes.
+         * @param leftInput an array of left channel samples to be processed.
+         * @param rightInput an array of right channel samples to be processed.
+         * @param leftOutput where to store the effected left channel samples.
+         * @param rightOutput where to store the effected right channel samples.
+         * @param sampleFrames number of samples of each channel.
+         */
+        void ProcessEconomyBlock(const float* leftInput, const float* rightInput, float* leftOutput,
+                                 float* rightOutput, int sampleFrames);
+
+        /**
+         * Mixes the dry input of a chunk with the echoes interpolated
+         * to leftEchoes_ and rightEchoes_, metering the input and the output
+         * at the full rate. Output arrays may be the same as the input ones.
+         * @param leftInput an array of left channel samples to be processed.
+         * @param rightInput an array of right channel samples to be processed.
+         * @param leftOutput where to store the effected left channel samples.
+         * @param rightOutput where to store the effected right channel samples.
+         * @param sampleFrames number of samples of each channel.
+         * @param dryGain a gain of the dry input before the first frame.
+         * @param dryStep a change of the gain of the dry input per frame.
+         * @param sumScale a ratio the sums of squared samples are scaled by,
+         *      so that they are accounted as the frames of the delay line.
+         */
+        void MixEchoes(const float* leftInput, const float* rightInput, float* leftOutput, float* rightOutput,
+                       int sampleFrames, float dryGain, float dryStep, float sumScale);
+
+#ifdef PINGPONGDELAY_TRIMMING
+        /**
+         * Decides whether the buffers may be used to process a block. Offers
+         * them to be trimmed after long silence and provides them again,
+         * once the input is not silent. Must be called from the audio thread
+         * only.
+         * @param leftInput an array of left channel samples to be processed.
+         * @param rightInput an array of right channel samples to be processed.
+         * @param sampleFrames number of samples of each channel.
+         * @return true if the buffers may be used, false if the block is
+         *      to be processed as if the delay line was silent.
+         */
+        bool ProvideBuffers(const float* leftInput, const float* rightInput, int sampleFrames);
+
+        /**
+         * Tells whether all samples of a block are below the silence level.
+         * @param leftInput an array of left channel samples.
+         * @param rightInput an array of right channel samples.
+         * @param sampleFrames number of samples of each channel.
+         * @return true if the block is silent, false otherwise.
+         */
+        static bool IsSilent(const float* leftInput, const float* rightInput, int sampleFrames);
+#endif
+
+        /**
+         * Clears samples about to be read by a delayed cursor, which were not
+         * written since the last reset. They lie at the beginning of the read
+         * range, because the further is the sample behind the buffer cursor,
+         * the earlier it was written.
+         * @param delayedCursor a buffer index of the first sample to be read.
+         * @param distance a distance of the delayed cursor behind the buffer cursor.
+         * @param sampleFrames number of samples to be read, the range must not wrap.
+         */
+        void ClearUnwritten(int delayedCursor, int distance, int sampleFrames);
+
+        /**
+         * Clears samples of one buffer about to be read by a delayed cursor
+         * during a block, which were not written since the last reset.
+         * @param buffer a buffer to clear.
+         * @param distance a distance of the delayed cursor behind the buffer cursor.
+         * @param sampleFrames number of frames of the block, the read range may wrap.
+         */
+        void ClearUnwrittenBlock(float* buffer, int distance, int sampleFrames);
+
+        /**
+         * Advances the watermark by written frames.
+         * @param sampleFrames number of frames written behind the buffer cursor.
+         */
+        void AdvanceWatermark(int sampleFrames);
+
+        /**
+         * Increments the inner buffer cursors.
+         */
+        void IncrementBufferCursor();
+
+        /**
+         * Proper math modulo arithmetic function for the cursor not
+         * to exceed bounds of the buffer arrays while calculating
+         * delayed index.
+         * @param cursorIndex a buffer index, does not matter if exceeded
+         *   outside from buffer arrays.
+         * @return (cursorIndex) mod (buffer size).
+         */
+        int BufferModulo(int cursorIndex);
+
+        /**
+         * Calculates evenly corresponding integer value from interval
+         * [min, max] to value from interval [0, 1].
+         * @param param a parameter value from interval [0, 1].
+         * @param min a lower bound of closed output interval.
+         * @param max an upper bound of closed output interval.
+         * @return corresponding int value from [min, max].
+         */
+        static int Corresponding(float param, int min, int max);
+
+        /**
+         * Calculates evenly corresponding float value from interval
+         * [min, max] to value from interval [0, 1].
+         * @param param a parameter value from interval [0, 1].
+         * @param min a lower bound of closed output interval.
+         * @param max an upper bound of closed output interval.
+         * @return corresponding float value from [min, max].
+         */
+        static float Corresponding(float param, float min, float max);
+
+
+        /**
+         * Size of the stereo buffer, reduced by the economy factor
+         * the buffers are allocated for.
+         *
+         * @see leftBuffer_
+         * @see rightBuffer_
+         */
+        int bufferSize_;
+
+        /**
+         * Size of the stereo buffer at the full rate given to the constructor.
+         */
+        int fullBufferSize_;
+
+        /**
+         * Inner time info containing valid tempo information.
+         */
+        VstTimeInfo* timeInfo_;
+
+
+        // Fields for parameters of unit settings.
+        /**
+         * Stores the value of delay parameter.
+         */
+        float delayParam_;
+
+        /**
+         * Stores the value of feedback parameter.
+         */
+        float feedbackParam_;
+
+        /**
+         * Stores the value of panorama parameter.
+         */
+        float panoramaParam_;
+
+        /**
+         * Stores the value of wet parameter.
+         */
+        float wetParam_;
+
+        /**
+         * Stores the value of synchronization parameter.
+         */
+        float syncParam_;
+
+
+        // Auxiliary fields for unit settings.
+        /**
+         * Field containing corresponding delay time in milliseconds set by
+         * delay parameter value while unit is usynchronized with its time info
+         * inner tempo.
+         *
+         * @see timeInfo_
+         */
+        int asyncDelayMs_;
+
+        /**
+         * This index points to the syncRatios_ index of which ratio is
+         * currently set by delay parameter value while unit is synchronized
+         * with its time info inner tempo.
+         *
+         * @see syncRatios_
+         * @see timeInfo_
+         */
+        int syncDelayRatioIndex_;
+
+        /**
+         * Field representing the precalculated correspondening feedback value
+         * to the interval [minFeedback_, maxFeedback_]set by feedbackParam_.
+         *
+         * @see minFeedback_
+         * @see maxFeedback_
+         * @see feedbackParam_
+         */
+        float feedback_;
+
+        /**
+         * This field together with panoramaParam_ are used to provide ping
+         * pong delaying. They represent the ratio of delaying signal in one
+         * channel in comparison to the other. They are always complementary
+         * so their sum must be equal to 1.
+         *
+         * @see panoramaParam_
+         */
+        float panoramaParamC_;
+
+        /**
+         * primaryPanningQuotient_ & secondaryPanningQuotient_ are used to provide
+         * stereo delaying. They represent the ratio of respectively left and
+         * right channel input sample to be delayed in left channel and the
+         * ratio of respectively right and left channel input sample to be
+         * delayed in right channel. They are always complementary. Their
+         * sum must be equal to 1.
+         *
+         * @see secondaryPanningQuotient_
+         */
+        float primaryPanningQuotient_;
+
+        /**
+         * primaryPanningQuotient_ & secondaryPanningQuotient_ are used to provide
+         * stereo delaying. They represent the ratio of respectively left and
+         * right channel input sample to be delayed in left channel and the
+         * ratio of respectively right and left channel input sample to be
+         * delayed in right channel. They are always complementary. Their
+         * sum must be equal to 1.
+         *
+         * @see primaryPanningQuotient_
+         */
+        float secondaryPanningQuotient_;
+
+        /**
+         * This field together with wetParam_ are complementary so that
+         * their sum must be equal to 1. In This ratio is also called a "dry"
+         * ratio in audio effect terminology. Wet represents the ratio of
+         * effected while dry represents the ratio of original signal in output.
+         *
+         * @see wetParam_
+         */
+        float wetParamC_;
+
+        /**
+         * This field stores the precalculated value representing weather the
+         * unit is synchronized ("true") with its time info or not ("false").
+         */
+        bool isAsync_;
+
+
+        // Fields for the taps.
+        /**
+         * Tap count parameter setting of unit.
+         */
+        float tapCountParam_;
+
+        /**
+         * Number of enabled taps corresponding to tapCountParam_.
+         */
+        int tapCount_;
+
+        /**
+         * Time parameter settings of the taps.
+         */
+        float tapTimeParams_[maxTapCount];
+
+        /**
+         * Ratios of the delay the taps read the delay line at,
+         * corresponding to tapTimeParams_.
+         */
+        float tapTimeRatios_[maxTapCount];
+
+        /**
+         * Gain parameter settings of the taps.
+         */
+        float tapGainParams_[maxTapCount];
+
+        /**
+         * Panorama parameter settings of the taps.
+         */
+        float tapPanoramaParams_[maxTapCount];
+
+        /**
+         * Precalculated gains of the taps in the left channel, applied
+         * to the sum of both delayed channels.
+         */
+        float tapLeftGains_[maxTapCount];
+
+        /**
+         * Precalculated gains of the taps in the right channel, applied
+         * to the sum of both delayed channels.
+         */
+        float tapRightGains_[maxTapCount];
+
+
+        // Fields for the interpolation.
+        /**
+         * Interpolation parameter setting of unit.
+         */
+        float interpolationParam_;
+
+        /**
+         * Interpolation of the delay line reads corresponding
+         * to interpolationParam_.
+         */
+        int interpolation_;
+
+        /**
+         * The previous left channel samples of the semi and the full delayed
+         * read heads, kept by the allpass interpolation.
+         */
+        float leftAllpassStates_[2];
+
+        /**
+         * The previous right channel samples of the semi and the full delayed
+         * read heads, kept by the allpass interpolation.
+         */
+        float rightAllpassStates_[2];
+
+
+        // Fields for the freeze.
+        /**
+         * Freeze parameter setting of unit.
+         */
+        float freezeParam_;
+
+        /**
+         * Tells whether the delay line is to be frozen, corresponding
+         * to freezeParam_.
+         */
+        bool isFrozen_;
+
+        /**
+         * Length of the frozen loop in samples, zero unless the delay line
+         * is frozen or thawing.
+         */
+        int freezeLength_;
+
+        /**
+         * Buffer index the delay line was frozen at, the loop ends just
+         * before it.
+         */
+        int freezeCursor_;
+
+        /**
+         * Number of frames played since the loop last began, from
+         * [0, freezeLength_).
+         */
+        int freezeOffset_;
+
+        /**
+         * The previous left channel samples of the read heads of the loop
+         * being faded out, kept by the allpass interpolation.
+         */
+        float frozenLeftAllpassStates_[2];
+
+        /**
+         * The previous right channel samples of the read heads of the loop
+         * being faded out, kept by the allpass interpolation.
+         */
+        float frozenRightAllpassStates_[2];
+
+        /**
+         * Number of frames of the current crossfade from the loop.
+         */
+        int thawLength_;
+
+        /**
+         * Number of frames left until the crossfade from the loop ends,
+         * zero if the unit does not thaw.
+         */
+        int thawFrames_;
+
+
+        // Fields for the economy.
+        /**
+         * Economy parameter setting of unit.
+         */
+        float economyParam_;
+
+        /**
+         * Index of the economy from economyStrings_ corresponding
+         * to economyParam_.
+         */
+        int economy_;
+
+        /**
+         * Factor by which the sample rate of the delay line is currently
+         * reduced, the one the buffers are allocated for, 1 if it runs
+         * at the full rate.
+         */
+        int economyFactor_;
+
+        /**
+         * Tells whether the delay line is being processed at the reduced
+         * rate, so that its output leaves out the dry input.
+         */
+        bool isReducing_;
+
+        /**
+         * Gain of the dry input at the end of the previous block processed
+         * at the reduced rate, the dry input is ramped from it.
+         */
+        float economyDryGain_;
+
+        /**
+         * Resampler decimating the input into the delay line and
+         * interpolating its echoes back.
+         */
+        PingPongDelayResampler resampler_;
+
+        /**
+         * Decimated left channel samples of a chunk, replaced by the echoes.
+         */
+        float leftReduced_[maxResampledFrames];
+
+        /**
+         * Decimated right channel samples of a chunk, replaced by the echoes.
+         */
+        float rightReduced_[maxResampledFrames];
+
+        /**
+         * Left channel echoes of a chunk interpolated back to the full rate.
+         */
+        float leftEchoes_[maxResamplingFactor * maxResampledFrames];
+
+        /**
+         * Right channel echoes of a chunk interpolated back to the full rate.
+         */
+        float rightEchoes_[maxResamplingFactor * maxResampledFrames];
+
+
+        // Fields for the tempo ramps.
+        /**
+         * Time info tempo of the previous block, zero if there is no tempo
+         * to ramp from.
+         */
+        double rampTempo_;
+
+        /**
+         * Musical position in quarter notes the next block is expected
+         * to start at, if the playback is not relocated.
+         */
+        double rampPpqPos_;
+
+        /**
+         * Tells whether rampPpqPos_ is known.
+         */
+        bool rampPpqPosValid_;
+
+
+        // Fields for the published settings.
+        /**
+         * Settings published to the audio thread.
+         */
+        PingPongDelaySettings publishedSettings_;
+
+        /**
+         * Seqlock sequence number of publishedSettings_, odd while they
+         * are being written.
+         */
+        std::atomic<unsigned int> publishedSequence_;
+
+        /**
+         * Sequence number of the settings taken over by the audio thread.
+         */
+        std::atomic<unsigned int> takenSequence_;
+
+        /**
+         * Settings being faded out.
+         */
+        PingPongDelaySettings fadingSettings_;
+
+        /**
+         * The previous left channel samples of the read heads of
+         * fadingSettings_, kept by the allpass interpolation.
+         */
+        float fadingLeftAllpassStates_[2];
+
+        /**
+         * The previous right channel samples of the read heads of
+         * fadingSettings_, kept by the allpass interpolation.
+         */
+        float fadingRightAllpassStates_[2];
+
+        /**
+         * Number of frames of the current crossfade.
+         */
+        int fadeLength_;
+
+        /**
+         * Number of frames left until the crossfade ends, zero if
+         * the unit does not crossfade.
+         */
+        int fadeFrames_;
+
+
+        /**
+         * Buffer cursor pointing to the index where should be current sample
+         * being played written.
+         */
+        int bufferCursor_;
+
+        /**
+         * An array of samples representing left channel circular buffer.
+         * Purpose of this buffers is to track down the dry signal combined with
+         * feedbacked delayed signal on left channel.
+         */
+        float* leftBuffer_;
+
+        /**
+         * An array of samples representing right channel circular buffer.
+         * Purpose of this buffers is to track down the dry signal combined with
+         * feedbacked delayed signal on right channel.
+         */
+        float* rightBuffer_;
+
+        /**
+         * Watermark of the buffers, number of frames written behind
+         * the buffer cursor since the last reset, at most the buffer size.
+         * Older samples are stale and are treated as silence.
+         */
+        int writtenFrames_;
+
+
+        // Fields for metering of levels.
+        /**
+         * Peak levels accumulated within the current metering window.
+         */
+        float meterPeaks_[meterPointCount][meterChannelCount];
+
+        /**
+         * Sums of squared samples accumulated within the current metering
+         * window.
+         */
+        double meterSums_[meterPointCount][meterChannelCount];
+
+        /**
+         * Number of frames accumulated within the current metering window.
+         */
+        int meterFrames_;
+
+        /**
+         * Snapshot of the levels of the latest complete metering window.
+         */
+        PingPongDelayLevelsSnapshot levels_;
+
+#ifdef PINGPONGDELAY_TRIMMING
+        // Fields for idle memory trimming.
+        /**
+         * State of the buffers, one of PingPongDelayBufferState.
+         */
+        std::atomic<int> bufferState_;
+
+        /**
+         * Time of silence after which the buffers are offered to be
+         * trimmed in milliseconds, zero if the trimming is disabled.
+         */
+        int idleTrimMs_;
+
+        /**
+         * Number of frames, through which the input and the delay line
+         * have been silent.
+         */
+        int silentFrames_;
+#endif
+
+
+        // Fields representing the possible settings of
+        // delaying time of unit while it is asynchronous.
+        /**
+         * Lower bound of possible asynchronous delay settings in ms.
+         */
+        static const int minAsyncDelayMs_;
+
+        /**
+         * Upper bound of possible asynchronous delay settings in ms.
+         */
+        static const int maxAsyncDelayMs_;
+
+
+        // Fields representing the possible settings of
+        // delaying time of unit while it is synchronized.
+        /**
+         * Stores the number of possible synchronized delay ratio settings.
+         * It is the size of syncDelayRatios_ array.
+         *
+         * @see syncDelayRatios_
+         */
+        static const int syncDelayRatioCount_;
+
+        /**
+         * Stores the possible synchronized delay ratios.
+         */
+        static const float syncDelayRatios_[];
+
+        /**
+         * Stores the strings of possible synchronized delay ratios,
+         * from syncDelayRatios_.
+         *
+         * @see syncDelayRatios_.
+         */
+        static const char* syncDelayRatioStrings_[];
+
+        /**
+         * Stores the strings of the interpolations in the order
+         * of PingPongDelayInterpolation.
+         */
+        static const char* interpolationStrings_[];
+
+        /**
+         * Number of possible economies.
+         */
+        static const int economyCount_;
+
+        /**
+         * Stores the strings of the economies, the rates of the delay line
+         * relative to the sample rate.
+         */
+        static const char* economyStrings_[];
+
+        /**
+         * Stores the factors of the economies in the order of economyStrings_.
+         */
+        static const int economyFactors_[];
+
+
+        // Field representing the bounds of feedback ratio.
+        // These constrictions are made due to the protection from
+        // output signal clipping.
+        /**
+         * Lower bound of possible feedback ratio settings.
+         */
+        static const float minFeedback_;
+        /**
+         * Upper bound of possible feedback ratio settings.
+         */
+        static const float maxFeedback_;
+
+        // Fields representing the bounds of tap time ratio.
+        /**
+         * Lower bound of possible tap time ratio settings.
+         */
+        static const float minTapTimeRatio_;
+
+        /**
+         * Upper bound of possible tap time ratio settings. Taps read
+         * at most as far as the echoes fed back, so that the buffers
+         * are long enough for them.
+         */
+        static const float maxTapTimeRatio_;
+
+
+        // Fields representing ratios of time convertions.
+        /**
+         * Stores how many seconds are in minute.
+         */
+        static const int sInMin_;
+
+        /**
+         * Stores how many milliseconds are in second.
+         */
+        static const int msInS_;
+
+        /**
+         * Distance in quarter notes between the expected and the actual
+         * musical position of a block, beyond which the playback is
+         * considered relocated and the delay does not ramp.
+         */
+        static const double rampPpqTolerance_;
+
+        /**
+         * Length of the crossfade to the published settings, into and out
+         * of the frozen loop and of the seam of the loop in milliseconds.
+         */
+        static const int fadeMs_;
+
+        /**
+         * Length of the metering window in milliseconds.
+         */
+        static const int meterWindowMs_;
+
+        /**
+         * Number of lanes the levels are accumulated in, so that
+         * the metering vectorizes together with the processing.
+         */
+        static const int meterLaneCount_ = 4;
+
+        /**
+         * Number of frames of a channel computed at once by ProcessChannel
+         * and MixChannels, all of them read before any is written, so that
+         * the loops vectorize.
+         */
+        static const int channelLaneCount_ = 8;
+
+#ifdef PINGPONGDELAY_TRIMMING
+        /**
+         * Level below which samples are considered silent.
+         */
+        static const float silenceLevel_;
+#endif
     };
 }
 
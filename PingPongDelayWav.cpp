@@ -0,0 +1,922 @@
+/**
+ * PingPongDelayWav.cpp:
+ *
+ * Implementation of PingPongDelayWavReader and PingPongDelayWavWriter
+ * classes streaming WAV and RF64 files in blocks.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayWavReader
+ * @see PingPongDelayWavWriter
+ */
+
+
+// Files over 2 GB must be seekable on 32-bit systems too.
+#define _FILE_OFFSET_BITS 64
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <algorithm>
+
+#ifndef PINGPONGDELAYWAV_H
+#include "PingPongDelayWav.h"
+#endif
+
+
+namespace PingPongDelay
+{
+    /**
+     * WAVE format tag of integer samples.
+     */
+    const int pcmFormatTag = 1;
+
+    /**
+     * WAVE format tag of floating point samples.
+     */
+    const int floatFormatTag = 3;
+
+    /**
+     * WAVE format tag of the extensible format, whose sub format holds
+     * the actual tag.
+     */
+    const int extensibleFormatTag = 0xFFFE;
+
+    /**
+     * Size of the header written by PingPongDelayWavWriter in bytes.
+     */
+    const int wavHeaderBytes = 80;
+
+    /**
+     * Size of the ds64 chunk written by PingPongDelayWavWriter in bytes,
+     * also the size of the JUNK chunk reserving its space.
+     */
+    const int ds64ChunkBytes = 28;
+
+    /**
+     * Value of 32-bit size fields replaced by ds64 chunk in RF64 files.
+     */
+    const unsigned long long rf64SizeMarker = 0xFFFFFFFFULL;
+
+
+    /**
+     * Reads a little endian unsigned value.
+     * @param data bytes of the value.
+     * @param bytes number of bytes of the value.
+     * @return the value.
+     */
+    static unsigned long long GetLittleEndian(const unsigned char* data, int bytes)
+    {
+        unsigned long long value = 0;
+        for(int i = bytes - 1; i >= 0; --i)
+        {
+            value = (value << 8) | data[i];
+        }
+        return value;
+    }
+
+    /**
+     * Writes a little endian unsigned value.
+     * @param data where to store the bytes of the value.
+     * @param value the value.
+     * @param bytes number of bytes of the value.
+     */
+    static void PutLittleEndian(unsigned char* data, unsigned long long value, int bytes)
+    {
+        for(int i = 0; i < bytes; ++i)
+        {
+            data[i] = (unsigned char)(value >> (8 * i));
+        }
+    }
+
+    /**
+     * Converts interleaved raw samples to float samples of separate channels.
+     * @param data raw interleaved samples.
+     * @param format a format of the samples.
+     * @param channels arrays to store the samples of each channel to.
+     * @param frame index of the first frame to store within the arrays.
+     * @param sampleFrames number of frames to convert.
+     */
+    static void DecodeFrames(const unsigned char* data, const PingPongDelayWavFormat& format, float** channels,
+                             int frame, int sampleFrames)
+    {
+        int channelCount = format.channelCount;
+        // Switching once per block, so that the loops stay tight.
+        switch(format.sampleFormat)
+        {
+            case Pcm16Format:
+                for(int i = 0; i < sampleFrames; ++i)
+                {
+                    for(int channel = 0; channel < channelCount; ++channel, data += 2)
+                    {
+                        int16_t sample;
+                        memcpy(&sample, data, sizeof(sample));
+                        channels[channel][frame + i] = sample * (1.0f / 32768.0f);
+                    }
+                }
+                break;
+
+            case Pcm24Format:
+                for(int i = 0; i < sampleFrames; ++i)
+                {
+                    for(int channel = 0; channel < channelCount; ++channel, data += 3)
+                    {
+                        // Shifting the sample to the top bits and back extends its sign.
+                        int32_t sample = (int32_t)(((uint32_t)data[0] << 8) | ((uint32_t)data[1] << 16) |
+                                                   ((uint32_t)data[2] << 24)) >> 8;
+                        channels[channel][frame + i] = sample * (1.0f / 8388608.0f);
+                    }
+                }
+                break;
+
+            case Pcm32Format:
+                for(int i = 0; i < sampleFrames; ++i)
+                {
+                    for(int channel = 0; channel < channelCount; ++channel, data += 4)
+                    {
+                        int32_t sample;
+                        memcpy(&sample, data, sizeof(sample));
+                        channels[channel][frame + i] = (float)(sample * (1.0 / 2147483648.0));
+                    }
+                }
+                break;
+
+            case Float32Format:
+                for(int i = 0; i < sampleFrames; ++i)
+                {
+                    for(int channel = 0; channel < channelCount; ++channel, data += 4)
+                    {
+                        memcpy(&channels[channel][frame + i], data, sizeof(float));
+                    }
+                }
+                break;
+
+            case Float64Format:
+                for(int i = 0; i < sampleFrames; ++i)
+                {
+                    for(int channel = 0; channel < channelCount; ++channel, data += 8)
+                    {
+                        double sample;
+                        memcpy(&sample, data, sizeof(sample));
+                        channels[channel][frame + i] = (float)sample;
+                    }
+                }
+                break;
+        }
+    }
+
+    /**
+     * Converts float samples of separate channels to interleaved raw
+     * samples, clipping them to the range of integer formats.
+     * @param channels arrays of the samples of each channel.
+     * @param frame index of the first frame to convert within the arrays.
+     * @param sampleFrames number of frames to convert.
+     * @param format a format of the samples.
+     * @param data where to store the raw interleaved samples.
+     */
+    static void EncodeFrames(const float* const* channels, int frame, int sampleFrames,
+                             const PingPongDelayWavFormat& format, unsigned char* data)
+    {
+        int channelCount = format.channelCount;
+        switch(format.sampleFormat)
+        {
+            case Pcm16Format:
+                for(int i = 0; i < sampleFrames; ++i)
+                {
+                    for(int channel = 0; channel < channelCount; ++channel, data += 2)
+                    {
+                        float sample = std::min(std::max(channels[channel][frame + i], -1.0f), 1.0f);
+                        int16_t value = (int16_t)lrintf(sample * 32767.0f);
+                        memcpy(data, &value, sizeof(value));
+                    }
+                }
+                break;
+
+            case Pcm24Format:
+                for(int i = 0; i < sampleFrames; ++i)
+                {
+                    for(int channel = 0; channel < channelCount; ++channel, data += 3)
+                    {
+                        float sample = std::min(std::max(channels[channel][frame + i], -1.0f), 1.0f);
+                        PutLittleEndian(data, (uint32_t)(int32_t)lrintf(sample * 8388607.0f), 3);
+                    }
+                }
+                break;
+
+            case Pcm32Format:
+                for(int i = 0; i < sampleFrames; ++i)
+                {
+                    for(int channel = 0; channel < channelCount; ++channel, data += 4)
+                    {
+                        double sample = std::min(std::max((double)channels[channel][frame + i], -1.0), 1.0);
+                        int32_t value = (int32_t)lrint(sample * 2147483647.0);
+                        memcpy(data, &value, sizeof(value));
+                    }
+                }
+                break;
+
+            case Float32Format:
+                for(int i = 0; i < sampleFrames; ++i)
+                {
+                    for(int channel = 0; channel < channelCount; ++channel, data += 4)
+                    {
+                        memcpy(data, &channels[channel][frame + i], sizeof(float));
+                    }
+                }
+                break;
+
+            case Float64Format:
+                for(int i = 0; i < sampleFrames; ++i)
+                {
+                    for(int channel = 0; channel < channelCount; ++channel, data += 8)
+                    {
+                        double sample = channels[channel][frame + i];
+                        memcpy(data, &sample, sizeof(sample));
+                    }
+                }
+                break;
+        }
+    }
+
+
+    /**
+     * Gets the size of a sample of a format.
+     * @param sampleFormat a format of the sample.
+     * @return size of the sample in bytes.
+     */
+    int SampleBytes(PingPongDelaySampleFormat sampleFormat)
+    {
+        switch(sampleFormat)
+        {
+            case Pcm16Format:
+                return 2;
+
+            case Pcm24Format:
+                return 3;
+
+            case Float64Format:
+                return 8;
+
+            default:
+                return 4;
+        }
+    }
+
+
+    /**
+     * A constructor. The reader has no file open.
+     */
+    PingPongDelayWavReader::PingPongDelayWavReader() :
+        file_(NULL),
+        remainingBytes_(0),
+        slot_(0),
+        slotPosition_(0),
+        slotCapacity_(0),
+        error_(NULL),
+        stopping_(false)
+    {
+        memset(&format_, 0, sizeof(format_));
+        memset(slots_, 0, sizeof(slots_));
+    }
+
+    /**
+     * A destructor. Closes the file, if open.
+     */
+    PingPongDelayWavReader::~PingPongDelayWavReader()
+    {
+        Close();
+    }
+
+    /**
+     * Opens a file and starts reading it ahead.
+     * @param path a path of the file.
+     * @param blockFrames number of frames read ahead at once.
+     * @param startFrame number of frames skipped at the beginning of
+     *      the file.
+     * @return true if the file was opened, false otherwise, the error
+     *      is described by GetError.
+     */
+    bool PingPongDelayWavReader::Open(const char* path, int blockFrames, unsigned long long startFrame)
+    {
+        Close();
+        error_ = NULL;
+        if(!(file_ = fopen(path, "rb")))
+        {
+            error_ = "cannot open the file";
+            return false;
+        }
+        if(!ParseHeader())
+        {
+            fclose(file_);
+            file_ = NULL;
+            return false;
+        }
+
+        size_t frameBytes = (size_t)format_.channelCount * SampleBytes(format_.sampleFormat);
+        unsigned long long skippedBytes = std::min(startFrame, format_.frameCount) * frameBytes;
+        if(fseeko(file_, (off_t)skippedBytes, SEEK_CUR) != 0)
+        {
+            error_ = "cannot seek the file";
+            fclose(file_);
+            file_ = NULL;
+            return false;
+        }
+        remainingBytes_ -= skippedBytes;
+
+        slotCapacity_ = (size_t)blockFrames * frameBytes;
+        for(int i = 0; i < 2; ++i)
+        {
+            slots_[i].data = new unsigned char[slotCapacity_];
+            slots_[i].length = 0;
+            slots_[i].full = false;
+        }
+        slot_ = 0;
+        slotPosition_ = 0;
+        stopping_ = false;
+        readThread_ = std::thread(&PingPongDelayWavReader::ReadLoop, this);
+        return true;
+    }
+
+    /**
+     * Closes the file, stopping the background thread.
+     */
+    void PingPongDelayWavReader::Close()
+    {
+        if(!file_)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(slotsMutex_);
+            stopping_ = true;
+        }
+        slotsChanged_.notify_all();
+        readThread_.join();
+
+        fclose(file_);
+        file_ = NULL;
+        for(int i = 0; i < 2; ++i)
+        {
+            delete[] slots_[i].data;
+            slots_[i].data = NULL;
+        }
+    }
+
+    /**
+     * Gets the format of the open file.
+     * @return format of the file.
+     */
+    const PingPongDelayWavFormat& PingPongDelayWavReader::GetFormat()
+    {
+        return format_;
+    }
+
+    /**
+     * Reads the next frames, converting them to float samples
+     * of separate channels.
+     * @param channels arrays to store the samples of each channel of
+     *      the file to.
+     * @param sampleFrames number of frames to read.
+     * @return number of frames read, less than sampleFrames only at
+     *      the end of the file or on an error.
+     */
+    int PingPongDelayWavReader::Read(float** channels, int sampleFrames)
+    {
+        size_t frameBytes = (size_t)format_.channelCount * SampleBytes(format_.sampleFormat);
+        int frame = 0;
+        while(frame < sampleFrames)
+        {
+            PingPongDelayWavSlot& slot = slots_[slot_];
+            {
+                std::unique_lock<std::mutex> lock(slotsMutex_);
+                slotsChanged_.wait(lock, [&slot] { return slot.full; });
+            }
+            // Empty slot marks the end of the file, it is kept full.
+            if(slot.length == 0)
+            {
+                break;
+            }
+
+            int frames = std::min((int)((slot.length - slotPosition_) / frameBytes), sampleFrames - frame);
+            DecodeFrames(slot.data + slotPosition_, format_, channels, frame, frames);
+            frame += frames;
+            slotPosition_ += frames * frameBytes;
+
+            // Handing the drained slot back, a partial frame left by
+            // a short read is dropped.
+            if(slot.length - slotPosition_ < frameBytes)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(slotsMutex_);
+                    slot.full = false;
+                }
+                slotsChanged_.notify_all();
+                slot_ ^= 1;
+                slotPosition_ = 0;
+            }
+        }
+        return frame;
+    }
+
+    /**
+     * Gets the description of the last error.
+     * @return description of the error, NULL if none.
+     */
+    const char* PingPongDelayWavReader::GetError()
+    {
+        return error_;
+    }
+
+    /**
+     * Parses the header of the file and seeks to the samples.
+     * @return true if the file is a supported WAV or RF64 file,
+     *      false otherwise.
+     */
+    bool PingPongDelayWavReader::ParseHeader()
+    {
+        unsigned char header[12];
+        if(fread(header, 1, sizeof(header), file_) != sizeof(header) ||
+           (memcmp(header, "RIFF", 4) != 0 && memcmp(header, "RF64", 4) != 0) || memcmp(header + 8, "WAVE", 4) != 0)
+        {
+            error_ = "not a WAV file";
+            return false;
+        }
+
+        bool isRf64 = (memcmp(header, "RF64", 4) == 0);
+        unsigned long long ds64DataBytes = 0;
+        int formatTag = 0;
+        int bitsPerSample = 0;
+        int blockAlign = 0;
+        format_.channelCount = 0;
+        for(;;)
+        {
+            unsigned char chunk[8];
+            if(fread(chunk, 1, sizeof(chunk), file_) != sizeof(chunk))
+            {
+                error_ = "no data chunk";
+                return false;
+            }
+            unsigned long long chunkBytes = GetLittleEndian(chunk + 4, 4);
+
+            if(memcmp(chunk, "data", 4) == 0)
+            {
+                if(format_.channelCount == 0)
+                {
+                    error_ = "no fmt chunk before the data chunk";
+                    return false;
+                }
+                if(isRf64 && chunkBytes == rf64SizeMarker)
+                {
+                    chunkBytes = ds64DataBytes;
+                }
+
+                // Size of data written by a crashed or streaming writer may
+                // be unknown, the rest of the file is taken then.
+                off_t dataOffset = ftello(file_);
+                fseeko(file_, 0, SEEK_END);
+                unsigned long long availableBytes = (unsigned long long)(ftello(file_) - dataOffset);
+                fseeko(file_, dataOffset, SEEK_SET);
+                if(chunkBytes == 0 || chunkBytes > availableBytes)
+                {
+                    chunkBytes = availableBytes;
+                }
+                format_.frameCount = chunkBytes / blockAlign;
+                remainingBytes_ = format_.frameCount * blockAlign;
+                return true;
+            }
+
+            unsigned char body[40];
+            size_t bodyBytes = (size_t)std::min(chunkBytes, (unsigned long long)sizeof(body));
+            if(fread(body, 1, bodyBytes, file_) != bodyBytes)
+            {
+                error_ = "truncated header";
+                return false;
+            }
+
+            if(memcmp(chunk, "ds64", 4) == 0 && bodyBytes >= 16)
+            {
+                ds64DataBytes = GetLittleEndian(body + 8, 8);
+            }
+            else if(memcmp(chunk, "fmt ", 4) == 0 && bodyBytes >= 16)
+            {
+                formatTag = (int)GetLittleEndian(body, 2);
+                format_.channelCount = (int)GetLittleEndian(body + 2, 2);
+                format_.sampleRate = (int)GetLittleEndian(body + 4, 4);
+                blockAlign = (int)GetLittleEndian(body + 12, 2);
+                bitsPerSample = (int)GetLittleEndian(body + 14, 2);
+                if(formatTag == extensibleFormatTag && bodyBytes >= 26)
+                {
+                    // First two bytes of the sub format GUID hold the tag.
+                    formatTag = (int)GetLittleEndian(body + 24, 2);
+                }
+
+                if(formatTag == pcmFormatTag && bitsPerSample == 16)
+                {
+                    format_.sampleFormat = Pcm16Format;
+                }
+                else if(formatTag == pcmFormatTag && bitsPerSample == 24)
+                {
+                    format_.sampleFormat = Pcm24Format;
+                }
+                else if(formatTag == pcmFormatTag && bitsPerSample == 32)
+                {
+                    format_.sampleFormat = Pcm32Format;
+                }
+                else if(formatTag == floatFormatTag && bitsPerSample == 32)
+                {
+                    format_.sampleFormat = Float32Format;
+                }
+                else if(formatTag == floatFormatTag && bitsPerSample == 64)
+                {
+                    format_.sampleFormat = Float64Format;
+                }
+                else
+                {
+                    error_ = "unsupported sample format";
+                    return false;
+                }
+                if(format_.channelCount <= 0 || blockAlign != format_.channelCount * SampleBytes(format_.sampleFormat))
+                {
+                    error_ = "invalid fmt chunk";
+                    return false;
+                }
+            }
+
+            // Skipping the rest of the chunk, chunks are word aligned.
+            unsigned long long skippedBytes = chunkBytes - bodyBytes + (chunkBytes & 1);
+            if(fseeko(file_, (off_t)skippedBytes, SEEK_CUR) != 0)
+            {
+                error_ = "truncated header";
+                return false;
+            }
+        }
+    }
+
+    /**
+     * Body of the background thread reading the blocks.
+     */
+    void PingPongDelayWavReader::ReadLoop()
+    {
+        for(int slot = 0; ; slot ^= 1)
+        {
+            {
+                std::unique_lock<std::mutex> lock(slotsMutex_);
+                slotsChanged_.wait(lock, [this, slot] { return !slots_[slot].full || stopping_; });
+                if(stopping_)
+                {
+                    return;
+                }
+            }
+
+            // The slot is owned by this thread until it is marked full.
+            size_t length = (size_t)std::min((unsigned long long)slotCapacity_, remainingBytes_);
+            length = fread(slots_[slot].data, 1, length, file_);
+            remainingBytes_ -= length;
+            {
+                std::lock_guard<std::mutex> lock(slotsMutex_);
+                slots_[slot].length = length;
+                slots_[slot].full = true;
+            }
+            slotsChanged_.notify_all();
+
+            if(length == 0)
+            {
+                return;
+            }
+        }
+    }
+
+
+    /**
+     * A constructor. The writer has no file open.
+     */
+    PingPongDelayWavWriter::PingPongDelayWavWriter() :
+        file_(NULL),
+        writtenBytes_(0),
+        slot_(0),
+        slotCapacity_(0),
+        error_(NULL),
+        failed_(false),
+        closing_(false)
+    {
+        memset(&format_, 0, sizeof(format_));
+        memset(slots_, 0, sizeof(slots_));
+    }
+
+    /**
+     * A destructor. Closes the file, if open.
+     */
+    PingPongDelayWavWriter::~PingPongDelayWavWriter()
+    {
+        Close();
+    }
+
+    /**
+     * Creates a file and starts writing it behind.
+     * @param path a path of the file.
+     * @param channelCount number of channels.
+     * @param sampleRate sample rate in Hz.
+     * @param sampleFormat format of the samples.
+     * @param blockFrames number of frames written behind at once.
+     * @return true if the file was created, false otherwise, the error
+     *      is described by GetError.
+     */
+    bool PingPongDelayWavWriter::Open(const char* path, int channelCount, int sampleRate,
+                                      PingPongDelaySampleFormat sampleFormat, int blockFrames)
+    {
+        Close();
+        error_ = NULL;
+        format_.channelCount = channelCount;
+        format_.sampleRate = sampleRate;
+        format_.sampleFormat = sampleFormat;
+        format_.frameCount = 0;
+        if(!(file_ = fopen(path, "wb")))
+        {
+            error_ = "cannot create the file";
+            return false;
+        }
+        if(!WriteHeader(0))
+        {
+            fclose(file_);
+            file_ = NULL;
+            return false;
+        }
+
+        writtenBytes_ = 0;
+        StartWriting(blockFrames);
+        return true;
+    }
+
+    /**
+     * Opens a file written by the writer before and starts writing it
+     * behind from a frame on, the following frames are replaced.
+     * @param path a path of the file.
+     * @param channelCount number of channels, must equal the one of the file.
+     * @param sampleRate sample rate in Hz, must equal the one of the file.
+     * @param sampleFormat format of the samples, must equal the one of the file.
+     * @param blockFrames number of frames written behind at once.
+     * @param startFrame number of frames of the file kept.
+     * @return true if the file was opened, false otherwise, the error
+     *      is described by GetError.
+     */
+    bool PingPongDelayWavWriter::Resume(const char* path, int channelCount, int sampleRate,
+                                        PingPongDelaySampleFormat sampleFormat, int blockFrames,
+                                        unsigned long long startFrame)
+    {
+        Close();
+        error_ = NULL;
+        format_.channelCount = channelCount;
+        format_.sampleRate = sampleRate;
+        format_.sampleFormat = sampleFormat;
+        format_.frameCount = 0;
+        if(!(file_ = fopen(path, "r+b")))
+        {
+            error_ = "cannot open the file";
+            return false;
+        }
+
+        // Header written by the writer has the fixed layout, the samples
+        // follow it right away.
+        unsigned char header[wavHeaderBytes];
+        int sampleBytes = SampleBytes(sampleFormat);
+        bool isFloat = (sampleFormat == Float32Format || sampleFormat == Float64Format);
+        unsigned long long startBytes = startFrame * channelCount * sampleBytes;
+        bool valid = (fread(header, 1, sizeof(header), file_) == sizeof(header)) &&
+            memcmp(header + 8, "WAVE", 4) == 0 && memcmp(header + 48, "fmt ", 4) == 0 &&
+            memcmp(header + 72, "data", 4) == 0 &&
+            GetLittleEndian(header + 56, 2) == (unsigned long long)(isFloat ? floatFormatTag : pcmFormatTag) &&
+            GetLittleEndian(header + 58, 2) == (unsigned long long)channelCount &&
+            GetLittleEndian(header + 60, 4) == (unsigned long long)sampleRate &&
+            GetLittleEndian(header + 70, 2) == (unsigned long long)(8 * sampleBytes);
+        if(!valid)
+        {
+            error_ = "not a file of the same format written by the renderer";
+        }
+        else if(fseeko(file_, 0, SEEK_END) != 0 ||
+                (unsigned long long)ftello(file_) < wavHeaderBytes + startBytes ||
+                fseeko(file_, (off_t)(wavHeaderBytes + startBytes), SEEK_SET) != 0)
+        {
+            error_ = "the file is shorter than the resumed frame";
+            valid = false;
+        }
+        if(!valid)
+        {
+            fclose(file_);
+            file_ = NULL;
+            return false;
+        }
+
+        writtenBytes_ = startBytes;
+        StartWriting(blockFrames);
+        return true;
+    }
+
+    /**
+     * Writes the rest of the samples and finishes the header.
+     * @return true if the whole file was written, false otherwise.
+     */
+    bool PingPongDelayWavWriter::Close()
+    {
+        if(!file_)
+        {
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(slotsMutex_);
+            if(slots_[slot_].length > 0)
+            {
+                slots_[slot_].full = true;
+            }
+            closing_ = true;
+        }
+        slotsChanged_.notify_all();
+        writeThread_.join();
+
+        bool written = !failed_;
+        // Data chunk is padded to the even size.
+        if(written && (writtenBytes_ & 1))
+        {
+            written = (fputc(0, file_) != EOF);
+        }
+        written = written && WriteHeader(writtenBytes_);
+        // Samples of the resumed file behind the written ones are cut off.
+        written = written && fflush(file_) == 0 &&
+            ftruncate(fileno(file_), (off_t)(wavHeaderBytes + writtenBytes_ + (writtenBytes_ & 1))) == 0;
+        written = (fclose(file_) == 0) && written;
+        file_ = NULL;
+        for(int i = 0; i < 2; ++i)
+        {
+            delete[] slots_[i].data;
+            slots_[i].data = NULL;
+        }
+        if(!written && !error_)
+        {
+            error_ = "cannot write the file";
+        }
+        return written;
+    }
+
+    /**
+     * Writes frames of float samples of separate channels, clipping
+     * them to the range of integer formats.
+     * @param channels arrays of the samples of each channel.
+     * @param sampleFrames number of frames to write.
+     * @return true on success, false if writing failed.
+     */
+    bool PingPongDelayWavWriter::Write(const float* const* channels, int sampleFrames)
+    {
+        size_t frameBytes = (size_t)format_.channelCount * SampleBytes(format_.sampleFormat);
+        int frame = 0;
+        while(frame < sampleFrames)
+        {
+            PingPongDelayWavSlot& slot = slots_[slot_];
+            int frames = std::min((int)((slotCapacity_ - slot.length) / frameBytes), sampleFrames - frame);
+            EncodeFrames(channels, frame, frames, format_, slot.data + slot.length);
+            slot.length += frames * frameBytes;
+            frame += frames;
+            if(slot.length + frameBytes > slotCapacity_)
+            {
+                HandOver();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(slotsMutex_);
+        if(failed_)
+        {
+            error_ = "cannot write the file";
+        }
+        return !failed_;
+    }
+
+    /**
+     * Gets the description of the last error.
+     * @return description of the error, NULL if none.
+     */
+    const char* PingPongDelayWavWriter::GetError()
+    {
+        return error_;
+    }
+
+    /**
+     * Allocates the slots and starts the background thread.
+     * @param blockFrames number of frames written behind at once.
+     */
+    void PingPongDelayWavWriter::StartWriting(int blockFrames)
+    {
+        slotCapacity_ = (size_t)blockFrames * format_.channelCount * SampleBytes(format_.sampleFormat);
+        for(int i = 0; i < 2; ++i)
+        {
+            slots_[i].data = new unsigned char[slotCapacity_];
+            slots_[i].length = 0;
+            slots_[i].full = false;
+        }
+        slot_ = 0;
+        failed_ = false;
+        closing_ = false;
+        writeThread_ = std::thread(&PingPongDelayWavWriter::WriteLoop, this);
+    }
+
+    /**
+     * Hands the slot being converted over to the background thread
+     * and waits for the other one.
+     */
+    void PingPongDelayWavWriter::HandOver()
+    {
+        {
+            std::lock_guard<std::mutex> lock(slotsMutex_);
+            slots_[slot_].full = true;
+        }
+        slotsChanged_.notify_all();
+
+        slot_ ^= 1;
+        PingPongDelayWavSlot& slot = slots_[slot_];
+        std::unique_lock<std::mutex> lock(slotsMutex_);
+        slotsChanged_.wait(lock, [&slot] { return !slot.full; });
+        slot.length = 0;
+    }
+
+    /**
+     * Writes the header of the file, RIFF with a JUNK chunk reserving
+     * the space of ds64 chunk, or RF64 once the sizes are known.
+     * @param dataBytes number of bytes of the samples.
+     * @return true on success, false otherwise.
+     */
+    bool PingPongDelayWavWriter::WriteHeader(unsigned long long dataBytes)
+    {
+        int sampleBytes = SampleBytes(format_.sampleFormat);
+        int blockAlign = format_.channelCount * sampleBytes;
+        unsigned long long riffBytes = (wavHeaderBytes - 8) + dataBytes + (dataBytes & 1);
+        bool isRf64 = (riffBytes >= rf64SizeMarker);
+
+        unsigned char header[wavHeaderBytes];
+        memset(header, 0, sizeof(header));
+        memcpy(header, isRf64 ? "RF64" : "RIFF", 4);
+        PutLittleEndian(header + 4, isRf64 ? rf64SizeMarker : riffBytes, 4);
+        memcpy(header + 8, "WAVE", 4);
+
+        // JUNK chunk is turned into ds64 chunk in place.
+        memcpy(header + 12, isRf64 ? "ds64" : "JUNK", 4);
+        PutLittleEndian(header + 16, ds64ChunkBytes, 4);
+        if(isRf64)
+        {
+            PutLittleEndian(header + 20, riffBytes, 8);
+            PutLittleEndian(header + 28, dataBytes, 8);
+            PutLittleEndian(header + 36, dataBytes / blockAlign, 8);
+        }
+
+        memcpy(header + 48, "fmt ", 4);
+        PutLittleEndian(header + 52, 16, 4);
+        bool isFloat = (format_.sampleFormat == Float32Format || format_.sampleFormat == Float64Format);
+        PutLittleEndian(header + 56, isFloat ? floatFormatTag : pcmFormatTag, 2);
+        PutLittleEndian(header + 58, format_.channelCount, 2);
+        PutLittleEndian(header + 60, format_.sampleRate, 4);
+        PutLittleEndian(header + 64, (unsigned long long)format_.sampleRate * blockAlign, 4);
+        PutLittleEndian(header + 68, blockAlign, 2);
+        PutLittleEndian(header + 70, 8 * sampleBytes, 2);
+
+        memcpy(header + 72, "data", 4);
+        PutLittleEndian(header + 76, isRf64 ? rf64SizeMarker : dataBytes, 4);
+
+        if(fseeko(file_, 0, SEEK_SET) != 0 || fwrite(header, 1, sizeof(header), file_) != sizeof(header))
+        {
+            error_ = "cannot write the header";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Body of the background thread writing the blocks.
+     */
+    void PingPongDelayWavWriter::WriteLoop()
+    {
+        for(int slot = 0; ; slot ^= 1)
+        {
+            {
+                std::unique_lock<std::mutex> lock(slotsMutex_);
+                slotsChanged_.wait(lock, [this, slot] { return slots_[slot].full || closing_; });
+                if(!slots_[slot].full)
+                {
+                    return;
+                }
+            }
+
+            // The slot is owned by this thread until it is marked empty.
+            size_t length = slots_[slot].length;
+            size_t written = failed_ ? 0 : fwrite(slots_[slot].data, 1, length, file_);
+            writtenBytes_ += written;
+            {
+                std::lock_guard<std::mutex> lock(slotsMutex_);
+                failed_ = failed_ || (written != length);
+                slots_[slot].full = false;
+            }
+            slotsChanged_.notify_all();
+        }
+    }
+}
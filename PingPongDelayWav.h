@@ -0,0 +1,399 @@
+/**
+ * PingPongDelayWav.h:
+ *
+ * Declaration of PingPongDelaySampleFormat enum and PingPongDelayWavFormat
+ * structure describing the format of WAV files.
+ *
+ * Declaration of PingPongDelayWavReader and PingPongDelayWavWriter classes
+ * streaming WAV and RF64 files in blocks, with the file I/O done ahead
+ * and behind by background threads, so that it overlaps the processing
+ * and the memory stays bounded by two blocks whatever the file length.
+ *
+ * Samples are little endian, as is the host the tools run on.
+ *
+ * @author  Jakub Kdela
+ * @version 1.0
+ * @since 2026-10-18
+ *
+ * @see PingPongDelayWavReader
+ * @see PingPongDelayWavWriter
+ */
+
+
+#include <stdio.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#ifndef PINGPONGDELAYWAV_H
+#define PINGPONGDELAYWAV_H
+
+
+namespace PingPongDelay
+{
+    /**
+     * An enum for supported formats of the samples.
+     */
+    enum PingPongDelaySampleFormat
+    {
+        Pcm16Format,
+        Pcm24Format,
+        Pcm32Format,
+        Float32Format,
+        Float64Format,
+    };
+
+
+    /**
+     * Format of a WAV file.
+     */
+    struct PingPongDelayWavFormat
+    {
+        /**
+         * Number of interleaved channels.
+         */
+        int channelCount;
+
+        /**
+         * Sample rate in Hz.
+         */
+        int sampleRate;
+
+        /**
+         * Format of the samples.
+         */
+        PingPongDelaySampleFormat sampleFormat;
+
+        /**
+         * Number of frames of the file.
+         */
+        unsigned long long frameCount;
+    };
+
+
+    /**
+     * Gets the size of a sample of a format.
+     * @param sampleFormat a format of the sample.
+     * @return size of the sample in bytes.
+     */
+    int SampleBytes(PingPongDelaySampleFormat sampleFormat);
+
+
+    /**
+     * Two blocks of raw file data, one of which is being filled or drained
+     * by the background thread while the other one is being converted.
+     */
+    struct PingPongDelayWavSlot
+    {
+        /**
+         * Raw interleaved samples.
+         */
+        unsigned char* data;
+
+        /**
+         * Number of valid bytes of the data.
+         */
+        size_t length;
+
+        /**
+         * True while the slot holds data to be consumed, read data for
+         * the converting thread of the reader or converted data for
+         * the background thread of the writer.
+         */
+        bool full;
+    };
+
+
+    /**
+     * Reader streaming samples of a WAV or RF64 file. A background thread
+     * reads the next block while the current one is being converted.
+     */
+    class PingPongDelayWavReader
+    {
+    public:
+        /**
+         * A constructor. The reader has no file open.
+         */
+        PingPongDelayWavReader();
+
+        /**
+         * A destructor. Closes the file, if open.
+         */
+        ~PingPongDelayWavReader();
+
+        /**
+         * Opens a file and starts reading it ahead.
+         * @param path a path of the file.
+         * @param blockFrames number of frames read ahead at once.
+         * @param startFrame number of frames skipped at the beginning of
+         *      the file.
+         * @return true if the file was opened, false otherwise, the error
+         *      is described by GetError.
+         */
+        bool Open(const char* path, int blockFrames, unsigned long long startFrame);
+
+        /**
+         * Closes the file, stopping the background thread.
+         */
+        void Close();
+
+        /**
+         * Gets the format of the open file.
+         * @return format of the file.
+         */
+        const PingPongDelayWavFormat& GetFormat();
+
+        /**
+         * Reads the next frames, converting them to float samples
+         * of separate channels.
+         * @param channels arrays to store the samples of each channel of
+         *      the file to.
+         * @param sampleFrames number of frames to read.
+         * @return number of frames read, less than sampleFrames only at
+         *      the end of the file or on an error.
+         */
+        int Read(float** channels, int sampleFrames);
+
+        /**
+         * Gets the description of the last error.
+         * @return description of the error, NULL if none.
+         */
+        const char* GetError();
+
+    private:
+        /**
+         * Parses the header of the file and seeks to the samples.
+         * @return true if the file is a supported WAV or RF64 file,
+         *      false otherwise.
+         */
+        bool ParseHeader();
+
+        /**
+         * Body of the background thread reading the blocks.
+         */
+        void ReadLoop();
+
+
+        /**
+         * Open file, NULL if none.
+         */
+        FILE* file_;
+
+        /**
+         * Format of the open file.
+         */
+        PingPongDelayWavFormat format_;
+
+        /**
+         * Number of bytes of the samples not yet read by the background
+         * thread.
+         */
+        unsigned long long remainingBytes_;
+
+        /**
+         * Slots of the raw data.
+         */
+        PingPongDelayWavSlot slots_[2];
+
+        /**
+         * Index of the slot being converted.
+         */
+        int slot_;
+
+        /**
+         * Position within the slot being converted in bytes.
+         */
+        size_t slotPosition_;
+
+        /**
+         * Capacity of each slot in bytes.
+         */
+        size_t slotCapacity_;
+
+        /**
+         * Description of the last error, NULL if none.
+         */
+        const char* error_;
+
+        /**
+         * Background thread reading the blocks.
+         */
+        std::thread readThread_;
+
+        /**
+         * Guards the slot ownership and stopping_.
+         */
+        std::mutex slotsMutex_;
+
+        /**
+         * Signals the change of slot ownership.
+         */
+        std::condition_variable slotsChanged_;
+
+        /**
+         * Tells the background thread to stop reading.
+         */
+        bool stopping_;
+    };
+
+
+    /**
+     * Writer streaming samples into a WAV file. A background thread
+     * writes the previous block while the next one is being converted.
+     * The file is written as RIFF and turned into RF64 when it is closed,
+     * if it exceeds the 4 GB limit of RIFF.
+     */
+    class PingPongDelayWavWriter
+    {
+    public:
+        /**
+         * A constructor. The writer has no file open.
+         */
+        PingPongDelayWavWriter();
+
+        /**
+         * A destructor. Closes the file, if open.
+         */
+        ~PingPongDelayWavWriter();
+
+        /**
+         * Creates a file and starts writing it behind.
+         * @param path a path of the file.
+         * @param channelCount number of channels.
+         * @param sampleRate sample rate in Hz.
+         * @param sampleFormat format of the samples.
+         * @param blockFrames number of frames written behind at once.
+         * @return true if the file was created, false otherwise, the error
+         *      is described by GetError.
+         */
+        bool Open(const char* path, int channelCount, int sampleRate, PingPongDelaySampleFormat sampleFormat,
+                  int blockFrames);
+
+        /**
+         * Opens a file written by the writer before and starts writing it
+         * behind from a frame on, the following frames are replaced.
+         * @param path a path of the file.
+         * @param channelCount number of channels, must equal the one of the file.
+         * @param sampleRate sample rate in Hz, must equal the one of the file.
+         * @param sampleFormat format of the samples, must equal the one of the file.
+         * @param blockFrames number of frames written behind at once.
+         * @param startFrame number of frames of the file kept.
+         * @return true if the file was opened, false otherwise, the error
+         *      is described by GetError.
+         */
+        bool Resume(const char* path, int channelCount, int sampleRate, PingPongDelaySampleFormat sampleFormat,
+                    int blockFrames, unsigned long long startFrame);
+
+        /**
+         * Writes the rest of the samples and finishes the header.
+         * @return true if the whole file was written, false otherwise.
+         */
+        bool Close();
+
+        /**
+         * Writes frames of float samples of separate channels, clipping
+         * them to the range of integer formats.
+         * @param channels arrays of the samples of each channel.
+         * @param sampleFrames number of frames to write.
+         * @return true on success, false if writing failed.
+         */
+        bool Write(const float* const* channels, int sampleFrames);
+
+        /**
+         * Gets the description of the last error.
+         * @return description of the error, NULL if none.
+         */
+        const char* GetError();
+
+    private:
+        /**
+         * Allocates the slots and starts the background thread.
+         * @param blockFrames number of frames written behind at once.
+         */
+        void StartWriting(int blockFrames);
+
+        /**
+         * Hands the slot being converted over to the background thread
+         * and waits for the other one.
+         */
+        void HandOver();
+
+        /**
+         * Writes the header of the file, RIFF with a JUNK chunk reserving
+         * the space of ds64 chunk, or RF64 once the sizes are known.
+         * @param dataBytes number of bytes of the samples.
+         * @return true on success, false otherwise.
+         */
+        bool WriteHeader(unsigned long long dataBytes);
+
+        /**
+         * Body of the background thread writing the blocks.
+         */
+        void WriteLoop();
+
+
+        /**
+         * Open file, NULL if none.
+         */
+        FILE* file_;
+
+        /**
+         * Format of the written file.
+         */
+        PingPongDelayWavFormat format_;
+
+        /**
+         * Number of bytes of the samples written by the background thread.
+         */
+        unsigned long long writtenBytes_;
+
+        /**
+         * Slots of the raw data.
+         */
+        PingPongDelayWavSlot slots_[2];
+
+        /**
+         * Index of the slot being converted.
+         */
+        int slot_;
+
+        /**
+         * Capacity of each slot in bytes.
+         */
+        size_t slotCapacity_;
+
+        /**
+         * Description of the last error, NULL if none.
+         */
+        const char* error_;
+
+        /**
+         * Set by the background thread when writing failed.
+         */
+        bool failed_;
+
+        /**
+         * Background thread writing the blocks.
+         */
+        std::thread writeThread_;
+
+        /**
+         * Guards the slot ownership, closing_ and failed_.
+         */
+        std::mutex slotsMutex_;
+
+        /**
+         * Signals the change of slot ownership.
+         */
+        std::condition_variable slotsChanged_;
+
+        /**
+         * Tells the background thread to stop once all the handed over
+         * slots are written.
+         */
+        bool closing_;
+    };
+}
+
+
+#endif